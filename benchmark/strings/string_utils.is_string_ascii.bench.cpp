@@ -0,0 +1,51 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <base/strings/string_utils.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
+#include <base/strings/typedefs.h>
+#include <benchmark/benchmark.h>
+
+namespace longlp::base {
+namespace {
+  // NOLINTBEGIN(*-magic-numbers)
+
+  // The loop IsStringASCII used to be.
+  template <typename Char>
+  auto ScalarIsStringASCII(std::basic_string_view<Char> str) -> bool {
+    return std::ranges::all_of(str, [](Char character) {
+      return static_cast<std::make_unsigned_t<Char>>(character) < 0x80;
+    });
+  }
+
+  template <typename String, bool kScalar>
+  void BM_IsStringASCII(benchmark::State& state) {
+    const String text(static_cast<size_t>(state.range(0)), 'a');
+    const std::basic_string_view<typename String::value_type> view(text);
+    for (auto _ : state) {
+      if constexpr (kScalar) {
+        benchmark::DoNotOptimize(ScalarIsStringASCII(view));
+      }
+      else {
+        benchmark::DoNotOptimize(IsStringASCII(view));
+      }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(
+      state.iterations() * text.size() * sizeof(typename String::value_type)));
+  }
+
+  BENCHMARK(BM_IsStringASCII<StringUTF8, true>)->Range(16, 64 * 1024);
+  BENCHMARK(BM_IsStringASCII<StringUTF8, false>)->Range(16, 64 * 1024);
+  BENCHMARK(BM_IsStringASCII<StringUTF16, true>)->Range(16, 64 * 1024);
+  BENCHMARK(BM_IsStringASCII<StringUTF16, false>)->Range(16, 64 * 1024);
+  BENCHMARK(BM_IsStringASCII<StringUTF32, true>)->Range(16, 64 * 1024);
+  BENCHMARK(BM_IsStringASCII<StringUTF32, false>)->Range(16, 64 * 1024);
+
+  // NOLINTEND(*-magic-numbers)
+}    // namespace
+}    // namespace longlp::base
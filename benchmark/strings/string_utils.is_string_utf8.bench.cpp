@@ -0,0 +1,87 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <base/strings/string_utils.h>
+
+#include <bit>
+#include <cstdint>
+
+#include <base/icu/utf.h>
+#include <base/strings/typedefs.h>
+#include <base/strings/utf_string_conversion_utils.h>
+#include <benchmark/benchmark.h>
+
+namespace longlp::base {
+namespace {
+  // NOLINTBEGIN(*-magic-numbers)
+
+  // The U8Next loop IsStringUTF8 used to be.
+  auto ScalarIsStringUTF8(StringViewUTF8 str) -> bool {
+    const auto* src    = std::bit_cast<const uint8_t*>(str.data());
+    const auto src_len = static_cast<int32_t>(str.length());
+    for (int32_t char_index = 0; char_index < src_len;) {
+      icu::CodePoint code_point(0);
+      icu::internal::U8Next(src, char_index, src_len, *code_point);
+      if (!IsValidCharacter(code_point)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Roughly 64 KiB of text made of |sample|.
+  auto MakeText(StringViewUTF8 sample) -> StringUTF8 {
+    StringUTF8 text;
+    while (text.size() < 64 * 1024) {
+      text += sample;
+    }
+    return text;
+  }
+
+  const StringViewUTF8 kASCII = LONGLP_LITERAL_UTF8(
+    "The quick brown fox jumps over the lazy dog. ");
+  const StringViewUTF8 kLatin = LONGLP_LITERAL_UTF8(
+    "Le cœur déçu mais l'âme plutôt naïve, Louÿs rêva de crapaüter. ");
+  const StringViewUTF8 kCyrillic = LONGLP_LITERAL_UTF8(
+    "Съешь же ещё этих мягких французских булок, да выпей чаю. ");
+  const StringViewUTF8 kCJK =
+    LONGLP_LITERAL_UTF8("天地玄黄，宇宙洪荒。日月盈昃，辰宿列张。");
+  const StringViewUTF8 kEmoji =
+    LONGLP_LITERAL_UTF8("\U0001F600\U0001F680\U0001F30D\U0001F389 ");
+
+  template <typename Validate>
+  void RunValidation(
+    benchmark::State& state,
+    StringViewUTF8 sample,
+    Validate validate) {
+    const auto text = MakeText(sample);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(validate(text));
+    }
+    state.SetBytesProcessed(
+      static_cast<int64_t>(state.iterations() * text.size()));
+  }
+
+  void BM_ScalarIsStringUTF8(benchmark::State& state, StringViewUTF8 sample) {
+    RunValidation(state, sample, &ScalarIsStringUTF8);
+  }
+
+  void BM_IsStringUTF8(benchmark::State& state, StringViewUTF8 sample) {
+    RunValidation(state, sample, &IsStringUTF8);
+  }
+
+  BENCHMARK_CAPTURE(BM_ScalarIsStringUTF8, ascii, kASCII);
+  BENCHMARK_CAPTURE(BM_IsStringUTF8, ascii, kASCII);
+  BENCHMARK_CAPTURE(BM_ScalarIsStringUTF8, latin, kLatin);
+  BENCHMARK_CAPTURE(BM_IsStringUTF8, latin, kLatin);
+  BENCHMARK_CAPTURE(BM_ScalarIsStringUTF8, cyrillic, kCyrillic);
+  BENCHMARK_CAPTURE(BM_IsStringUTF8, cyrillic, kCyrillic);
+  BENCHMARK_CAPTURE(BM_ScalarIsStringUTF8, cjk, kCJK);
+  BENCHMARK_CAPTURE(BM_IsStringUTF8, cjk, kCJK);
+  BENCHMARK_CAPTURE(BM_ScalarIsStringUTF8, emoji, kEmoji);
+  BENCHMARK_CAPTURE(BM_IsStringUTF8, emoji, kEmoji);
+
+  // NOLINTEND(*-magic-numbers)
+}    // namespace
+}    // namespace longlp::base
@@ -63,6 +63,17 @@
 #  define LONGLP_ALWAYS_INLINE inline
 #endif
 
+// Compiles a single function for an instruction set that is not enabled for the
+// whole translation unit, e.g. LONGLP_TARGET_ATTRIBUTE("avx2"). Callers must
+// check base::CPU before calling such a function. MSVC does not need it since
+// its intrinsics are always available.
+#if (defined(LONGLP_COMPILER_CLANG) || defined(LONGLP_COMPILER_GCC)) && \
+  LONGLP_HAS_ATTRIBUTE(target)
+#  define LONGLP_TARGET_ATTRIBUTE(isa) __attribute__((target(isa)))
+#else
+#  define LONGLP_TARGET_ATTRIBUTE(isa)
+#endif
+
 #if defined(LONGLP_COMPILER_CLANG)
 #  define LONGLP_GSL_OWNER   [[gsl::Owner]]
 #  define LONGLP_GSL_POINTER [[gsl::Pointer]]
@@ -0,0 +1,51 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#ifndef LONGLP_INCLUDE_BASE_CPU_H_
+#define LONGLP_INCLUDE_BASE_CPU_H_
+
+#include "base/base_export.h"
+#include "base/predef.h"
+
+namespace longlp::base {
+
+// Query information about the processor, mostly to select the vectorized
+// kernels at runtime.
+//
+// Only the instruction sets that this library has kernels for are reported.
+// On x86, an AVX feature is only reported when the OS also saves the
+// corresponding registers on context switch.
+//
+// Setting the environment variable LONGLP_CPU_MAX_ISA to "avx2", "sse42" or
+// "none" hides the instruction sets above it, so that the tests run the
+// kernels of every tier on the same host. Other values are ignored.
+class BASE_EXPORT CPU final {
+ public:
+  CPU();
+
+  // Returns the CPU of the running process. The detection is done once and the
+  // instance is never destroyed.
+  static auto GetInstanceNoAllocation() -> const CPU&;
+
+  [[nodiscard]] constexpr auto has_sse42() const -> bool { return has_sse42_; }
+
+  [[nodiscard]] constexpr auto has_avx2() const -> bool { return has_avx2_; }
+
+  // AVX-512 Foundation + Byte and Word instructions.
+  [[nodiscard]] constexpr auto has_avx512bw() const -> bool {
+    return has_avx512bw_;
+  }
+
+  [[nodiscard]] constexpr auto has_neon() const -> bool { return has_neon_; }
+
+ private:
+  bool has_sse42_    = false;
+  bool has_avx2_     = false;
+  bool has_avx512bw_ = false;
+  bool has_neon_     = false;
+};
+
+}    // namespace longlp::base
+
+#endif    // LONGLP_INCLUDE_BASE_CPU_H_
@@ -5,126 +5,216 @@
 #ifndef LONGLP_INCLUDE_BASE_ICU_UTF_H_
 #define LONGLP_INCLUDE_BASE_ICU_UTF_H_
 
-// This file has the relevant components from ICU copied to handle basic
-// UTF8/16/32 conversions. Components are copied from utf8.h
-// and utf16.h into utf.h. The functions and types have been put in the
-// "icu" namespace.
+// This file has the relevant components of ICU reimplemented to handle basic
+// UTF8/16/32 conversions. They follow the macros of utf8.h and utf16.h, with
+// the same results, but are constexpr functions in the "icu" namespace and do
+// not need ICU itself, neither its headers nor its libraries.
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 
-#include <unicode/utf16.h>
-#include <unicode/utf8.h>
-
 #include "base/compiler_specific.h"
 #include "base/types/strong_alias.h"
 
-namespace longlp::base::icu {
-namespace internal {
-
-  LONGLP_DIAGNOSTIC_PUSH
-  LONGLP_CLANG_DIAGNOSTIC_IGNORED("-Wunsafe-buffer-usage")
-
-  // See
-  // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf8_8h.html#aa2298b48749d9f45772c8f5a6885464a
-  LONGLP_ALWAYS_INLINE constexpr auto kU8MaxLength  = U8_MAX_LENGTH;
-  LONGLP_ALWAYS_INLINE constexpr auto kU16MaxLength = U16_MAX_LENGTH;
-
-  // See
-  // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf8_8h.html#a57f3e5429ae4edb27a42367c627aa482
-  // The length can be negative for a NUL-terminated string
-  LONGLP_ALWAYS_INLINE void U8Next(
-    const uint8_t* src,
-    int32_t& offset,
-    const int32_t length,
-    UChar32& codepoint) {
-    LONGLP_DIAGNOSTIC_PUSH
-    LONGLP_CLANG_DIAGNOSTIC_IGNORED("-Wsign-compare")
+namespace longlp::base {
+
+// The code point and UTF-16 code unit types of ICU.
+using UChar32 = int32_t;
+using UChar   = char16_t;
 
-    U8_NEXT(src, offset, length, codepoint);
+namespace icu {
+  namespace internal {
+
+    LONGLP_DIAGNOSTIC_PUSH
+    LONGLP_CLANG_DIAGNOSTIC_IGNORED("-Wunsafe-buffer-usage")
+
+    // NOLINTBEGIN(*-magic-numbers,
+    // cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+    // See
+    // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf8_8h.html#aa2298b48749d9f45772c8f5a6885464a
+    LONGLP_ALWAYS_INLINE constexpr auto kU8MaxLength  = 4;
+    LONGLP_ALWAYS_INLINE constexpr auto kU16MaxLength = 2;
+
+    // Bit (1 << (second byte >> 5)) is set when the second byte is valid
+    // after a three-byte lead, indexed by the low bits of the lead. This
+    // excludes the overlong forms and the surrogates.
+    inline constexpr std::array<uint8_t, 16> kU8Lead3T1Bits = {{
+      0x20, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,
+      0x30, 0x30, 0x30, 0x30, 0x30, 0x10, 0x30, 0x30}};
+
+    // Bit (1 << (lead & 7)) is set when the second byte is valid after a
+    // four-byte lead, indexed by the second byte >> 4. This excludes the
+    // overlong forms and anything past U+10FFFF.
+    inline constexpr std::array<uint8_t, 16> kU8Lead4T1Bits = {{
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x1E, 0x0F, 0x0F, 0x0F, 0x00, 0x00, 0x00, 0x00}};
+
+    // See
+    // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf8_8h.html#a57f3e5429ae4edb27a42367c627aa482
+    // The length can be negative for a NUL-terminated string. An ill-formed
+    // sequence gives a negative |codepoint| and skips its maximal subpart.
+    LONGLP_ALWAYS_INLINE constexpr void U8Next(
+      const uint8_t* src,
+      int32_t& offset,
+      const int32_t length,
+      UChar32& codepoint) {
+      uint32_t lead = src[offset++];
+      if (lead < 0x80) {
+        codepoint = static_cast<UChar32>(lead);
+        return;
+      }
+
+      codepoint = -1;
+      if (offset == length) {
+        return;
+      }
+      uint32_t trail = src[offset];
+      if (lead >= 0xE0) {
+        if (lead < 0xF0) {
+          // U+0800..U+FFFF except surrogates.
+          lead &= 0x0FU;
+          if ((kU8Lead3T1Bits[lead] & (1U << (trail >> 5U))) == 0) {
+            return;
+          }
+          lead = (lead << 6U) | (trail & 0x3FU);
+        }
+        else {
+          // U+10000..U+10FFFF.
+          lead -= 0xF0;
+          if (
+            lead > 4 || (kU8Lead4T1Bits[trail >> 4U] & (1U << lead)) == 0) {
+            return;
+          }
+          lead = (lead << 6U) | (trail & 0x3FU);
+          if (++offset == length) {
+            return;
+          }
+          trail = src[offset] - 0x80U;
+          if (trail > 0x3F) {
+            return;
+          }
+          lead = (lead << 6U) | trail;
+        }
+        // Second-to-last trail byte.
+        if (++offset == length) {
+          return;
+        }
+      }
+      else {
+        // U+0080..U+07FF.
+        if (lead < 0xC2) {
+          return;
+        }
+        lead &= 0x1FU;
+      }
+
+      // Last trail byte.
+      trail = src[offset] - 0x80U;
+      if (trail > 0x3F) {
+        return;
+      }
+      ++offset;
+      codepoint = static_cast<UChar32>((lead << 6U) | trail);
+    }
+
+    // See
+    // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf16_8h.html#ac25b589c0c9b60160d357770fad39cea
+    LONGLP_ALWAYS_INLINE constexpr auto
+    U16IsSurrogate(const char16_t utf16_c) -> bool {
+      return (utf16_c & 0xF800U) == 0xD800U;
+    }
+
+    // See
+    // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf16_8h.html#a6e141a548138e8c24822d219b7e06cb4
+    LONGLP_ALWAYS_INLINE constexpr auto
+    U16IsSurrogateLead(const char16_t utf16_c) -> bool {
+      return (utf16_c & 0x400U) == 0;
+    }
+
+    // See
+    // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf16_8h.html#afe8d9f450b9297897f018c2f23eb0724
+    LONGLP_ALWAYS_INLINE constexpr auto
+    U16IsTrail(const char16_t utf16_c) -> bool {
+      return (utf16_c & 0xFC00U) == 0xDC00U;
+    }
+
+    // See
+    // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf16_8h.html#ac1deffbf1956d9fe696129515e88f006
+    LONGLP_ALWAYS_INLINE constexpr auto
+    U16GetSupplementary(const char16_t lead, const char16_t trail) -> UChar32 {
+      constexpr UChar32 kSurrogateOffset = (0xD800 << 10) + 0xDC00 - 0x10000;
+      return (UChar32{lead} << 10) + UChar32{trail} - kSurrogateOffset;
+    }
+
+    // See
+    // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf8_8h.html#a154f04764da5af41729c4df6bf9e09f3
+    LONGLP_ALWAYS_INLINE constexpr void
+    U8AppendUnsafe(uint8_t* src, size_t& offset, const UChar32 codepoint) {
+      const auto value = static_cast<uint32_t>(codepoint);
+      if (value <= 0x7F) {
+        src[offset++] = static_cast<uint8_t>(value);
+        return;
+      }
+      if (value <= 0x7FF) {
+        src[offset++] = static_cast<uint8_t>((value >> 6U) | 0xC0U);
+      }
+      else {
+        if (value <= 0xFFFF) {
+          src[offset++] = static_cast<uint8_t>((value >> 12U) | 0xE0U);
+        }
+        else {
+          src[offset++] = static_cast<uint8_t>((value >> 18U) | 0xF0U);
+          src[offset++] =
+            static_cast<uint8_t>(((value >> 12U) & 0x3FU) | 0x80U);
+        }
+        src[offset++] = static_cast<uint8_t>(((value >> 6U) & 0x3FU) | 0x80U);
+      }
+      src[offset++] = static_cast<uint8_t>((value & 0x3FU) | 0x80U);
+    }
+
+    // See
+    // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf16_8h.html#add0a383d49e1ca81e2920d25883a56a9
+    LONGLP_ALWAYS_INLINE constexpr auto U16Length(const UChar32 codepoint)
+      -> int32_t {
+      return static_cast<uint32_t>(codepoint) <= 0xFFFF ? 1 : 2;
+    }
+
+    // See
+    // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf16_8h.html#aea8253343c96066779cd3383080cafa8
+    LONGLP_ALWAYS_INLINE constexpr void
+    U16AppendUnsafe(UChar* src, size_t& offset, const UChar32 codepoint) {
+      const auto value = static_cast<uint32_t>(codepoint);
+      if (value <= 0xFFFF) {
+        src[offset++] = static_cast<UChar>(value);
+        return;
+      }
+      src[offset++] = static_cast<UChar>((value >> 10U) + 0xD7C0U);
+      src[offset++] = static_cast<UChar>((value & 0x3FFU) | 0xDC00U);
+    }
+
+    // See
+    // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf16_8h.html#a35f04f1f6e7f0965a66b5268eec29b99
+    LONGLP_ALWAYS_INLINE constexpr auto U16IsSingle(char16_t codeunit)
+      -> bool {
+      return !U16IsSurrogate(codeunit);
+    }
+
+    // See
+    // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf16_8h.html#ace839ae31a801fd9c53fa67c5f8b9144
+    LONGLP_ALWAYS_INLINE constexpr auto U16IsLead(char16_t codeunit) -> bool {
+      return (codeunit & 0xFC00U) == 0xD800U;
+    }
+
+    // NOLINTEND(*-magic-numbers,
+    // cppcoreguidelines-pro-bounds-pointer-arithmetic)
 
     LONGLP_DIAGNOSTIC_POP
-  }
-
-  // See
-  // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf16_8h.html#ac25b589c0c9b60160d357770fad39cea
-  LONGLP_ALWAYS_INLINE constexpr auto
-  U16IsSurrogate(const char16_t utf16_c) -> bool {
-    return U16_IS_SURROGATE(utf16_c);
-  }
-
-  // See
-  // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf16_8h.html#a6e141a548138e8c24822d219b7e06cb4
-  LONGLP_ALWAYS_INLINE constexpr auto
-  U16IsSurrogateLead(const char16_t utf16_c) {
-    return U16_IS_SURROGATE_LEAD(utf16_c);
-  }
-
-  // See
-  // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf16_8h.html#afe8d9f450b9297897f018c2f23eb0724
-  LONGLP_ALWAYS_INLINE constexpr auto
-  U16IsTrail(const char16_t utf16_c) -> bool {
-    return U16_IS_TRAIL(utf16_c);
-  }
-
-  // See
-  // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf16_8h.html#ac1deffbf1956d9fe696129515e88f006
-  LONGLP_ALWAYS_INLINE constexpr auto
-  U16GetSupplementary(const char16_t lead, const char16_t trail) -> UChar32 {
-    return U16_GET_SUPPLEMENTARY(lead, trail);
-  }
-
-  // See
-  // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf8_8h.html#a154f04764da5af41729c4df6bf9e09f3
-  LONGLP_ALWAYS_INLINE void
-  U8AppendUnsafe(uint8_t* src, size_t& offset, const UChar32 codepoint) {
-    U8_APPEND_UNSAFE(src, offset, codepoint);
-  }
-
-  // See
-  // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf16_8h.html#add0a383d49e1ca81e2920d25883a56a9
-  LONGLP_ALWAYS_INLINE constexpr auto U16Length(const UChar32 codepoint) {
-    return U16_LENGTH(codepoint);
-  }
-
-  // See
-  // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf16_8h.html#aea8253343c96066779cd3383080cafa8
-  LONGLP_ALWAYS_INLINE void
-  U16AppendUnsafe(UChar* src, size_t& offset, const UChar32 codepoint) {
-    U16_APPEND_UNSAFE(src, offset, codepoint);
-  }
-
-  // See
-  // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf16_8h.html#a35f04f1f6e7f0965a66b5268eec29b99
-  LONGLP_ALWAYS_INLINE auto U16IsSingle(char16_t codeunit) -> bool {
-    return U16_IS_SINGLE(codeunit);
-  }
-
-  // See
-  // https://unicode-org.github.io/icu-docs/apidoc/released/icu4c/utf16_8h.html#ace839ae31a801fd9c53fa67c5f8b9144
-  LONGLP_ALWAYS_INLINE auto U16IsLead(char16_t codeunit) -> bool {
-    return U16_IS_LEAD(codeunit);
-  }
-
-  LONGLP_DIAGNOSTIC_POP
-
-// Any used macro should be undefined to prevent the usage of these macros in
-// our codebase
-#undef U8_MAX_LENGTH
-#undef U8_NEXT
-#undef U8_APPEND_UNSAFE
-
-#undef U16_MAX_LENGTH
-#undef U16_IS_SURROGATE
-#undef U16_IS_SURROGATE_LEAD
-#undef U16_IS_TRAIL
-#undef U16_GET_SUPPLEMENTARY
-#undef U16_LENGTH
-#undef U16_APPEND_UNSAFE
-#undef U16_IS_SINGLE
-#undef U16_IS_LEAD
-}    // namespace internal
-
-using CodePoint = StrongAlias<class LongLPCodePoint, UChar32>;
-}    // namespace longlp::base::icu
+  }    // namespace internal
+
+  using CodePoint = StrongAlias<class LongLPCodePoint, UChar32>;
+}    // namespace icu
+}    // namespace longlp::base
 
 #endif    // LONGLP_INCLUDE_BASE_ICU_UTF_H_
@@ -147,7 +147,7 @@ class NoDestructor {
   auto operator->() -> T* { return get(); }
 
   auto get() const -> const T* {
-    return std::bit_cast<const T*>(instance_storage_);
+    return std::bit_cast<const T*>(&instance_storage_);
   }
 
   auto get() -> T* { return std::bit_cast<T*>(&instance_storage_); }
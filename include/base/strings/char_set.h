@@ -0,0 +1,82 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#ifndef LONGLP_INCLUDE_BASE_STRINGS_CHAR_SET_H_
+#define LONGLP_INCLUDE_BASE_STRINGS_CHAR_SET_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/strings/typedefs.h"
+
+namespace longlp::base {
+
+// A set of code units, precompiled for the searches of ReplaceChars(),
+// RemoveChars() and TrimString(), which otherwise look every code unit of
+// their input up in the string of characters they are given. Build one once
+// and reuse it when the same set is searched for repeatedly:
+//
+//   static const CharSet<CharUTF8> kSeparators(LONGLP_LITERAL_UTF8(",;| "));
+//   for (const auto& line : lines) {
+//     TrimString(line, kSeparators, trimmed);
+//     ...
+//   }
+//
+// The code units below 0x100 are kept in a 256-bit bitmap and are matched a
+// whole vector at a time. The wider ones of UTF-16 and UTF-32, which are
+// rare in such sets, are kept as sorted ranges and looked up one by one.
+//
+// Like std::basic_string_view::find_first_of(), a set holds code units, not
+// code points: a character encoded in several code units adds each of them.
+//
+// Instantiated for ASCII, UTF-8, UTF-16 and UTF-32.
+template <CharTraits Char>
+class BASE_EXPORT CharSet final {
+ public:
+  static constexpr size_t npos = std::basic_string_view<Char>::npos;
+
+  // The empty set.
+  CharSet() = default;
+  // The set of the code units of |chars|.
+  explicit CharSet(std::basic_string_view<Char> chars);
+
+  [[nodiscard]] auto Contains(Char unit) const -> bool;
+
+  // Same as the std::basic_string_view members of the same names, with the
+  // set in place of their string of characters.
+  [[nodiscard]] auto FindFirstOf(
+    std::basic_string_view<Char> str,
+    size_t pos = 0) const -> size_t;
+  [[nodiscard]] auto FindFirstNotOf(
+    std::basic_string_view<Char> str,
+    size_t pos = 0) const -> size_t;
+  [[nodiscard]] auto FindLastNotOf(std::basic_string_view<Char> str) const
+    -> size_t;
+
+ private:
+  struct Range {
+    uint32_t first = 0;
+    uint32_t last  = 0;
+  };
+
+  template <bool kNegate>
+  auto Find(std::basic_string_view<Char> str, size_t pos) const -> size_t;
+
+  // Bit (unit & 7) of bitmap_[unit >> 3] is set for the code units below
+  // 0x100 of the set.
+  std::array<uint8_t, 32> bitmap_{};
+  // The same bits, laid out for a lookup by nibble: bit ((unit >> 4) & 7) of
+  // nibbles_[(unit >> 7) * 16 + (unit & 15)].
+  std::array<uint8_t, 32> nibbles_{};
+  // The code units above 0xFF, sorted and merged.
+  std::vector<Range> ranges_{};
+};
+
+}    // namespace longlp::base
+
+#endif    // LONGLP_INCLUDE_BASE_STRINGS_CHAR_SET_H_
@@ -0,0 +1,215 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#ifndef LONGLP_INCLUDE_BASE_STRINGS_CODE_POINTS_H_
+#define LONGLP_INCLUDE_BASE_STRINGS_CODE_POINTS_H_
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <ranges>
+#include <string_view>
+
+#include "base/compiler_specific.h"
+#include "base/icu/utf.h"
+#include "base/strings/typedefs.h"
+#include "base/strings/utf_string_conversion_utils.h"
+
+namespace longlp::base {
+
+// NOLINTBEGIN(*-magic-numbers,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+// A view of the code points of UTF-8, -16 or -32 text, decoded lazily as it is
+// iterated, without allocating. Ill-formed sequences read as one U+FFFD each,
+// as for the conversions in utf_string_conversion.h.
+//
+//   for (icu::CodePoint code_point : CodePoints(text)) {
+//     ...
+//   }
+//   auto it = std::ranges::find_if(CodePoints(text), IsSeparator);
+//   size_t offset = it.offset();
+//
+// The iterators measure the ASCII text ahead of them a word at a time, and
+// step through it without decoding.
+template <CharTraits Char>
+class CodePointView : public std::ranges::view_interface<CodePointView<Char>> {
+ public:
+  class Iterator {
+   public:
+    using iterator_concept = std::forward_iterator_tag;
+    using value_type       = icu::CodePoint;
+    using difference_type  = std::ptrdiff_t;
+
+    constexpr Iterator() = default;
+
+    Iterator(std::basic_string_view<Char> text, size_t offset) :
+      text_(text),
+      offset_(offset) {
+      Decode();
+    }
+
+    auto operator*() const -> icu::CodePoint { return code_point_; }
+
+    auto operator++() -> Iterator& {
+      offset_ += length_;
+      Decode();
+      return *this;
+    }
+
+    auto operator++(int) -> Iterator {
+      Iterator copy = *this;
+      ++*this;
+      return copy;
+    }
+
+    // Offset in code units of the current code point in the text.
+    [[nodiscard]] constexpr auto offset() const -> size_t { return offset_; }
+
+    friend auto operator==(const Iterator& lhs, const Iterator& rhs) -> bool {
+      return lhs.offset_ == rhs.offset_;
+    }
+
+    friend auto operator==(const Iterator& it, std::default_sentinel_t)
+      -> bool {
+      return it.offset_ >= it.text_.size();
+    }
+
+   private:
+    // Number of code units measured ahead at once, so that an early exit does
+    // not pay for a long ASCII run it never reaches.
+    static constexpr size_t kMaxASCIIRun = 64;
+
+    // Length of the ASCII run at the start of |text|, up to kMaxASCIIRun.
+    static auto ASCIIRunLength(std::basic_string_view<Char> text) -> size_t {
+      constexpr size_t kUnitsPerWord = sizeof(uint64_t) / sizeof(Char);
+      constexpr uint64_t kNonASCIIBits =
+        sizeof(Char) == 1 ? 0x8080808080808080U : 0xFF80FF80FF80FF80U;
+
+      const size_t limit = std::min(text.size(), kMaxASCIIRun);
+      size_t length      = 0;
+      for (; length + kUnitsPerWord <= limit; length += kUnitsPerWord) {
+        uint64_t word = 0;
+        std::memcpy(&word, text.data() + length, sizeof(word));
+        word &= kNonASCIIBits;
+        if (word != 0) {
+          // The first non-ASCII unit in memory order.
+          const auto bit = static_cast<size_t>(
+            std::endian::native == std::endian::little
+              ? std::countr_zero(word)
+              : std::countl_zero(word));
+          return length + bit / (8 * sizeof(Char));
+        }
+      }
+      while (length < limit && text[length] < 0x80) {
+        ++length;
+      }
+      return length;
+    }
+
+    void Decode() {
+      if (offset_ >= text_.size()) {
+        return;
+      }
+      length_ = 1;
+
+      if constexpr (std::same_as<Char, CharUTF32>) {
+        code_point_ = icu::CodePoint(static_cast<UChar32>(text_[offset_]));
+      }
+      else {
+        if (offset_ < ascii_end_) {
+          code_point_ = icu::CodePoint(static_cast<UChar32>(text_[offset_]));
+          return;
+        }
+        if (text_[offset_] < 0x80) {
+          ascii_end_  = offset_ + ASCIIRunLength(text_.substr(offset_));
+          code_point_ = icu::CodePoint(static_cast<UChar32>(text_[offset_]));
+          return;
+        }
+
+        if constexpr (std::same_as<Char, CharUTF8>) {
+          // A code point takes at most 4 bytes, which keeps the offsets of
+          // U8Next() small on any text.
+          int32_t length = 0;
+          icu::internal::U8Next(
+            std::bit_cast<const uint8_t*>(text_.data() + offset_),
+            length,
+            static_cast<int32_t>(std::min<size_t>(
+              text_.size() - offset_,
+              icu::internal::kU8MaxLength)),
+            *code_point_);
+          length_ = static_cast<size_t>(length);
+        }
+        else {
+          const Char unit = text_[offset_];
+          code_point_     = icu::CodePoint(static_cast<UChar32>(unit));
+          if (
+            icu::internal::U16IsLead(unit) && offset_ + 1 < text_.size() &&
+            icu::internal::U16IsTrail(text_[offset_ + 1])) {
+            *code_point_ =
+              icu::internal::U16GetSupplementary(unit, text_[offset_ + 1]);
+            length_ = 2;
+          }
+        }
+      }
+
+      if (!IsValidCodepoint(code_point_)) {
+        code_point_ = icu::CodePoint(0xFFFD);
+      }
+    }
+
+    std::basic_string_view<Char> text_;
+    size_t offset_    = 0;
+    // Code units of the current code point.
+    size_t length_    = 0;
+    // End of the ASCII run measured last.
+    size_t ascii_end_ = 0;
+    icu::CodePoint code_point_;
+  };
+
+  constexpr CodePointView() = default;
+
+  constexpr explicit CodePointView(std::basic_string_view<Char> text) :
+    text_(text) {}
+
+  [[nodiscard]] auto begin() const -> Iterator { return {text_, 0}; }
+
+  [[nodiscard]] constexpr auto end() const -> std::default_sentinel_t {
+    return std::default_sentinel;
+  }
+
+  [[nodiscard]] constexpr auto empty() const -> bool { return text_.empty(); }
+
+ private:
+  std::basic_string_view<Char> text_;
+};
+
+inline auto CodePoints(StringViewUTF8 utf8) -> CodePointView<CharUTF8> {
+  return CodePointView<CharUTF8>(utf8);
+}
+
+inline auto CodePoints(StringViewUTF16 utf16) -> CodePointView<CharUTF16> {
+  return CodePointView<CharUTF16>(utf16);
+}
+
+inline auto CodePoints(StringViewUTF32 utf32) -> CodePointView<CharUTF32> {
+  return CodePointView<CharUTF32>(utf32);
+}
+
+// NOLINTEND(*-magic-numbers,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}    // namespace longlp::base
+
+// The view only refers to the text, so its iterators outlive it.
+namespace std::ranges {
+template <longlp::base::CharTraits Char>
+inline constexpr bool enable_borrowed_range<longlp::base::CodePointView<Char>> =
+  true;
+}    // namespace std::ranges
+
+#endif    // LONGLP_INCLUDE_BASE_STRINGS_CODE_POINTS_H_
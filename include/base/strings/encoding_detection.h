@@ -0,0 +1,64 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#ifndef LONGLP_INCLUDE_BASE_STRINGS_ENCODING_DETECTION_H_
+#define LONGLP_INCLUDE_BASE_STRINGS_ENCODING_DETECTION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "base/base_export.h"
+#include "base/strings/typedefs.h"
+
+namespace longlp::base {
+
+// Encodings of text of unknown origin, e.g. the content of a file.
+enum class TextEncoding : uint8_t {
+  kASCII,
+  kUTF8,
+  kUTF16LE,
+  kUTF16BE,
+  kUTF32LE,
+  kUTF32BE,
+  // Any byte sequence is Latin-1 (ISO-8859-1), which makes it the answer for
+  // input that is nothing else.
+  kLatin1,
+};
+
+struct EncodingDetection {
+  TextEncoding encoding = TextEncoding::kASCII;
+  // Length in bytes of the byte order mark starting the input, 0 without one.
+  size_t bom_length     = 0;
+};
+
+// Guesses the encoding of |bytes|:
+//  - A byte order mark decides, UTF-32LE winning over UTF-16LE when both
+//    match (FF FE 00 00).
+//  - Without one, UTF-16 and UTF-32 are recognized from the zero bytes of
+//    their ASCII and Latin-1 range characters, counted on a sample of the
+//    start of the input, then confirmed by validating the whole input.
+//  - Otherwise, the input is ASCII or UTF-8 if it validates as such, in one
+//    vectorized pass, or Latin-1.
+// UTF-16 without byte order mark nor any ASCII range character, e.g. only
+// CJK text, is not recognized.
+BASE_EXPORT auto DetectEncoding(std::string_view bytes) -> EncodingDetection;
+
+// Converts |bytes| from |encoding| to UTF-8, without the byte order mark if
+// any. Invalid input is replaced by U+FFFD as by the conversions of
+// utf_string_conversion.h, in which case this returns false. Text that is
+// already UTF-8 is only validated and copied.
+BASE_EXPORT auto ConvertToUTF8(
+  std::string_view bytes,
+  TextEncoding encoding,
+  StringUTF8& utf8_output) -> bool;
+
+// Same, with the encoding from DetectEncoding(), which does not have to be
+// validated again.
+BASE_EXPORT auto ConvertToUTF8(std::string_view bytes, StringUTF8& utf8_output)
+  -> bool;
+
+}    // namespace longlp::base
+
+#endif    // LONGLP_INCLUDE_BASE_STRINGS_ENCODING_DETECTION_H_
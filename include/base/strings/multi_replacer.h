@@ -0,0 +1,103 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#ifndef LONGLP_INCLUDE_BASE_STRINGS_MULTI_REPLACER_H_
+#define LONGLP_INCLUDE_BASE_STRINGS_MULTI_REPLACER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/strings/typedefs.h"
+
+namespace longlp::base {
+
+// Replaces many substrings at once, in one pass over the string, where
+// chaining ReplaceSubstringsAfterOffset() would take one pass per pattern.
+// Build one once from its table of patterns and reuse it:
+//
+//   static const MultiReplacer<CharUTF8> kEscaper({
+//     {LONGLP_LITERAL_UTF8("&"), LONGLP_LITERAL_UTF8("&amp;")},
+//     {LONGLP_LITERAL_UTF8("<"), LONGLP_LITERAL_UTF8("&lt;")},
+//     {LONGLP_LITERAL_UTF8(">"), LONGLP_LITERAL_UTF8("&gt;")},
+//   });
+//   kEscaper.Replace(text);
+//
+// Matches do not overlap, and are the leftmost-longest ones: of the patterns
+// found at the earliest position, the longest one is replaced, and the search
+// resumes after it. Replacements are never searched again.
+//
+// The patterns are compiled into an Aho-Corasick automaton, a DFA whose
+// transitions are all resolved ahead of time, so that the search takes a
+// single table lookup per code unit. The code units that appear in no pattern
+// share one column of the table, which keeps it small enough to stay in cache.
+//
+// Instantiated for ASCII, UTF-8, UTF-16 and UTF-32.
+template <CharTraits Char>
+class BASE_EXPORT MultiReplacer final {
+ public:
+  struct Replacement {
+    std::basic_string_view<Char> find_this;
+    std::basic_string_view<Char> replace_with;
+  };
+
+  // Empty patterns are ignored. When a pattern appears more than once, its
+  // first replacement is used.
+  explicit MultiReplacer(std::span<const Replacement> replacements);
+  MultiReplacer(std::initializer_list<Replacement> replacements);
+
+  // Replaces the matches of the patterns in |str| that start at or after
+  // |start_offset|. Transforms the string without reallocating when
+  // possible, and returns |true| if any matches were found.
+  //
+  // Runs in O(n) time in the length of |str|, plus, for each match, a rescan
+  // of at most the length of the longest pattern: the search runs past a
+  // match as long as a longer one may start at the same position.
+  auto Replace(std::basic_string<Char>& str, size_t start_offset = 0) const
+    -> bool;
+
+ private:
+  struct State {
+    // Length of the prefix of a pattern that the state stands for.
+    uint32_t depth   = 0;
+    // One past the index of the longest pattern that is a suffix of that
+    // prefix, or 0 if there is none.
+    uint32_t pattern = 0;
+  };
+
+  struct Match {
+    size_t start   = 0;
+    size_t end     = 0;
+    size_t pattern = 0;
+  };
+
+  [[nodiscard]] auto ClassOf(Char unit) const -> uint32_t;
+  [[nodiscard]] auto FindMatches(
+    std::basic_string_view<Char> str,
+    size_t pos) const -> std::vector<Match>;
+
+  // The class of each code unit below 0x100: 0 for those in no pattern, and a
+  // column of |transitions_| for the others.
+  std::array<uint32_t, 256> byte_classes_{};
+  // The classes of the code units above 0xFF, sorted by code unit.
+  std::vector<std::pair<uint32_t, uint32_t>> wide_classes_{};
+  uint32_t num_classes_ = 1;
+  // The next state of state |s| on a code unit of class |c| is at
+  // transitions_[s * num_classes_ + c]. State 0 is the start.
+  std::vector<uint32_t> transitions_{};
+  std::vector<State> states_{};
+  std::vector<size_t> pattern_lengths_{};
+  std::vector<std::basic_string<Char>> replacements_{};
+};
+
+}    // namespace longlp::base
+
+#endif    // LONGLP_INCLUDE_BASE_STRINGS_MULTI_REPLACER_H_
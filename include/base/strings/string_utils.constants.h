@@ -86,7 +86,7 @@ BASE_EXPORT constexpr StringViewASCII kWhitespaceInfraASCII =
 
 // Null-terminated string representing the UTF-8 byte order mark.
 BASE_EXPORT constexpr StringViewUTF8 kUTF8ByteOrderMark =
-  LONGLP_LITERAL_UTF8("\u00EF\u00BB\u00BF");
+  LONGLP_LITERAL_UTF8("\uFEFF");
 
 #undef LONGLP_WHITESPACE_ASCII_NO_CR_LF
 #undef LONGLP_WHITESPACE_ASCII
@@ -13,11 +13,13 @@
 #include <algorithm>
 #include <concepts>
 #include <initializer_list>
+#include <span>
 #include <type_traits>
 #include <vector>
 
 #include "base/base_export.h"
 #include "base/compiler_specific.h"
+#include "base/strings/char_set.h"
 #include "base/strings/string_utils.internal.h"
 #include "base/strings/typedefs.h"
 
@@ -44,9 +46,24 @@ LONGLP_DEFINE_TO_LOWER_AND_TO_UPPER_ASCII_FOR_CHAR(UTF32)
 // Converts the given string to its ASCII-lowercase/uppercase equivalent.
 // Non-ASCII bytes (or UTF-16 code units in `StringViewUTF16`) are permitted but
 // will be unmodified.
+//
+// The span overloads write to |output| instead of allocating, and return false
+// without writing anything when it is shorter than |str|. |output| may be the
+// storage of |str|, but must not otherwise overlap it. The InPlace variants
+// convert |str| itself.
 #define LONGLP_DECLARE_TO_LOWER_AND_TO_UPPER_ASCII_FOR_STRING(CharType)      \
   BASE_EXPORT auto ToLowerASCII(StringView##CharType str)->String##CharType; \
-  BASE_EXPORT auto ToUpperASCII(StringView##CharType str)->String##CharType;
+  BASE_EXPORT auto ToUpperASCII(StringView##CharType str)->String##CharType; \
+  BASE_EXPORT auto ToLowerASCII(                                             \
+    StringView##CharType str,                                                \
+    std::span<Char##CharType> output)                                        \
+    ->bool;                                                                  \
+  BASE_EXPORT auto ToUpperASCII(                                             \
+    StringView##CharType str,                                                \
+    std::span<Char##CharType> output)                                        \
+    ->bool;                                                                  \
+  BASE_EXPORT void ToLowerASCIIInPlace(String##CharType& str);               \
+  BASE_EXPORT void ToUpperASCIIInPlace(String##CharType& str);
 
 LONGLP_DECLARE_TO_LOWER_AND_TO_UPPER_ASCII_FOR_STRING(ASCII)
 LONGLP_DECLARE_TO_LOWER_AND_TO_UPPER_ASCII_FOR_STRING(UTF8)
@@ -82,13 +99,19 @@ struct CaseInsensitiveCompareASCII {
 //
 // Non-ASCII bytes (or UTF-16 code units in `StringViewUTF16`) are permitted but
 // will be compared unmodified.
-
-#define LONGLP_DEFINE_COMPARE_CASE_INSENSITIVE_ASCII(CharType)              \
-  BASE_EXPORT constexpr auto CompareCaseInsensitiveASCII(                   \
-    StringView##CharType lhs,                                               \
-    StringView##CharType rhs)                                               \
-    ->int32_t {                                                             \
-    return internal::CompareCaseInsensitiveASCII<Char##CharType>(lhs, rhs); \
+//
+// Calls that are not constant evaluated compare a vector of code units at a
+// time.
+
+#define LONGLP_DEFINE_COMPARE_CASE_INSENSITIVE_ASCII(CharType)                \
+  BASE_EXPORT constexpr auto CompareCaseInsensitiveASCII(                     \
+    StringView##CharType lhs,                                                 \
+    StringView##CharType rhs)                                                 \
+    ->int32_t {                                                               \
+    if (std::is_constant_evaluated()) {                                       \
+      return internal::CompareCaseInsensitiveASCII<Char##CharType>(lhs, rhs); \
+    }                                                                         \
+    return internal::VectorizedCompareCaseInsensitiveASCII(lhs, rhs);         \
   }
 
 LONGLP_DEFINE_COMPARE_CASE_INSENSITIVE_ASCII(ASCII)
@@ -103,13 +126,19 @@ LONGLP_DEFINE_COMPARE_CASE_INSENSITIVE_ASCII(UTF32)
 // unmodified. To compare all Unicode code points case-insensitively, use
 // base::i18n::ToLower or base::i18n::FoldCase and then compare with either ==
 // or !=.
+//
+// Calls that are not constant evaluated compare a vector of code units at a
+// time, the narrower code units being widened to the other type.
 
 #define LONGLP_DEFINE_EQUALS_CASE_INSENSITIVE_ASCII_FOR(CharA, CharB)      \
   BASE_EXPORT constexpr auto                                               \
   EqualsCaseInsensitiveASCII(StringView##CharA lhs, StringView##CharB rhs) \
     ->bool {                                                               \
-    return internal::                                                      \
-      EqualsCaseInsensitiveASCII<Char##CharA, Char##CharB>(lhs, rhs);      \
+    if (std::is_constant_evaluated()) {                                    \
+      return internal::                                                    \
+        EqualsCaseInsensitiveASCII<Char##CharA, Char##CharB>(lhs, rhs);    \
+    }                                                                      \
+    return internal::VectorizedEqualsCaseInsensitiveASCII(lhs, rhs);       \
   }
 
 LONGLP_DEFINE_EQUALS_CASE_INSENSITIVE_ASCII_FOR(UTF8, UTF8)
@@ -137,11 +166,18 @@ LONGLP_DEFINE_EQUALS_CASE_INSENSITIVE_ASCII_FOR(ASCII, ASCII)
 // Removes characters in |remove_chars| from anywhere in |input|.  Returns true
 // if any characters were removed.  |remove_chars| must be null-terminated.
 // NOTE: Safe to use the same variable for both |input| and |output|.
-#define LONGLP_DECLARE_REMOVE_CHARS(CharType) \
-  BASE_EXPORT auto RemoveChars(               \
-    StringView##CharType input,               \
-    StringView##CharType remove_chars,        \
-    String##CharType& output)                 \
+//
+// The CharSet versions save building the set on every call (see char_set.h).
+#define LONGLP_DECLARE_REMOVE_CHARS(CharType)    \
+  BASE_EXPORT auto RemoveChars(                  \
+    StringView##CharType input,                  \
+    StringView##CharType remove_chars,           \
+    String##CharType& output)                    \
+    ->bool;                                      \
+  BASE_EXPORT auto RemoveChars(                  \
+    StringView##CharType input,                  \
+    const CharSet<Char##CharType>& remove_chars, \
+    String##CharType& output)                    \
     ->bool;
 LONGLP_DECLARE_REMOVE_CHARS(ASCII)
 LONGLP_DECLARE_REMOVE_CHARS(UTF8)
@@ -155,12 +191,18 @@ LONGLP_DECLARE_REMOVE_CHARS(UTF32)
 // the |replace_with| string.  Returns true if any characters were replaced.
 // |replace_chars| must be null-terminated.
 // NOTE: Safe to use the same variable for both |input| and |output|.
-#define LONGLP_DECLARE_REPLACE_CHARS(CharType) \
-  BASE_EXPORT auto ReplaceChars(               \
-    StringView##CharType input,                \
-    StringView##CharType replace_chars,        \
-    StringView##CharType replace_with,         \
-    String##CharType& output)                  \
+#define LONGLP_DECLARE_REPLACE_CHARS(CharType)    \
+  BASE_EXPORT auto ReplaceChars(                  \
+    StringView##CharType input,                   \
+    StringView##CharType replace_chars,           \
+    StringView##CharType replace_with,            \
+    String##CharType& output)                     \
+    ->bool;                                       \
+  BASE_EXPORT auto ReplaceChars(                  \
+    StringView##CharType input,                   \
+    const CharSet<Char##CharType>& replace_chars, \
+    StringView##CharType replace_with,            \
+    String##CharType& output)                     \
     ->bool;
 LONGLP_DECLARE_REPLACE_CHARS(ASCII)
 LONGLP_DECLARE_REPLACE_CHARS(UTF8)
@@ -169,6 +211,34 @@ LONGLP_DECLARE_REPLACE_CHARS(UTF32)
 
 #undef LONGLP_DECLARE_REPLACE_CHARS
 
+// Starting at |start_offset| (usually 0), replaces the first instance of
+// |find_this| in |str| with |replace_with|. ReplaceSubstringsAfterOffset()
+// replaces every instance, scanning from left to right, so that instances
+// do not overlap: "aaa" with "aa" replaced by "b" gives "ba". Both return
+// true if anything was replaced, and do nothing for an empty |find_this|.
+// |find_this| and |replace_with| must not refer to |str|.
+//
+// The whole string is rewritten in one pass, with at most one allocation.
+#define LONGLP_DECLARE_REPLACE_SUBSTRINGS_AFTER_OFFSET(CharType) \
+  BASE_EXPORT auto ReplaceFirstSubstringAfterOffset(             \
+    String##CharType& str,                                       \
+    size_t start_offset,                                         \
+    StringView##CharType find_this,                              \
+    StringView##CharType replace_with)                           \
+    ->bool;                                                      \
+  BASE_EXPORT auto ReplaceSubstringsAfterOffset(                 \
+    String##CharType& str,                                       \
+    size_t start_offset,                                         \
+    StringView##CharType find_this,                              \
+    StringView##CharType replace_with)                           \
+    ->bool;
+LONGLP_DECLARE_REPLACE_SUBSTRINGS_AFTER_OFFSET(ASCII)
+LONGLP_DECLARE_REPLACE_SUBSTRINGS_AFTER_OFFSET(UTF8)
+LONGLP_DECLARE_REPLACE_SUBSTRINGS_AFTER_OFFSET(UTF16)
+LONGLP_DECLARE_REPLACE_SUBSTRINGS_AFTER_OFFSET(UTF32)
+
+#undef LONGLP_DECLARE_REPLACE_SUBSTRINGS_AFTER_OFFSET
+
 using internal::TrimPositions;
 // Removes characters in |trim_chars| from the beginning and end of |input|.
 // The 8-bit version only works on 8-bit characters, not UTF-8. Returns true if
@@ -178,16 +248,26 @@ using internal::TrimPositions;
 // the normal usage to trim in-place).
 // StringView versions of the above. The returned pieces refer to the original
 // buffer.
-#define LONGLP_DECLARE_TRIM_STRING(CharType) \
-  BASE_EXPORT auto TrimString(               \
-    StringView##CharType input,              \
-    StringView##CharType trim_chars,         \
-    String##CharType& output)                \
-    ->bool;                                  \
-  BASE_EXPORT auto TrimString(               \
-    StringView##CharType input,              \
-    StringView##CharType trim_chars,         \
-    TrimPositions positions)                 \
+#define LONGLP_DECLARE_TRIM_STRING(CharType)   \
+  BASE_EXPORT auto TrimString(                 \
+    StringView##CharType input,                \
+    StringView##CharType trim_chars,           \
+    String##CharType& output)                  \
+    ->bool;                                    \
+  BASE_EXPORT auto TrimString(                 \
+    StringView##CharType input,                \
+    StringView##CharType trim_chars,           \
+    TrimPositions positions)                   \
+    ->StringView##CharType;                    \
+  BASE_EXPORT auto TrimString(                 \
+    StringView##CharType input,                \
+    const CharSet<Char##CharType>& trim_chars, \
+    String##CharType& output)                  \
+    ->bool;                                    \
+  BASE_EXPORT auto TrimString(                 \
+    StringView##CharType input,                \
+    const CharSet<Char##CharType>& trim_chars, \
+    TrimPositions positions)                   \
     ->StringView##CharType;
 
 LONGLP_DECLARE_TRIM_STRING(ASCII)
@@ -204,6 +284,23 @@ BASE_EXPORT void TruncateUTF8ToByteSize(
   size_t byte_size,
   StringUTF8& output);
 
+// Returns true if every code unit of |str| is ASCII (below 0x80).
+#define LONGLP_DECLARE_IS_STRING_ASCII(CharType) \
+  BASE_EXPORT auto IsStringASCII(StringView##CharType str)->bool;
+LONGLP_DECLARE_IS_STRING_ASCII(ASCII)
+LONGLP_DECLARE_IS_STRING_ASCII(UTF8)
+LONGLP_DECLARE_IS_STRING_ASCII(UTF16)
+LONGLP_DECLARE_IS_STRING_ASCII(UTF32)
+
+#undef LONGLP_DECLARE_IS_STRING_ASCII
+
+// Returns true if |str| is structurally valid UTF-8: every code point is a
+// Unicode scalar value in its shortest encoding. IsStringUTF8 additionally
+// rejects non-character code points (e.g. U+FFFE), see IsValidCharacter;
+// IsStringUTF8AllowingNoncharacters accepts them.
+BASE_EXPORT auto IsStringUTF8(StringViewUTF8 str) -> bool;
+BASE_EXPORT auto IsStringUTF8AllowingNoncharacters(StringViewUTF8 str) -> bool;
+
 // Trims any whitespace from either end of the input string.
 //
 // The StringView versions return a substring referencing the input buffer.
@@ -10,8 +10,11 @@
 #include <cstddef>
 #include <string>
 #include <string_view>
+#include <type_traits>
 
+#include "base/base_export.h"
 #include "base/compiler_specific.h"
+#include "base/strings/char_set.h"
 #include "base/strings/string_utils.constants.h"
 #include "base/strings/typedefs.h"
 
@@ -37,34 +40,6 @@ constexpr auto ToUpperASCII(CharT char_value) -> CharT {
          : char_value;
 }
 
-// Converts the given string to its ASCII-lowercase equivalent. Non-ASCII
-// bytes (or UTF-16 code units in `StringViewUTF16`) are permitted but will be
-// unmodified.
-template <CharTraits CharT>
-auto ToLowerASCII(std::basic_string_view<CharT> str_view)
-  -> std::basic_string<CharT> {
-  std::basic_string<CharT> ret;
-  ret.reserve(str_view.size());
-  for (auto character : str_view) {
-    ret.push_back(ToLowerASCII(character));
-  }
-  return ret;
-}
-
-// Converts the given string to its ASCII-uppercase equivalent. Non-ASCII
-// bytes (or UTF-16 code units in `StringViewUTF16`) are permitted but will be
-// unmodified.
-template <CharTraits CharT>
-auto ToUpperASCII(std::basic_string_view<CharT> str_view)
-  -> std::basic_string<CharT> {
-  std::basic_string<CharT> ret;
-  ret.reserve(str_view.size());
-  for (auto character : str_view) {
-    ret.push_back(ToUpperASCII(character));
-  }
-  return ret;
-}
-
 // Like strcasecmp for ASCII case-insensitive comparisons only. Returns:
 //   -1  (a < b)
 //    0  (a == b)
@@ -131,6 +106,66 @@ constexpr auto EqualsCaseInsensitiveASCII(
     });
 }
 
+// Vectorized versions of the two functions above, for the calls that are not
+// constant evaluated. They give the same results.
+#define LONGLP_DECLARE_VECTORIZED_COMPARE_CASE_INSENSITIVE_ASCII(CharType) \
+  BASE_EXPORT auto VectorizedCompareCaseInsensitiveASCII(                  \
+    StringView##CharType lhs,                                              \
+    StringView##CharType rhs)                                              \
+    ->int32_t;
+
+LONGLP_DECLARE_VECTORIZED_COMPARE_CASE_INSENSITIVE_ASCII(ASCII)
+LONGLP_DECLARE_VECTORIZED_COMPARE_CASE_INSENSITIVE_ASCII(UTF8)
+LONGLP_DECLARE_VECTORIZED_COMPARE_CASE_INSENSITIVE_ASCII(UTF16)
+LONGLP_DECLARE_VECTORIZED_COMPARE_CASE_INSENSITIVE_ASCII(UTF32)
+
+#undef LONGLP_DECLARE_VECTORIZED_COMPARE_CASE_INSENSITIVE_ASCII
+
+#define LONGLP_DECLARE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(CharA, CharB) \
+  BASE_EXPORT auto VectorizedEqualsCaseInsensitiveASCII(                      \
+    StringView##CharA lhs,                                                    \
+    StringView##CharB rhs)                                                    \
+    ->bool;
+
+LONGLP_DECLARE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF8, UTF8)
+LONGLP_DECLARE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF8, UTF16)
+LONGLP_DECLARE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF8, UTF32)
+LONGLP_DECLARE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF8, ASCII)
+
+LONGLP_DECLARE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF16, UTF8)
+LONGLP_DECLARE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF16, UTF16)
+LONGLP_DECLARE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF16, UTF32)
+LONGLP_DECLARE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF16, ASCII)
+
+LONGLP_DECLARE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF32, UTF8)
+LONGLP_DECLARE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF32, UTF16)
+LONGLP_DECLARE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF32, UTF32)
+LONGLP_DECLARE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF32, ASCII)
+
+LONGLP_DECLARE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(ASCII, UTF8)
+LONGLP_DECLARE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(ASCII, UTF16)
+LONGLP_DECLARE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(ASCII, UTF32)
+LONGLP_DECLARE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(ASCII, ASCII)
+
+#undef LONGLP_DECLARE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII
+
+// Same as |str.find(find_this, pos)|, with a vectorized search that skips
+// most of the positions where only the first code unit of |find_this|
+// matches.
+#define LONGLP_DECLARE_VECTORIZED_FIND(CharType) \
+  BASE_EXPORT auto VectorizedFind(               \
+    StringView##CharType str,                    \
+    StringView##CharType find_this,              \
+    size_t pos)                                  \
+    ->size_t;
+
+LONGLP_DECLARE_VECTORIZED_FIND(ASCII)
+LONGLP_DECLARE_VECTORIZED_FIND(UTF8)
+LONGLP_DECLARE_VECTORIZED_FIND(UTF16)
+LONGLP_DECLARE_VECTORIZED_FIND(UTF32)
+
+#undef LONGLP_DECLARE_VECTORIZED_FIND
+
 // A Matcher for DoReplaceMatchesAfterOffset() that matches substrings.
 template <CharTraits CharT>
 struct SubstringMatcher {
@@ -138,7 +173,10 @@ struct SubstringMatcher {
 
   constexpr auto
   Find(const std::basic_string_view<CharT> input, const size_t pos) -> size_t {
-    return input.find(find_this.data(), pos, find_this.length());
+    if (std::is_constant_evaluated()) {
+      return input.find(find_this.data(), pos, find_this.length());
+    }
+    return VectorizedFind(input, find_this, pos);
   }
 
   constexpr auto MatchSize() -> size_t { return find_this.length(); }
@@ -147,12 +185,11 @@ struct SubstringMatcher {
 // A Matcher for DoReplaceMatchesAfterOffset() that matches single characters.
 template <CharTraits CharT>
 struct CharacterMatcher {
-  std::basic_string_view<CharT> find_any_of_these;
+  const CharSet<CharT>& find_any_of_these;
 
-  constexpr auto
+  auto
   Find(const std::basic_string_view<CharT> input, const size_t pos) -> size_t {
-    return input
-      .find_first_of(find_any_of_these.data(), pos, find_any_of_these.length());
+    return find_any_of_these.FindFirstOf(input, pos);
   }
 
   constexpr auto MatchSize() -> size_t { return 1; }
@@ -337,7 +374,7 @@ auto DoReplaceMatchesAfterOffset(
 template <CharTraits CharT>
 auto ReplaceChars(
   std::basic_string_view<CharT> input,
-  std::basic_string_view<CharT> find_any_of_these,
+  const CharSet<CharT>& find_any_of_these,
   std::basic_string_view<CharT> replace_with,
   std::basic_string<CharT>& output) -> bool {
   // Commonly, this is called with output and input being the same string; in
@@ -364,22 +401,17 @@ enum TrimPositions {
 template <CharTraits CharT>
 auto TrimString(
   std::basic_string_view<CharT> input,
-  std::basic_string_view<CharT> trim_chars,
+  const CharSet<CharT>& trim_chars,
   TrimPositions positions,
   std::basic_string<CharT>& output) -> TrimPositions {
   LONGLP_DIAGNOSTIC_PUSH
   LONGLP_CLANG_DIAGNOSTIC_IGNORED("-Wunsafe-buffer-usage")
-  // Find the edges of leading/trailing whitespace as desired. Need to use
-  // a StringPiece version of input to be able to call find* on it with the
-  // StringPiece version of trim_chars (normally the trim_chars will be a
-  // constant so avoid making a copy).
+  // Find the edges of leading/trailing whitespace as desired.
   const size_t last_char = input.length() - 1;
   const size_t first_good_char =
-    (positions & kTrimLeading) ? input.find_first_not_of(trim_chars) : 0;
+    (positions & kTrimLeading) ? trim_chars.FindFirstNotOf(input) : 0;
   const size_t last_good_char =
-    (positions & kTrimTrailing)
-      ? input.find_last_not_of(trim_chars)
-      : last_char;
+    (positions & kTrimTrailing) ? trim_chars.FindLastNotOf(input) : last_char;
 
   // When the string was all trimmed, report that we stripped off characters
   // from whichever position the caller was interested in. For empty input, we
@@ -406,13 +438,13 @@ auto TrimString(
 template <CharTraits CharT>
 auto TrimStringView(
   std::basic_string_view<CharT> input,
-  std::basic_string_view<CharT> trim_chars,
+  const CharSet<CharT>& trim_chars,
   TrimPositions positions) -> std::basic_string_view<CharT> {
   size_t begin =
-    (positions & kTrimLeading) ? input.find_first_not_of(trim_chars) : 0;
+    (positions & kTrimLeading) ? trim_chars.FindFirstNotOf(input) : 0;
   size_t end =
     (positions & kTrimTrailing)
-      ? input.find_last_not_of(trim_chars) + 1
+      ? trim_chars.FindLastNotOf(input) + 1
       : input.size();
   return input.substr(std::min(begin, input.size()), end - begin);
 }
@@ -28,6 +28,11 @@ using CharUTF16       = char16_t;
 using CharUTF32       = char32_t;
 using CharASCII       = char;
 
+// Latin-1 (ISO-8859-1) text is held as ASCII text is, one byte per character.
+using StringLatin1     = std::string;
+using StringViewLatin1 = std::string_view;
+using CharLatin1       = char;
+
 // follow C++ named requirements: CharTraits
 // https://en.cppreference.com/w/cpp/named_req/CharTraits
 // NOLINTBEGIN(readability-identifier-length)
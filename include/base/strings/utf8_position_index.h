@@ -0,0 +1,63 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#ifndef LONGLP_INCLUDE_BASE_STRINGS_UTF8_POSITION_INDEX_H_
+#define LONGLP_INCLUDE_BASE_STRINGS_UTF8_POSITION_INDEX_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/icu/utf.h"
+#include "base/strings/typedefs.h"
+
+namespace longlp::base {
+
+// Random access to the code points of UTF-8 text. The index records the byte
+// offset of every |stride|-th code point when it is built, in one pass over
+// the text, so that looking a code point up only decodes the at most
+// |stride| - 1 code points after the closest recorded one. The memory use is
+// one size_t per |stride| code points.
+//
+// Code points are counted as CountCodePoints() does: an ill-formed sequence
+// counts as one code point, U+FFFD.
+//
+//   const UTF8PositionIndex index(text);
+//   for (size_t i = 0; i < index.size(); i += 1000) {
+//     Consume(index.CodePointAt(i));
+//   }
+//
+// The index points into |text|, which must outlive it and not change.
+class BASE_EXPORT UTF8PositionIndex final {
+ public:
+  static constexpr size_t kDefaultStride = 64;
+
+  // |stride| has to be positive.
+  explicit UTF8PositionIndex(
+    StringViewUTF8 text,
+    size_t stride = kDefaultStride);
+
+  // Number of code points of the text.
+  [[nodiscard]] constexpr auto size() const -> size_t { return size_; }
+
+  // Byte offset of code point |code_point_index| in the text. size() maps to
+  // the size of the text, anything past it to npos.
+  [[nodiscard]] auto OffsetOf(size_t code_point_index) const -> size_t;
+
+  // Code point |code_point_index|, which has to be below size(). Ill-formed
+  // sequences read as U+FFFD.
+  [[nodiscard]] auto CodePointAt(size_t code_point_index) const
+    -> icu::CodePoint;
+
+ private:
+  StringViewUTF8 text_;
+  size_t stride_;
+  size_t size_ = 0;
+  // samples_[i] is the byte offset of code point i * stride_.
+  std::vector<size_t> samples_{};
+};
+
+}    // namespace longlp::base
+
+#endif    // LONGLP_INCLUDE_BASE_STRINGS_UTF8_POSITION_INDEX_H_
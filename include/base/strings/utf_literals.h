@@ -0,0 +1,226 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#ifndef LONGLP_INCLUDE_BASE_STRINGS_UTF_LITERALS_H_
+#define LONGLP_INCLUDE_BASE_STRINGS_UTF_LITERALS_H_
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "base/icu/utf.h"
+#include "base/strings/typedefs.h"
+#include "base/strings/utf_string_conversion_utils.h"
+
+namespace longlp::base {
+
+// NOLINTBEGIN(*-magic-numbers, *-avoid-c-arrays)
+
+// Compile-time transcoding of string constants, for when a constant is needed
+// in another encoding than the one it is written in, e.g. UTF-8 spelled with
+// escapes:
+//
+//   constexpr StringViewUTF16 kName = LONGLP_UTF16_FROM_UTF8("caf\xC3\xA9");
+//   constexpr StringViewUTF8 kSign = LONGLP_UTF8_FROM_UTF32("\x20AC");
+//
+// The result is a view of a NUL-terminated array with static storage, built
+// by the compiler, so it costs nothing at run time. Unlike the conversions of
+// utf_string_conversion.h, invalid input does not turn into U+FFFD: it fails
+// to compile.
+
+// A string usable as a template argument. |N| counts the terminating NUL.
+template <CharTraits Char, size_t N>
+struct FixedString {
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  consteval FixedString(const Char (&str)[N]) {
+    std::copy_n(str, N, chars.begin());
+  }
+
+  [[nodiscard]] constexpr auto view() const -> std::basic_string_view<Char> {
+    return {chars.data(), N - 1};
+  }
+
+  // Public, as required for a template argument.
+  std::array<Char, N> chars{};
+};
+
+namespace internal {
+  // Not constexpr: reaching it while transcoding a literal stops the
+  // compilation there.
+  inline void InvalidUTFLiteral() {}
+
+  struct LiteralCodePoint {
+    char32_t value = 0;
+    size_t length  = 0;
+  };
+
+  // Decodes the code point starting at |src[i]|, which has to be well-formed.
+  template <CharTraits Char>
+  consteval auto DecodeLiteral(std::basic_string_view<Char> src, size_t i)
+    -> LiteralCodePoint {
+    LiteralCodePoint code_point;
+    if constexpr (std::same_as<Char, CharUTF8>) {
+      // U8Next() reads bytes, which a char8_t pointer cannot be cast to here.
+      std::array<uint8_t, icu::internal::kU8MaxLength> bytes{};
+      const size_t count = std::min(src.size() - i, bytes.size());
+      for (size_t k = 0; k < count; ++k) {
+        bytes[k] = static_cast<uint8_t>(src[i + k]);
+      }
+      int32_t length = 0;
+      UChar32 value  = 0;
+      icu::internal::U8Next(
+        bytes.data(),
+        length,
+        static_cast<int32_t>(count),
+        value);
+      // Truncated and overlong sequences, and encoded surrogates.
+      if (value < 0) {
+        InvalidUTFLiteral();
+      }
+      code_point = {
+        static_cast<char32_t>(value),
+        static_cast<size_t>(length)};
+    }
+    else if constexpr (std::same_as<Char, CharUTF16>) {
+      code_point = {src[i], 1};
+      if (
+        icu::internal::U16IsLead(src[i]) && i + 1 < src.size() &&
+        icu::internal::U16IsTrail(src[i + 1])) {
+        code_point = {
+          static_cast<char32_t>(
+            icu::internal::U16GetSupplementary(src[i], src[i + 1])),
+          2};
+      }
+    }
+    else {
+      static_assert(std::same_as<Char, CharUTF32>);
+      code_point = {src[i], 1};
+    }
+
+    // Lone surrogates, and values past U+10FFFF.
+    if (!IsValidCodepoint(
+          icu::CodePoint(static_cast<UChar32>(code_point.value)))) {
+      InvalidUTFLiteral();
+    }
+    return code_point;
+  }
+
+  // Appends |value| to |dest| at |size|, or only counts its code units when
+  // |dest| is null.
+  template <CharTraits Char>
+  consteval void EncodeLiteral(char32_t value, Char* dest, size_t& size) {
+    std::array<Char, 4> units{};
+    size_t length = 0;
+    if constexpr (std::same_as<Char, CharUTF8>) {
+      if (value < 0x80) {
+        units[length++] = static_cast<Char>(value);
+      }
+      else if (value < 0x800) {
+        units[length++] = static_cast<Char>(0xC0 | (value >> 6U));
+        units[length++] = static_cast<Char>(0x80 | (value & 0x3FU));
+      }
+      else if (value < 0x10000) {
+        units[length++] = static_cast<Char>(0xE0 | (value >> 12U));
+        units[length++] = static_cast<Char>(0x80 | ((value >> 6U) & 0x3FU));
+        units[length++] = static_cast<Char>(0x80 | (value & 0x3FU));
+      }
+      else {
+        units[length++] = static_cast<Char>(0xF0 | (value >> 18U));
+        units[length++] = static_cast<Char>(0x80 | ((value >> 12U) & 0x3FU));
+        units[length++] = static_cast<Char>(0x80 | ((value >> 6U) & 0x3FU));
+        units[length++] = static_cast<Char>(0x80 | (value & 0x3FU));
+      }
+    }
+    else if constexpr (std::same_as<Char, CharUTF16>) {
+      if (value < 0x10000) {
+        units[length++] = static_cast<Char>(value);
+      }
+      else {
+        units[length++] =
+          static_cast<Char>(0xD800 + ((value - 0x10000) >> 10U));
+        units[length++] = static_cast<Char>(0xDC00 + (value & 0x3FFU));
+      }
+    }
+    else {
+      static_assert(std::same_as<Char, CharUTF32>);
+      units[length++] = value;
+    }
+
+    for (size_t k = 0; k < length; ++k, ++size) {
+      if (dest != nullptr) {
+        dest[size] = units[k];
+      }
+    }
+  }
+
+  // Transcodes |src| into |dest|, or only measures the result when |dest| is
+  // null.
+  template <CharTraits DestChar, CharTraits SrcChar>
+  consteval auto TranscodeLiteral(
+    std::basic_string_view<SrcChar> src,
+    DestChar* dest) -> size_t {
+    size_t size = 0;
+    for (size_t i = 0; i < src.size();) {
+      const auto code_point = DecodeLiteral(src, i);
+      EncodeLiteral(code_point.value, dest, size);
+      i += code_point.length;
+    }
+    return size;
+  }
+
+  template <CharTraits DestChar, FixedString kSrc>
+  consteval auto TranscodedArray() {
+    constexpr size_t kSize = TranscodeLiteral<DestChar>(
+      kSrc.view(),
+      static_cast<DestChar*>(nullptr));
+    // Zero-initialized, so NUL-terminated.
+    std::array<DestChar, kSize + 1> chars{};
+    TranscodeLiteral(kSrc.view(), chars.data());
+    return chars;
+  }
+
+  template <CharTraits DestChar, FixedString kSrc>
+  inline constexpr auto kTranscodedArray = TranscodedArray<DestChar, kSrc>();
+}    // namespace internal
+
+// |kSrc| transcoded to |DestChar| at compile time.
+template <CharTraits DestChar, FixedString kSrc>
+inline constexpr std::basic_string_view<DestChar> kTranscodedLiteral(
+  internal::kTranscodedArray<DestChar, kSrc>.data(),
+  internal::kTranscodedArray<DestChar, kSrc>.size() - 1);
+
+// NOLINTEND(*-magic-numbers, *-avoid-c-arrays)
+}    // namespace longlp::base
+
+// Usage: LONGLP_UTF16_FROM_UTF8("caf\xC3\xA9"), the argument is spelled as for
+// LONGLP_LITERAL_UTF8() and the like.
+#define LONGLP_UTF16_FROM_UTF8(x)                      \
+  (::longlp::base::kTranscodedLiteral<                 \
+    ::longlp::base::CharUTF16,                         \
+    ::longlp::base::FixedString(LONGLP_LITERAL_UTF8(x))>)
+#define LONGLP_UTF32_FROM_UTF8(x)                      \
+  (::longlp::base::kTranscodedLiteral<                 \
+    ::longlp::base::CharUTF32,                         \
+    ::longlp::base::FixedString(LONGLP_LITERAL_UTF8(x))>)
+#define LONGLP_UTF8_FROM_UTF16(x)                       \
+  (::longlp::base::kTranscodedLiteral<                  \
+    ::longlp::base::CharUTF8,                           \
+    ::longlp::base::FixedString(LONGLP_LITERAL_UTF16(x))>)
+#define LONGLP_UTF32_FROM_UTF16(x)                      \
+  (::longlp::base::kTranscodedLiteral<                  \
+    ::longlp::base::CharUTF32,                          \
+    ::longlp::base::FixedString(LONGLP_LITERAL_UTF16(x))>)
+#define LONGLP_UTF8_FROM_UTF32(x)                       \
+  (::longlp::base::kTranscodedLiteral<                  \
+    ::longlp::base::CharUTF8,                           \
+    ::longlp::base::FixedString(LONGLP_LITERAL_UTF32(x))>)
+#define LONGLP_UTF16_FROM_UTF32(x)                      \
+  (::longlp::base::kTranscodedLiteral<                  \
+    ::longlp::base::CharUTF16,                          \
+    ::longlp::base::FixedString(LONGLP_LITERAL_UTF32(x))>)
+
+#endif    // LONGLP_INCLUDE_BASE_STRINGS_UTF_LITERALS_H_
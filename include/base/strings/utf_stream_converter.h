@@ -0,0 +1,67 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#ifndef LONGLP_INCLUDE_BASE_STRINGS_UTF_STREAM_CONVERTER_H_
+#define LONGLP_INCLUDE_BASE_STRINGS_UTF_STREAM_CONVERTER_H_
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "base/base_export.h"
+#include "base/strings/typedefs.h"
+
+namespace longlp::base {
+
+// Converts a stream of UTF-8, -16 or -32 text that arrives in chunks of any
+// size, with the same result as converting the whole stream at once (see
+// utf_string_conversion.h). A code point split across two chunks is held back
+// until the next one completes it, which takes at most 3 bytes of UTF-8 or
+// one lead surrogate of UTF-16, so the memory use does not depend on the
+// length of the stream.
+//
+//   UTFStreamConverter<CharUTF8, CharUTF16> converter;
+//   StringUTF16 output;
+//   while (auto chunk = socket.Read()) {
+//     output.clear();
+//     converter.Convert(chunk, output);
+//     Consume(output);
+//   }
+//   output.clear();
+//   converter.Finish(output);
+//
+// Instantiated for every pair of UTF-8, UTF-16 and UTF-32.
+template <CharTraits SrcChar, CharTraits DestChar>
+class BASE_EXPORT UTFStreamConverter final {
+ public:
+  // Converts |chunk| and appends the result to |output|. Returns false if
+  // invalid input was replaced by U+FFFD.
+  auto Convert(
+    std::basic_string_view<SrcChar> chunk,
+    std::basic_string<DestChar>& output) -> bool;
+
+  // Ends the stream by appending a U+FFFD for the code point left incomplete,
+  // if any, in which case it returns false. The converter can then start a
+  // new stream.
+  auto Finish(std::basic_string<DestChar>& output) -> bool;
+
+  // Whether the stream ends in the middle of a code point so far.
+  [[nodiscard]] constexpr auto has_pending() const -> bool {
+    return pending_size_ > 0;
+  }
+
+ private:
+  static constexpr size_t kMaxPending = std::same_as<SrcChar, CharUTF8>    ? 3
+                                        : std::same_as<SrcChar, CharUTF16> ? 1
+                                                                           : 0;
+
+  std::array<SrcChar, kMaxPending> pending_{};
+  size_t pending_size_ = 0;
+};
+
+}    // namespace longlp::base
+
+#endif    // LONGLP_INCLUDE_BASE_STRINGS_UTF_STREAM_CONVERTER_H_
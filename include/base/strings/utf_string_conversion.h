@@ -5,12 +5,17 @@
 #ifndef LONGLP_INCLUDE_BASE_STRINGS_UTF_STRING_CONVERSION_H_
 #define LONGLP_INCLUDE_BASE_STRINGS_UTF_STRING_CONVERSION_H_
 
+#include <bit>
 #include <cstddef>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <vector>
 
 #include "base/base_export.h"
+#include "base/icu/utf.h"
 #include "base/predef.h"
 #include "base/strings/typedefs.h"
 
@@ -18,12 +23,33 @@ namespace longlp::base {
 
 // NOLINTBEGIN(*-avoid-c-arrays)
 
-// These convert between UTF-8, -16, -32 and ASCII strings. They are potentially
-// slow, so avoid unnecessary conversions. The low-level versions return a
-// boolean indicating whether the conversion was 100% valid. In this case, it
-// will still do the best it can and put the result in the output buffer. The
-// versions that return strings ignore this error and just return the best
-// conversion possible.
+// These convert between UTF-8, -16, -32, ASCII and Latin-1 strings. They are
+// potentially slow, so avoid unnecessary conversions. The low-level versions
+// return a boolean indicating whether the conversion was 100% valid. In this
+// case, it will still do the best it can and put the result in the output
+// buffer. The versions that return strings ignore this error and just return
+// the best conversion possible.
+
+// Outcome of a conversion, in detail.
+struct UTFConversionResult {
+  // Number of code units written to the output, or, for the overloads taking
+  // a span, the number of code units the conversion needs when it exceeds the
+  // size of the output.
+  size_t size                                = 0;
+  // Whether the conversion was 100% valid, as for the overloads returning a
+  // bool. False when the output span was too small or the input had invalid
+  // sequences.
+  bool success                               = false;
+  // Offset in the source, in code units, of the first sequence replaced by
+  // U+FFFD, of the first non-ASCII code unit for the *ToASCII functions, or
+  // of the first sequence replaced by '?' for the *ToLatin1 functions. Empty
+  // when the input was valid, or when nothing was written.
+  std::optional<size_t> first_invalid_offset = std::nullopt;
+  // Number of sequences replaced by U+FFFD, of non-ASCII code units for the
+  // *ToASCII functions, or of sequences replaced by '?' for the *ToLatin1
+  // functions.
+  size_t replaced_count                      = 0;
+};
 
 // UTF32 To Others
 BASE_EXPORT auto
@@ -31,7 +57,7 @@ UTF32ToUTF8(StringViewUTF32 utf32, StringUTF8& utf8_output) -> bool;
 BASE_EXPORT auto
 UTF32ToUTF16(StringViewUTF32 utf32, StringUTF16& utf16_output) -> bool;
 // Converts to 7-bit ASCII by truncating. The result must be known to be ASCII
-// beforehand.
+// beforehand; returns false when it was not.
 BASE_EXPORT auto
 UTF32ToASCII(StringViewUTF32 utf32, StringASCII& ascii_output) -> bool;
 
@@ -41,7 +67,7 @@ UTF16ToUTF32(StringViewUTF16 utf16, StringUTF32& utf32_output) -> bool;
 BASE_EXPORT auto
 UTF16ToUTF8(StringViewUTF16 utf16, StringUTF8& utf8_output) -> bool;
 // Converts to 7-bit ASCII by truncating. The result must be known to be ASCII
-// beforehand.
+// beforehand; returns false when it was not.
 BASE_EXPORT auto
 UTF16ToASCII(StringViewUTF16 utf16, StringASCII& ascii_output) -> bool;
 
@@ -50,8 +76,17 @@ BASE_EXPORT auto
 UTF8ToUTF16(StringViewUTF8 utf8, StringUTF16& utf16_output) -> bool;
 BASE_EXPORT auto
 UTF8ToUTF32(StringViewUTF8 utf8, StringUTF32& utf32_output) -> bool;
-// TODO(longlp, string): utf8-ascii, see
-// https://source.chromium.org/chromium/chromium/src/+/main:third_party/libxml/src/encoding.c;l=227;bpv=1;bpt=1?q=UTF8ToAscii&sq=&ss=chromium%2Fchromium%2Fsrc
+// Copies ASCII text. Fails at the first non-ASCII byte, leaving the ASCII
+// text before it in |ascii_output|.
+BASE_EXPORT auto
+UTF8ToASCII(StringViewUTF8 utf8, StringASCII& ascii_output) -> bool;
+// Same as UTF8ToASCII(), but replaces every non-ASCII code point, and every
+// ill-formed sequence UTF8ToUTF16() would replace by U+FFFD, with
+// |substitute|. Returns false if anything was replaced.
+BASE_EXPORT auto UTF8ToASCIILossy(
+  StringViewUTF8 utf8,
+  StringASCII& ascii_output,
+  CharASCII substitute = '?') -> bool;
 
 // ASCII To Others
 // This converts an ASCII string, typically a hardcoded constant, to a UTF16
@@ -67,10 +102,222 @@ ASCIIToUTF32(StringViewASCII ascii, StringUTF32& utf32_output) -> bool;
 BASE_EXPORT auto
 ASCIIToUTF8(StringViewASCII ascii, StringUTF8& utf8_output) -> bool;
 
+// Latin-1 To Others
+// Latin-1 (ISO-8859-1) holds U+0000..U+00FF, one byte each, so converting it
+// always succeeds.
+BASE_EXPORT auto
+Latin1ToUTF8(StringViewLatin1 latin1, StringUTF8& utf8_output) -> bool;
+BASE_EXPORT auto
+Latin1ToUTF16(StringViewLatin1 latin1, StringUTF16& utf16_output) -> bool;
+
+// Others To Latin-1
+// Replaces every code point above U+00FF, and every ill-formed sequence
+// UTF8ToUTF16() or UTF16ToUTF8() would replace by U+FFFD, with '?'. Returns
+// false if anything was replaced.
+BASE_EXPORT auto
+UTF8ToLatin1(StringViewUTF8 utf8, StringLatin1& latin1_output) -> bool;
+BASE_EXPORT auto
+UTF16ToLatin1(StringViewUTF16 utf16, StringLatin1& latin1_output) -> bool;
+
+// Same as UTF16ToUTF8() and UTF32ToUTF8(), for code units stored in
+// |byte_order| rather than in the host one, e.g. std::endian::big for UTF-16BE
+// read from the network. The byte swap is part of the conversion, it takes
+// neither another pass nor a temporary copy.
+BASE_EXPORT auto UTF16ToUTF8(
+  StringViewUTF16 utf16,
+  std::endian byte_order,
+  StringUTF8& utf8_output) -> bool;
+BASE_EXPORT auto UTF32ToUTF8(
+  StringViewUTF32 utf32,
+  std::endian byte_order,
+  StringUTF8& utf8_output) -> bool;
+
+// Converts every string of the batch as the functions above would, back to
+// back into the output with a single allocation, which suits many short
+// strings. The result of string i is [offsets[i], offsets[i + 1]) of the
+// output, so |offsets| gets one more element than the batch. Returns false if
+// any of the strings was invalid.
+BASE_EXPORT auto UTF8ToUTF16Batch(
+  std::span<const StringViewUTF8> utf8_batch,
+  StringUTF16& utf16_output,
+  std::vector<size_t>& offsets) -> bool;
+BASE_EXPORT auto UTF16ToUTF8Batch(
+  std::span<const StringViewUTF16> utf16_batch,
+  StringUTF8& utf8_output,
+  std::vector<size_t>& offsets) -> bool;
+
+// Same as the functions above, but also rewrite |offsets|, positions in the
+// input sorted in ascending order, to the matching positions in the output,
+// all in the single pass of the conversion. An offset inside a code point, or
+// inside an ill-formed sequence replaced by one U+FFFD, past the end of the
+// input, or out of order, is set to npos.
+BASE_EXPORT auto UTF8ToUTF16AndAdjustOffsets(
+  StringViewUTF8 utf8,
+  StringUTF16& utf16_output,
+  std::vector<size_t>& offsets) -> bool;
+BASE_EXPORT auto UTF16ToUTF8AndAdjustOffsets(
+  StringViewUTF16 utf16,
+  StringUTF8& utf8_output,
+  std::vector<size_t>& offsets) -> bool;
+
+// Same as the functions above, but large inputs are converted on up to
+// |max_threads| threads, std::thread::hardware_concurrency() when 0. The input
+// is split in front of code points, so the output is identical to the one of
+// the serial conversion. Inputs below a few hundred thousand code units per
+// thread are converted on the calling thread.
+BASE_EXPORT auto UTF8ToUTF16Parallel(
+  StringViewUTF8 utf8,
+  StringUTF16& utf16_output,
+  size_t max_threads = 0) -> bool;
+BASE_EXPORT auto UTF8ToUTF32Parallel(
+  StringViewUTF8 utf8,
+  StringUTF32& utf32_output,
+  size_t max_threads = 0) -> bool;
+BASE_EXPORT auto UTF16ToUTF8Parallel(
+  StringViewUTF16 utf16,
+  StringUTF8& utf8_output,
+  size_t max_threads = 0) -> bool;
+BASE_EXPORT auto UTF16ToUTF32Parallel(
+  StringViewUTF16 utf16,
+  StringUTF32& utf32_output,
+  size_t max_threads = 0) -> bool;
+BASE_EXPORT auto UTF32ToUTF8Parallel(
+  StringViewUTF32 utf32,
+  StringUTF8& utf8_output,
+  size_t max_threads = 0) -> bool;
+BASE_EXPORT auto UTF32ToUTF16Parallel(
+  StringViewUTF32 utf32,
+  StringUTF16& utf16_output,
+  size_t max_threads = 0) -> bool;
+
+// Same as the functions above, but also report where the input was invalid
+// in |result|. The report is only assembled once an invalid sequence is met,
+// so valid input converts as fast as with the functions above.
+BASE_EXPORT auto UTF32ToUTF8(
+  StringViewUTF32 utf32,
+  StringUTF8& utf8_output,
+  UTFConversionResult& result) -> bool;
+BASE_EXPORT auto UTF32ToUTF16(
+  StringViewUTF32 utf32,
+  StringUTF16& utf16_output,
+  UTFConversionResult& result) -> bool;
+BASE_EXPORT auto UTF16ToUTF32(
+  StringViewUTF16 utf16,
+  StringUTF32& utf32_output,
+  UTFConversionResult& result) -> bool;
+BASE_EXPORT auto UTF16ToUTF8(
+  StringViewUTF16 utf16,
+  StringUTF8& utf8_output,
+  UTFConversionResult& result) -> bool;
+BASE_EXPORT auto UTF8ToUTF16(
+  StringViewUTF8 utf8,
+  StringUTF16& utf16_output,
+  UTFConversionResult& result) -> bool;
+BASE_EXPORT auto UTF8ToUTF32(
+  StringViewUTF8 utf8,
+  StringUTF32& utf32_output,
+  UTFConversionResult& result) -> bool;
+
+// Encodes an array of code points, as UTF32ToUTF8() and UTF32ToUTF16() would,
+// sizing the output once. Code points that are not Unicode scalar values are
+// replaced by U+FFFD. The bool overloads return false if there were any, the
+// span overloads count them, and report the first one's offset, in code
+// points.
+BASE_EXPORT auto EncodeCodePoints(
+  std::span<const icu::CodePoint> code_points,
+  StringUTF8& utf8_output) -> bool;
+BASE_EXPORT auto EncodeCodePoints(
+  std::span<const icu::CodePoint> code_points,
+  StringUTF16& utf16_output) -> bool;
+BASE_EXPORT auto EncodeCodePoints(
+  std::span<const icu::CodePoint> code_points,
+  std::span<CharUTF8> utf8_output) -> UTFConversionResult;
+BASE_EXPORT auto EncodeCodePoints(
+  std::span<const icu::CodePoint> code_points,
+  std::span<CharUTF16> utf16_output) -> UTFConversionResult;
+
+// Decodes text into |code_points|, one U+FFFD for every ill-formed sequence.
+// The text never decodes to more code points than it has code units. Same
+// results as the span overloads below.
+BASE_EXPORT auto DecodeCodePoints(
+  StringViewUTF8 utf8,
+  std::span<icu::CodePoint> code_points) -> UTFConversionResult;
+BASE_EXPORT auto DecodeCodePoints(
+  StringViewUTF16 utf16,
+  std::span<icu::CodePoint> code_points) -> UTFConversionResult;
+BASE_EXPORT auto DecodeCodePoints(
+  StringViewUTF32 utf32,
+  std::span<icu::CodePoint> code_points) -> UTFConversionResult;
+
+// The overloads below convert into a caller-provided buffer, such as a stack
+// buffer or an arena, and never allocate. When |*_output| is too small they
+// write nothing and return the size it needs instead; a buffer of that size
+// is guaranteed to fit the conversion.
+
+BASE_EXPORT auto
+UTF32ToUTF8(StringViewUTF32 utf32, std::span<CharUTF8> utf8_output)
+  -> UTFConversionResult;
+BASE_EXPORT auto
+UTF32ToUTF16(StringViewUTF32 utf32, std::span<CharUTF16> utf16_output)
+  -> UTFConversionResult;
+BASE_EXPORT auto
+UTF32ToASCII(StringViewUTF32 utf32, std::span<CharASCII> ascii_output)
+  -> UTFConversionResult;
+
+BASE_EXPORT auto
+UTF16ToUTF32(StringViewUTF16 utf16, std::span<CharUTF32> utf32_output)
+  -> UTFConversionResult;
+BASE_EXPORT auto
+UTF16ToUTF8(StringViewUTF16 utf16, std::span<CharUTF8> utf8_output)
+  -> UTFConversionResult;
+BASE_EXPORT auto
+UTF16ToASCII(StringViewUTF16 utf16, std::span<CharASCII> ascii_output)
+  -> UTFConversionResult;
+
+BASE_EXPORT auto
+UTF8ToUTF16(StringViewUTF8 utf8, std::span<CharUTF16> utf16_output)
+  -> UTFConversionResult;
+BASE_EXPORT auto
+UTF8ToUTF32(StringViewUTF8 utf8, std::span<CharUTF32> utf32_output)
+  -> UTFConversionResult;
+
+BASE_EXPORT auto
+ASCIIToUTF16(StringViewASCII ascii, std::span<CharUTF16> utf16_output)
+  -> UTFConversionResult;
+BASE_EXPORT auto
+ASCIIToUTF32(StringViewASCII ascii, std::span<CharUTF32> utf32_output)
+  -> UTFConversionResult;
+BASE_EXPORT auto
+ASCIIToUTF8(StringViewASCII ascii, std::span<CharUTF8> utf8_output)
+  -> UTFConversionResult;
+
+BASE_EXPORT auto
+Latin1ToUTF8(StringViewLatin1 latin1, std::span<CharUTF8> utf8_output)
+  -> UTFConversionResult;
+BASE_EXPORT auto
+Latin1ToUTF16(StringViewLatin1 latin1, std::span<CharUTF16> utf16_output)
+  -> UTFConversionResult;
+BASE_EXPORT auto
+UTF8ToLatin1(StringViewUTF8 utf8, std::span<CharLatin1> latin1_output)
+  -> UTFConversionResult;
+BASE_EXPORT auto
+UTF16ToLatin1(StringViewUTF16 utf16, std::span<CharLatin1> latin1_output)
+  -> UTFConversionResult;
+
+BASE_EXPORT auto UTF16ToUTF8(
+  StringViewUTF16 utf16,
+  std::endian byte_order,
+  std::span<CharUTF8> utf8_output) -> UTFConversionResult;
+BASE_EXPORT auto UTF32ToUTF8(
+  StringViewUTF32 utf32,
+  std::endian byte_order,
+  std::span<CharUTF8> utf8_output) -> UTFConversionResult;
+
 // The conversion functions in this file should not be used to convert string
 // literals. Instead, the corresponding prefixes (e.g. u"" for UTF16 or U"" for
 // UTF32) should be used. Deleting the overloads here catches these cases at
 // compile time.
+// When a literal has to be written in another encoding, see utf_literals.h.
 
 template <size_t N>
 auto UTF32ToUTF8(const char32_t (&str)[N], StringUTF8& utf8_output)
@@ -101,6 +348,11 @@ auto UTF8ToUTF32(const char8_t (&str)[N], StringUTF32& utf32_output)
 template <size_t N>
 auto UTF8ToASCII(const char8_t (&str)[N], StringASCII& ascii_output)
   -> bool = delete;
+template <size_t N>
+auto UTF8ToASCIILossy(
+  const char8_t (&str)[N],
+  StringASCII& ascii_output,
+  CharASCII substitute = '?') -> bool = delete;
 
 template <size_t N>
 auto ASCIIToUTF16(const char (&str)[N], StringUTF16& utf16_output)
@@ -112,6 +364,19 @@ template <size_t N>
 auto ASCIIToUTF8(const char (&str)[N], StringUTF8& utf8_output)
   -> bool = delete;
 
+template <size_t N>
+auto Latin1ToUTF8(const char (&str)[N], StringUTF8& utf8_output)
+  -> bool = delete;
+template <size_t N>
+auto Latin1ToUTF16(const char (&str)[N], StringUTF16& utf16_output)
+  -> bool = delete;
+template <size_t N>
+auto UTF8ToLatin1(const char8_t (&str)[N], StringLatin1& latin1_output)
+  -> bool = delete;
+template <size_t N>
+auto UTF16ToLatin1(const char16_t (&str)[N], StringLatin1& latin1_output)
+  -> bool = delete;
+
 // NOLINTEND(*-avoid-c-arrays)
 }    // namespace longlp::base
 
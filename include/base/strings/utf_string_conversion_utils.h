@@ -70,9 +70,27 @@ BASE_EXPORT auto ReadUnicodeCharacter(
   size_t& char_index,
   icu::CodePoint& code_point_out) -> bool;
 
+// CountCodePoints -------------------------------------------------------------
+
+// Number of code points ReadUnicodeCharacter() reads from the whole string,
+// counting one for every ill-formed sequence the conversions replace by
+// U+FFFD, in a single vectorized pass.
+BASE_EXPORT auto CountCodePoints(StringViewUTF8 utf8_src) -> size_t;
+BASE_EXPORT auto CountCodePoints(StringViewUTF16 utf16_src) -> size_t;
+
+// FirstCodePointLength --------------------------------------------------------
+
+// Number of code units of the first code point of |src|, or of the ill-formed
+// sequence the conversions replace by one U+FFFD. |src| must not be empty.
+BASE_EXPORT auto FirstCodePointLength(StringViewUTF8 utf8_src) -> size_t;
+BASE_EXPORT auto FirstCodePointLength(StringViewUTF16 utf16_src) -> size_t;
+
 // AppendUnicodeCharacter
 // -------------------------------------------------------
 
+// To encode many code points at once, prefer EncodeCodePoints() from
+// utf_string_conversion.h, which sizes the output once.
+
 // Appends a UTF-8 character to the given 8-bit string.  Returns the number of
 // bytes written.
 BASE_EXPORT auto
@@ -97,10 +115,9 @@ AppendUnicodeCharacter(icu::CodePoint code_point, StringUTF32& utf32_output)
 
 // Generalized Unicode converter -----------------------------------------------
 
-// Guesses the length of the output in UTF-8 in bytes, clears that output
-// string, and reserves that amount of space.  We assume that the input
-// character types are unsigned, which will be true for UTF-16 and -32 on our
-// systems.
+// Computes the exact length of the output in UTF-8 in bytes, U+FFFD
+// replacements included, clears that output string, and reserves that amount
+// of space.
 template <CharTraits CharT>
 void PrepareForUTF8Output(
   std::basic_string_view<CharT> src,
@@ -7,6 +7,7 @@
 #include "base/auto_reset.h"
 #include "base/base_export.h"
 #include "base/compiler_specific.h"
+#include "base/cpu.h"
 #include "base/immediate_crash.h"
 #include "base/macros.h"
 #include "base/no_destructor.h"
@@ -25,6 +26,7 @@
 #include "base/strings/string_utils.h"
 #include "base/strings/string_utils.internal.h"
 #include "base/strings/typedefs.h"
+#include "base/strings/utf_string_conversion.h"
 #include "base/strings/utf_string_conversion_utils.h"
 
 // icu/
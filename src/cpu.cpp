@@ -0,0 +1,110 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include "base/cpu.h"
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY) && defined(LONGLP_COMPILER_MSVC)
+#  include <immintrin.h>
+#  include <intrin.h>
+#endif
+
+namespace longlp::base {
+
+namespace {
+  // NOLINTBEGIN(*-magic-numbers)
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY) && defined(LONGLP_COMPILER_MSVC)
+  struct CPUIDRegisters {
+    uint32_t eax;
+    uint32_t ebx;
+    uint32_t ecx;
+    uint32_t edx;
+  };
+
+  auto QueryCPUID(int32_t leaf, int32_t subleaf) -> CPUIDRegisters {
+    std::array<int32_t, 4> registers{};
+    __cpuidex(registers.data(), leaf, subleaf);
+    return {
+      static_cast<uint32_t>(registers[0]),
+      static_cast<uint32_t>(registers[1]),
+      static_cast<uint32_t>(registers[2]),
+      static_cast<uint32_t>(registers[3]),
+    };
+  }
+
+  constexpr auto HasBit(uint32_t value, uint32_t bit) -> bool {
+    return (value & (1U << bit)) != 0;
+  }
+#endif
+  // NOLINTEND(*-magic-numbers)
+}    // namespace
+
+CPU::CPU() {
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+#  if defined(LONGLP_COMPILER_GCC) || defined(LONGLP_COMPILER_CLANG)
+  // The builtins already take care of the XCR0 check for AVX states.
+  __builtin_cpu_init();
+  has_sse42_    = __builtin_cpu_supports("sse4.2") != 0;
+  has_avx2_     = __builtin_cpu_supports("avx2") != 0;
+  has_avx512bw_ = __builtin_cpu_supports("avx512f") != 0 &&
+                  __builtin_cpu_supports("avx512bw") != 0;
+#  elif defined(LONGLP_COMPILER_MSVC)
+  // NOLINTBEGIN(*-magic-numbers)
+  const auto max_leaf = QueryCPUID(0, 0).eax;
+  const auto leaf1    = QueryCPUID(1, 0);
+  has_sse42_          = HasBit(leaf1.ecx, 20);
+
+  // OSXSAVE and the YMM state (bits 1 and 2 of XCR0) are required before
+  // touching any AVX register.
+  const bool os_saves_ymm =
+    HasBit(leaf1.ecx, 27) && (_xgetbv(0) & 0x6) == 0x6;
+  // Opmask, upper ZMM0-15 and ZMM16-31 states (bits 5, 6 and 7 of XCR0).
+  const bool os_saves_zmm = os_saves_ymm && (_xgetbv(0) & 0xE0) == 0xE0;
+  if (max_leaf >= 7) {
+    const auto leaf7 = QueryCPUID(7, 0);
+    has_avx2_        = os_saves_ymm && HasBit(leaf7.ebx, 5);
+    has_avx512bw_ =
+      os_saves_zmm && HasBit(leaf7.ebx, 16) && HasBit(leaf7.ebx, 30);
+  }
+  // NOLINTEND(*-magic-numbers)
+#  endif
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+  // Advanced SIMD is mandatory on AArch64.
+  has_neon_ = true;
+#endif
+
+  // See LONGLP_CPU_MAX_ISA in cpu.h. The kernels are selected from
+  // GetInstanceNoAllocation(), so the cap applies to all of them.
+  // NOLINTNEXTLINE(concurrency-mt-unsafe)
+  const char* max_isa_env = std::getenv("LONGLP_CPU_MAX_ISA");
+  if (max_isa_env == nullptr) {
+    return;
+  }
+  const std::string_view max_isa(max_isa_env);
+  if (max_isa == "avx2") {
+    has_avx512bw_ = false;
+  }
+  else if (max_isa == "sse42") {
+    has_avx512bw_ = false;
+    has_avx2_     = false;
+  }
+  else if (max_isa == "none") {
+    has_avx512bw_ = false;
+    has_avx2_     = false;
+    has_sse42_    = false;
+    has_neon_     = false;
+  }
+}
+
+auto CPU::GetInstanceNoAllocation() -> const CPU& {
+  // CPU is trivially destructible, no need for NoDestructor.
+  static const CPU kCPU;
+  return kCPU;
+}
+
+}    // namespace longlp::base
@@ -0,0 +1,141 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include "base/strings/char_set.h"
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <iterator>
+#include <type_traits>
+
+#include "strings/simd/utf_kernels.h"
+
+namespace longlp::base {
+// NOLINTBEGIN(*-magic-numbers)
+namespace {
+  constexpr uint32_t kLastByte = 0xFF;
+
+  template <CharTraits Char>
+  auto ToCodeUnit(Char unit) -> uint32_t {
+    return static_cast<uint32_t>(static_cast<std::make_unsigned_t<Char>>(unit));
+  }
+
+  // ASCII strings go through the UTF-8 kernel.
+  template <CharTraits Char>
+  auto KernelUnits(std::basic_string_view<Char> str) {
+    if constexpr (std::same_as<Char, CharASCII>) {
+      return std::bit_cast<const CharUTF8*>(str.data());
+    }
+    else {
+      return str.data();
+    }
+  }
+}    // namespace
+
+template <CharTraits Char>
+CharSet<Char>::CharSet(std::basic_string_view<Char> chars) {
+  std::vector<uint32_t> wide_units;
+  for (const Char c : chars) {
+    const uint32_t unit = ToCodeUnit(c);
+    if (unit > kLastByte) {
+      wide_units.push_back(unit);
+      continue;
+    }
+    bitmap_[unit >> 3] |= static_cast<uint8_t>(1U << (unit & 7));
+    nibbles_[(unit >> 7) * 16 + (unit & 15)] |=
+      static_cast<uint8_t>(1U << ((unit >> 4) & 7));
+  }
+
+  std::ranges::sort(wide_units);
+  for (const uint32_t unit : wide_units) {
+    if (!ranges_.empty() && unit <= ranges_.back().last + 1) {
+      ranges_.back().last = unit;
+    }
+    else {
+      ranges_.push_back({.first = unit, .last = unit});
+    }
+  }
+}
+
+template <CharTraits Char>
+auto CharSet<Char>::Contains(Char unit) const -> bool {
+  const uint32_t value = ToCodeUnit(unit);
+  if (value <= kLastByte) {
+    return ((bitmap_[value >> 3] >> (value & 7)) & 1) != 0;
+  }
+  const auto next = std::ranges::upper_bound(ranges_, value, {}, &Range::first);
+  return next != ranges_.begin() && value <= std::prev(next)->last;
+}
+
+template <CharTraits Char>
+template <bool kNegate>
+auto CharSet<Char>::Find(std::basic_string_view<Char> str, size_t pos) const
+  -> size_t {
+  const internal::simd::ByteSet byte_set{
+    .bitmap  = bitmap_.data(),
+    .nibbles = nibbles_.data()};
+  const auto* units = KernelUnits(str);
+  for (size_t i = pos; i < str.size(); ++i) {
+    if constexpr (sizeof(Char) == 1) {
+      i += internal::simd::FindInByteSet(
+        units + i,
+        str.size() - i,
+        byte_set,
+        kNegate);
+      return i < str.size() ? i : npos;
+    }
+    else {
+      // The code units above 0xFF are looked up here, and only need to be
+      // when they may be the answer.
+      i += internal::simd::FindInByteSet(
+        units + i,
+        str.size() - i,
+        byte_set,
+        kNegate,
+        /*stop_at_wide=*/kNegate || !ranges_.empty());
+      if (i == str.size()) {
+        break;
+      }
+      if (Contains(str[i]) != kNegate) {
+        return i;
+      }
+    }
+  }
+  return npos;
+}
+
+template <CharTraits Char>
+auto CharSet<Char>::FindFirstOf(std::basic_string_view<Char> str, size_t pos)
+  const -> size_t {
+  return Find</*kNegate=*/false>(str, pos);
+}
+
+template <CharTraits Char>
+auto CharSet<Char>::FindFirstNotOf(
+  std::basic_string_view<Char> str,
+  size_t pos) const -> size_t {
+  return Find</*kNegate=*/true>(str, pos);
+}
+
+template <CharTraits Char>
+auto CharSet<Char>::FindLastNotOf(std::basic_string_view<Char> str) const
+  -> size_t {
+  // Trimming only scans the few code units it removes, which a vector kernel
+  // would not speed up.
+  for (size_t i = str.size(); i > 0; --i) {
+    if (!Contains(str[i - 1])) {
+      return i - 1;
+    }
+  }
+  return npos;
+}
+
+template class CharSet<CharASCII>;
+template class CharSet<CharUTF8>;
+template class CharSet<CharUTF16>;
+template class CharSet<CharUTF32>;
+
+// NOLINTEND(*-magic-numbers)
+}    // namespace longlp::base
@@ -0,0 +1,395 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include "base/strings/encoding_detection.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "base/icu/utf.h"
+#include "base/strings/string_utils.constants.h"
+#include "base/strings/utf_string_conversion.h"
+#include "base/strings/utf_string_conversion_utils.h"
+#include "strings/simd/utf_kernels.h"
+
+namespace longlp::base {
+// NOLINTBEGIN(*-magic-numbers,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+namespace {
+
+  constexpr icu::CodePoint kErrorCodePoint(0xFFFD);
+
+  // Number of bytes at the start of the input the zero bytes are counted on.
+  // Enough for the statistics, small enough for the count to be negligible
+  // next to the validation of large inputs.
+  constexpr size_t kSampleSize = 4096;
+
+  // UTF-16 and UTF-32 are only guessed when at least one code unit in
+  // kMinZeroShare has its zero bytes where ASCII and Latin-1 characters have
+  // them, and when the other positions have kMinZeroRatio times fewer.
+  constexpr size_t kMinZeroShare = 16;
+  constexpr size_t kMinZeroRatio = 8;
+
+  struct ByteOrderMark {
+    std::string_view bytes;
+    TextEncoding encoding;
+  };
+
+  // FF FE 00 00 also starts with the UTF-16LE mark, so UTF-32 comes first.
+  // The UTF-8 mark is kUTF8ByteOrderMark.
+  constexpr std::array<ByteOrderMark, 4> kByteOrderMarks = {{
+    {std::string_view("\xFF\xFE\0\0", 4), TextEncoding::kUTF32LE},
+    {std::string_view("\0\0\xFE\xFF", 4), TextEncoding::kUTF32BE},
+    {std::string_view("\xFF\xFE", 2), TextEncoding::kUTF16LE},
+    {std::string_view("\xFE\xFF", 2), TextEncoding::kUTF16BE},
+  }};
+
+  auto StartsWithUTF8ByteOrderMark(std::string_view bytes) -> bool {
+    return bytes.size() >= kUTF8ByteOrderMark.size() &&
+           std::equal(
+             kUTF8ByteOrderMark.begin(),
+             kUTF8ByteOrderMark.end(),
+             bytes.begin(),
+             [](CharUTF8 mark, char byte) {
+               return mark == static_cast<CharUTF8>(byte);
+             });
+  }
+
+  auto DetectByteOrderMark(std::string_view bytes)
+    -> std::optional<EncodingDetection> {
+    if (StartsWithUTF8ByteOrderMark(bytes)) {
+      return EncodingDetection{TextEncoding::kUTF8, kUTF8ByteOrderMark.size()};
+    }
+    for (const auto& mark : kByteOrderMarks) {
+      if (bytes.starts_with(mark.bytes)) {
+        return EncodingDetection{mark.encoding, mark.bytes.size()};
+      }
+    }
+    return std::nullopt;
+  }
+
+  // Length of the byte order mark of |encoding| starting |bytes|, if any.
+  auto ByteOrderMarkLength(std::string_view bytes, TextEncoding encoding)
+    -> size_t {
+    const auto bom = DetectByteOrderMark(bytes);
+    return bom && bom->encoding == encoding ? bom->bom_length : 0;
+  }
+
+  // Number of zero bytes at each offset modulo 4. Written for the compiler to
+  // vectorize.
+  auto CountZeroBytes(std::string_view sample) -> std::array<size_t, 4> {
+    std::array<size_t, 4> zeros{};
+    size_t i = 0;
+    for (; i + zeros.size() <= sample.size(); i += zeros.size()) {
+      for (size_t k = 0; k < zeros.size(); ++k) {
+        zeros[k] += sample[i + k] == 0 ? 1U : 0U;
+      }
+    }
+    for (; i < sample.size(); ++i) {
+      zeros[i % zeros.size()] += sample[i] == 0 ? 1U : 0U;
+    }
+    return zeros;
+  }
+
+  // Whether |expected| zero bytes out of |units| code units are frequent
+  // enough, and |unexpected| ones rare enough, for a wide encoding.
+  constexpr auto
+  IsZeroPattern(size_t expected, size_t unexpected, size_t units) -> bool {
+    return expected > 0 && expected * kMinZeroShare >= units &&
+           unexpected * kMinZeroRatio <= expected;
+  }
+
+  // The wide encoding the zero bytes of the sample of an input of |size|
+  // bytes look like, if any.
+  auto GuessWideEncoding(size_t size, const std::array<size_t, 4>& zeros)
+    -> std::optional<TextEncoding> {
+    const size_t sample_size = std::min(size, kSampleSize);
+    if (size % 4 == 0 && sample_size >= 4) {
+      // The highest byte of UTF-32 is always zero, the next one is for the
+      // BMP.
+      const size_t units = sample_size / 4;
+      if (zeros[3] == units && zeros[2] * 2 >= units && zeros[0] < units) {
+        return TextEncoding::kUTF32LE;
+      }
+      if (zeros[0] == units && zeros[1] * 2 >= units && zeros[3] < units) {
+        return TextEncoding::kUTF32BE;
+      }
+    }
+    if (size % 2 == 0 && sample_size >= 2) {
+      const size_t units = sample_size / 2;
+      const size_t even  = zeros[0] + zeros[2];
+      const size_t odd   = zeros[1] + zeros[3];
+      if (IsZeroPattern(odd, even, units)) {
+        return TextEncoding::kUTF16LE;
+      }
+      if (IsZeroPattern(even, odd, units)) {
+        return TextEncoding::kUTF16BE;
+      }
+    }
+    return std::nullopt;
+  }
+
+  constexpr auto IsBigEndian(TextEncoding encoding) -> bool {
+    return encoding == TextEncoding::kUTF16BE ||
+           encoding == TextEncoding::kUTF32BE;
+  }
+
+  // Number of code units checked at once for the absence of invalid ones.
+  constexpr size_t kValidationBlock = 64;
+
+  // Whether |bytes| is UTF-16 without lone surrogate. Only the high byte of a
+  // code unit tells whether it is a surrogate, so this does not need to swap
+  // bytes, and blocks without surrogate are skipped in a vectorized loop.
+  auto IsValidUTF16(std::string_view bytes, bool big_endian) -> bool {
+    if (bytes.size() % 2 != 0) {
+      return false;
+    }
+    const auto* high   = std::bit_cast<const uint8_t*>(bytes.data()) +
+                         (big_endian ? 0 : 1);
+    const size_t units = bytes.size() / 2;
+    for (size_t i = 0; i < units;) {
+      const size_t end = std::min(units, i + kValidationBlock);
+      bool surrogates  = false;
+      for (size_t k = i; k < end; ++k) {
+        surrogates |= (high[2 * k] & 0xF8U) == 0xD8U;
+      }
+      if (!surrogates) {
+        i = end;
+        continue;
+      }
+      // A pair may end past the block, the next one then starts after it.
+      for (; i < end; ++i) {
+        if ((high[2 * i] & 0xF8U) != 0xD8U) {
+          continue;
+        }
+        if (
+          (high[2 * i] & 0xFCU) != 0xD8U || i + 1 >= units ||
+          (high[2 * (i + 1)] & 0xFCU) != 0xDCU) {
+          return false;
+        }
+        ++i;
+      }
+    }
+    return true;
+  }
+
+  // Reads the code unit at |src| stored in the byte order of |kBigEndian|.
+  template <std::unsigned_integral Unit, bool kBigEndian>
+  LONGLP_ALWAYS_INLINE auto LoadUnit(const char* src) -> Unit {
+    Unit unit = 0;
+    std::memcpy(&unit, src, sizeof(unit));
+    if constexpr ((std::endian::native == std::endian::big) != kBigEndian) {
+      if constexpr (sizeof(Unit) == 2) {
+        unit = static_cast<Unit>((unit >> 8U) | (unit << 8U));
+      }
+      else {
+        unit = ((unit >> 24U) & 0xFFU) | ((unit >> 8U) & 0xFF00U) |
+               ((unit << 8U) & 0xFF0000U) | (unit << 24U);
+      }
+    }
+    return unit;
+  }
+
+  // Whether |bytes| is UTF-32 of Unicode scalar values only.
+  template <bool kBigEndian>
+  auto IsValidUTF32(std::string_view bytes) -> bool {
+    if (bytes.size() % 4 != 0) {
+      return false;
+    }
+    const size_t units = bytes.size() / 4;
+    for (size_t i = 0; i < units; i += kValidationBlock) {
+      const size_t end = std::min(units, i + kValidationBlock);
+      bool invalid     = false;
+      for (size_t k = i; k < end; ++k) {
+        const auto unit = LoadUnit<uint32_t, kBigEndian>(bytes.data() + 4 * k);
+        invalid |= (unit > 0x10FFFFU) | ((unit & 0xFFFFF800U) == 0xD800U);
+      }
+      if (invalid) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  auto IsValid(std::string_view bytes, TextEncoding encoding) -> bool {
+    switch (encoding) {
+      case TextEncoding::kUTF16LE:
+      case TextEncoding::kUTF16BE:
+        return IsValidUTF16(bytes, IsBigEndian(encoding));
+      case TextEncoding::kUTF32LE:
+        return IsValidUTF32<false>(bytes);
+      case TextEncoding::kUTF32BE:
+        return IsValidUTF32<true>(bytes);
+      // Only the wide encodings are guessed from the zero bytes.
+      case TextEncoding::kASCII:
+      case TextEncoding::kUTF8:
+      case TextEncoding::kLatin1:
+      default:
+        return false;
+    }
+  }
+
+  // Copies the code units of |bytes| in host byte order. A trailing partial
+  // code unit is left out, the caller replaces it.
+  template <CharTraits Char, bool kBigEndian>
+  auto LoadUnits(std::string_view bytes) -> std::basic_string<Char> {
+    using Unit = std::conditional_t<sizeof(Char) == 2, uint16_t, uint32_t>;
+    std::basic_string<Char> units(bytes.size() / sizeof(Char), Char{});
+    for (size_t i = 0; i < units.size(); ++i) {
+      units[i] = static_cast<Char>(
+        LoadUnit<Unit, kBigEndian>(bytes.data() + i * sizeof(Char)));
+    }
+    return units;
+  }
+
+  template <CharTraits Char, bool kBigEndian>
+  auto WideToUTF8(std::string_view bytes, StringUTF8& utf8_output) -> bool {
+    constexpr auto kByteOrder =
+      kBigEndian ? std::endian::big : std::endian::little;
+    // Aligned input is converted in place, the conversion swapping the bytes
+    // as it goes. Only misaligned input is copied first.
+    const bool aligned =
+      std::bit_cast<uintptr_t>(bytes.data()) % alignof(Char) == 0;
+    std::basic_string<Char> copy;
+    if (!aligned) [[unlikely]] {
+      copy = LoadUnits<Char, kBigEndian>(bytes);
+    }
+    const std::basic_string_view<Char> units =
+      aligned ? std::basic_string_view<Char>(
+                  std::bit_cast<const Char*>(bytes.data()),
+                  bytes.size() / sizeof(Char))
+              : copy;
+    const auto byte_order = aligned ? kByteOrder : std::endian::native;
+    bool success          = false;
+    if constexpr (std::same_as<Char, CharUTF16>) {
+      success = UTF16ToUTF8(units, byte_order, utf8_output);
+    }
+    else {
+      success = UTF32ToUTF8(units, byte_order, utf8_output);
+    }
+    if (bytes.size() % sizeof(Char) != 0) [[unlikely]] {
+      AppendUnicodeCharacter(kErrorCodePoint, utf8_output);
+      success = false;
+    }
+    return success;
+  }
+
+  // Replaces the ill-formed sequences of |utf8| by U+FFFD. Only called on
+  // input that failed validation.
+  auto SanitizeUTF8(StringViewUTF8 utf8, StringUTF8& utf8_output) -> bool {
+    utf8_output.clear();
+    utf8_output.reserve(utf8.size());
+    bool success = true;
+    for (size_t i = 0; i < utf8.size(); ++i) {
+      const size_t ascii =
+        internal::simd::ASCIIPrefixLength(utf8.data() + i, utf8.size() - i);
+      utf8_output.append(utf8.substr(i, ascii));
+      i += ascii;
+      if (i >= utf8.size()) {
+        break;
+      }
+      icu::CodePoint code_point;
+      if (!ReadUnicodeCharacter(utf8, i, code_point)) {
+        code_point = kErrorCodePoint;
+        success    = false;
+      }
+      AppendUnicodeCharacter(code_point, utf8_output);
+    }
+    return success;
+  }
+
+  // Converts |bytes|, without byte order mark, knowing whether they are valid
+  // in |encoding| already.
+  auto DoConvertToUTF8(
+    std::string_view bytes,
+    TextEncoding encoding,
+    bool validated,
+    StringUTF8& utf8_output) -> bool {
+    const StringViewUTF8 utf8(
+      std::bit_cast<const CharUTF8*>(bytes.data()),
+      bytes.size());
+    switch (encoding) {
+      case TextEncoding::kASCII:
+      case TextEncoding::kUTF8:
+        // ASCII is UTF-8 already, and handled as such if it turns out not to
+        // be ASCII.
+        if (
+          validated ||
+          internal::simd::ValidateUTF8(utf8.data(), utf8.size()).valid) {
+          utf8_output.assign(utf8);
+          return true;
+        }
+        return SanitizeUTF8(utf8, utf8_output);
+      case TextEncoding::kUTF16LE:
+        return WideToUTF8<CharUTF16, false>(bytes, utf8_output);
+      case TextEncoding::kUTF16BE:
+        return WideToUTF8<CharUTF16, true>(bytes, utf8_output);
+      case TextEncoding::kUTF32LE:
+        return WideToUTF8<CharUTF32, false>(bytes, utf8_output);
+      case TextEncoding::kUTF32BE:
+        return WideToUTF8<CharUTF32, true>(bytes, utf8_output);
+      case TextEncoding::kLatin1:
+        return Latin1ToUTF8(bytes, utf8_output);
+      default:
+        return false;
+    }
+  }
+
+}    // namespace
+
+auto DetectEncoding(std::string_view bytes) -> EncodingDetection {
+  if (const auto bom = DetectByteOrderMark(bytes)) {
+    return *bom;
+  }
+
+  const auto zeros = CountZeroBytes(bytes.substr(0, kSampleSize));
+  if (const auto wide = GuessWideEncoding(bytes.size(), zeros)) {
+    if (IsValid(bytes, *wide)) {
+      return {*wide, 0};
+    }
+  }
+
+  // The validator would skip the ASCII prefix just as fast, measuring it
+  // first tells ASCII apart without another pass.
+  const auto* utf8   = std::bit_cast<const CharUTF8*>(bytes.data());
+  const size_t ascii = internal::simd::ASCIIPrefixLength(utf8, bytes.size());
+  if (ascii == bytes.size()) {
+    return {TextEncoding::kASCII, 0};
+  }
+  if (internal::simd::ValidateUTF8(utf8 + ascii, bytes.size() - ascii).valid) {
+    return {TextEncoding::kUTF8, 0};
+  }
+  return {TextEncoding::kLatin1, 0};
+}
+
+auto ConvertToUTF8(
+  std::string_view bytes,
+  TextEncoding encoding,
+  StringUTF8& utf8_output) -> bool {
+  bytes.remove_prefix(ByteOrderMarkLength(bytes, encoding));
+  return DoConvertToUTF8(bytes, encoding, /*validated=*/false, utf8_output);
+}
+
+auto ConvertToUTF8(std::string_view bytes, StringUTF8& utf8_output) -> bool {
+  const auto detection = DetectEncoding(bytes);
+  bytes.remove_prefix(detection.bom_length);
+  // Only a byte order mark leaves the encoding unchecked.
+  return DoConvertToUTF8(
+    bytes,
+    detection.encoding,
+    /*validated=*/detection.bom_length == 0,
+    utf8_output);
+}
+
+// NOLINTEND(*-magic-numbers,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}    // namespace longlp::base
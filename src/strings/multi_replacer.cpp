@@ -0,0 +1,250 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include "base/strings/multi_replacer.h"
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+namespace longlp::base {
+// NOLINTBEGIN(*-magic-numbers)
+namespace {
+  constexpr uint32_t kLastByte = 0xFF;
+  constexpr uint32_t kNoState  = std::numeric_limits<uint32_t>::max();
+
+  template <CharTraits Char>
+  auto ToCodeUnit(Char unit) -> uint32_t {
+    return static_cast<uint32_t>(static_cast<std::make_unsigned_t<Char>>(unit));
+  }
+}    // namespace
+
+template <CharTraits Char>
+MultiReplacer<Char>::MultiReplacer(std::span<const Replacement> replacements) {
+  // Give each code unit of the patterns its own column of the table.
+  std::vector<uint32_t> wide_units;
+  for (const Replacement& replacement : replacements) {
+    for (const Char c : replacement.find_this) {
+      const uint32_t unit = ToCodeUnit(c);
+      if (unit > kLastByte) {
+        wide_units.push_back(unit);
+      }
+      else if (byte_classes_[unit] == 0) {
+        byte_classes_[unit] = num_classes_++;
+      }
+    }
+  }
+  std::ranges::sort(wide_units);
+  const auto duplicates = std::ranges::unique(wide_units);
+  wide_units.erase(duplicates.begin(), duplicates.end());
+  for (const uint32_t unit : wide_units) {
+    wide_classes_.emplace_back(unit, num_classes_++);
+  }
+
+  // Build the trie of the patterns.
+  states_.emplace_back();
+  transitions_.assign(num_classes_, kNoState);
+  for (const Replacement& replacement : replacements) {
+    if (replacement.find_this.empty()) {
+      continue;
+    }
+    uint32_t state = 0;
+    for (const Char c : replacement.find_this) {
+      const size_t index = state * num_classes_ + ClassOf(c);
+      if (transitions_[index] == kNoState) {
+        transitions_[index] = static_cast<uint32_t>(states_.size());
+        states_.push_back({.depth = states_[state].depth + 1});
+        transitions_.resize(transitions_.size() + num_classes_, kNoState);
+      }
+      state = transitions_[index];
+    }
+    if (states_[state].pattern == 0) {
+      pattern_lengths_.push_back(replacement.find_this.size());
+      replacements_.emplace_back(replacement.replace_with);
+      states_[state].pattern = static_cast<uint32_t>(pattern_lengths_.size());
+    }
+  }
+
+  // Turn the trie into a DFA, breadth-first. The failure state of a state is
+  // the one of the longest proper suffix of its prefix that is also a prefix
+  // of a pattern; the transitions missing from the trie are those of the
+  // failure state, which is shallower and so already complete.
+  std::vector<uint32_t> failures(states_.size(), 0);
+  std::vector<uint32_t> queue;
+  queue.reserve(states_.size());
+  for (uint32_t c = 0; c < num_classes_; ++c) {
+    if (transitions_[c] == kNoState) {
+      transitions_[c] = 0;
+    }
+    else {
+      queue.push_back(transitions_[c]);
+    }
+  }
+  for (size_t head = 0; head < queue.size(); ++head) {
+    const uint32_t state     = queue[head];
+    const size_t row         = state * num_classes_;
+    const size_t failure_row = failures[state] * num_classes_;
+    for (uint32_t c = 0; c < num_classes_; ++c) {
+      const uint32_t next = transitions_[row + c];
+      if (next == kNoState) {
+        transitions_[row + c] = transitions_[failure_row + c];
+        continue;
+      }
+      failures[next] = transitions_[failure_row + c];
+      if (states_[next].pattern == 0) {
+        states_[next].pattern = states_[failures[next]].pattern;
+      }
+      queue.push_back(next);
+    }
+  }
+}
+
+template <CharTraits Char>
+MultiReplacer<Char>::MultiReplacer(
+  std::initializer_list<Replacement> replacements)
+  : MultiReplacer(std::span<const Replacement>(replacements)) {}
+
+template <CharTraits Char>
+auto MultiReplacer<Char>::ClassOf(Char unit) const -> uint32_t {
+  const uint32_t value = ToCodeUnit(unit);
+  if (value <= kLastByte) {
+    return byte_classes_[value];
+  }
+  const auto found = std::ranges::lower_bound(
+    wide_classes_,
+    value,
+    {},
+    &std::pair<uint32_t, uint32_t>::first);
+  return found != wide_classes_.end() && found->first == value ? found->second
+                                                               : 0;
+}
+
+template <CharTraits Char>
+auto MultiReplacer<Char>::FindMatches(
+  std::basic_string_view<Char> str,
+  size_t pos) const -> std::vector<Match> {
+  std::vector<Match> matches;
+  while (pos < str.size()) {
+    // The leftmost-longest match found so far. It is final once every prefix
+    // of a pattern still being followed starts after it: any match found
+    // later would start later too.
+    Match best{.start = str.size()};
+    bool found     = false;
+    uint32_t state = 0;
+    for (size_t i = pos; i < str.size(); ++i) {
+      state = transitions_[state * num_classes_ + ClassOf(str[i])];
+      const State& info = states_[state];
+      const size_t end  = i + 1;
+      if (info.pattern != 0) {
+        const size_t start = end - pattern_lengths_[info.pattern - 1];
+        if (!found || start < best.start) {
+          best  = {.start = start, .end = end, .pattern = info.pattern - 1};
+          found = true;
+        }
+        else if (start == best.start) {
+          best.end     = end;
+          best.pattern = info.pattern - 1;
+        }
+      }
+      if (found && end - info.depth > best.start) {
+        break;
+      }
+    }
+    if (!found) {
+      break;
+    }
+    matches.push_back(best);
+    pos = best.end;
+  }
+  return matches;
+}
+
+template <CharTraits Char>
+auto MultiReplacer<Char>::Replace(
+  std::basic_string<Char>& str,
+  size_t start_offset) const -> bool {
+  using Traits = std::char_traits<Char>;
+
+  const std::vector<Match> matches = FindMatches(str, start_offset);
+  if (matches.empty()) {
+    return false;
+  }
+
+  // Unlike in DoReplaceMatchesAfterOffset(), the replacements may lengthen
+  // the string at some matches and shorten it at others. The rewrite in place
+  // below stays behind the text it has yet to read if that text is first
+  // shifted by the largest growth of the string over any prefix of the
+  // matches.
+  const size_t str_length = str.length();
+  size_t final_length     = str_length;
+  size_t max_length       = str_length;
+  for (const Match& match : matches) {
+    final_length += replacements_[match.pattern].length();
+    final_length -= match.end - match.start;
+    max_length    = std::max(max_length, final_length);
+  }
+  const size_t expansion = max_length - str_length;
+
+  if (str.capacity() < max_length) {
+    // If we'd have to allocate a new buffer anyway, build the result directly
+    // into a new allocation of its final size via append().
+    std::basic_string<Char> src(str.get_allocator());
+    str.swap(src);
+    str.reserve(final_length);
+
+    size_t pos = 0;
+    for (const Match& match : matches) {
+      str.append(src, pos, match.start - pos);
+      str.append(replacements_[match.pattern]);
+      pos = match.end;
+    }
+    str.append(src, pos, str_length - pos);
+    return true;
+  }
+
+  // Make room for the growth by shifting the data after the first match to a
+  // higher index, then alternate replacement and move operations from there.
+  const size_t first_match = matches.front().start;
+  if (expansion != 0) {
+    str.resize(max_length);
+    Traits::move(
+      str.data() + first_match + expansion,
+      str.data() + first_match,
+      str_length - first_match);
+  }
+
+  auto* buffer        = str.data();
+  size_t write_offset = first_match;
+  size_t read_offset  = first_match;
+  for (const Match& match : matches) {
+    const size_t unmatched_length = match.start - read_offset;
+    Traits::move(
+      buffer + write_offset,
+      buffer + read_offset + expansion,
+      unmatched_length);
+    write_offset += unmatched_length;
+
+    const std::basic_string<Char>& replace_with = replacements_[match.pattern];
+    Traits::copy(
+      buffer + write_offset,
+      replace_with.data(),
+      replace_with.size());
+    write_offset += replace_with.size();
+    read_offset   = match.end;
+  }
+  Traits::move(
+    buffer + write_offset,
+    buffer + read_offset + expansion,
+    str_length - read_offset);
+  str.resize(final_length);
+  return true;
+}
+
+template class MultiReplacer<CharASCII>;
+template class MultiReplacer<CharUTF8>;
+template class MultiReplacer<CharUTF16>;
+template class MultiReplacer<CharUTF32>;
+
+// NOLINTEND(*-magic-numbers)
+}    // namespace longlp::base
@@ -0,0 +1,619 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <cstdint>
+#include <cstring>
+
+#include "base/compiler_specific.h"
+#include "base/cpu.h"
+#include "base/predef.h"
+#include "strings/simd/load_store.h"
+#include "strings/simd/utf_kernels.h"
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+#  include <immintrin.h>
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+#  include <arm_neon.h>
+#endif
+
+namespace longlp::base::internal::simd {
+// NOLINTBEGIN(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+namespace {
+  // A code unit is a letter to change iff |unit - kFirst<kToUpper>|, computed
+  // in the width of the code unit, is below 26 as an unsigned value. Code
+  // units of any other value, non-ASCII ones included, wrap around above it.
+  // Changing the case flips bit 0x20.
+  //
+  // Two code units are equal ignoring case iff their XOR is zero, or is 0x20
+  // and the first one ORed with 0x20 is a lowercase letter. The comparison
+  // kernels test a whole vector of such XORs against zero at once.
+  template <bool kToUpper>
+  constexpr uint32_t kFirst = kToUpper ? 'a' : 'A';
+  constexpr uint32_t kLetters = 26;
+  constexpr uint32_t kCaseBit = 0x20;
+
+  template <typename Unit>
+  using Kernel = void (*)(const Unit*, size_t, Unit*);
+  template <typename LhsUnit, typename RhsUnit>
+  using MismatchKernel = auto (*)(const LhsUnit*, const RhsUnit*, size_t)
+    -> size_t;
+
+  struct Kernels {
+    Kernel<CharUTF8> utf8_lower;
+    Kernel<CharUTF16> utf16_lower;
+    Kernel<CharUTF32> utf32_lower;
+    Kernel<CharUTF8> utf8_upper;
+    Kernel<CharUTF16> utf16_upper;
+    Kernel<CharUTF32> utf32_upper;
+    MismatchKernel<CharUTF8, CharUTF8> utf8_utf8_mismatch;
+    MismatchKernel<CharUTF16, CharUTF16> utf16_utf16_mismatch;
+    MismatchKernel<CharUTF32, CharUTF32> utf32_utf32_mismatch;
+    MismatchKernel<CharUTF8, CharUTF16> utf8_utf16_mismatch;
+    MismatchKernel<CharUTF8, CharUTF32> utf8_utf32_mismatch;
+    MismatchKernel<CharUTF16, CharUTF32> utf16_utf32_mismatch;
+  };
+
+  // Also the tail of the vector kernels.
+  template <typename Unit, bool kToUpper>
+  void ChangeCaseScalar(const Unit* src, size_t length, Unit* dest) {
+    for (size_t i = 0; i < length; ++i) {
+      const auto unit = static_cast<uint32_t>(src[i]);
+      dest[i] = static_cast<Unit>(
+        unit - kFirst<kToUpper> < kLetters ? unit ^ kCaseBit : unit);
+    }
+  }
+
+  // Also finds the mismatch inside the vector that stopped a vector kernel.
+  template <typename LhsUnit, typename RhsUnit>
+  auto MismatchScalar(const LhsUnit* lhs, const RhsUnit* rhs, size_t length)
+    -> size_t {
+    size_t i = 0;
+    for (; i < length; ++i) {
+      const auto lhs_unit = static_cast<uint32_t>(lhs[i]);
+      const uint32_t diff = lhs_unit ^ static_cast<uint32_t>(rhs[i]);
+      const bool is_letter =
+        (lhs_unit | kCaseBit) - kFirst</*kToUpper=*/true> < kLetters;
+      if ((diff & ~(is_letter ? kCaseBit : 0U)) != 0) {
+        break;
+      }
+    }
+    return i;
+  }
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+  // |value| in every |Unit| lane.
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto SplatSSE42(uint32_t value) -> __m128i {
+    if constexpr (sizeof(Unit) == 1) {
+      return _mm_set1_epi8(static_cast<char>(value));
+    }
+    else if constexpr (sizeof(Unit) == 2) {
+      return _mm_set1_epi16(static_cast<int16_t>(value));
+    }
+    else {
+      return _mm_set1_epi32(static_cast<int32_t>(value));
+    }
+  }
+
+  // kCaseBit in the lanes of the letters to change, zero elsewhere. There is
+  // no unsigned comparison before AVX-512, but x == min(x, 25) is x < 26.
+  template <typename Unit, bool kToUpper>
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto CaseBitsSSE42(__m128i units) -> __m128i {
+    const __m128i first = SplatSSE42<Unit>(kFirst<kToUpper>);
+    const __m128i last = SplatSSE42<Unit>(kLetters - 1);
+    __m128i in_range;
+    if constexpr (sizeof(Unit) == 1) {
+      const __m128i offset = _mm_sub_epi8(units, first);
+      in_range = _mm_cmpeq_epi8(_mm_min_epu8(offset, last), offset);
+    }
+    else if constexpr (sizeof(Unit) == 2) {
+      const __m128i offset = _mm_sub_epi16(units, first);
+      in_range = _mm_cmpeq_epi16(_mm_min_epu16(offset, last), offset);
+    }
+    else {
+      const __m128i offset = _mm_sub_epi32(units, first);
+      in_range = _mm_cmpeq_epi32(_mm_min_epu32(offset, last), offset);
+    }
+    return _mm_and_si128(in_range, SplatSSE42<Unit>(kCaseBit));
+  }
+
+  template <typename Unit, bool kToUpper>
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  void ChangeCaseSSE42(const Unit* src, size_t length, Unit* dest) {
+    constexpr size_t kUnitsPerVector = 16 / sizeof(Unit);
+    size_t i = 0;
+    for (; i + kUnitsPerVector <= length; i += kUnitsPerVector) {
+      const __m128i units = LoadUnaligned<__m128i>(src + i);
+      StoreUnaligned(
+        dest + i,
+        _mm_xor_si128(units, CaseBitsSSE42<Unit, kToUpper>(units)));
+    }
+    ChangeCaseScalar<Unit, kToUpper>(src + i, length - i, dest + i);
+  }
+
+  // One vector of |Wide| code units, zero-extended from the |Narrow| ones at
+  // |src|.
+  template <typename Narrow, typename Wide>
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto LoadWidenedSSE42(const Narrow* src) -> __m128i {
+    if constexpr (sizeof(Narrow) == sizeof(Wide)) {
+      return LoadUnaligned<__m128i>(src);
+    }
+    else if constexpr (sizeof(Narrow) == 1 && sizeof(Wide) == 2) {
+      return _mm_cvtepu8_epi16(LoadUnalignedLow64(src));
+    }
+    else if constexpr (sizeof(Narrow) == 1) {
+      int32_t bytes = 0;
+      std::memcpy(&bytes, src, sizeof(bytes));
+      return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(bytes));
+    }
+    else {
+      return _mm_cvtepu16_epi32(LoadUnalignedLow64(src));
+    }
+  }
+
+  template <typename LhsUnit, typename RhsUnit>
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto MismatchSSE42(const LhsUnit* lhs, const RhsUnit* rhs, size_t length)
+    -> size_t {
+    constexpr size_t kUnitsPerVector = 16 / sizeof(RhsUnit);
+    const __m128i case_bit = SplatSSE42<RhsUnit>(kCaseBit);
+    size_t i = 0;
+    for (; i + kUnitsPerVector <= length; i += kUnitsPerVector) {
+      const __m128i lhs_units = LoadWidenedSSE42<LhsUnit, RhsUnit>(lhs + i);
+      const __m128i diff =
+        _mm_xor_si128(lhs_units, LoadUnaligned<__m128i>(rhs + i));
+      const __m128i letters = CaseBitsSSE42<RhsUnit, /*kToUpper=*/true>(
+        _mm_or_si128(lhs_units, case_bit));
+      const __m128i mismatch = _mm_andnot_si128(letters, diff);
+      if (!_mm_testz_si128(mismatch, mismatch)) {
+        break;
+      }
+    }
+    return i + MismatchScalar(lhs + i, rhs + i, length - i);
+  }
+
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  LONGLP_ALWAYS_INLINE auto SplatAVX2(uint32_t value) -> __m256i {
+    if constexpr (sizeof(Unit) == 1) {
+      return _mm256_set1_epi8(static_cast<char>(value));
+    }
+    else if constexpr (sizeof(Unit) == 2) {
+      return _mm256_set1_epi16(static_cast<int16_t>(value));
+    }
+    else {
+      return _mm256_set1_epi32(static_cast<int32_t>(value));
+    }
+  }
+
+  template <typename Unit, bool kToUpper>
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  LONGLP_ALWAYS_INLINE auto CaseBitsAVX2(__m256i units) -> __m256i {
+    const __m256i first = SplatAVX2<Unit>(kFirst<kToUpper>);
+    const __m256i last = SplatAVX2<Unit>(kLetters - 1);
+    __m256i in_range;
+    if constexpr (sizeof(Unit) == 1) {
+      const __m256i offset = _mm256_sub_epi8(units, first);
+      in_range = _mm256_cmpeq_epi8(_mm256_min_epu8(offset, last), offset);
+    }
+    else if constexpr (sizeof(Unit) == 2) {
+      const __m256i offset = _mm256_sub_epi16(units, first);
+      in_range = _mm256_cmpeq_epi16(_mm256_min_epu16(offset, last), offset);
+    }
+    else {
+      const __m256i offset = _mm256_sub_epi32(units, first);
+      in_range = _mm256_cmpeq_epi32(_mm256_min_epu32(offset, last), offset);
+    }
+    return _mm256_and_si256(in_range, SplatAVX2<Unit>(kCaseBit));
+  }
+
+  template <typename Unit, bool kToUpper>
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  LONGLP_ALWAYS_INLINE auto ChangeCaseAVX2(__m256i units) -> __m256i {
+    return _mm256_xor_si256(units, CaseBitsAVX2<Unit, kToUpper>(units));
+  }
+
+  template <typename Unit, bool kToUpper>
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  void ChangeCaseAVX2(const Unit* src, size_t length, Unit* dest) {
+    constexpr size_t kUnitsPerVector = 32 / sizeof(Unit);
+    size_t i = 0;
+    // Two independent vectors per iteration keep both ports busy.
+    for (; i + 2 * kUnitsPerVector <= length; i += 2 * kUnitsPerVector) {
+      const __m256i first = LoadUnaligned<__m256i>(src + i);
+      const __m256i second = LoadUnaligned<__m256i>(src + i + kUnitsPerVector);
+      StoreUnaligned(dest + i, ChangeCaseAVX2<Unit, kToUpper>(first));
+      StoreUnaligned(
+        dest + i + kUnitsPerVector,
+        ChangeCaseAVX2<Unit, kToUpper>(second));
+    }
+    if (i + kUnitsPerVector <= length) {
+      StoreUnaligned(
+        dest + i,
+        ChangeCaseAVX2<Unit, kToUpper>(LoadUnaligned<__m256i>(src + i)));
+      i += kUnitsPerVector;
+    }
+    ChangeCaseSSE42<Unit, kToUpper>(src + i, length - i, dest + i);
+  }
+
+  template <typename Narrow, typename Wide>
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  LONGLP_ALWAYS_INLINE auto LoadWidenedAVX2(const Narrow* src) -> __m256i {
+    if constexpr (sizeof(Narrow) == sizeof(Wide)) {
+      return LoadUnaligned<__m256i>(src);
+    }
+    else if constexpr (sizeof(Narrow) == 1 && sizeof(Wide) == 2) {
+      return _mm256_cvtepu8_epi16(LoadUnaligned<__m128i>(src));
+    }
+    else if constexpr (sizeof(Narrow) == 1) {
+      return _mm256_cvtepu8_epi32(LoadUnalignedLow64(src));
+    }
+    else {
+      return _mm256_cvtepu16_epi32(LoadUnaligned<__m128i>(src));
+    }
+  }
+
+  template <typename LhsUnit, typename RhsUnit>
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto MismatchAVX2(const LhsUnit* lhs, const RhsUnit* rhs, size_t length)
+    -> size_t {
+    constexpr size_t kUnitsPerVector = 32 / sizeof(RhsUnit);
+    const __m256i case_bit = SplatAVX2<RhsUnit>(kCaseBit);
+    size_t i = 0;
+    for (; i + kUnitsPerVector <= length; i += kUnitsPerVector) {
+      const __m256i lhs_units = LoadWidenedAVX2<LhsUnit, RhsUnit>(lhs + i);
+      const __m256i diff =
+        _mm256_xor_si256(lhs_units, LoadUnaligned<__m256i>(rhs + i));
+      const __m256i letters = CaseBitsAVX2<RhsUnit, /*kToUpper=*/true>(
+        _mm256_or_si256(lhs_units, case_bit));
+      const __m256i mismatch = _mm256_andnot_si256(letters, diff);
+      if (!_mm256_testz_si256(mismatch, mismatch)) {
+        return i + MismatchScalar(lhs + i, rhs + i, kUnitsPerVector);
+      }
+    }
+    return i + MismatchSSE42(lhs + i, rhs + i, length - i);
+  }
+
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  LONGLP_ALWAYS_INLINE auto SplatAVX512(uint32_t value) -> __m512i {
+    if constexpr (sizeof(Unit) == 1) {
+      return _mm512_set1_epi8(static_cast<char>(value));
+    }
+    else if constexpr (sizeof(Unit) == 2) {
+      return _mm512_set1_epi16(static_cast<int16_t>(value));
+    }
+    else {
+      return _mm512_set1_epi32(static_cast<int32_t>(value));
+    }
+  }
+
+  template <typename Unit, bool kToUpper>
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  LONGLP_ALWAYS_INLINE auto CaseBitsAVX512(__m512i units) -> __m512i {
+    const __m512i first = SplatAVX512<Unit>(kFirst<kToUpper>);
+    const __m512i letters = SplatAVX512<Unit>(kLetters);
+    const __m512i case_bit = SplatAVX512<Unit>(kCaseBit);
+    if constexpr (sizeof(Unit) == 1) {
+      return _mm512_maskz_mov_epi8(
+        _mm512_cmplt_epu8_mask(_mm512_sub_epi8(units, first), letters),
+        case_bit);
+    }
+    else if constexpr (sizeof(Unit) == 2) {
+      return _mm512_maskz_mov_epi16(
+        _mm512_cmplt_epu16_mask(_mm512_sub_epi16(units, first), letters),
+        case_bit);
+    }
+    else {
+      return _mm512_maskz_mov_epi32(
+        _mm512_cmplt_epu32_mask(_mm512_sub_epi32(units, first), letters),
+        case_bit);
+    }
+  }
+
+  template <typename Unit, bool kToUpper>
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  void ChangeCaseAVX512(const Unit* src, size_t length, Unit* dest) {
+    constexpr size_t kUnitsPerVector = 64 / sizeof(Unit);
+    size_t i = 0;
+    for (; i + kUnitsPerVector <= length; i += kUnitsPerVector) {
+      const __m512i units = LoadUnaligned<__m512i>(src + i);
+      StoreUnaligned(
+        dest + i,
+        _mm512_xor_si512(units, CaseBitsAVX512<Unit, kToUpper>(units)));
+    }
+    ChangeCaseSSE42<Unit, kToUpper>(src + i, length - i, dest + i);
+  }
+
+  template <typename Narrow, typename Wide>
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  LONGLP_ALWAYS_INLINE auto LoadWidenedAVX512(const Narrow* src) -> __m512i {
+    if constexpr (sizeof(Narrow) == sizeof(Wide)) {
+      return LoadUnaligned<__m512i>(src);
+    }
+    else if constexpr (sizeof(Narrow) == 1 && sizeof(Wide) == 2) {
+      return _mm512_cvtepu8_epi16(LoadUnaligned<__m256i>(src));
+    }
+    else if constexpr (sizeof(Narrow) == 1) {
+      return _mm512_cvtepu8_epi32(LoadUnaligned<__m128i>(src));
+    }
+    else {
+      return _mm512_cvtepu16_epi32(LoadUnaligned<__m256i>(src));
+    }
+  }
+
+  template <typename LhsUnit, typename RhsUnit>
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  auto MismatchAVX512(const LhsUnit* lhs, const RhsUnit* rhs, size_t length)
+    -> size_t {
+    constexpr size_t kUnitsPerVector = 64 / sizeof(RhsUnit);
+    const __m512i case_bit = SplatAVX512<RhsUnit>(kCaseBit);
+    size_t i = 0;
+    for (; i + kUnitsPerVector <= length; i += kUnitsPerVector) {
+      const __m512i lhs_units = LoadWidenedAVX512<LhsUnit, RhsUnit>(lhs + i);
+      const __m512i diff =
+        _mm512_xor_si512(lhs_units, LoadUnaligned<__m512i>(rhs + i));
+      const __m512i letters = CaseBitsAVX512<RhsUnit, /*kToUpper=*/true>(
+        _mm512_or_si512(lhs_units, case_bit));
+      const __m512i mismatch = _mm512_andnot_si512(letters, diff);
+      if (_mm512_test_epi32_mask(mismatch, mismatch) != 0) {
+        return i + MismatchScalar(lhs + i, rhs + i, kUnitsPerVector);
+      }
+    }
+    return i + MismatchSSE42(lhs + i, rhs + i, length - i);
+  }
+#endif    // defined(LONGLP_ARCH_CPU_X86_FAMILY)
+
+#if defined(LONGLP_ARCH_CPU_ARM64)
+  // Bitwise operations do not care about the lane width, so the vectors are
+  // uint8x16_t everywhere and only reinterpreted for the arithmetic.
+  template <typename Unit>
+  LONGLP_ALWAYS_INLINE auto SplatNEON(uint32_t value) -> uint8x16_t {
+    if constexpr (sizeof(Unit) == 1) {
+      return vdupq_n_u8(static_cast<uint8_t>(value));
+    }
+    else if constexpr (sizeof(Unit) == 2) {
+      return vreinterpretq_u8_u16(vdupq_n_u16(static_cast<uint16_t>(value)));
+    }
+    else {
+      return vreinterpretq_u8_u32(vdupq_n_u32(value));
+    }
+  }
+
+  template <typename Unit, bool kToUpper>
+  LONGLP_ALWAYS_INLINE auto CaseBitsNEON(uint8x16_t units) -> uint8x16_t {
+    uint8x16_t in_range;
+    if constexpr (sizeof(Unit) == 1) {
+      in_range = vcltq_u8(
+        vsubq_u8(units, vdupq_n_u8(kFirst<kToUpper>)),
+        vdupq_n_u8(kLetters));
+    }
+    else if constexpr (sizeof(Unit) == 2) {
+      in_range = vreinterpretq_u8_u16(vcltq_u16(
+        vsubq_u16(vreinterpretq_u16_u8(units), vdupq_n_u16(kFirst<kToUpper>)),
+        vdupq_n_u16(kLetters)));
+    }
+    else {
+      in_range = vreinterpretq_u8_u32(vcltq_u32(
+        vsubq_u32(vreinterpretq_u32_u8(units), vdupq_n_u32(kFirst<kToUpper>)),
+        vdupq_n_u32(kLetters)));
+    }
+    return vandq_u8(in_range, SplatNEON<Unit>(kCaseBit));
+  }
+
+  template <typename Unit, bool kToUpper>
+  void ChangeCaseNEON(const Unit* src, size_t length, Unit* dest) {
+    constexpr size_t kUnitsPerVector = 16 / sizeof(Unit);
+    size_t i = 0;
+    for (; i + kUnitsPerVector <= length; i += kUnitsPerVector) {
+      const uint8x16_t units =
+        vld1q_u8(reinterpret_cast<const uint8_t*>(src + i));
+      vst1q_u8(
+        reinterpret_cast<uint8_t*>(dest + i),
+        veorq_u8(units, CaseBitsNEON<Unit, kToUpper>(units)));
+    }
+    ChangeCaseScalar<Unit, kToUpper>(src + i, length - i, dest + i);
+  }
+
+  template <typename Narrow, typename Wide>
+  LONGLP_ALWAYS_INLINE auto LoadWidenedNEON(const Narrow* src) -> uint8x16_t {
+    if constexpr (sizeof(Narrow) == sizeof(Wide)) {
+      return vld1q_u8(reinterpret_cast<const uint8_t*>(src));
+    }
+    else if constexpr (sizeof(Narrow) == 1 && sizeof(Wide) == 2) {
+      return vreinterpretq_u8_u16(
+        vmovl_u8(vld1_u8(reinterpret_cast<const uint8_t*>(src))));
+    }
+    else if constexpr (sizeof(Narrow) == 1) {
+      uint32_t bytes = 0;
+      std::memcpy(&bytes, src, sizeof(bytes));
+      return vreinterpretq_u8_u32(
+        vmovl_u16(vget_low_u16(vmovl_u8(vcreate_u8(bytes)))));
+    }
+    else {
+      return vreinterpretq_u8_u32(
+        vmovl_u16(vld1_u16(reinterpret_cast<const uint16_t*>(src))));
+    }
+  }
+
+  template <typename LhsUnit, typename RhsUnit>
+  auto MismatchNEON(const LhsUnit* lhs, const RhsUnit* rhs, size_t length)
+    -> size_t {
+    constexpr size_t kUnitsPerVector = 16 / sizeof(RhsUnit);
+    const uint8x16_t case_bit = SplatNEON<RhsUnit>(kCaseBit);
+    size_t i = 0;
+    for (; i + kUnitsPerVector <= length; i += kUnitsPerVector) {
+      const uint8x16_t lhs_units = LoadWidenedNEON<LhsUnit, RhsUnit>(lhs + i);
+      const uint8x16_t diff = veorq_u8(
+        lhs_units,
+        vld1q_u8(reinterpret_cast<const uint8_t*>(rhs + i)));
+      const uint8x16_t letters = CaseBitsNEON<RhsUnit, /*kToUpper=*/true>(
+        vorrq_u8(lhs_units, case_bit));
+      if (vmaxvq_u8(vbicq_u8(diff, letters)) != 0) {
+        break;
+      }
+    }
+    return i + MismatchScalar(lhs + i, rhs + i, length - i);
+  }
+#endif    // defined(LONGLP_ARCH_CPU_ARM64)
+
+  auto SelectKernels() -> Kernels {
+    [[maybe_unused]] const auto& cpu = CPU::GetInstanceNoAllocation();
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+    if (cpu.has_avx512bw()) {
+      return {
+        &ChangeCaseAVX512<CharUTF8, false>,
+        &ChangeCaseAVX512<CharUTF16, false>,
+        &ChangeCaseAVX512<CharUTF32, false>,
+        &ChangeCaseAVX512<CharUTF8, true>,
+        &ChangeCaseAVX512<CharUTF16, true>,
+        &ChangeCaseAVX512<CharUTF32, true>,
+        &MismatchAVX512<CharUTF8, CharUTF8>,
+        &MismatchAVX512<CharUTF16, CharUTF16>,
+        &MismatchAVX512<CharUTF32, CharUTF32>,
+        &MismatchAVX512<CharUTF8, CharUTF16>,
+        &MismatchAVX512<CharUTF8, CharUTF32>,
+        &MismatchAVX512<CharUTF16, CharUTF32>};
+    }
+    if (cpu.has_avx2()) {
+      return {
+        &ChangeCaseAVX2<CharUTF8, false>,
+        &ChangeCaseAVX2<CharUTF16, false>,
+        &ChangeCaseAVX2<CharUTF32, false>,
+        &ChangeCaseAVX2<CharUTF8, true>,
+        &ChangeCaseAVX2<CharUTF16, true>,
+        &ChangeCaseAVX2<CharUTF32, true>,
+        &MismatchAVX2<CharUTF8, CharUTF8>,
+        &MismatchAVX2<CharUTF16, CharUTF16>,
+        &MismatchAVX2<CharUTF32, CharUTF32>,
+        &MismatchAVX2<CharUTF8, CharUTF16>,
+        &MismatchAVX2<CharUTF8, CharUTF32>,
+        &MismatchAVX2<CharUTF16, CharUTF32>};
+    }
+    if (cpu.has_sse42()) {
+      return {
+        &ChangeCaseSSE42<CharUTF8, false>,
+        &ChangeCaseSSE42<CharUTF16, false>,
+        &ChangeCaseSSE42<CharUTF32, false>,
+        &ChangeCaseSSE42<CharUTF8, true>,
+        &ChangeCaseSSE42<CharUTF16, true>,
+        &ChangeCaseSSE42<CharUTF32, true>,
+        &MismatchSSE42<CharUTF8, CharUTF8>,
+        &MismatchSSE42<CharUTF16, CharUTF16>,
+        &MismatchSSE42<CharUTF32, CharUTF32>,
+        &MismatchSSE42<CharUTF8, CharUTF16>,
+        &MismatchSSE42<CharUTF8, CharUTF32>,
+        &MismatchSSE42<CharUTF16, CharUTF32>};
+    }
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+    if (cpu.has_neon()) {
+      return {
+        &ChangeCaseNEON<CharUTF8, false>,
+        &ChangeCaseNEON<CharUTF16, false>,
+        &ChangeCaseNEON<CharUTF32, false>,
+        &ChangeCaseNEON<CharUTF8, true>,
+        &ChangeCaseNEON<CharUTF16, true>,
+        &ChangeCaseNEON<CharUTF32, true>,
+        &MismatchNEON<CharUTF8, CharUTF8>,
+        &MismatchNEON<CharUTF16, CharUTF16>,
+        &MismatchNEON<CharUTF32, CharUTF32>,
+        &MismatchNEON<CharUTF8, CharUTF16>,
+        &MismatchNEON<CharUTF8, CharUTF32>,
+        &MismatchNEON<CharUTF16, CharUTF32>};
+    }
+#endif
+    return {
+      &ChangeCaseScalar<CharUTF8, false>,
+      &ChangeCaseScalar<CharUTF16, false>,
+      &ChangeCaseScalar<CharUTF32, false>,
+      &ChangeCaseScalar<CharUTF8, true>,
+      &ChangeCaseScalar<CharUTF16, true>,
+      &ChangeCaseScalar<CharUTF32, true>,
+      &MismatchScalar<CharUTF8, CharUTF8>,
+      &MismatchScalar<CharUTF16, CharUTF16>,
+      &MismatchScalar<CharUTF32, CharUTF32>,
+      &MismatchScalar<CharUTF8, CharUTF16>,
+      &MismatchScalar<CharUTF8, CharUTF32>,
+      &MismatchScalar<CharUTF16, CharUTF32>};
+  }
+
+  auto GetKernels() -> const Kernels& {
+    static const Kernels kKernels = SelectKernels();
+    return kKernels;
+  }
+}    // namespace
+
+void ToLowerASCII(const CharUTF8* src, size_t src_length, CharUTF8* dest) {
+  GetKernels().utf8_lower(src, src_length, dest);
+}
+
+void ToLowerASCII(const CharUTF16* src, size_t src_length, CharUTF16* dest) {
+  GetKernels().utf16_lower(src, src_length, dest);
+}
+
+void ToLowerASCII(const CharUTF32* src, size_t src_length, CharUTF32* dest) {
+  GetKernels().utf32_lower(src, src_length, dest);
+}
+
+void ToUpperASCII(const CharUTF8* src, size_t src_length, CharUTF8* dest) {
+  GetKernels().utf8_upper(src, src_length, dest);
+}
+
+void ToUpperASCII(const CharUTF16* src, size_t src_length, CharUTF16* dest) {
+  GetKernels().utf16_upper(src, src_length, dest);
+}
+
+void ToUpperASCII(const CharUTF32* src, size_t src_length, CharUTF32* dest) {
+  GetKernels().utf32_upper(src, src_length, dest);
+}
+
+auto CaseInsensitiveMismatchASCII(
+  const CharUTF8* lhs,
+  const CharUTF8* rhs,
+  size_t length) -> size_t {
+  return GetKernels().utf8_utf8_mismatch(lhs, rhs, length);
+}
+
+auto CaseInsensitiveMismatchASCII(
+  const CharUTF16* lhs,
+  const CharUTF16* rhs,
+  size_t length) -> size_t {
+  return GetKernels().utf16_utf16_mismatch(lhs, rhs, length);
+}
+
+auto CaseInsensitiveMismatchASCII(
+  const CharUTF32* lhs,
+  const CharUTF32* rhs,
+  size_t length) -> size_t {
+  return GetKernels().utf32_utf32_mismatch(lhs, rhs, length);
+}
+
+auto CaseInsensitiveMismatchASCII(
+  const CharUTF8* lhs,
+  const CharUTF16* rhs,
+  size_t length) -> size_t {
+  return GetKernels().utf8_utf16_mismatch(lhs, rhs, length);
+}
+
+auto CaseInsensitiveMismatchASCII(
+  const CharUTF8* lhs,
+  const CharUTF32* rhs,
+  size_t length) -> size_t {
+  return GetKernels().utf8_utf32_mismatch(lhs, rhs, length);
+}
+
+auto CaseInsensitiveMismatchASCII(
+  const CharUTF16* lhs,
+  const CharUTF32* rhs,
+  size_t length) -> size_t {
+  return GetKernels().utf16_utf32_mismatch(lhs, rhs, length);
+}
+
+// NOLINTEND(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}    // namespace longlp::base::internal::simd
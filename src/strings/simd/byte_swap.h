@@ -0,0 +1,133 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+// Loads of UTF-16 and UTF-32 code units stored either in the host byte order
+// or in the opposite one, "swapped", e.g. UTF-16BE on a little-endian host.
+// The kernels take |kSwapped| as a template parameter, so the swap is one
+// shuffle per load and the host byte order pays nothing.
+
+#ifndef LONGLP_SRC_STRINGS_SIMD_BYTE_SWAP_H_
+#define LONGLP_SRC_STRINGS_SIMD_BYTE_SWAP_H_
+
+#include <cstdint>
+
+#include "base/compiler_specific.h"
+#include "base/predef.h"
+#include "base/strings/typedefs.h"
+#include "strings/simd/load_store.h"
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+#  include <immintrin.h>
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+#  include <arm_neon.h>
+#endif
+
+namespace longlp::base::internal::simd {
+// NOLINTBEGIN(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+constexpr auto ByteSwap(CharUTF16 unit) -> CharUTF16 {
+  return static_cast<CharUTF16>((unit >> 8U) | (unit << 8U));
+}
+
+constexpr auto ByteSwap(CharUTF32 unit) -> CharUTF32 {
+  return ((unit >> 24U) & 0xFFU) | ((unit >> 8U) & 0xFF00U) |
+         ((unit << 8U) & 0xFF0000U) | (unit << 24U);
+}
+
+// Reads the code unit at |src| in the host byte order.
+template <bool kSwapped, CharTraits Char>
+LONGLP_ALWAYS_INLINE constexpr auto LoadUnit(const Char* src) -> Char {
+  if constexpr (kSwapped) {
+    return ByteSwap(*src);
+  }
+  else {
+    return *src;
+  }
+}
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+// pshufb control reversing every |sizeof(Char)| bytes of a 128-bit lane.
+template <CharTraits Char>
+LONGLP_TARGET_ATTRIBUTE("sse4.2")
+LONGLP_ALWAYS_INLINE auto ByteSwapShuffleSSE42() -> __m128i {
+  if constexpr (sizeof(Char) == 2) {
+    return _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+  }
+  else {
+    return _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  }
+}
+
+template <bool kSwapped, CharTraits Char>
+LONGLP_TARGET_ATTRIBUTE("sse4.2")
+LONGLP_ALWAYS_INLINE auto LoadSSE42(const Char* src) -> __m128i {
+  const __m128i units = LoadUnaligned<__m128i>(src);
+  if constexpr (kSwapped) {
+    return _mm_shuffle_epi8(units, ByteSwapShuffleSSE42<Char>());
+  }
+  else {
+    return units;
+  }
+}
+
+template <bool kSwapped, CharTraits Char>
+LONGLP_TARGET_ATTRIBUTE("avx2")
+LONGLP_ALWAYS_INLINE auto LoadAVX2(const Char* src) -> __m256i {
+  const __m256i units = LoadUnaligned<__m256i>(src);
+  if constexpr (kSwapped) {
+    // vpshufb shuffles within 128-bit lanes, which is all a swap needs.
+    return _mm256_shuffle_epi8(
+      units,
+      _mm256_broadcastsi128_si256(ByteSwapShuffleSSE42<Char>()));
+  }
+  else {
+    return units;
+  }
+}
+
+template <bool kSwapped, CharTraits Char>
+LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+LONGLP_ALWAYS_INLINE auto LoadAVX512(const Char* src) -> __m512i {
+  const __m512i units = LoadUnaligned<__m512i>(src);
+  if constexpr (kSwapped) {
+    return _mm512_shuffle_epi8(
+      units,
+      _mm512_broadcast_i32x4(ByteSwapShuffleSSE42<Char>()));
+  }
+  else {
+    return units;
+  }
+}
+#endif    // defined(LONGLP_ARCH_CPU_X86_FAMILY)
+
+#if defined(LONGLP_ARCH_CPU_ARM64)
+template <bool kSwapped>
+LONGLP_ALWAYS_INLINE auto LoadNEON(const CharUTF16* src) -> uint16x8_t {
+  const uint16x8_t units = vld1q_u16(reinterpret_cast<const uint16_t*>(src));
+  if constexpr (kSwapped) {
+    return vreinterpretq_u16_u8(vrev16q_u8(vreinterpretq_u8_u16(units)));
+  }
+  else {
+    return units;
+  }
+}
+
+template <bool kSwapped>
+LONGLP_ALWAYS_INLINE auto LoadNEON(const CharUTF32* src) -> uint32x4_t {
+  const uint32x4_t units = vld1q_u32(reinterpret_cast<const uint32_t*>(src));
+  if constexpr (kSwapped) {
+    return vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(units)));
+  }
+  else {
+    return units;
+  }
+}
+#endif    // defined(LONGLP_ARCH_CPU_ARM64)
+
+// NOLINTEND(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}    // namespace longlp::base::internal::simd
+
+#endif    // LONGLP_SRC_STRINGS_SIMD_BYTE_SWAP_H_
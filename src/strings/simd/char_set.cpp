@@ -0,0 +1,570 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <bit>
+#include <cstdint>
+
+#include "base/compiler_specific.h"
+#include "base/cpu.h"
+#include "base/predef.h"
+#include "strings/simd/load_store.h"
+#include "strings/simd/utf_kernels.h"
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+#  include <immintrin.h>
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+#  include <arm_neon.h>
+#endif
+
+namespace longlp::base::internal::simd {
+// NOLINTBEGIN(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+namespace {
+  // The x86 kernels classify bytes with two pshufb lookups, as in Langdale and
+  // Lemire's "Parsing Gigabytes of JSON per Second": the low nibble of a byte
+  // picks a row of the nibble table, in which bit (byte >> 4) & 7 tells the
+  // membership. pshufb zeroes the lanes whose index has bit 7 set, so the
+  // table of bytes below 0x80 and the one of the others are looked up with
+  // the byte and with the byte XOR 0x80, and ORed. NEON has a 32-byte table
+  // lookup and uses the bitmap directly.
+  //
+  // Wider code units are narrowed with unsigned saturation, so the code units
+  // above 0xFF become 0xFF, whose lane is then overridden from a comparison
+  // of the code units themselves.
+  constexpr uint32_t kLastByte = 0xFF;
+
+  template <typename Unit>
+  using Kernel =
+    auto (*)(const Unit*, size_t, const ByteSet&, bool, bool) -> size_t;
+
+  struct Kernels {
+    Kernel<CharUTF8> utf8;
+    Kernel<CharUTF16> utf16;
+    Kernel<CharUTF32> utf32;
+  };
+
+  auto IsMember(const ByteSet& set, uint32_t byte) -> bool {
+    return ((set.bitmap[byte >> 3] >> (byte & 7)) & 1) != 0;
+  }
+
+  // Also the tail of the vector kernels.
+  template <typename Unit>
+  auto FindScalar(
+    const Unit* src,
+    size_t length,
+    const ByteSet& set,
+    bool negate,
+    bool stop_at_wide) -> size_t {
+    for (size_t i = 0; i < length; ++i) {
+      const auto unit = static_cast<uint32_t>(src[i]);
+      if (unit > kLastByte ? stop_at_wide : IsMember(set, unit) != negate) {
+        return i;
+      }
+    }
+    return length;
+  }
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+  // 1 << (i & 7) in byte i: the bit of the membership in the nibble table
+  // rows, indexed by the high nibble of a byte.
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto HighNibbleBitsSSE42() -> __m128i {
+    return _mm_setr_epi8(
+      1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+  }
+
+  // 0xFF in the lanes of the bytes of the set, zero elsewhere.
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto InSetSSE42(__m128i bytes, __m128i low, __m128i high)
+    -> __m128i {
+    const __m128i row = _mm_or_si128(
+      _mm_shuffle_epi8(low, bytes),
+      _mm_shuffle_epi8(high, _mm_xor_si128(bytes, _mm_set1_epi8(-128))));
+    const __m128i bit = _mm_shuffle_epi8(
+      HighNibbleBitsSSE42(),
+      _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0F)));
+    return _mm_cmpeq_epi8(_mm_and_si128(row, bit), bit);
+  }
+
+  // The 16 code units at |src|, as saturated bytes.
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto LoadBytesSSE42(const Unit* src) -> __m128i {
+    constexpr size_t kUnitsPerVector = 16 / sizeof(Unit);
+    if constexpr (sizeof(Unit) == 1) {
+      return LoadUnaligned<__m128i>(src);
+    }
+    else if constexpr (sizeof(Unit) == 2) {
+      // packus saturates signed values, which the code units above 0x7FFF are
+      // not.
+      const __m128i max = _mm_set1_epi16(static_cast<int16_t>(kLastByte));
+      return _mm_packus_epi16(
+        _mm_min_epu16(LoadUnaligned<__m128i>(src), max),
+        _mm_min_epu16(LoadUnaligned<__m128i>(src + kUnitsPerVector), max));
+    }
+    else {
+      const __m128i max = _mm_set1_epi32(static_cast<int32_t>(kLastByte));
+      return _mm_packus_epi16(
+        _mm_packus_epi32(
+          _mm_min_epu32(LoadUnaligned<__m128i>(src), max),
+          _mm_min_epu32(LoadUnaligned<__m128i>(src + kUnitsPerVector), max)),
+        _mm_packus_epi32(
+          _mm_min_epu32(LoadUnaligned<__m128i>(src + 2 * kUnitsPerVector), max),
+          _mm_min_epu32(
+            LoadUnaligned<__m128i>(src + 3 * kUnitsPerVector),
+            max)));
+    }
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto NarrowLanes32SSE42(__m128i units) -> __m128i {
+    const __m128i max = _mm_set1_epi32(static_cast<int32_t>(kLastByte));
+    return _mm_cmpeq_epi32(_mm_min_epu32(units, max), units);
+  }
+
+  // 0xFF in the lanes of the 16 code units at |src| that are below 0x100.
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto NarrowLanesSSE42(const Unit* src) -> __m128i {
+    constexpr size_t kUnitsPerVector = 16 / sizeof(Unit);
+    if constexpr (sizeof(Unit) == 2) {
+      const __m128i max = _mm_set1_epi16(static_cast<int16_t>(kLastByte));
+      const __m128i first = LoadUnaligned<__m128i>(src);
+      const __m128i second = LoadUnaligned<__m128i>(src + kUnitsPerVector);
+      return _mm_packs_epi16(
+        _mm_cmpeq_epi16(_mm_min_epu16(first, max), first),
+        _mm_cmpeq_epi16(_mm_min_epu16(second, max), second));
+    }
+    else {
+      static_assert(sizeof(Unit) == 4);
+      return _mm_packs_epi16(
+        _mm_packs_epi32(
+          NarrowLanes32SSE42(LoadUnaligned<__m128i>(src)),
+          NarrowLanes32SSE42(LoadUnaligned<__m128i>(src + kUnitsPerVector))),
+        _mm_packs_epi32(
+          NarrowLanes32SSE42(LoadUnaligned<__m128i>(src + 2 * kUnitsPerVector)),
+          NarrowLanes32SSE42(
+            LoadUnaligned<__m128i>(src + 3 * kUnitsPerVector))));
+    }
+  }
+
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto FindSSE42(
+    const Unit* src,
+    size_t length,
+    const ByteSet& set,
+    bool negate,
+    bool stop_at_wide) -> size_t {
+    constexpr size_t kUnitsPerBlock = 16;
+    const __m128i low = LoadUnaligned<__m128i>(set.nibbles);
+    const __m128i high = LoadUnaligned<__m128i>(set.nibbles + 16);
+    const __m128i flip = _mm_set1_epi8(negate ? -1 : 0);
+    const __m128i wide = _mm_set1_epi8(stop_at_wide ? -1 : 0);
+    size_t i = 0;
+    for (; i + kUnitsPerBlock <= length; i += kUnitsPerBlock) {
+      __m128i found =
+        _mm_xor_si128(InSetSSE42(LoadBytesSSE42(src + i), low, high), flip);
+      if constexpr (sizeof(Unit) > 1) {
+        found = _mm_blendv_epi8(wide, found, NarrowLanesSSE42(src + i));
+      }
+      const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(found));
+      if (mask != 0) {
+        return i + static_cast<size_t>(std::countr_zero(mask));
+      }
+    }
+    return i + FindScalar(src + i, length - i, set, negate, stop_at_wide);
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  LONGLP_ALWAYS_INLINE auto InSetAVX2(__m256i bytes, __m256i low, __m256i high)
+    -> __m256i {
+    const __m256i row = _mm256_or_si256(
+      _mm256_shuffle_epi8(low, bytes),
+      _mm256_shuffle_epi8(
+        high,
+        _mm256_xor_si256(bytes, _mm256_set1_epi8(-128))));
+    const __m256i bit = _mm256_shuffle_epi8(
+      _mm256_broadcastsi128_si256(HighNibbleBitsSSE42()),
+      _mm256_and_si256(_mm256_srli_epi16(bytes, 4), _mm256_set1_epi8(0x0F)));
+    return _mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit);
+  }
+
+  // The packs work within 128-bit lanes; these put the 32 bytes back in the
+  // order of the code units.
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  LONGLP_ALWAYS_INLINE auto Packed16OrderAVX2(__m256i bytes) -> __m256i {
+    return _mm256_permute4x64_epi64(bytes, 0xD8);
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  LONGLP_ALWAYS_INLINE auto Packed32OrderAVX2(__m256i bytes) -> __m256i {
+    return _mm256_permutevar8x32_epi32(
+      bytes,
+      _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+  }
+
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  LONGLP_ALWAYS_INLINE auto LoadBytesAVX2(const Unit* src) -> __m256i {
+    constexpr size_t kUnitsPerVector = 32 / sizeof(Unit);
+    if constexpr (sizeof(Unit) == 1) {
+      return LoadUnaligned<__m256i>(src);
+    }
+    else if constexpr (sizeof(Unit) == 2) {
+      const __m256i max = _mm256_set1_epi16(static_cast<int16_t>(kLastByte));
+      return Packed16OrderAVX2(_mm256_packus_epi16(
+        _mm256_min_epu16(LoadUnaligned<__m256i>(src), max),
+        _mm256_min_epu16(LoadUnaligned<__m256i>(src + kUnitsPerVector), max)));
+    }
+    else {
+      const __m256i max =
+        _mm256_set1_epi32(static_cast<int32_t>(kLastByte));
+      return Packed32OrderAVX2(_mm256_packus_epi16(
+        _mm256_packus_epi32(
+          _mm256_min_epu32(LoadUnaligned<__m256i>(src), max),
+          _mm256_min_epu32(LoadUnaligned<__m256i>(src + kUnitsPerVector), max)),
+        _mm256_packus_epi32(
+          _mm256_min_epu32(
+            LoadUnaligned<__m256i>(src + 2 * kUnitsPerVector),
+            max),
+          _mm256_min_epu32(
+            LoadUnaligned<__m256i>(src + 3 * kUnitsPerVector),
+            max))));
+    }
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  LONGLP_ALWAYS_INLINE auto NarrowLanes32AVX2(__m256i units) -> __m256i {
+    const __m256i max = _mm256_set1_epi32(static_cast<int32_t>(kLastByte));
+    return _mm256_cmpeq_epi32(_mm256_min_epu32(units, max), units);
+  }
+
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  LONGLP_ALWAYS_INLINE auto NarrowLanesAVX2(const Unit* src) -> __m256i {
+    constexpr size_t kUnitsPerVector = 32 / sizeof(Unit);
+    if constexpr (sizeof(Unit) == 2) {
+      const __m256i max = _mm256_set1_epi16(static_cast<int16_t>(kLastByte));
+      const __m256i first = LoadUnaligned<__m256i>(src);
+      const __m256i second = LoadUnaligned<__m256i>(src + kUnitsPerVector);
+      return Packed16OrderAVX2(_mm256_packs_epi16(
+        _mm256_cmpeq_epi16(_mm256_min_epu16(first, max), first),
+        _mm256_cmpeq_epi16(_mm256_min_epu16(second, max), second)));
+    }
+    else {
+      static_assert(sizeof(Unit) == 4);
+      return Packed32OrderAVX2(_mm256_packs_epi16(
+        _mm256_packs_epi32(
+          NarrowLanes32AVX2(LoadUnaligned<__m256i>(src)),
+          NarrowLanes32AVX2(LoadUnaligned<__m256i>(src + kUnitsPerVector))),
+        _mm256_packs_epi32(
+          NarrowLanes32AVX2(LoadUnaligned<__m256i>(src + 2 * kUnitsPerVector)),
+          NarrowLanes32AVX2(
+            LoadUnaligned<__m256i>(src + 3 * kUnitsPerVector)))));
+    }
+  }
+
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto FindAVX2(
+    const Unit* src,
+    size_t length,
+    const ByteSet& set,
+    bool negate,
+    bool stop_at_wide) -> size_t {
+    constexpr size_t kUnitsPerBlock = 32;
+    const __m256i low =
+      _mm256_broadcastsi128_si256(LoadUnaligned<__m128i>(set.nibbles));
+    const __m256i high =
+      _mm256_broadcastsi128_si256(LoadUnaligned<__m128i>(set.nibbles + 16));
+    const __m256i flip = _mm256_set1_epi8(negate ? -1 : 0);
+    const __m256i wide = _mm256_set1_epi8(stop_at_wide ? -1 : 0);
+    size_t i = 0;
+    for (; i + kUnitsPerBlock <= length; i += kUnitsPerBlock) {
+      __m256i found =
+        _mm256_xor_si256(InSetAVX2(LoadBytesAVX2(src + i), low, high), flip);
+      if constexpr (sizeof(Unit) > 1) {
+        found = _mm256_blendv_epi8(wide, found, NarrowLanesAVX2(src + i));
+      }
+      const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(found));
+      if (mask != 0) {
+        return i + static_cast<size_t>(std::countr_zero(mask));
+      }
+    }
+    return i + FindScalar(src + i, length - i, set, negate, stop_at_wide);
+  }
+
+  // AVX-512 narrows in order with the saturating vpmovus* instructions, and
+  // compares straight into mask registers.
+
+  // The zero-masked form, as GCC warns about the undefined source operand of
+  // the plain one.
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  LONGLP_ALWAYS_INLINE auto BroadcastAVX512(__m128i block) -> __m512i {
+    return _mm512_maskz_broadcast_i32x4(0xFFFF, block);
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  LONGLP_ALWAYS_INLINE auto InSetAVX512(
+    __m512i bytes,
+    __m512i low,
+    __m512i high) -> uint64_t {
+    const __m512i row = _mm512_or_si512(
+      _mm512_shuffle_epi8(low, bytes),
+      _mm512_shuffle_epi8(
+        high,
+        _mm512_xor_si512(bytes, _mm512_set1_epi8(-128))));
+    const __m512i bit = _mm512_shuffle_epi8(
+      BroadcastAVX512(HighNibbleBitsSSE42()),
+      _mm512_and_si512(_mm512_srli_epi16(bytes, 4), _mm512_set1_epi8(0x0F)));
+    return _mm512_test_epi8_mask(row, bit);
+  }
+
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  LONGLP_ALWAYS_INLINE auto LoadBytesAVX512(const Unit* src) -> __m512i {
+    constexpr size_t kUnitsPerVector = 64 / sizeof(Unit);
+    if constexpr (sizeof(Unit) == 1) {
+      return LoadUnaligned<__m512i>(src);
+    }
+    else if constexpr (sizeof(Unit) == 2) {
+      return _mm512_inserti64x4(
+        _mm512_castsi256_si512(
+          _mm512_cvtusepi16_epi8(LoadUnaligned<__m512i>(src))),
+        _mm512_cvtusepi16_epi8(LoadUnaligned<__m512i>(src + kUnitsPerVector)),
+        1);
+    }
+    else {
+      __m512i bytes = _mm512_castsi128_si512(
+        _mm512_cvtusepi32_epi8(LoadUnaligned<__m512i>(src)));
+      bytes = _mm512_inserti32x4(
+        bytes,
+        _mm512_cvtusepi32_epi8(LoadUnaligned<__m512i>(src + kUnitsPerVector)),
+        1);
+      bytes = _mm512_inserti32x4(
+        bytes,
+        _mm512_cvtusepi32_epi8(
+          LoadUnaligned<__m512i>(src + 2 * kUnitsPerVector)),
+        2);
+      return _mm512_inserti32x4(
+        bytes,
+        _mm512_cvtusepi32_epi8(
+          LoadUnaligned<__m512i>(src + 3 * kUnitsPerVector)),
+        3);
+    }
+  }
+
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  LONGLP_ALWAYS_INLINE auto NarrowLanesAVX512(const Unit* src) -> uint64_t {
+    constexpr size_t kUnitsPerVector = 64 / sizeof(Unit);
+    if constexpr (sizeof(Unit) == 2) {
+      const __m512i max = _mm512_set1_epi16(static_cast<int16_t>(kLastByte));
+      return _mm512_cmple_epu16_mask(LoadUnaligned<__m512i>(src), max) |
+             (uint64_t{_mm512_cmple_epu16_mask(
+                LoadUnaligned<__m512i>(src + kUnitsPerVector),
+                max)}
+              << 32U);
+    }
+    else {
+      static_assert(sizeof(Unit) == 4);
+      const __m512i max = _mm512_set1_epi32(static_cast<int32_t>(kLastByte));
+      uint64_t narrow = 0;
+      for (size_t k = 0; k < 4; ++k) {
+        narrow |= uint64_t{_mm512_cmple_epu32_mask(
+                    LoadUnaligned<__m512i>(src + k * kUnitsPerVector),
+                    max)}
+                  << (16 * k);
+      }
+      return narrow;
+    }
+  }
+
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  auto FindAVX512(
+    const Unit* src,
+    size_t length,
+    const ByteSet& set,
+    bool negate,
+    bool stop_at_wide) -> size_t {
+    constexpr size_t kUnitsPerBlock = 64;
+    const __m512i low = BroadcastAVX512(LoadUnaligned<__m128i>(set.nibbles));
+    const __m512i high =
+      BroadcastAVX512(LoadUnaligned<__m128i>(set.nibbles + 16));
+    const uint64_t flip = negate ? ~uint64_t{0} : 0;
+    const uint64_t wide = stop_at_wide ? ~uint64_t{0} : 0;
+    size_t i = 0;
+    for (; i + kUnitsPerBlock <= length; i += kUnitsPerBlock) {
+      uint64_t found = InSetAVX512(LoadBytesAVX512(src + i), low, high) ^ flip;
+      if constexpr (sizeof(Unit) > 1) {
+        const uint64_t narrow = NarrowLanesAVX512(src + i);
+        found = (found & narrow) | (wide & ~narrow);
+      }
+      if (found != 0) {
+        return i + static_cast<size_t>(std::countr_zero(found));
+      }
+    }
+    return i + FindScalar(src + i, length - i, set, negate, stop_at_wide);
+  }
+#endif    // defined(LONGLP_ARCH_CPU_X86_FAMILY)
+
+#if defined(LONGLP_ARCH_CPU_ARM64)
+  LONGLP_ALWAYS_INLINE auto InSetNEON(uint8x16_t bytes, uint8x16x2_t bitmap)
+    -> uint8x16_t {
+    const uint8x16_t row = vqtbl2q_u8(bitmap, vshrq_n_u8(bytes, 3));
+    const uint8x16_t bit = vshlq_u8(
+      vdupq_n_u8(1),
+      vreinterpretq_s8_u8(vandq_u8(bytes, vdupq_n_u8(7))));
+    return vtstq_u8(row, bit);
+  }
+
+  template <typename Unit>
+  LONGLP_ALWAYS_INLINE auto LoadBytesNEON(const Unit* src) -> uint8x16_t {
+    if constexpr (sizeof(Unit) == 1) {
+      return vld1q_u8(reinterpret_cast<const uint8_t*>(src));
+    }
+    else if constexpr (sizeof(Unit) == 2) {
+      const auto* units = reinterpret_cast<const uint16_t*>(src);
+      return vcombine_u8(
+        vqmovn_u16(vld1q_u16(units)),
+        vqmovn_u16(vld1q_u16(units + 8)));
+    }
+    else {
+      const auto* units = reinterpret_cast<const uint32_t*>(src);
+      return vcombine_u8(
+        vqmovn_u16(vcombine_u16(
+          vqmovn_u32(vld1q_u32(units)),
+          vqmovn_u32(vld1q_u32(units + 4)))),
+        vqmovn_u16(vcombine_u16(
+          vqmovn_u32(vld1q_u32(units + 8)),
+          vqmovn_u32(vld1q_u32(units + 12)))));
+    }
+  }
+
+  template <typename Unit>
+  LONGLP_ALWAYS_INLINE auto NarrowLanesNEON(const Unit* src) -> uint8x16_t {
+    if constexpr (sizeof(Unit) == 2) {
+      const auto* units = reinterpret_cast<const uint16_t*>(src);
+      const uint16x8_t max = vdupq_n_u16(kLastByte);
+      return vcombine_u8(
+        vmovn_u16(vcleq_u16(vld1q_u16(units), max)),
+        vmovn_u16(vcleq_u16(vld1q_u16(units + 8), max)));
+    }
+    else {
+      static_assert(sizeof(Unit) == 4);
+      const auto* units = reinterpret_cast<const uint32_t*>(src);
+      const uint32x4_t max = vdupq_n_u32(kLastByte);
+      return vcombine_u8(
+        vmovn_u16(vcombine_u16(
+          vmovn_u32(vcleq_u32(vld1q_u32(units), max)),
+          vmovn_u32(vcleq_u32(vld1q_u32(units + 4), max)))),
+        vmovn_u16(vcombine_u16(
+          vmovn_u32(vcleq_u32(vld1q_u32(units + 8), max)),
+          vmovn_u32(vcleq_u32(vld1q_u32(units + 12), max)))));
+    }
+  }
+
+  template <typename Unit>
+  auto FindNEON(
+    const Unit* src,
+    size_t length,
+    const ByteSet& set,
+    bool negate,
+    bool stop_at_wide) -> size_t {
+    constexpr size_t kUnitsPerBlock = 16;
+    const uint8x16x2_t bitmap = {
+      {vld1q_u8(set.bitmap), vld1q_u8(set.bitmap + 16)}};
+    const uint8x16_t flip = vdupq_n_u8(negate ? 0xFF : 0);
+    const uint8x16_t wide = vdupq_n_u8(stop_at_wide ? 0xFF : 0);
+    size_t i = 0;
+    for (; i + kUnitsPerBlock <= length; i += kUnitsPerBlock) {
+      uint8x16_t found =
+        veorq_u8(InSetNEON(LoadBytesNEON(src + i), bitmap), flip);
+      if constexpr (sizeof(Unit) > 1) {
+        found = vbslq_u8(NarrowLanesNEON(src + i), found, wide);
+      }
+      // Four bits per lane, there is no movemask.
+      const uint64_t mask = vget_lane_u64(
+        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(found), 4)),
+        0);
+      if (mask != 0) {
+        return i + static_cast<size_t>(std::countr_zero(mask)) / 4;
+      }
+    }
+    return i + FindScalar(src + i, length - i, set, negate, stop_at_wide);
+  }
+#endif    // defined(LONGLP_ARCH_CPU_ARM64)
+
+  auto SelectKernels() -> Kernels {
+    [[maybe_unused]] const auto& cpu = CPU::GetInstanceNoAllocation();
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+    if (cpu.has_avx512bw()) {
+      return {
+        &FindAVX512<CharUTF8>,
+        &FindAVX512<CharUTF16>,
+        &FindAVX512<CharUTF32>};
+    }
+    if (cpu.has_avx2()) {
+      return {
+        &FindAVX2<CharUTF8>,
+        &FindAVX2<CharUTF16>,
+        &FindAVX2<CharUTF32>};
+    }
+    if (cpu.has_sse42()) {
+      return {
+        &FindSSE42<CharUTF8>,
+        &FindSSE42<CharUTF16>,
+        &FindSSE42<CharUTF32>};
+    }
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+    if (cpu.has_neon()) {
+      return {
+        &FindNEON<CharUTF8>,
+        &FindNEON<CharUTF16>,
+        &FindNEON<CharUTF32>};
+    }
+#endif
+    return {
+      &FindScalar<CharUTF8>,
+      &FindScalar<CharUTF16>,
+      &FindScalar<CharUTF32>};
+  }
+
+  auto GetKernels() -> const Kernels& {
+    static const Kernels kKernels = SelectKernels();
+    return kKernels;
+  }
+}    // namespace
+
+auto FindInByteSet(
+  const CharUTF8* src,
+  size_t src_length,
+  const ByteSet& set,
+  bool negate) -> size_t {
+  return GetKernels().utf8(src, src_length, set, negate, false);
+}
+
+auto FindInByteSet(
+  const CharUTF16* src,
+  size_t src_length,
+  const ByteSet& set,
+  bool negate,
+  bool stop_at_wide) -> size_t {
+  return GetKernels().utf16(src, src_length, set, negate, stop_at_wide);
+}
+
+auto FindInByteSet(
+  const CharUTF32* src,
+  size_t src_length,
+  const ByteSet& set,
+  bool negate,
+  bool stop_at_wide) -> size_t {
+  return GetKernels().utf32(src, src_length, set, negate, stop_at_wide);
+}
+
+// NOLINTEND(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}    // namespace longlp::base::internal::simd
@@ -0,0 +1,386 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "base/compiler_specific.h"
+#include "base/cpu.h"
+#include "base/predef.h"
+#include "strings/simd/load_store.h"
+#include "strings/simd/utf_kernels.h"
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+#  include <immintrin.h>
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+#  include <arm_neon.h>
+#endif
+
+namespace longlp::base::internal::simd {
+// NOLINTBEGIN(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+namespace {
+  // Muła's "SIMD-friendly algorithms for substring searching": a vector of
+  // candidate positions is compared with the first code unit of the needle,
+  // and the vector |needle_length - 1| code units further with its last one.
+  // Only the positions where both match, rare in real text, are compared in
+  // full. Unlike a search for the first code unit alone, a frequent first
+  // code unit (a space, a 'e') does not stop the vector loop.
+  template <typename Unit>
+  using Kernel =
+    auto (*)(const Unit*, size_t, const Unit*, size_t) -> size_t;
+
+  struct Kernels {
+    Kernel<CharUTF8> utf8;
+    Kernel<CharUTF16> utf16;
+    Kernel<CharUTF32> utf32;
+  };
+
+  // Whether the needle is at |candidate|, whose first and last code units are
+  // already known to match.
+  template <typename Unit>
+  LONGLP_ALWAYS_INLINE auto MatchesAt(
+    const Unit* candidate,
+    const Unit* needle,
+    size_t needle_length) -> bool {
+    return needle_length <= 2 ||
+           std::memcmp(
+             candidate + 1,
+             needle + 1,
+             (needle_length - 2) * sizeof(Unit)) == 0;
+  }
+
+  // Also the tail of the vector kernels.
+  template <typename Unit>
+  auto FindScalar(
+    const Unit* haystack,
+    size_t haystack_length,
+    const Unit* needle,
+    size_t needle_length) -> size_t {
+    const size_t found = std::basic_string_view<Unit>(haystack, haystack_length)
+                           .find(needle, 0, needle_length);
+    return found == std::basic_string_view<Unit>::npos ? haystack_length
+                                                        : found;
+  }
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto SplatSSE42(Unit value) -> __m128i {
+    if constexpr (sizeof(Unit) == 1) {
+      return _mm_set1_epi8(static_cast<char>(value));
+    }
+    else if constexpr (sizeof(Unit) == 2) {
+      return _mm_set1_epi16(static_cast<int16_t>(value));
+    }
+    else {
+      return _mm_set1_epi32(static_cast<int32_t>(value));
+    }
+  }
+
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto CmpEqSSE42(__m128i lhs, __m128i rhs) -> __m128i {
+    if constexpr (sizeof(Unit) == 1) {
+      return _mm_cmpeq_epi8(lhs, rhs);
+    }
+    else if constexpr (sizeof(Unit) == 2) {
+      return _mm_cmpeq_epi16(lhs, rhs);
+    }
+    else {
+      return _mm_cmpeq_epi32(lhs, rhs);
+    }
+  }
+
+  // movemask sets the sizeof(Unit) bits of every matching lane; one
+  // candidate is taken per lane.
+  template <typename Unit>
+  constexpr uint32_t kLaneBits = (uint32_t{1} << sizeof(Unit)) - 1;
+
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto FindSSE42(
+    const Unit* haystack,
+    size_t haystack_length,
+    const Unit* needle,
+    size_t needle_length) -> size_t {
+    constexpr size_t kUnitsPerVector = 16 / sizeof(Unit);
+    const size_t last = needle_length - 1;
+    const __m128i first_unit = SplatSSE42(needle[0]);
+    const __m128i last_unit = SplatSSE42(needle[last]);
+    size_t i = 0;
+    for (; i + last + kUnitsPerVector <= haystack_length;
+         i += kUnitsPerVector) {
+      const __m128i firsts = LoadUnaligned<__m128i>(haystack + i);
+      const __m128i lasts = LoadUnaligned<__m128i>(haystack + i + last);
+      auto candidates = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(
+        CmpEqSSE42<Unit>(firsts, first_unit),
+        CmpEqSSE42<Unit>(lasts, last_unit))));
+      while (candidates != 0) {
+        const auto bit = static_cast<uint32_t>(std::countr_zero(candidates));
+        const size_t position = i + bit / sizeof(Unit);
+        if (MatchesAt(haystack + position, needle, needle_length)) {
+          return position;
+        }
+        candidates &= ~(kLaneBits<Unit> << bit);
+      }
+    }
+    return i +
+           FindScalar(haystack + i, haystack_length - i, needle, needle_length);
+  }
+
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  LONGLP_ALWAYS_INLINE auto SplatAVX2(Unit value) -> __m256i {
+    if constexpr (sizeof(Unit) == 1) {
+      return _mm256_set1_epi8(static_cast<char>(value));
+    }
+    else if constexpr (sizeof(Unit) == 2) {
+      return _mm256_set1_epi16(static_cast<int16_t>(value));
+    }
+    else {
+      return _mm256_set1_epi32(static_cast<int32_t>(value));
+    }
+  }
+
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  LONGLP_ALWAYS_INLINE auto CmpEqAVX2(__m256i lhs, __m256i rhs) -> __m256i {
+    if constexpr (sizeof(Unit) == 1) {
+      return _mm256_cmpeq_epi8(lhs, rhs);
+    }
+    else if constexpr (sizeof(Unit) == 2) {
+      return _mm256_cmpeq_epi16(lhs, rhs);
+    }
+    else {
+      return _mm256_cmpeq_epi32(lhs, rhs);
+    }
+  }
+
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto FindAVX2(
+    const Unit* haystack,
+    size_t haystack_length,
+    const Unit* needle,
+    size_t needle_length) -> size_t {
+    constexpr size_t kUnitsPerVector = 32 / sizeof(Unit);
+    const size_t last = needle_length - 1;
+    const __m256i first_unit = SplatAVX2(needle[0]);
+    const __m256i last_unit = SplatAVX2(needle[last]);
+    size_t i = 0;
+    for (; i + last + kUnitsPerVector <= haystack_length;
+         i += kUnitsPerVector) {
+      const __m256i firsts = LoadUnaligned<__m256i>(haystack + i);
+      const __m256i lasts = LoadUnaligned<__m256i>(haystack + i + last);
+      auto candidates =
+        static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(
+          CmpEqAVX2<Unit>(firsts, first_unit),
+          CmpEqAVX2<Unit>(lasts, last_unit))));
+      while (candidates != 0) {
+        const auto bit = static_cast<uint32_t>(std::countr_zero(candidates));
+        const size_t position = i + bit / sizeof(Unit);
+        if (MatchesAt(haystack + position, needle, needle_length)) {
+          return position;
+        }
+        candidates &= ~(kLaneBits<Unit> << bit);
+      }
+    }
+    return i +
+           FindScalar(haystack + i, haystack_length - i, needle, needle_length);
+  }
+
+  // AVX-512 compares into mask registers, one bit per code unit, and the
+  // second comparison only runs in the lanes the first one kept.
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  LONGLP_ALWAYS_INLINE auto CandidatesAVX512(
+    const Unit* firsts,
+    const Unit* lasts,
+    Unit first_unit,
+    Unit last_unit) -> uint64_t {
+    const __m512i first_block = LoadUnaligned<__m512i>(firsts);
+    const __m512i last_block = LoadUnaligned<__m512i>(lasts);
+    if constexpr (sizeof(Unit) == 1) {
+      return _mm512_mask_cmpeq_epi8_mask(
+        _mm512_cmpeq_epi8_mask(
+          first_block,
+          _mm512_set1_epi8(static_cast<char>(first_unit))),
+        last_block,
+        _mm512_set1_epi8(static_cast<char>(last_unit)));
+    }
+    else if constexpr (sizeof(Unit) == 2) {
+      return _mm512_mask_cmpeq_epi16_mask(
+        _mm512_cmpeq_epi16_mask(
+          first_block,
+          _mm512_set1_epi16(static_cast<int16_t>(first_unit))),
+        last_block,
+        _mm512_set1_epi16(static_cast<int16_t>(last_unit)));
+    }
+    else {
+      return _mm512_mask_cmpeq_epi32_mask(
+        _mm512_cmpeq_epi32_mask(
+          first_block,
+          _mm512_set1_epi32(static_cast<int32_t>(first_unit))),
+        last_block,
+        _mm512_set1_epi32(static_cast<int32_t>(last_unit)));
+    }
+  }
+
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  auto FindAVX512(
+    const Unit* haystack,
+    size_t haystack_length,
+    const Unit* needle,
+    size_t needle_length) -> size_t {
+    constexpr size_t kUnitsPerVector = 64 / sizeof(Unit);
+    const size_t last = needle_length - 1;
+    size_t i = 0;
+    for (; i + last + kUnitsPerVector <= haystack_length;
+         i += kUnitsPerVector) {
+      uint64_t candidates = CandidatesAVX512(
+        haystack + i,
+        haystack + i + last,
+        needle[0],
+        needle[last]);
+      while (candidates != 0) {
+        const size_t position =
+          i + static_cast<size_t>(std::countr_zero(candidates));
+        if (MatchesAt(haystack + position, needle, needle_length)) {
+          return position;
+        }
+        candidates &= candidates - 1;
+      }
+    }
+    return i +
+           FindScalar(haystack + i, haystack_length - i, needle, needle_length);
+  }
+#endif    // defined(LONGLP_ARCH_CPU_X86_FAMILY)
+
+#if defined(LONGLP_ARCH_CPU_ARM64)
+  // 0xFF bytes in the lanes where |src| holds |value|.
+  template <typename Unit>
+  LONGLP_ALWAYS_INLINE auto EqualLanesNEON(const Unit* src, Unit value)
+    -> uint8x16_t {
+    if constexpr (sizeof(Unit) == 1) {
+      return vceqq_u8(
+        vld1q_u8(reinterpret_cast<const uint8_t*>(src)),
+        vdupq_n_u8(static_cast<uint8_t>(value)));
+    }
+    else if constexpr (sizeof(Unit) == 2) {
+      return vreinterpretq_u8_u16(vceqq_u16(
+        vld1q_u16(reinterpret_cast<const uint16_t*>(src)),
+        vdupq_n_u16(static_cast<uint16_t>(value))));
+    }
+    else {
+      return vreinterpretq_u8_u32(vceqq_u32(
+        vld1q_u32(reinterpret_cast<const uint32_t*>(src)),
+        vdupq_n_u32(static_cast<uint32_t>(value))));
+    }
+  }
+
+  template <typename Unit>
+  auto FindNEON(
+    const Unit* haystack,
+    size_t haystack_length,
+    const Unit* needle,
+    size_t needle_length) -> size_t {
+    constexpr size_t kUnitsPerVector = 16 / sizeof(Unit);
+    // Four bits per byte, there is no movemask.
+    constexpr uint64_t kLaneBits = (uint64_t{1} << (4 * sizeof(Unit))) - 1;
+    const size_t last = needle_length - 1;
+    size_t i = 0;
+    for (; i + last + kUnitsPerVector <= haystack_length;
+         i += kUnitsPerVector) {
+      const uint8x16_t both = vandq_u8(
+        EqualLanesNEON(haystack + i, needle[0]),
+        EqualLanesNEON(haystack + i + last, needle[last]));
+      uint64_t candidates = vget_lane_u64(
+        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(both), 4)),
+        0);
+      while (candidates != 0) {
+        const auto bit = static_cast<uint32_t>(std::countr_zero(candidates));
+        const size_t position = i + bit / (4 * sizeof(Unit));
+        if (MatchesAt(haystack + position, needle, needle_length)) {
+          return position;
+        }
+        candidates &= ~(kLaneBits << bit);
+      }
+    }
+    return i +
+           FindScalar(haystack + i, haystack_length - i, needle, needle_length);
+  }
+#endif    // defined(LONGLP_ARCH_CPU_ARM64)
+
+  auto SelectKernels() -> Kernels {
+    [[maybe_unused]] const auto& cpu = CPU::GetInstanceNoAllocation();
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+    if (cpu.has_avx512bw()) {
+      return {
+        &FindAVX512<CharUTF8>,
+        &FindAVX512<CharUTF16>,
+        &FindAVX512<CharUTF32>};
+    }
+    if (cpu.has_avx2()) {
+      return {
+        &FindAVX2<CharUTF8>,
+        &FindAVX2<CharUTF16>,
+        &FindAVX2<CharUTF32>};
+    }
+    if (cpu.has_sse42()) {
+      return {
+        &FindSSE42<CharUTF8>,
+        &FindSSE42<CharUTF16>,
+        &FindSSE42<CharUTF32>};
+    }
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+    if (cpu.has_neon()) {
+      return {
+        &FindNEON<CharUTF8>,
+        &FindNEON<CharUTF16>,
+        &FindNEON<CharUTF32>};
+    }
+#endif
+    return {
+      &FindScalar<CharUTF8>,
+      &FindScalar<CharUTF16>,
+      &FindScalar<CharUTF32>};
+  }
+
+  auto GetKernels() -> const Kernels& {
+    static const Kernels kKernels = SelectKernels();
+    return kKernels;
+  }
+}    // namespace
+
+auto FindSubstring(
+  const CharUTF8* haystack,
+  size_t haystack_length,
+  const CharUTF8* needle,
+  size_t needle_length) -> size_t {
+  return GetKernels().utf8(haystack, haystack_length, needle, needle_length);
+}
+
+auto FindSubstring(
+  const CharUTF16* haystack,
+  size_t haystack_length,
+  const CharUTF16* needle,
+  size_t needle_length) -> size_t {
+  return GetKernels().utf16(haystack, haystack_length, needle, needle_length);
+}
+
+auto FindSubstring(
+  const CharUTF32* haystack,
+  size_t haystack_length,
+  const CharUTF32* needle,
+  size_t needle_length) -> size_t {
+  return GetKernels().utf32(haystack, haystack_length, needle, needle_length);
+}
+
+// NOLINTEND(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}    // namespace longlp::base::internal::simd
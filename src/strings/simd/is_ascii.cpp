@@ -0,0 +1,293 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <bit>
+#include <cstdint>
+
+#include "base/compiler_specific.h"
+#include "base/cpu.h"
+#include "base/predef.h"
+#include "strings/simd/load_store.h"
+#include "strings/simd/utf_kernels.h"
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+#  include <immintrin.h>
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+#  include <arm_neon.h>
+#endif
+
+namespace longlp::base::internal::simd {
+// NOLINTBEGIN(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+namespace {
+  // Every code unit is ASCII iff the OR of all of them has none of these bits
+  // set. The pattern is replicated over a 32-bit lane so the vector kernels
+  // can look at the code units as raw dwords.
+  template <typename Unit>
+  constexpr uint32_t kNonASCIIBits = sizeof(Unit) == 1   ? 0x80808080U
+                                     : sizeof(Unit) == 2 ? 0xFF80FF80U
+                                                         : 0xFFFFFF80U;
+
+  template <typename Unit>
+  using Kernel = auto (*)(const Unit*, size_t) -> bool;
+  using PrefixKernel = auto (*)(const CharUTF8*, size_t) -> size_t;
+
+  struct Kernels {
+    Kernel<CharUTF8> utf8;
+    Kernel<CharUTF16> utf16;
+    Kernel<CharUTF32> utf32;
+    PrefixKernel utf8_prefix;
+  };
+
+  // Also the tail of the vector kernels.
+  template <typename Unit>
+  auto IsASCIIScalar(const Unit* src, size_t length) -> bool {
+    uint32_t bits = 0;
+    for (size_t i = 0; i < length; ++i) {
+      bits |= static_cast<uint32_t>(src[i]);
+    }
+    return (bits & kNonASCIIBits<Unit>) == 0;
+  }
+
+  auto ASCIIPrefixLengthScalar(const CharUTF8* src, size_t length) -> size_t {
+    size_t i = 0;
+    while (i < length && static_cast<uint8_t>(src[i]) < 0x80) {
+      ++i;
+    }
+    return i;
+  }
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto IsASCIISSE42(const Unit* src, size_t length) -> bool {
+    constexpr size_t kUnitsPerVector = 16 / sizeof(Unit);
+    const __m128i non_ascii =
+      _mm_set1_epi32(static_cast<int32_t>(kNonASCIIBits<Unit>));
+
+    size_t i = 0;
+    // Four vectors per test keep the loop bound by loads.
+    for (; i + 4 * kUnitsPerVector <= length; i += 4 * kUnitsPerVector) {
+      const __m128i bits = _mm_or_si128(
+        _mm_or_si128(
+          LoadUnaligned<__m128i>(src + i),
+          LoadUnaligned<__m128i>(src + i + kUnitsPerVector)),
+        _mm_or_si128(
+          LoadUnaligned<__m128i>(src + i + 2 * kUnitsPerVector),
+          LoadUnaligned<__m128i>(src + i + 3 * kUnitsPerVector)));
+      if (!_mm_testz_si128(bits, non_ascii)) {
+        return false;
+      }
+    }
+    for (; i + kUnitsPerVector <= length; i += kUnitsPerVector) {
+      if (!_mm_testz_si128(LoadUnaligned<__m128i>(src + i), non_ascii)) {
+        return false;
+      }
+    }
+    return IsASCIIScalar(src + i, length - i);
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto ASCIIPrefixLengthSSE42(const CharUTF8* src, size_t length) -> size_t {
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+      const auto non_ascii = static_cast<uint32_t>(
+        _mm_movemask_epi8(LoadUnaligned<__m128i>(src + i)));
+      if (non_ascii != 0) {
+        return i + static_cast<size_t>(std::countr_zero(non_ascii));
+      }
+    }
+    return i + ASCIIPrefixLengthScalar(src + i, length - i);
+  }
+
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto IsASCIIAVX2(const Unit* src, size_t length) -> bool {
+    constexpr size_t kUnitsPerVector = 32 / sizeof(Unit);
+    const __m256i non_ascii =
+      _mm256_set1_epi32(static_cast<int32_t>(kNonASCIIBits<Unit>));
+
+    size_t i = 0;
+    for (; i + 4 * kUnitsPerVector <= length; i += 4 * kUnitsPerVector) {
+      const __m256i bits = _mm256_or_si256(
+        _mm256_or_si256(
+          LoadUnaligned<__m256i>(src + i),
+          LoadUnaligned<__m256i>(src + i + kUnitsPerVector)),
+        _mm256_or_si256(
+          LoadUnaligned<__m256i>(src + i + 2 * kUnitsPerVector),
+          LoadUnaligned<__m256i>(src + i + 3 * kUnitsPerVector)));
+      if (!_mm256_testz_si256(bits, non_ascii)) {
+        return false;
+      }
+    }
+    for (; i + kUnitsPerVector <= length; i += kUnitsPerVector) {
+      if (!_mm256_testz_si256(LoadUnaligned<__m256i>(src + i), non_ascii)) {
+        return false;
+      }
+    }
+    return IsASCIIScalar(src + i, length - i);
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto ASCIIPrefixLengthAVX2(const CharUTF8* src, size_t length) -> size_t {
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+      const auto non_ascii = static_cast<uint32_t>(
+        _mm256_movemask_epi8(LoadUnaligned<__m256i>(src + i)));
+      if (non_ascii != 0) {
+        return i + static_cast<size_t>(std::countr_zero(non_ascii));
+      }
+    }
+    return i + ASCIIPrefixLengthScalar(src + i, length - i);
+  }
+
+  template <typename Unit>
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  auto IsASCIIAVX512(const Unit* src, size_t length) -> bool {
+    constexpr size_t kUnitsPerVector = 64 / sizeof(Unit);
+    const __m512i non_ascii =
+      _mm512_set1_epi32(static_cast<int32_t>(kNonASCIIBits<Unit>));
+
+    size_t i = 0;
+    for (; i + 4 * kUnitsPerVector <= length; i += 4 * kUnitsPerVector) {
+      const __m512i bits = _mm512_or_si512(
+        _mm512_or_si512(
+          LoadUnaligned<__m512i>(src + i),
+          LoadUnaligned<__m512i>(src + i + kUnitsPerVector)),
+        _mm512_or_si512(
+          LoadUnaligned<__m512i>(src + i + 2 * kUnitsPerVector),
+          LoadUnaligned<__m512i>(src + i + 3 * kUnitsPerVector)));
+      if (_mm512_test_epi32_mask(bits, non_ascii) != 0) {
+        return false;
+      }
+    }
+    for (; i + kUnitsPerVector <= length; i += kUnitsPerVector) {
+      const __m512i units = LoadUnaligned<__m512i>(src + i);
+      if (_mm512_test_epi32_mask(units, non_ascii) != 0) {
+        return false;
+      }
+    }
+    return IsASCIIScalar(src + i, length - i);
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  auto ASCIIPrefixLengthAVX512(const CharUTF8* src, size_t length) -> size_t {
+    size_t i = 0;
+    for (; i + 64 <= length; i += 64) {
+      const uint64_t non_ascii =
+        _mm512_movepi8_mask(LoadUnaligned<__m512i>(src + i));
+      if (non_ascii != 0) {
+        return i + static_cast<size_t>(std::countr_zero(non_ascii));
+      }
+    }
+    return i + ASCIIPrefixLengthScalar(src + i, length - i);
+  }
+#endif    // defined(LONGLP_ARCH_CPU_X86_FAMILY)
+
+#if defined(LONGLP_ARCH_CPU_ARM64)
+  template <typename Unit>
+  auto IsASCIINEON(const Unit* src, size_t length) -> bool {
+    constexpr size_t kUnitsPerVector = 16 / sizeof(Unit);
+    const uint32x4_t non_ascii = vdupq_n_u32(kNonASCIIBits<Unit>);
+    const auto* bytes = reinterpret_cast<const uint8_t*>(src);
+
+    size_t i = 0;
+    for (; i + 4 * kUnitsPerVector <= length;
+         i += 4 * kUnitsPerVector, bytes += 64) {
+      const uint8x16_t bits = vorrq_u8(
+        vorrq_u8(vld1q_u8(bytes), vld1q_u8(bytes + 16)),
+        vorrq_u8(vld1q_u8(bytes + 32), vld1q_u8(bytes + 48)));
+      if (vmaxvq_u32(vandq_u32(vreinterpretq_u32_u8(bits), non_ascii)) != 0) {
+        return false;
+      }
+    }
+    for (; i + kUnitsPerVector <= length; i += kUnitsPerVector, bytes += 16) {
+      const uint32x4_t units =
+        vld1q_u32(reinterpret_cast<const uint32_t*>(bytes));
+      if (vmaxvq_u32(vandq_u32(units, non_ascii)) != 0) {
+        return false;
+      }
+    }
+    return IsASCIIScalar(src + i, length - i);
+  }
+
+  // The scalar loop finds the exact position inside the first block with a
+  // non-ASCII byte.
+  auto ASCIIPrefixLengthNEON(const CharUTF8* src, size_t length) -> size_t {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(src);
+    size_t i          = 0;
+    for (; i + 16 <= length; i += 16) {
+      if (vmaxvq_u8(vld1q_u8(bytes + i)) >= 0x80) {
+        break;
+      }
+    }
+    return i + ASCIIPrefixLengthScalar(src + i, length - i);
+  }
+#endif    // defined(LONGLP_ARCH_CPU_ARM64)
+
+  auto SelectKernels() -> Kernels {
+    [[maybe_unused]] const auto& cpu = CPU::GetInstanceNoAllocation();
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+    if (cpu.has_avx512bw()) {
+      return {
+        &IsASCIIAVX512<CharUTF8>,
+        &IsASCIIAVX512<CharUTF16>,
+        &IsASCIIAVX512<CharUTF32>,
+        &ASCIIPrefixLengthAVX512};
+    }
+    if (cpu.has_avx2()) {
+      return {
+        &IsASCIIAVX2<CharUTF8>,
+        &IsASCIIAVX2<CharUTF16>,
+        &IsASCIIAVX2<CharUTF32>,
+        &ASCIIPrefixLengthAVX2};
+    }
+    if (cpu.has_sse42()) {
+      return {
+        &IsASCIISSE42<CharUTF8>,
+        &IsASCIISSE42<CharUTF16>,
+        &IsASCIISSE42<CharUTF32>,
+        &ASCIIPrefixLengthSSE42};
+    }
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+    if (cpu.has_neon()) {
+      return {
+        &IsASCIINEON<CharUTF8>,
+        &IsASCIINEON<CharUTF16>,
+        &IsASCIINEON<CharUTF32>,
+        &ASCIIPrefixLengthNEON};
+    }
+#endif
+    return {
+      &IsASCIIScalar<CharUTF8>,
+      &IsASCIIScalar<CharUTF16>,
+      &IsASCIIScalar<CharUTF32>,
+      &ASCIIPrefixLengthScalar};
+  }
+
+  auto GetKernels() -> const Kernels& {
+    static const Kernels kKernels = SelectKernels();
+    return kKernels;
+  }
+}    // namespace
+
+auto IsASCII(const CharUTF8* src, size_t src_length) -> bool {
+  return GetKernels().utf8(src, src_length);
+}
+
+auto IsASCII(const CharUTF16* src, size_t src_length) -> bool {
+  return GetKernels().utf16(src, src_length);
+}
+
+auto IsASCII(const CharUTF32* src, size_t src_length) -> bool {
+  return GetKernels().utf32(src, src_length);
+}
+
+auto ASCIIPrefixLength(const CharUTF8* src, size_t src_length) -> size_t {
+  return GetKernels().utf8_prefix(src, src_length);
+}
+
+// NOLINTEND(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}    // namespace longlp::base::internal::simd
@@ -0,0 +1,709 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#include "base/compiler_specific.h"
+#include "base/cpu.h"
+#include "base/predef.h"
+#include "strings/simd/load_store.h"
+#include "strings/simd/utf8_encode_tables.h"
+#include "strings/simd/utf_kernels.h"
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+#  include <immintrin.h>
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+#  include <arm_neon.h>
+#endif
+
+namespace longlp::base::internal::simd {
+// NOLINTBEGIN(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+namespace {
+  using CountKernel  = auto (*)(const CharLatin1*, size_t) -> size_t;
+  using ToUTF8Kernel = auto (*)(const CharLatin1*, size_t, CharUTF8*, size_t)
+    -> TranscodeResult;
+  using FromUTF8Kernel =
+    auto (*)(const CharUTF8*, size_t, CharLatin1*, size_t) -> TranscodeResult;
+  using ToUTF16Kernel = auto (*)(const CharLatin1*, size_t, CharUTF16*)
+    -> TranscodeResult;
+  using FromUTF16Kernel = auto (*)(const CharUTF16*, size_t, CharLatin1*)
+    -> TranscodeResult;
+
+  struct Kernels {
+    CountKernel count_non_ascii;
+    ToUTF8Kernel to_utf8;
+    FromUTF8Kernel from_utf8;
+    ToUTF16Kernel to_utf16;
+    FromUTF16Kernel from_utf16;
+  };
+
+  // Every step reads 16 bytes. Encoding them takes up to 32 bytes. Decoding
+  // reads one byte more, the continuation of a last lead byte, and its two
+  // overlapping stores reach at most 24 bytes.
+  constexpr size_t kBlockSize    = 16;
+  constexpr size_t kMaxBlockSize = 32;
+
+  // Eight bytes of which the ones whose bit is set in |keep_mask| are kept,
+  // in order.
+  constexpr auto MakeKeepShuffle(uint32_t keep_mask) -> UTF8CompactShuffle {
+    UTF8CompactShuffle entry;
+    entry.shuffle.fill(internal_tables::kUnusedByte);
+    for (uint8_t byte = 0; byte < 8; ++byte) {
+      if ((keep_mask & (1U << byte)) != 0) {
+        entry.shuffle[entry.length++] = byte;
+      }
+    }
+    return entry;
+  }
+
+  // Indexed by the mask of the bytes to keep among eight.
+  constexpr auto kKeepTable =
+    internal_tables::MakeCompactTable<&MakeKeepShuffle>();
+
+  // Which bytes of a block the UTF-8 to Latin-1 kernels can decode, from
+  // per-byte masks. Bit i of |next_cont| is set when byte i + 1 is a
+  // continuation byte, which sees one byte past the block.
+  struct Latin1Block {
+    // Number of bytes to consume, up to the first byte that is neither ASCII
+    // nor part of a two-byte sequence of U+0080..U+00FF.
+    size_t read        = 0;
+    // The bytes of the block, among the first |read|, that produce a byte.
+    uint32_t keep_mask = 0;
+  };
+
+  constexpr auto ClassifyLatin1Block(
+    uint32_t non_ascii,
+    uint32_t lead,
+    uint32_t cont,
+    uint32_t next_cont) -> Latin1Block {
+    // A lead byte has to be followed by a continuation byte, and the
+    // continuation byte preceded by the lead byte. The block starts in front
+    // of a code point, so its first byte is never a valid continuation.
+    const uint32_t good_lead = lead & next_cont;
+    const uint32_t good_cont = cont & (good_lead << 1U);
+    const uint32_t bad       = non_ascii & ~(good_lead | good_cont) & 0xFFFF;
+    if (bad == 0) {
+      // A last lead byte takes its continuation from the next block.
+      return {kBlockSize + ((good_lead >> 15U) & 1U), ~cont & 0xFFFF};
+    }
+    // A good lead byte is followed by its continuation, which is good too, so
+    // the first bad byte starts a code point.
+    const auto read = static_cast<size_t>(std::countr_zero(bad));
+    return {read, ~cont & ((1U << read) - 1U)};
+  }
+
+  // The count kernels count the bytes of U+0080..U+00FF, which take two bytes
+  // in UTF-8.
+  auto CountNonASCIIScalar(const CharLatin1* src, size_t src_length)
+    -> size_t {
+    size_t count = 0;
+    for (size_t i = 0; i < src_length; ++i) {
+      count += static_cast<uint8_t>(src[i]) >> 7U;
+    }
+    return count;
+  }
+
+  auto Latin1ToUTF8Scalar(
+    const CharLatin1* /*src*/,
+    size_t /*src_length*/,
+    CharUTF8* /*dest*/,
+    size_t /*dest_length*/) -> TranscodeResult {
+    return {};
+  }
+
+  auto UTF8ToLatin1Scalar(
+    const CharUTF8* /*src*/,
+    size_t /*src_length*/,
+    CharLatin1* /*dest*/,
+    size_t /*dest_length*/) -> TranscodeResult {
+    return {};
+  }
+
+  auto Latin1ToUTF16Scalar(
+    const CharLatin1* /*src*/,
+    size_t /*src_length*/,
+    CharUTF16* /*dest*/) -> TranscodeResult {
+    return {};
+  }
+
+  auto NarrowToLatin1Scalar(
+    const CharUTF16* /*src*/,
+    size_t /*src_length*/,
+    CharLatin1* /*dest*/) -> TranscodeResult {
+    return {};
+  }
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+  // Encodes 8 bytes zero-extended to 16-bit lanes, returns the number of
+  // bytes written. Writes 16 bytes.
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto EncodeLatin1SSE42(__m128i units, CharUTF8* dest)
+    -> size_t {
+    const __m128i is_ascii = _mm_cmplt_epi16(units, _mm_set1_epi16(0x80));
+    const __m128i two_bytes = _mm_or_si128(
+      _mm_or_si128(_mm_srli_epi16(units, 6), _mm_set1_epi16(0xC0)),
+      _mm_slli_epi16(
+        _mm_or_si128(
+          _mm_and_si128(units, _mm_set1_epi16(0x3F)),
+          _mm_set1_epi16(0x80)),
+        8));
+    const __m128i lanes = _mm_blendv_epi8(two_bytes, units, is_ascii);
+
+    const auto ascii_mask = static_cast<uint32_t>(
+      _mm_movemask_epi8(_mm_packs_epi16(is_ascii, is_ascii)) & 0xFF);
+    const auto& entry = kUTF8TwoByteCompactTable[ascii_mask];
+    StoreUnaligned(
+      dest,
+      _mm_shuffle_epi8(lanes, LoadUnaligned<__m128i>(entry.shuffle.data())));
+    return entry.length;
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto Latin1ToUTF8StepSSE42(
+    const CharLatin1* src,
+    CharUTF8* dest) -> size_t {
+    const __m128i input = LoadUnaligned<__m128i>(src);
+    if (_mm_movemask_epi8(input) == 0) {
+      StoreUnaligned(dest, input);
+      return kBlockSize;
+    }
+    const size_t written = EncodeLatin1SSE42(_mm_cvtepu8_epi16(input), dest);
+    return written + EncodeLatin1SSE42(
+                       _mm_cvtepu8_epi16(_mm_srli_si128(input, 8)),
+                       dest + written);
+  }
+
+  // Decodes the ASCII bytes and two-byte sequences at the start of a block.
+  // The block has to be followed by at least one readable byte.
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto UTF8ToLatin1StepSSE42(
+    const CharUTF8* src,
+    CharLatin1* dest) -> TranscodeResult {
+    const __m128i input = LoadUnaligned<__m128i>(src);
+    const auto non_ascii = static_cast<uint32_t>(_mm_movemask_epi8(input));
+    if (non_ascii == 0) {
+      StoreUnaligned(dest, input);
+      return {kBlockSize, kBlockSize};
+    }
+
+    const __m128i next = LoadUnaligned<__m128i>(src + 1);
+    const __m128i top_bits = _mm_set1_epi8(static_cast<int8_t>(0xC0));
+    const __m128i continuation = _mm_set1_epi8(static_cast<int8_t>(0x80));
+    // C2 and C3 lead the sequences of U+0080..U+00FF.
+    const __m128i lead = _mm_cmpeq_epi8(
+      _mm_and_si128(input, _mm_set1_epi8(static_cast<int8_t>(0xFE))),
+      _mm_set1_epi8(static_cast<int8_t>(0xC2)));
+    const Latin1Block block = ClassifyLatin1Block(
+      non_ascii,
+      static_cast<uint32_t>(_mm_movemask_epi8(lead)),
+      static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_and_si128(input, top_bits), continuation))),
+      static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_and_si128(next, top_bits), continuation))));
+    if (block.read == 0) {
+      return {};
+    }
+
+    // A lead byte becomes the decoded byte, its continuation is dropped.
+    const __m128i decoded = _mm_or_si128(
+      _mm_and_si128(
+        _mm_slli_epi16(input, 6),
+        _mm_set1_epi8(static_cast<int8_t>(0xC0))),
+      _mm_and_si128(next, _mm_set1_epi8(0x3F)));
+    const __m128i bytes = _mm_blendv_epi8(input, decoded, lead);
+
+    const auto& low  = kKeepTable[block.keep_mask & 0xFFU];
+    const auto& high = kKeepTable[block.keep_mask >> 8U];
+    StoreUnaligned(
+      dest,
+      _mm_shuffle_epi8(bytes, LoadUnaligned<__m128i>(low.shuffle.data())));
+    StoreUnaligned(
+      dest + low.length,
+      _mm_shuffle_epi8(
+        _mm_srli_si128(bytes, 8),
+        LoadUnaligned<__m128i>(high.shuffle.data())));
+    return {block.read, size_t{low.length} + high.length};
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto CountNonASCIISSE42(const CharLatin1* src, size_t src_length)
+    -> size_t {
+    size_t count = 0;
+    size_t i     = 0;
+    for (; i + 16 <= src_length; i += 16) {
+      const __m128i input = LoadUnaligned<__m128i>(src + i);
+      count += static_cast<size_t>(
+        std::popcount(static_cast<uint32_t>(_mm_movemask_epi8(input))));
+    }
+    return count + CountNonASCIIScalar(src + i, src_length - i);
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto Latin1ToUTF8SSE42(
+    const CharLatin1* src,
+    size_t src_length,
+    CharUTF8* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + kBlockSize <= src_length &&
+           result.written + kMaxBlockSize <= dest_length) {
+      result.written +=
+        Latin1ToUTF8StepSSE42(src + result.read, dest + result.written);
+      result.read += kBlockSize;
+    }
+    return result;
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto UTF8ToLatin1SSE42(
+    const CharUTF8* src,
+    size_t src_length,
+    CharLatin1* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + kBlockSize < src_length &&
+           result.written + kMaxBlockSize <= dest_length) {
+      const auto step =
+        UTF8ToLatin1StepSSE42(src + result.read, dest + result.written);
+      if (step.read == 0) {
+        break;
+      }
+      result.read += step.read;
+      result.written += step.written;
+    }
+    return result;
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto Latin1ToUTF16SSE42(
+    const CharLatin1* src,
+    size_t src_length,
+    CharUTF16* dest) -> TranscodeResult {
+    size_t i = 0;
+    for (; i + 16 <= src_length; i += 16) {
+      const __m128i input = LoadUnaligned<__m128i>(src + i);
+      StoreUnaligned(dest + i, _mm_cvtepu8_epi16(input));
+      StoreUnaligned(dest + i + 8, _mm_cvtepu8_epi16(_mm_srli_si128(input, 8)));
+    }
+    return {i, i};
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto NarrowToLatin1SSE42(
+    const CharUTF16* src,
+    size_t src_length,
+    CharLatin1* dest) -> TranscodeResult {
+    size_t i = 0;
+    for (; i + 8 <= src_length; i += 8) {
+      const __m128i units = LoadUnaligned<__m128i>(src + i);
+      if (!_mm_testz_si128(
+            units,
+            _mm_set1_epi16(static_cast<int16_t>(0xFF00)))) {
+        break;
+      }
+      StoreUnalignedLow64(dest + i, _mm_packus_epi16(units, units));
+    }
+    return {i, i};
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto CountNonASCIIAVX2(const CharLatin1* src, size_t src_length)
+    -> size_t {
+    size_t count = 0;
+    size_t i     = 0;
+    for (; i + 32 <= src_length; i += 32) {
+      const __m256i input = LoadUnaligned<__m256i>(src + i);
+      count += static_cast<size_t>(
+        std::popcount(static_cast<uint32_t>(_mm256_movemask_epi8(input))));
+    }
+    return count + CountNonASCIISSE42(src + i, src_length - i);
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto Latin1ToUTF8AVX2(
+    const CharLatin1* src,
+    size_t src_length,
+    CharUTF8* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + 2 * kBlockSize <= src_length &&
+           result.written + 2 * kMaxBlockSize <= dest_length) {
+      const __m256i input = LoadUnaligned<__m256i>(src + result.read);
+      if (_mm256_movemask_epi8(input) == 0) {
+        StoreUnaligned(dest + result.written, input);
+        result.written += 2 * kBlockSize;
+      }
+      else {
+        result.written +=
+          Latin1ToUTF8StepSSE42(src + result.read, dest + result.written);
+        result.written += Latin1ToUTF8StepSSE42(
+          src + result.read + kBlockSize,
+          dest + result.written);
+      }
+      result.read += 2 * kBlockSize;
+    }
+    const auto tail = Latin1ToUTF8SSE42(
+      src + result.read,
+      src_length - result.read,
+      dest + result.written,
+      dest_length - result.written);
+    return {result.read + tail.read, result.written + tail.written};
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto UTF8ToLatin1AVX2(
+    const CharUTF8* src,
+    size_t src_length,
+    CharLatin1* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + 2 * kBlockSize <= src_length &&
+           result.written + 2 * kBlockSize <= dest_length) {
+      const __m256i input = LoadUnaligned<__m256i>(src + result.read);
+      if (_mm256_movemask_epi8(input) != 0) {
+        break;
+      }
+      StoreUnaligned(dest + result.written, input);
+      result.read += 2 * kBlockSize;
+      result.written += 2 * kBlockSize;
+    }
+    const auto tail = UTF8ToLatin1SSE42(
+      src + result.read,
+      src_length - result.read,
+      dest + result.written,
+      dest_length - result.written);
+    return {result.read + tail.read, result.written + tail.written};
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto Latin1ToUTF16AVX2(
+    const CharLatin1* src,
+    size_t src_length,
+    CharUTF16* dest) -> TranscodeResult {
+    size_t i = 0;
+    for (; i + 16 <= src_length; i += 16) {
+      StoreUnaligned(
+        dest + i,
+        _mm256_cvtepu8_epi16(LoadUnaligned<__m128i>(src + i)));
+    }
+    return {i, i};
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto NarrowToLatin1AVX2(
+    const CharUTF16* src,
+    size_t src_length,
+    CharLatin1* dest) -> TranscodeResult {
+    size_t i = 0;
+    for (; i + 16 <= src_length; i += 16) {
+      const __m256i units = LoadUnaligned<__m256i>(src + i);
+      if (!_mm256_testz_si256(
+            units,
+            _mm256_set1_epi16(static_cast<int16_t>(0xFF00)))) {
+        break;
+      }
+      StoreUnaligned(
+        dest + i,
+        _mm_packus_epi16(
+          _mm256_castsi256_si128(units),
+          _mm256_extracti128_si256(units, 1)));
+    }
+    const auto tail = NarrowToLatin1SSE42(src + i, src_length - i, dest + i);
+    return {i + tail.read, i + tail.written};
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  auto CountNonASCIIAVX512(const CharLatin1* src, size_t src_length)
+    -> size_t {
+    size_t count = 0;
+    size_t i     = 0;
+    for (; i + 64 <= src_length; i += 64) {
+      count += static_cast<size_t>(
+        std::popcount(_mm512_movepi8_mask(LoadUnaligned<__m512i>(src + i))));
+    }
+    return count + CountNonASCIISSE42(src + i, src_length - i);
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  auto Latin1ToUTF16AVX512(
+    const CharLatin1* src,
+    size_t src_length,
+    CharUTF16* dest) -> TranscodeResult {
+    size_t i = 0;
+    for (; i + 32 <= src_length; i += 32) {
+      StoreUnaligned(
+        dest + i,
+        _mm512_cvtepu8_epi16(LoadUnaligned<__m256i>(src + i)));
+    }
+    const auto tail = Latin1ToUTF16SSE42(src + i, src_length - i, dest + i);
+    return {i + tail.read, i + tail.written};
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  auto NarrowToLatin1AVX512(
+    const CharUTF16* src,
+    size_t src_length,
+    CharLatin1* dest) -> TranscodeResult {
+    size_t i = 0;
+    for (; i + 32 <= src_length; i += 32) {
+      const __m512i units = LoadUnaligned<__m512i>(src + i);
+      if (_mm512_test_epi16_mask(
+            units,
+            _mm512_set1_epi16(static_cast<int16_t>(0xFF00))) != 0) {
+        break;
+      }
+      StoreUnaligned(
+        dest + i,
+        _mm512_maskz_cvtepi16_epi8(~__mmask32{0}, units));
+    }
+    const auto tail = NarrowToLatin1SSE42(src + i, src_length - i, dest + i);
+    return {i + tail.read, i + tail.written};
+  }
+#endif    // defined(LONGLP_ARCH_CPU_X86_FAMILY)
+
+#if defined(LONGLP_ARCH_CPU_ARM64)
+  // Bit i of the result is set when byte i of |mask| is set.
+  inline auto MoveMaskNEON(uint8x16_t mask) -> uint32_t {
+    constexpr std::array<uint8_t, 16> kLaneBits = {
+      1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    const uint8x16_t bits = vandq_u8(mask, vld1q_u8(kLaneBits.data()));
+    return static_cast<uint32_t>(vaddv_u8(vget_low_u8(bits))) |
+           (static_cast<uint32_t>(vaddv_u8(vget_high_u8(bits))) << 8U);
+  }
+
+  // See EncodeLatin1SSE42().
+  inline auto EncodeLatin1NEON(uint16x8_t units, CharUTF8* dest) -> size_t {
+    const uint16x8_t is_ascii  = vcltq_u16(units, vdupq_n_u16(0x80));
+    const uint16x8_t two_bytes = vorrq_u16(
+      vorrq_u16(vshrq_n_u16(units, 6), vdupq_n_u16(0xC0)),
+      vshlq_n_u16(
+        vorrq_u16(vandq_u16(units, vdupq_n_u16(0x3F)), vdupq_n_u16(0x80)),
+        8));
+    const uint16x8_t lanes = vbslq_u16(is_ascii, units, two_bytes);
+
+    constexpr std::array<uint16_t, 8> kLaneBits = {1, 2, 4, 8, 16, 32, 64, 128};
+    const uint32_t ascii_mask =
+      vaddvq_u16(vandq_u16(is_ascii, vld1q_u16(kLaneBits.data())));
+    const auto& entry = kUTF8TwoByteCompactTable[ascii_mask];
+    vst1q_u8(
+      reinterpret_cast<uint8_t*>(dest),
+      vqtbl1q_u8(vreinterpretq_u8_u16(lanes), vld1q_u8(entry.shuffle.data())));
+    return entry.length;
+  }
+
+  auto CountNonASCIINEON(const CharLatin1* src, size_t src_length)
+    -> size_t {
+    size_t count = 0;
+    size_t i     = 0;
+    for (; i + 16 <= src_length; i += 16) {
+      const uint8x16_t input =
+        vld1q_u8(reinterpret_cast<const uint8_t*>(src + i));
+      count += vaddvq_u8(vshrq_n_u8(input, 7));
+    }
+    return count + CountNonASCIIScalar(src + i, src_length - i);
+  }
+
+  auto Latin1ToUTF8NEON(
+    const CharLatin1* src,
+    size_t src_length,
+    CharUTF8* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + kBlockSize <= src_length &&
+           result.written + kMaxBlockSize <= dest_length) {
+      const uint8x16_t input =
+        vld1q_u8(reinterpret_cast<const uint8_t*>(src + result.read));
+      if (vmaxvq_u8(input) < 0x80) {
+        vst1q_u8(reinterpret_cast<uint8_t*>(dest + result.written), input);
+        result.written += kBlockSize;
+      }
+      else {
+        result.written +=
+          EncodeLatin1NEON(vmovl_u8(vget_low_u8(input)), dest + result.written);
+        result.written +=
+          EncodeLatin1NEON(vmovl_high_u8(input), dest + result.written);
+      }
+      result.read += kBlockSize;
+    }
+    return result;
+  }
+
+  // See UTF8ToLatin1StepSSE42().
+  inline auto UTF8ToLatin1StepNEON(const CharUTF8* src, CharLatin1* dest)
+    -> TranscodeResult {
+    const auto* bytes_in   = reinterpret_cast<const uint8_t*>(src);
+    auto* out              = reinterpret_cast<uint8_t*>(dest);
+    const uint8x16_t input = vld1q_u8(bytes_in);
+    if (vmaxvq_u8(input) < 0x80) {
+      vst1q_u8(out, input);
+      return {kBlockSize, kBlockSize};
+    }
+
+    const uint8x16_t next     = vld1q_u8(bytes_in + 1);
+    const uint8x16_t top_bits = vdupq_n_u8(0xC0);
+    const uint8x16_t lead =
+      vceqq_u8(vandq_u8(input, vdupq_n_u8(0xFE)), vdupq_n_u8(0xC2));
+    const Latin1Block block = ClassifyLatin1Block(
+      MoveMaskNEON(vcgeq_u8(input, vdupq_n_u8(0x80))),
+      MoveMaskNEON(lead),
+      MoveMaskNEON(vceqq_u8(vandq_u8(input, top_bits), vdupq_n_u8(0x80))),
+      MoveMaskNEON(vceqq_u8(vandq_u8(next, top_bits), vdupq_n_u8(0x80))));
+    if (block.read == 0) {
+      return {};
+    }
+
+    const uint8x16_t decoded = vorrq_u8(
+      vshlq_n_u8(input, 6),
+      vandq_u8(next, vdupq_n_u8(0x3F)));
+    const uint8x16_t bytes = vbslq_u8(lead, decoded, input);
+
+    const auto& low  = kKeepTable[block.keep_mask & 0xFFU];
+    const auto& high = kKeepTable[block.keep_mask >> 8U];
+    vst1q_u8(out, vqtbl1q_u8(bytes, vld1q_u8(low.shuffle.data())));
+    vst1q_u8(
+      out + low.length,
+      vqtbl1q_u8(vextq_u8(bytes, bytes, 8), vld1q_u8(high.shuffle.data())));
+    return {block.read, size_t{low.length} + high.length};
+  }
+
+  auto UTF8ToLatin1NEON(
+    const CharUTF8* src,
+    size_t src_length,
+    CharLatin1* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + kBlockSize < src_length &&
+           result.written + kMaxBlockSize <= dest_length) {
+      const auto step =
+        UTF8ToLatin1StepNEON(src + result.read, dest + result.written);
+      if (step.read == 0) {
+        break;
+      }
+      result.read += step.read;
+      result.written += step.written;
+    }
+    return result;
+  }
+
+  auto Latin1ToUTF16NEON(
+    const CharLatin1* src,
+    size_t src_length,
+    CharUTF16* dest) -> TranscodeResult {
+    size_t i = 0;
+    for (; i + 16 <= src_length; i += 16) {
+      const uint8x16_t input =
+        vld1q_u8(reinterpret_cast<const uint8_t*>(src + i));
+      auto* out = reinterpret_cast<uint16_t*>(dest + i);
+      vst1q_u16(out, vmovl_u8(vget_low_u8(input)));
+      vst1q_u16(out + 8, vmovl_high_u8(input));
+    }
+    return {i, i};
+  }
+
+  auto NarrowToLatin1NEON(
+    const CharUTF16* src,
+    size_t src_length,
+    CharLatin1* dest) -> TranscodeResult {
+    size_t i = 0;
+    for (; i + 8 <= src_length; i += 8) {
+      const uint16x8_t units =
+        vld1q_u16(reinterpret_cast<const uint16_t*>(src + i));
+      if (vmaxvq_u16(units) > 0xFF) {
+        break;
+      }
+      vst1_u8(reinterpret_cast<uint8_t*>(dest + i), vmovn_u16(units));
+    }
+    return {i, i};
+  }
+#endif    // defined(LONGLP_ARCH_CPU_ARM64)
+
+  auto SelectKernels() -> Kernels {
+    [[maybe_unused]] const auto& cpu = CPU::GetInstanceNoAllocation();
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+    // The decoder gains little from wider vectors past its ASCII blocks, nor
+    // the encoder from AVX-512 without the VBMI2 compress instructions.
+    if (cpu.has_avx512bw()) {
+      return {
+        &CountNonASCIIAVX512,
+        &Latin1ToUTF8AVX2,
+        &UTF8ToLatin1AVX2,
+        &Latin1ToUTF16AVX512,
+        &NarrowToLatin1AVX512};
+    }
+    if (cpu.has_avx2()) {
+      return {
+        &CountNonASCIIAVX2,
+        &Latin1ToUTF8AVX2,
+        &UTF8ToLatin1AVX2,
+        &Latin1ToUTF16AVX2,
+        &NarrowToLatin1AVX2};
+    }
+    if (cpu.has_sse42()) {
+      return {
+        &CountNonASCIISSE42,
+        &Latin1ToUTF8SSE42,
+        &UTF8ToLatin1SSE42,
+        &Latin1ToUTF16SSE42,
+        &NarrowToLatin1SSE42};
+    }
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+    if (cpu.has_neon()) {
+      return {
+        &CountNonASCIINEON,
+        &Latin1ToUTF8NEON,
+        &UTF8ToLatin1NEON,
+        &Latin1ToUTF16NEON,
+        &NarrowToLatin1NEON};
+    }
+#endif
+    return {
+      &CountNonASCIIScalar,
+      &Latin1ToUTF8Scalar,
+      &UTF8ToLatin1Scalar,
+      &Latin1ToUTF16Scalar,
+      &NarrowToLatin1Scalar};
+  }
+
+  auto GetKernels() -> const Kernels& {
+    static const Kernels kKernels = SelectKernels();
+    return kKernels;
+  }
+}    // namespace
+
+auto UTF8LengthOfLatin1(const CharLatin1* src, size_t src_length) -> size_t {
+  return src_length + GetKernels().count_non_ascii(src, src_length);
+}
+
+auto Latin1ToUTF8(
+  const CharLatin1* src,
+  size_t src_length,
+  CharUTF8* dest,
+  size_t dest_length) -> TranscodeResult {
+  return GetKernels().to_utf8(src, src_length, dest, dest_length);
+}
+
+auto UTF8ToLatin1(
+  const CharUTF8* src,
+  size_t src_length,
+  CharLatin1* dest,
+  size_t dest_length) -> TranscodeResult {
+  return GetKernels().from_utf8(src, src_length, dest, dest_length);
+}
+
+auto Latin1ToUTF16(const CharLatin1* src, size_t src_length, CharUTF16* dest)
+  -> TranscodeResult {
+  return GetKernels().to_utf16(src, src_length, dest);
+}
+
+auto NarrowToLatin1(const CharUTF16* src, size_t src_length, CharLatin1* dest)
+  -> TranscodeResult {
+  return GetKernels().from_utf16(src, src_length, dest);
+}
+
+// NOLINTEND(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}    // namespace longlp::base::internal::simd
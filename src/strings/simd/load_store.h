@@ -0,0 +1,87 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+// Unaligned loads and stores of whole vectors from and to code unit buffers.
+//
+// The x86 intrinsics take a pointer to the vector type, whose alignment is
+// larger than the one of any code unit. Casting to it is fine since the
+// intrinsics do not require it, but -Wcast-align=strict still flags every
+// cast, so the kernels go through these helpers which own the only ones. The
+// aligned lookup tables are read with them too, the unaligned forms cost
+// nothing on aligned data.
+// NEON loads and stores take pointers to the lane type, they need no helper.
+
+#ifndef LONGLP_SRC_STRINGS_SIMD_LOAD_STORE_H_
+#define LONGLP_SRC_STRINGS_SIMD_LOAD_STORE_H_
+
+#include "base/compiler_specific.h"
+#include "base/predef.h"
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+#  include <immintrin.h>
+#endif
+
+namespace longlp::base::internal::simd {
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+// NOLINTBEGIN(*-reinterpret-cast)
+LONGLP_DIAGNOSTIC_PUSH
+LONGLP_GCC_DIAGNOSTIC_IGNORED("-Wcast-align")
+
+// Reads one |Vector|, one of __m128i, __m256i or __m512i, from |src|, which
+// has no alignment requirement.
+template <typename Vector>
+auto LoadUnaligned(const void* src) -> Vector;
+
+template <>
+LONGLP_TARGET_ATTRIBUTE("sse4.2")
+LONGLP_ALWAYS_INLINE auto LoadUnaligned<__m128i>(const void* src) -> __m128i {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+}
+
+template <>
+LONGLP_TARGET_ATTRIBUTE("avx2")
+LONGLP_ALWAYS_INLINE auto LoadUnaligned<__m256i>(const void* src) -> __m256i {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+}
+
+template <>
+LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+LONGLP_ALWAYS_INLINE auto LoadUnaligned<__m512i>(const void* src) -> __m512i {
+  return _mm512_loadu_si512(src);
+}
+
+// Reads 8 bytes from |src| into the low half of the result, the high half is
+// zeroed.
+LONGLP_TARGET_ATTRIBUTE("sse4.2")
+LONGLP_ALWAYS_INLINE auto LoadUnalignedLow64(const void* src) -> __m128i {
+  return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+}
+
+LONGLP_TARGET_ATTRIBUTE("sse4.2")
+LONGLP_ALWAYS_INLINE void StoreUnaligned(void* dest, __m128i vector) {
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), vector);
+}
+
+LONGLP_TARGET_ATTRIBUTE("avx2")
+LONGLP_ALWAYS_INLINE void StoreUnaligned(void* dest, __m256i vector) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest), vector);
+}
+
+LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+LONGLP_ALWAYS_INLINE void StoreUnaligned(void* dest, __m512i vector) {
+  _mm512_storeu_si512(dest, vector);
+}
+
+// Writes the low 8 bytes of |vector| to |dest|.
+LONGLP_TARGET_ATTRIBUTE("sse4.2")
+LONGLP_ALWAYS_INLINE void StoreUnalignedLow64(void* dest, __m128i vector) {
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(dest), vector);
+}
+
+LONGLP_DIAGNOSTIC_POP
+// NOLINTEND(*-reinterpret-cast)
+#endif    // defined(LONGLP_ARCH_CPU_X86_FAMILY)
+}    // namespace longlp::base::internal::simd
+
+#endif    // LONGLP_SRC_STRINGS_SIMD_LOAD_STORE_H_
@@ -0,0 +1,250 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <cstdint>
+
+#include "base/compiler_specific.h"
+#include "base/cpu.h"
+#include "base/predef.h"
+#include "strings/simd/load_store.h"
+#include "strings/simd/utf_kernels.h"
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+#  include <immintrin.h>
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+#  include <arm_neon.h>
+#endif
+
+namespace longlp::base::internal::simd {
+// NOLINTBEGIN(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+namespace {
+  using KernelUTF16 = auto (*)(const CharUTF16*, size_t, CharASCII*)
+    -> TranscodeResult;
+  using KernelUTF32 = auto (*)(const CharUTF32*, size_t, CharASCII*)
+    -> TranscodeResult;
+
+  struct Kernels {
+    KernelUTF16 utf16;
+    KernelUTF32 utf32;
+  };
+
+  template <typename Char>
+  auto NarrowToASCIIScalar(
+    const Char* /*src*/,
+    size_t /*src_length*/,
+    CharASCII* /*dest*/) -> TranscodeResult {
+    return {};
+  }
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto NarrowUTF16ToASCIISSE42(
+    const CharUTF16* src,
+    size_t src_length,
+    CharASCII* dest) -> TranscodeResult {
+    size_t i = 0;
+    for (; i + 8 <= src_length; i += 8) {
+      const __m128i units = LoadUnaligned<__m128i>(src + i);
+      if (!_mm_testz_si128(units, _mm_set1_epi16(static_cast<int16_t>(0xFF80)))) {
+        break;
+      }
+      StoreUnalignedLow64(dest + i, _mm_packus_epi16(units, units));
+    }
+    return {i, i};
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto NarrowUTF32ToASCIISSE42(
+    const CharUTF32* src,
+    size_t src_length,
+    CharASCII* dest) -> TranscodeResult {
+    size_t i = 0;
+    for (; i + 8 <= src_length; i += 8) {
+      const __m128i low  = LoadUnaligned<__m128i>(src + i);
+      const __m128i high = LoadUnaligned<__m128i>(src + i + 4);
+      if (!_mm_testz_si128(
+            _mm_or_si128(low, high),
+            _mm_set1_epi32(static_cast<int32_t>(0xFFFFFF80)))) {
+        break;
+      }
+      const __m128i words = _mm_packus_epi32(low, high);
+      StoreUnalignedLow64(dest + i, _mm_packus_epi16(words, words));
+    }
+    return {i, i};
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto NarrowUTF16ToASCIIAVX2(
+    const CharUTF16* src,
+    size_t src_length,
+    CharASCII* dest) -> TranscodeResult {
+    size_t i = 0;
+    for (; i + 16 <= src_length; i += 16) {
+      const __m256i units = LoadUnaligned<__m256i>(src + i);
+      if (!_mm256_testz_si256(
+            units,
+            _mm256_set1_epi16(static_cast<int16_t>(0xFF80)))) {
+        break;
+      }
+      StoreUnaligned(
+        dest + i,
+        _mm_packus_epi16(
+          _mm256_castsi256_si128(units),
+          _mm256_extracti128_si256(units, 1)));
+    }
+    const auto tail = NarrowUTF16ToASCIISSE42(src + i, src_length - i, dest + i);
+    return {i + tail.read, i + tail.written};
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto NarrowUTF32ToASCIIAVX2(
+    const CharUTF32* src,
+    size_t src_length,
+    CharASCII* dest) -> TranscodeResult {
+    size_t i = 0;
+    for (; i + 16 <= src_length; i += 16) {
+      const __m256i low  = LoadUnaligned<__m256i>(src + i);
+      const __m256i high = LoadUnaligned<__m256i>(src + i + 8);
+      if (!_mm256_testz_si256(
+            _mm256_or_si256(low, high),
+            _mm256_set1_epi32(static_cast<int32_t>(0xFFFFFF80)))) {
+        break;
+      }
+      // packus works within 128-bit lanes, the permute restores the order.
+      const __m256i words =
+        _mm256_permute4x64_epi64(_mm256_packus_epi32(low, high), 0xD8);
+      StoreUnaligned(
+        dest + i,
+        _mm_packus_epi16(
+          _mm256_castsi256_si128(words),
+          _mm256_extracti128_si256(words, 1)));
+    }
+    const auto tail = NarrowUTF32ToASCIISSE42(src + i, src_length - i, dest + i);
+    return {i + tail.read, i + tail.written};
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  auto NarrowUTF16ToASCIIAVX512(
+    const CharUTF16* src,
+    size_t src_length,
+    CharASCII* dest) -> TranscodeResult {
+    size_t i = 0;
+    for (; i + 32 <= src_length; i += 32) {
+      const __m512i units = LoadUnaligned<__m512i>(src + i);
+      if (_mm512_test_epi16_mask(
+            units,
+            _mm512_set1_epi16(static_cast<int16_t>(0xFF80))) != 0) {
+        break;
+      }
+      StoreUnaligned(
+        dest + i,
+        _mm512_maskz_cvtepi16_epi8(~__mmask32{0}, units));
+    }
+    const auto tail = NarrowUTF16ToASCIISSE42(src + i, src_length - i, dest + i);
+    return {i + tail.read, i + tail.written};
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  auto NarrowUTF32ToASCIIAVX512(
+    const CharUTF32* src,
+    size_t src_length,
+    CharASCII* dest) -> TranscodeResult {
+    size_t i = 0;
+    for (; i + 16 <= src_length; i += 16) {
+      const __m512i code_points = LoadUnaligned<__m512i>(src + i);
+      if (_mm512_test_epi32_mask(
+            code_points,
+            _mm512_set1_epi32(static_cast<int32_t>(0xFFFFFF80))) != 0) {
+        break;
+      }
+      StoreUnaligned(
+        dest + i,
+        _mm512_maskz_cvtepi32_epi8(
+          static_cast<__mmask16>(0xFFFF),
+          code_points));
+    }
+    const auto tail = NarrowUTF32ToASCIISSE42(src + i, src_length - i, dest + i);
+    return {i + tail.read, i + tail.written};
+  }
+#endif    // defined(LONGLP_ARCH_CPU_X86_FAMILY)
+
+#if defined(LONGLP_ARCH_CPU_ARM64)
+  auto NarrowUTF16ToASCIINEON(
+    const CharUTF16* src,
+    size_t src_length,
+    CharASCII* dest) -> TranscodeResult {
+    size_t i = 0;
+    for (; i + 8 <= src_length; i += 8) {
+      const uint16x8_t units =
+        vld1q_u16(reinterpret_cast<const uint16_t*>(src + i));
+      if (vmaxvq_u16(units) >= 0x80) {
+        break;
+      }
+      vst1_u8(reinterpret_cast<uint8_t*>(dest + i), vmovn_u16(units));
+    }
+    return {i, i};
+  }
+
+  auto NarrowUTF32ToASCIINEON(
+    const CharUTF32* src,
+    size_t src_length,
+    CharASCII* dest) -> TranscodeResult {
+    size_t i = 0;
+    for (; i + 8 <= src_length; i += 8) {
+      const auto* input     = reinterpret_cast<const uint32_t*>(src + i);
+      const uint32x4_t low  = vld1q_u32(input);
+      const uint32x4_t high = vld1q_u32(input + 4);
+      if (vmaxvq_u32(vmaxq_u32(low, high)) >= 0x80) {
+        break;
+      }
+      vst1_u8(
+        reinterpret_cast<uint8_t*>(dest + i),
+        vmovn_u16(vcombine_u16(vmovn_u32(low), vmovn_u32(high))));
+    }
+    return {i, i};
+  }
+#endif    // defined(LONGLP_ARCH_CPU_ARM64)
+
+  auto SelectKernels() -> Kernels {
+    [[maybe_unused]] const auto& cpu = CPU::GetInstanceNoAllocation();
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+    if (cpu.has_avx512bw()) {
+      return {&NarrowUTF16ToASCIIAVX512, &NarrowUTF32ToASCIIAVX512};
+    }
+    if (cpu.has_avx2()) {
+      return {&NarrowUTF16ToASCIIAVX2, &NarrowUTF32ToASCIIAVX2};
+    }
+    if (cpu.has_sse42()) {
+      return {&NarrowUTF16ToASCIISSE42, &NarrowUTF32ToASCIISSE42};
+    }
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+    if (cpu.has_neon()) {
+      return {&NarrowUTF16ToASCIINEON, &NarrowUTF32ToASCIINEON};
+    }
+#endif
+    return {
+      &NarrowToASCIIScalar<CharUTF16>,
+      &NarrowToASCIIScalar<CharUTF32>};
+  }
+
+  auto GetKernels() -> const Kernels& {
+    static const Kernels kKernels = SelectKernels();
+    return kKernels;
+  }
+}    // namespace
+
+auto NarrowToASCII(const CharUTF16* src, size_t src_length, CharASCII* dest)
+  -> TranscodeResult {
+  return GetKernels().utf16(src, src_length, dest);
+}
+
+auto NarrowToASCII(const CharUTF32* src, size_t src_length, CharASCII* dest)
+  -> TranscodeResult {
+  return GetKernels().utf32(src, src_length, dest);
+}
+
+// NOLINTEND(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}    // namespace longlp::base::internal::simd
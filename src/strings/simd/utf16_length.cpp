@@ -0,0 +1,162 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <bit>
+#include <cstdint>
+
+#include "base/compiler_specific.h"
+#include "base/cpu.h"
+#include "base/icu/utf.h"
+#include "base/predef.h"
+#include "strings/simd/load_store.h"
+#include "strings/simd/utf_kernels.h"
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+#  include <immintrin.h>
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+#  include <arm_neon.h>
+#endif
+
+namespace longlp::base::internal::simd {
+// NOLINTBEGIN(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+namespace {
+  // UTF-16 decodes to one code point per code unit, except that a lead
+  // surrogate directly followed by a trail surrogate makes a single one. A
+  // code unit cannot be both, so the pairs never overlap and can be counted
+  // independently at every position.
+  using Kernel = auto (*)(const CharUTF16*, size_t) -> size_t;
+
+  // Also the tail of the vector kernels.
+  auto CountSurrogatePairsScalar(const CharUTF16* src, size_t src_length)
+    -> size_t {
+    size_t pairs = 0;
+    for (size_t i = 0; i + 1 < src_length; ++i) {
+      pairs += icu::internal::U16IsLead(src[i]) &&
+                   icu::internal::U16IsTrail(src[i + 1])
+                 ? 1U
+                 : 0U;
+    }
+    return pairs;
+  }
+
+  // The blocks need one more code unit to see a pair straddling them.
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto CountSurrogatePairsSSE42(const CharUTF16* src, size_t src_length)
+    -> size_t {
+    const __m128i high_bits = _mm_set1_epi16(static_cast<int16_t>(0xFC00));
+    const __m128i lead      = _mm_set1_epi16(static_cast<int16_t>(0xD800));
+    const __m128i trail     = _mm_set1_epi16(static_cast<int16_t>(0xDC00));
+    size_t pairs = 0;
+    size_t i     = 0;
+    for (; i + 8 < src_length; i += 8) {
+      const __m128i units = LoadUnaligned<__m128i>(src + i);
+      const __m128i next  = LoadUnaligned<__m128i>(src + i + 1);
+      const __m128i pair = _mm_and_si128(
+        _mm_cmpeq_epi16(_mm_and_si128(units, high_bits), lead),
+        _mm_cmpeq_epi16(_mm_and_si128(next, high_bits), trail));
+      // Two mask bits per lane.
+      const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(pair));
+      pairs += static_cast<size_t>(std::popcount(mask)) / 2;
+    }
+    return pairs + CountSurrogatePairsScalar(src + i, src_length - i);
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto CountSurrogatePairsAVX2(const CharUTF16* src, size_t src_length)
+    -> size_t {
+    const __m256i high_bits = _mm256_set1_epi16(static_cast<int16_t>(0xFC00));
+    const __m256i lead      = _mm256_set1_epi16(static_cast<int16_t>(0xD800));
+    const __m256i trail     = _mm256_set1_epi16(static_cast<int16_t>(0xDC00));
+    size_t pairs = 0;
+    size_t i     = 0;
+    for (; i + 16 < src_length; i += 16) {
+      const __m256i units = LoadUnaligned<__m256i>(src + i);
+      const __m256i next  = LoadUnaligned<__m256i>(src + i + 1);
+      const __m256i pair = _mm256_and_si256(
+        _mm256_cmpeq_epi16(_mm256_and_si256(units, high_bits), lead),
+        _mm256_cmpeq_epi16(_mm256_and_si256(next, high_bits), trail));
+      const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(pair));
+      pairs += static_cast<size_t>(std::popcount(mask)) / 2;
+    }
+    return pairs + CountSurrogatePairsScalar(src + i, src_length - i);
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  auto CountSurrogatePairsAVX512(const CharUTF16* src, size_t src_length)
+    -> size_t {
+    const __m512i high_bits = _mm512_set1_epi16(static_cast<int16_t>(0xFC00));
+    const __m512i lead      = _mm512_set1_epi16(static_cast<int16_t>(0xD800));
+    const __m512i trail     = _mm512_set1_epi16(static_cast<int16_t>(0xDC00));
+    size_t pairs = 0;
+    size_t i     = 0;
+    for (; i + 32 < src_length; i += 32) {
+      const __m512i units = LoadUnaligned<__m512i>(src + i);
+      const __m512i next  = LoadUnaligned<__m512i>(src + i + 1);
+      const __mmask32 pair =
+        _mm512_cmpeq_epi16_mask(_mm512_and_si512(units, high_bits), lead) &
+        _mm512_cmpeq_epi16_mask(_mm512_and_si512(next, high_bits), trail);
+      pairs += static_cast<size_t>(std::popcount(pair));
+    }
+    return pairs + CountSurrogatePairsScalar(src + i, src_length - i);
+  }
+#endif    // defined(LONGLP_ARCH_CPU_X86_FAMILY)
+
+#if defined(LONGLP_ARCH_CPU_ARM64)
+  // The 16-bit lanes count up to 65535 blocks before they are folded.
+  auto CountSurrogatePairsNEON(const CharUTF16* src, size_t src_length)
+    -> size_t {
+    const auto* units          = reinterpret_cast<const uint16_t*>(src);
+    const uint16x8_t high_bits = vdupq_n_u16(0xFC00);
+    size_t pairs = 0;
+    size_t i     = 0;
+    while (i + 8 < src_length) {
+      uint16x8_t lanes = vdupq_n_u16(0);
+      for (size_t block = 0; block < 0xFFFF && i + 8 < src_length;
+           ++block, i += 8) {
+        const uint16x8_t pair = vandq_u16(
+          vceqq_u16(
+            vandq_u16(vld1q_u16(units + i), high_bits),
+            vdupq_n_u16(0xD800)),
+          vceqq_u16(
+            vandq_u16(vld1q_u16(units + i + 1), high_bits),
+            vdupq_n_u16(0xDC00)));
+        lanes = vsubq_u16(lanes, pair);
+      }
+      pairs += vaddlvq_u16(lanes);
+    }
+    return pairs + CountSurrogatePairsScalar(src + i, src_length - i);
+  }
+#endif    // defined(LONGLP_ARCH_CPU_ARM64)
+
+  auto SelectKernel() -> Kernel {
+    [[maybe_unused]] const auto& cpu = CPU::GetInstanceNoAllocation();
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+    if (cpu.has_avx512bw()) {
+      return &CountSurrogatePairsAVX512;
+    }
+    if (cpu.has_avx2()) {
+      return &CountSurrogatePairsAVX2;
+    }
+    if (cpu.has_sse42()) {
+      return &CountSurrogatePairsSSE42;
+    }
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+    if (cpu.has_neon()) {
+      return &CountSurrogatePairsNEON;
+    }
+#endif
+    return &CountSurrogatePairsScalar;
+  }
+}    // namespace
+
+auto UTF32LengthOfUTF16(const CharUTF16* src, size_t src_length) -> size_t {
+  static const Kernel kKernel = SelectKernel();
+  return src_length - kKernel(src, src_length);
+}
+
+// NOLINTEND(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}    // namespace longlp::base::internal::simd
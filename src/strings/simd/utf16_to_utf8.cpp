@@ -0,0 +1,594 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#include "base/compiler_specific.h"
+#include "base/cpu.h"
+#include "base/predef.h"
+#include "strings/simd/byte_swap.h"
+#include "strings/simd/load_store.h"
+#include "strings/simd/utf8_encode.h"
+#include "strings/simd/utf8_encode_tables.h"
+#include "strings/simd/utf_kernels.h"
+
+namespace longlp::base::internal::simd {
+// NOLINTBEGIN(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+namespace {
+  using LengthKernel = auto (*)(const CharUTF16*, size_t) -> TranscodeResult;
+  using Kernel       = auto (*)(const CharUTF16*, size_t, CharUTF8*, size_t)
+    -> TranscodeResult;
+
+  struct Kernels {
+    LengthKernel length;
+    Kernel transcode;
+  };
+
+  // Every step reads 8 code units, but keeps 16 available so that a surrogate
+  // pair straddling the block can be read. The overlapping stores of the
+  // widest block (3 bytes per unit) reach at most 28 bytes.
+  constexpr size_t kBlockSize    = 8;
+  constexpr size_t kRequiredSize = 16;
+  constexpr size_t kMaxBlockSize = 32;
+
+  // The length kernels count in 16-bit lanes, between -4 and 0 per code unit.
+  // They fold the lanes into the total every |kLengthFlushBlocks| blocks.
+  constexpr size_t kLengthFlushBlocks = size_t{1} << 12U;
+
+  // UTF-8 length of the code unit at |src[index]|. A lone surrogate takes 3
+  // bytes like the U+FFFD replacing it, a surrogate pair 3 + 1.
+  template <bool kSwapped>
+  constexpr auto UTF8Length(const CharUTF16* src, size_t index, size_t length)
+    -> size_t {
+    const uint32_t unit = LoadUnit<kSwapped>(src + index);
+    if (unit < 0x80) {
+      return 1;
+    }
+    if (unit < 0x800) {
+      return 2;
+    }
+    if ((unit & 0xFC00) == 0xD800 && index + 1 < length &&
+        (LoadUnit<kSwapped>(src + index + 1) & 0xFC00) == 0xDC00) {
+      return 1;
+    }
+    return 3;
+  }
+
+  auto UTF8LengthOfUTF16Scalar(const CharUTF16* /*src*/, size_t /*src_length*/)
+    -> TranscodeResult {
+    return {};
+  }
+
+  auto UTF16ToUTF8Scalar(
+    const CharUTF16* /*src*/,
+    size_t /*src_length*/,
+    CharUTF8* /*dest*/,
+    size_t /*dest_length*/) -> TranscodeResult {
+    return {};
+  }
+
+  // Encodes a block that contains surrogates one unit at a time. A pair may
+  // end one unit after the block. Stops in front of a lone surrogate.
+  template <bool kSwapped>
+  inline auto EncodeSurrogateBlock(const CharUTF16* src, CharUTF8* dest)
+    -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read < kBlockSize) {
+      const uint32_t unit = LoadUnit<kSwapped>(src + result.read);
+      if ((unit & 0xF800) != 0xD800) {
+        result.written += EncodeUTF8(unit, dest + result.written);
+        result.read += 1;
+        continue;
+      }
+      const uint32_t trail = LoadUnit<kSwapped>(src + result.read + 1);
+      if ((unit & 0xFC00) != 0xD800 || (trail & 0xFC00) != 0xDC00) {
+        break;
+      }
+      result.written += EncodeUTF8(
+        (((unit & 0x3FF) << 10) | (trail & 0x3FF)) + 0x10000,
+        dest + result.written);
+      result.read += 2;
+    }
+    return result;
+  }
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+  // Classifies the 8 code units at |src| and encodes them with the cheapest
+  // block encoder. Returns an empty result when the block starts with a lone
+  // surrogate.
+  template <bool kSwapped>
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto StepSSE42(const CharUTF16* src, CharUTF8* dest)
+    -> TranscodeResult {
+    const __m128i input = LoadSSE42<kSwapped>(src);
+
+    // ASCII block.
+    if (_mm_testz_si128(input, _mm_set1_epi16(static_cast<int16_t>(0xFF80)))) {
+      StoreUnalignedLow64(dest, _mm_packus_epi16(input, input));
+      return {kBlockSize, kBlockSize};
+    }
+
+    // 1 or 2 bytes block.
+    if (_mm_testz_si128(input, _mm_set1_epi16(static_cast<int16_t>(0xF800)))) {
+      const __m128i is_ascii = _mm_cmpeq_epi16(
+        _mm_and_si128(input, _mm_set1_epi16(static_cast<int16_t>(0xFF80))),
+        _mm_setzero_si128());
+      const __m128i two_bytes = _mm_or_si128(
+        _mm_or_si128(_mm_srli_epi16(input, 6), _mm_set1_epi16(0xC0)),
+        _mm_slli_epi16(
+          _mm_or_si128(
+            _mm_and_si128(input, _mm_set1_epi16(0x3F)),
+            _mm_set1_epi16(0x80)),
+          8));
+      const __m128i lanes = _mm_blendv_epi8(two_bytes, input, is_ascii);
+
+      const auto ascii_mask = static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_packs_epi16(is_ascii, is_ascii)) & 0xFF);
+      const auto& entry = kUTF8TwoByteCompactTable[ascii_mask];
+      StoreUnaligned(
+        dest,
+        _mm_shuffle_epi8(lanes, LoadUnaligned<__m128i>(entry.shuffle.data())));
+      return {kBlockSize, entry.length};
+    }
+
+    const __m128i high_bits =
+      _mm_and_si128(input, _mm_set1_epi16(static_cast<int16_t>(0xFC00)));
+    const __m128i leads = _mm_cmpeq_epi16(
+      high_bits,
+      _mm_set1_epi16(static_cast<int16_t>(0xD800)));
+    const __m128i trails = _mm_cmpeq_epi16(
+      high_bits,
+      _mm_set1_epi16(static_cast<int16_t>(0xDC00)));
+    const auto lead_mask  = static_cast<uint32_t>(_mm_movemask_epi8(leads));
+    const auto trail_mask = static_cast<uint32_t>(_mm_movemask_epi8(trails));
+
+    // 1, 2 or 3 bytes block.
+    if ((lead_mask | trail_mask) == 0) {
+      const size_t written = EncodeUpToThreeBytesSSE42(
+        _mm_cvtepu16_epi32(input),
+        dest);
+      return {
+        kBlockSize,
+        written + EncodeUpToThreeBytesSSE42(
+                    _mm_cvtepu16_epi32(_mm_srli_si128(input, 8)),
+                    dest + written)};
+    }
+
+    // Four surrogate pairs, e.g. a run of emoji. Each 32-bit lane holds the
+    // lead in its low half and the trail in its high half.
+    if (lead_mask == 0x3333 && trail_mask == 0xCCCC) {
+      const __m128i code_points = _mm_add_epi32(
+        _mm_or_si128(
+          _mm_slli_epi32(_mm_and_si128(input, _mm_set1_epi32(0x3FF)), 10),
+          _mm_and_si128(_mm_srli_epi32(input, 16), _mm_set1_epi32(0x3FF))),
+        _mm_set1_epi32(0x10000));
+      StoreUnaligned(dest, EncodeFourBytesSSE42(code_points));
+      return {kBlockSize, 16};
+    }
+
+    return EncodeSurrogateBlock<kSwapped>(src, dest);
+  }
+
+  // Runs StepSSE42() until |result| reaches |stop| or the end of the usable
+  // input or output. Returns false when it stopped in front of a lone
+  // surrogate or at the end of the output.
+  template <bool kSwapped>
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto StepsSSE42(
+    const CharUTF16* src,
+    size_t src_length,
+    size_t stop,
+    CharUTF8* dest,
+    size_t dest_length,
+    TranscodeResult& result) -> bool {
+    while (result.read < stop && result.read + kRequiredSize <= src_length) {
+      if (result.written + kMaxBlockSize > dest_length) {
+        return false;
+      }
+      const auto step =
+        StepSSE42<kSwapped>(src + result.read, dest + result.written);
+      if (step.read == 0) {
+        return false;
+      }
+      result.read += step.read;
+      result.written += step.written;
+    }
+    return true;
+  }
+
+  // Per 16-bit lane, minus the number of bytes below 3 the code unit takes.
+  // |next| holds the code units one position further, to see surrogate pairs.
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto MissingBytesSSE42(__m128i units, __m128i next)
+    -> __m128i {
+    const __m128i high_bits = _mm_set1_epi16(static_cast<int16_t>(0xFC00));
+    const __m128i pair      = _mm_and_si128(
+      _mm_cmpeq_epi16(
+        _mm_and_si128(units, high_bits),
+        _mm_set1_epi16(static_cast<int16_t>(0xD800))),
+      _mm_cmpeq_epi16(
+        _mm_and_si128(next, high_bits),
+        _mm_set1_epi16(static_cast<int16_t>(0xDC00))));
+    return _mm_add_epi16(
+      _mm_add_epi16(
+        _mm_cmpeq_epi16(_mm_min_epu16(units, _mm_set1_epi16(0x7F)), units),
+        _mm_cmpeq_epi16(_mm_min_epu16(units, _mm_set1_epi16(0x7FF)), units)),
+      _mm_add_epi16(pair, pair));
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto HorizontalSumSSE42(__m128i lanes) -> int64_t {
+    // madd widens the signed 16-bit lanes to 32 bits.
+    lanes = _mm_madd_epi16(lanes, _mm_set1_epi16(1));
+    lanes = _mm_add_epi32(lanes, _mm_srli_si128(lanes, 8));
+    lanes = _mm_add_epi32(lanes, _mm_srli_si128(lanes, 4));
+    return _mm_cvtsi128_si32(lanes);
+  }
+
+  // The blocks need one more code unit to see a pair straddling them.
+  template <bool kSwapped>
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto UTF8LengthOfUTF16SSE42(const CharUTF16* src, size_t src_length)
+    -> TranscodeResult {
+    TranscodeResult result;
+    int64_t missing = 0;
+    while (result.read + kBlockSize < src_length) {
+      __m128i lanes = _mm_setzero_si128();
+      for (size_t block = 0;
+           block < kLengthFlushBlocks && result.read + kBlockSize < src_length;
+           ++block, result.read += kBlockSize) {
+        lanes = _mm_add_epi16(
+          lanes,
+          MissingBytesSSE42(
+            LoadSSE42<kSwapped>(src + result.read),
+            LoadSSE42<kSwapped>(src + result.read + 1)));
+      }
+      missing += HorizontalSumSSE42(lanes);
+    }
+    result.written = static_cast<size_t>(
+      static_cast<int64_t>(3 * result.read) + missing);
+    return result;
+  }
+
+  template <bool kSwapped>
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto UTF16ToUTF8SSE42(
+    const CharUTF16* src,
+    size_t src_length,
+    CharUTF8* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    StepsSSE42<kSwapped>(
+      src,
+      src_length,
+      src_length,
+      dest,
+      dest_length,
+      result);
+    return result;
+  }
+
+  template <bool kSwapped>
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto UTF8LengthOfUTF16AVX2(const CharUTF16* src, size_t src_length)
+    -> TranscodeResult {
+    TranscodeResult result;
+    int64_t missing = 0;
+    while (result.read + 2 * kBlockSize < src_length) {
+      __m256i lanes = _mm256_setzero_si256();
+      for (size_t block = 0; block < kLengthFlushBlocks &&
+                             result.read + 2 * kBlockSize < src_length;
+           ++block, result.read += 2 * kBlockSize) {
+        const __m256i units = LoadAVX2<kSwapped>(src + result.read);
+        const __m256i next  = LoadAVX2<kSwapped>(src + result.read + 1);
+        const __m256i high_bits =
+          _mm256_set1_epi16(static_cast<int16_t>(0xFC00));
+        const __m256i pair = _mm256_and_si256(
+          _mm256_cmpeq_epi16(
+            _mm256_and_si256(units, high_bits),
+            _mm256_set1_epi16(static_cast<int16_t>(0xD800))),
+          _mm256_cmpeq_epi16(
+            _mm256_and_si256(next, high_bits),
+            _mm256_set1_epi16(static_cast<int16_t>(0xDC00))));
+        lanes = _mm256_add_epi16(
+          lanes,
+          _mm256_add_epi16(
+            _mm256_add_epi16(
+              _mm256_cmpeq_epi16(
+                _mm256_min_epu16(units, _mm256_set1_epi16(0x7F)),
+                units),
+              _mm256_cmpeq_epi16(
+                _mm256_min_epu16(units, _mm256_set1_epi16(0x7FF)),
+                units)),
+            _mm256_add_epi16(pair, pair)));
+      }
+      missing += HorizontalSumSSE42(_mm_add_epi16(
+        _mm256_castsi256_si128(lanes),
+        _mm256_extracti128_si256(lanes, 1)));
+    }
+    result.written = static_cast<size_t>(
+      static_cast<int64_t>(3 * result.read) + missing);
+    return result;
+  }
+
+  template <bool kSwapped>
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto UTF16ToUTF8AVX2(
+    const CharUTF16* src,
+    size_t src_length,
+    CharUTF8* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + kRequiredSize <= src_length &&
+           result.written + kMaxBlockSize <= dest_length) {
+      const __m256i input = LoadAVX2<kSwapped>(src + result.read);
+      if (_mm256_testz_si256(
+            input,
+            _mm256_set1_epi16(static_cast<int16_t>(0xFF80)))) {
+        StoreUnaligned(
+          dest + result.written,
+          _mm_packus_epi16(
+            _mm256_castsi256_si128(input),
+            _mm256_extracti128_si256(input, 1)));
+        result.read += 16;
+        result.written += 16;
+        continue;
+      }
+
+      // Do not probe the same units twice, text that is not ASCII tends to
+      // stay so.
+      if (!StepsSSE42<kSwapped>(
+            src,
+            src_length,
+            result.read + 16,
+            dest,
+            dest_length,
+            result)) {
+        break;
+      }
+    }
+    return result;
+  }
+
+  template <bool kSwapped>
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  auto UTF8LengthOfUTF16AVX512(const CharUTF16* src, size_t src_length)
+    -> TranscodeResult {
+    TranscodeResult result;
+    size_t missing = 0;
+    for (; result.read + 32 < src_length; result.read += 32) {
+      const __m512i units = LoadAVX512<kSwapped>(src + result.read);
+      const __m512i next  = LoadAVX512<kSwapped>(src + result.read + 1);
+      const __m512i high_bits =
+        _mm512_set1_epi16(static_cast<int16_t>(0xFC00));
+      const __mmask32 pair =
+        _mm512_cmpeq_epi16_mask(
+          _mm512_and_si512(units, high_bits),
+          _mm512_set1_epi16(static_cast<int16_t>(0xD800))) &
+        _mm512_cmpeq_epi16_mask(
+          _mm512_and_si512(next, high_bits),
+          _mm512_set1_epi16(static_cast<int16_t>(0xDC00)));
+      missing += static_cast<size_t>(
+        std::popcount(_mm512_cmple_epu16_mask(units, _mm512_set1_epi16(0x7F))) +
+        std::popcount(
+          _mm512_cmple_epu16_mask(units, _mm512_set1_epi16(0x7FF))) +
+        2 * std::popcount(pair));
+    }
+    result.written = 3 * result.read - missing;
+    return result;
+  }
+
+  template <bool kSwapped>
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  auto UTF16ToUTF8AVX512(
+    const CharUTF16* src,
+    size_t src_length,
+    CharUTF8* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + kRequiredSize <= src_length &&
+           result.written + kMaxBlockSize <= dest_length) {
+      if (result.read + 32 <= src_length) {
+        const __m512i input = LoadAVX512<kSwapped>(src + result.read);
+        if (_mm512_test_epi16_mask(
+              input,
+              _mm512_set1_epi16(static_cast<int16_t>(0xFF80))) == 0) {
+          StoreUnaligned(
+            dest + result.written,
+            _mm512_maskz_cvtepi16_epi8(~__mmask32{0}, input));
+          result.read += 32;
+          result.written += 32;
+          continue;
+        }
+      }
+
+      if (!StepsSSE42<kSwapped>(
+            src,
+            src_length,
+            result.read + 32,
+            dest,
+            dest_length,
+            result)) {
+        break;
+      }
+    }
+    return result;
+  }
+#endif    // defined(LONGLP_ARCH_CPU_X86_FAMILY)
+
+#if defined(LONGLP_ARCH_CPU_ARM64)
+  // See StepSSE42().
+  template <bool kSwapped>
+  inline auto StepNEON(const CharUTF16* src, CharUTF8* dest)
+    -> TranscodeResult {
+    const uint16x8_t input = LoadNEON<kSwapped>(src);
+    auto* out              = reinterpret_cast<uint8_t*>(dest);
+    const uint16_t max     = vmaxvq_u16(input);
+
+    if (max < 0x80) {
+      vst1_u8(out, vmovn_u16(input));
+      return {kBlockSize, kBlockSize};
+    }
+
+    if (max < 0x800) {
+      const uint16x8_t is_ascii  = vcltq_u16(input, vdupq_n_u16(0x80));
+      const uint16x8_t two_bytes = vorrq_u16(
+        vorrq_u16(vshrq_n_u16(input, 6), vdupq_n_u16(0xC0)),
+        vshlq_n_u16(
+          vorrq_u16(vandq_u16(input, vdupq_n_u16(0x3F)), vdupq_n_u16(0x80)),
+          8));
+      const uint16x8_t lanes = vbslq_u16(is_ascii, input, two_bytes);
+
+      constexpr std::array<uint16_t, 8> kLaneBits = {
+        1, 2, 4, 8, 16, 32, 64, 128};
+      const uint32_t ascii_mask =
+        vaddvq_u16(vandq_u16(is_ascii, vld1q_u16(kLaneBits.data())));
+      const auto& entry = kUTF8TwoByteCompactTable[ascii_mask];
+      vst1q_u8(
+        out,
+        vqtbl1q_u8(vreinterpretq_u8_u16(lanes), vld1q_u8(entry.shuffle.data())));
+      return {kBlockSize, entry.length};
+    }
+
+    const uint16x8_t high_bits = vandq_u16(input, vdupq_n_u16(0xF800));
+    if (vmaxvq_u16(vceqq_u16(high_bits, vdupq_n_u16(0xD800))) == 0) {
+      const size_t written =
+        EncodeUpToThreeBytesNEON(vmovl_u16(vget_low_u16(input)), dest);
+      return {
+        kBlockSize,
+        written +
+          EncodeUpToThreeBytesNEON(vmovl_high_u16(input), dest + written)};
+    }
+
+    return EncodeSurrogateBlock<kSwapped>(src, dest);
+  }
+
+  template <bool kSwapped>
+  auto UTF8LengthOfUTF16NEON(const CharUTF16* src, size_t src_length)
+    -> TranscodeResult {
+    TranscodeResult result;
+    int64_t missing = 0;
+    while (result.read + kBlockSize < src_length) {
+      int16x8_t lanes = vdupq_n_s16(0);
+      for (size_t block = 0;
+           block < kLengthFlushBlocks && result.read + kBlockSize < src_length;
+           ++block, result.read += kBlockSize) {
+        const uint16x8_t units     = LoadNEON<kSwapped>(src + result.read);
+        const uint16x8_t next      = LoadNEON<kSwapped>(src + result.read + 1);
+        const uint16x8_t high_bits = vdupq_n_u16(0xFC00);
+        const uint16x8_t pair      = vandq_u16(
+          vceqq_u16(vandq_u16(units, high_bits), vdupq_n_u16(0xD800)),
+          vceqq_u16(vandq_u16(next, high_bits), vdupq_n_u16(0xDC00)));
+        const uint16x8_t lane_missing = vaddq_u16(
+          vaddq_u16(
+            vcleq_u16(units, vdupq_n_u16(0x7F)),
+            vcleq_u16(units, vdupq_n_u16(0x7FF))),
+          vaddq_u16(pair, pair));
+        lanes = vaddq_s16(lanes, vreinterpretq_s16_u16(lane_missing));
+      }
+      missing += vaddlvq_s16(lanes);
+    }
+    result.written = static_cast<size_t>(
+      static_cast<int64_t>(3 * result.read) + missing);
+    return result;
+  }
+
+  template <bool kSwapped>
+  auto UTF16ToUTF8NEON(
+    const CharUTF16* src,
+    size_t src_length,
+    CharUTF8* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + kRequiredSize <= src_length &&
+           result.written + kMaxBlockSize <= dest_length) {
+      const auto step =
+        StepNEON<kSwapped>(src + result.read, dest + result.written);
+      if (step.read == 0) {
+        break;
+      }
+      result.read += step.read;
+      result.written += step.written;
+    }
+    return result;
+  }
+#endif    // defined(LONGLP_ARCH_CPU_ARM64)
+
+  template <bool kSwapped>
+  auto SelectKernels() -> Kernels {
+    [[maybe_unused]] const auto& cpu = CPU::GetInstanceNoAllocation();
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+    if (cpu.has_avx512bw()) {
+      return {
+        &UTF8LengthOfUTF16AVX512<kSwapped>,
+        &UTF16ToUTF8AVX512<kSwapped>};
+    }
+    if (cpu.has_avx2()) {
+      return {
+        &UTF8LengthOfUTF16AVX2<kSwapped>,
+        &UTF16ToUTF8AVX2<kSwapped>};
+    }
+    if (cpu.has_sse42()) {
+      return {
+        &UTF8LengthOfUTF16SSE42<kSwapped>,
+        &UTF16ToUTF8SSE42<kSwapped>};
+    }
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+    if (cpu.has_neon()) {
+      return {
+        &UTF8LengthOfUTF16NEON<kSwapped>,
+        &UTF16ToUTF8NEON<kSwapped>};
+    }
+#endif
+    return {&UTF8LengthOfUTF16Scalar, &UTF16ToUTF8Scalar};
+  }
+
+  template <bool kSwapped>
+  auto GetKernels() -> const Kernels& {
+    static const Kernels kKernels = SelectKernels<kSwapped>();
+    return kKernels;
+  }
+
+  template <bool kSwapped>
+  auto UTF8LengthOfUTF16Impl(const CharUTF16* src, size_t src_length)
+    -> size_t {
+    auto [read, length] = GetKernels<kSwapped>().length(src, src_length);
+    for (; read < src_length; ++read) {
+      length += UTF8Length<kSwapped>(src, read, src_length);
+    }
+    return length;
+  }
+}    // namespace
+
+auto UTF8LengthOfUTF16(const CharUTF16* src, size_t src_length) -> size_t {
+  return UTF8LengthOfUTF16Impl<false>(src, src_length);
+}
+
+auto UTF8LengthOfSwappedUTF16(const CharUTF16* src, size_t src_length)
+  -> size_t {
+  return UTF8LengthOfUTF16Impl<true>(src, src_length);
+}
+
+auto UTF16ToUTF8(
+  const CharUTF16* src,
+  size_t src_length,
+  CharUTF8* dest,
+  size_t dest_length) -> TranscodeResult {
+  return GetKernels<false>().transcode(src, src_length, dest, dest_length);
+}
+
+auto SwappedUTF16ToUTF8(
+  const CharUTF16* src,
+  size_t src_length,
+  CharUTF8* dest,
+  size_t dest_length) -> TranscodeResult {
+  return GetKernels<true>().transcode(src, src_length, dest, dest_length);
+}
+
+// NOLINTEND(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}    // namespace longlp::base::internal::simd
@@ -0,0 +1,487 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <bit>
+#include <cstdint>
+
+#include "base/compiler_specific.h"
+#include "base/cpu.h"
+#include "base/predef.h"
+#include "strings/simd/load_store.h"
+#include "strings/simd/utf_kernels.h"
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+#  include <immintrin.h>
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+#  include <arm_neon.h>
+#endif
+
+namespace longlp::base::internal::simd {
+// NOLINTBEGIN(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+namespace {
+  using LengthKernel = auto (*)(const CharUTF32*, size_t) -> TranscodeResult;
+  using Kernel       = auto (*)(const CharUTF32*, size_t, CharUTF16*, size_t)
+    -> TranscodeResult;
+
+  struct Kernels {
+    LengthKernel length;
+    Kernel transcode;
+  };
+
+  // Every step reads 8 code points and writes at most 16 code units.
+  constexpr size_t kBlockSize    = 8;
+  constexpr size_t kMaxBlockSize = 16;
+
+  // See utf32_to_utf8.cpp.
+  constexpr size_t kLengthFlushBlocks = size_t{1} << 20U;
+
+  constexpr auto IsSupplementary(uint32_t code_point) -> bool {
+    return code_point >= 0x10000 && code_point <= 0x10FFFF;
+  }
+
+  constexpr auto IsScalarValue(uint32_t code_point) -> bool {
+    return code_point <= 0x10FFFF && (code_point & 0xFFFFF800) != 0xD800;
+  }
+
+  auto UTF16LengthOfUTF32Scalar(
+    const CharUTF32* /*src*/,
+    size_t /*src_length*/) -> TranscodeResult {
+    return {};
+  }
+
+  auto UTF32ToUTF16Scalar(
+    const CharUTF32* /*src*/,
+    size_t /*src_length*/,
+    CharUTF16* /*dest*/,
+    size_t /*dest_length*/) -> TranscodeResult {
+    return {};
+  }
+
+  // Encodes |count| code points one at a time. Stops in front of a code point
+  // that is not a Unicode scalar value.
+  inline auto EncodeBlock(const CharUTF32* src, size_t count, CharUTF16* dest)
+    -> TranscodeResult {
+    TranscodeResult result;
+    for (; result.read < count; ++result.read) {
+      const uint32_t code_point = src[result.read];
+      if (!IsScalarValue(code_point)) {
+        break;
+      }
+      if (code_point < 0x10000) {
+        dest[result.written++] = static_cast<CharUTF16>(code_point);
+      }
+      else {
+        dest[result.written++] = static_cast<CharUTF16>(
+          0xD7C0 + (code_point >> 10));
+        dest[result.written++] = static_cast<CharUTF16>(
+          0xDC00 | (code_point & 0x3FF));
+      }
+    }
+    return result;
+  }
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+  // Lanes holding |code_points| >= |bound|, compared as unsigned.
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto AtLeastSSE42(__m128i code_points, uint32_t bound)
+    -> __m128i {
+    return _mm_cmpeq_epi32(
+      _mm_max_epu32(code_points, _mm_set1_epi32(static_cast<int32_t>(bound))),
+      code_points);
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto SupplementarySSE42(__m128i code_points)
+    -> __m128i {
+    return _mm_and_si128(
+      AtLeastSSE42(code_points, 0x10000),
+      _mm_cmpeq_epi32(
+        _mm_min_epu32(code_points, _mm_set1_epi32(0x10FFFF)),
+        code_points));
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto HorizontalSumSSE42(__m128i lanes) -> size_t {
+    lanes = _mm_add_epi32(lanes, _mm_srli_si128(lanes, 8));
+    lanes = _mm_add_epi32(lanes, _mm_srli_si128(lanes, 4));
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(lanes));
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto UTF16LengthOfUTF32SSE42(const CharUTF32* src, size_t src_length)
+    -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + 4 <= src_length) {
+      __m128i pairs = _mm_setzero_si128();
+      for (size_t block = 0;
+           block < kLengthFlushBlocks && result.read + 4 <= src_length;
+           ++block, result.read += 4) {
+        pairs = _mm_sub_epi32(
+          pairs,
+          SupplementarySSE42(LoadUnaligned<__m128i>(src + result.read)));
+      }
+      result.written += HorizontalSumSSE42(pairs);
+    }
+    result.written += result.read;
+    return result;
+  }
+
+  // Encodes the four code points of |code_points| (loaded from |src|) as
+  // surrogate pairs when they are all supplementary.
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto EncodeHalfSSE42(
+    __m128i code_points,
+    const CharUTF32* src,
+    CharUTF16* dest) -> TranscodeResult {
+    if (_mm_movemask_epi8(SupplementarySSE42(code_points)) == 0xFFFF) {
+      // Each 32-bit lane becomes the lead in its low half and the trail in
+      // its high half.
+      const __m128i leads = _mm_add_epi32(
+        _mm_srli_epi32(code_points, 10),
+        _mm_set1_epi32(0xD7C0));
+      const __m128i trails = _mm_or_si128(
+        _mm_and_si128(code_points, _mm_set1_epi32(0x3FF)),
+        _mm_set1_epi32(0xDC00));
+      StoreUnaligned(dest, _mm_or_si128(leads, _mm_slli_epi32(trails, 16)));
+      return {4, 8};
+    }
+    return EncodeBlock(src, 4, dest);
+  }
+
+  // Encodes the 8 code points at |src|. Stops in front of the first one that
+  // is not a Unicode scalar value.
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto StepSSE42(const CharUTF32* src, CharUTF16* dest)
+    -> TranscodeResult {
+    const __m128i low  = LoadUnaligned<__m128i>(src);
+    const __m128i high = LoadUnaligned<__m128i>(src + 4);
+    const __m128i max = _mm_max_epu32(low, high);
+
+    // BMP block without surrogates: the code points fit 16 bits, the
+    // saturating pack only narrows them.
+    const __m128i surrogate_bits =
+      _mm_set1_epi32(static_cast<int32_t>(0xFFFFF800));
+    const __m128i surrogates = _mm_or_si128(
+      _mm_cmpeq_epi32(
+        _mm_and_si128(low, surrogate_bits),
+        _mm_set1_epi32(0xD800)),
+      _mm_cmpeq_epi32(
+        _mm_and_si128(high, surrogate_bits),
+        _mm_set1_epi32(0xD800)));
+    if (_mm_testz_si128(max, _mm_set1_epi32(static_cast<int32_t>(0xFFFF0000))) &&
+        _mm_testz_si128(surrogates, surrogates)) {
+      StoreUnaligned(dest, _mm_packus_epi32(low, high));
+      return {kBlockSize, kBlockSize};
+    }
+
+    const auto first = EncodeHalfSSE42(low, src, dest);
+    if (first.read < 4) {
+      return first;
+    }
+    const auto second = EncodeHalfSSE42(high, src + 4, dest + first.written);
+    return {first.read + second.read, first.written + second.written};
+  }
+
+  // Runs StepSSE42() until |result| reaches |stop|, the end of the input or
+  // the end of the output. Returns false when it stopped in front of an
+  // invalid code point.
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto StepsSSE42(
+    const CharUTF32* src,
+    size_t src_length,
+    size_t stop,
+    CharUTF16* dest,
+    size_t dest_length,
+    TranscodeResult& result) -> bool {
+    while (result.read < stop && result.read + kBlockSize <= src_length &&
+           result.written + kMaxBlockSize <= dest_length) {
+      const auto step = StepSSE42(src + result.read, dest + result.written);
+      if (step.read == 0) {
+        return false;
+      }
+      result.read += step.read;
+      result.written += step.written;
+    }
+    return true;
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto UTF32ToUTF16SSE42(
+    const CharUTF32* src,
+    size_t src_length,
+    CharUTF16* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    StepsSSE42(src, src_length, src_length, dest, dest_length, result);
+    return result;
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto UTF16LengthOfUTF32AVX2(const CharUTF32* src, size_t src_length)
+    -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + 8 <= src_length) {
+      __m256i pairs = _mm256_setzero_si256();
+      for (size_t block = 0;
+           block < kLengthFlushBlocks && result.read + 8 <= src_length;
+           ++block, result.read += 8) {
+        const __m256i code_points = LoadUnaligned<__m256i>(src + result.read);
+        const __m256i above = _mm256_cmpeq_epi32(
+          _mm256_max_epu32(code_points, _mm256_set1_epi32(0x10000)),
+          code_points);
+        const __m256i below = _mm256_cmpeq_epi32(
+          _mm256_min_epu32(code_points, _mm256_set1_epi32(0x10FFFF)),
+          code_points);
+        pairs = _mm256_sub_epi32(pairs, _mm256_and_si256(above, below));
+      }
+      result.written += HorizontalSumSSE42(_mm_add_epi32(
+        _mm256_castsi256_si128(pairs),
+        _mm256_extracti128_si256(pairs, 1)));
+    }
+    result.written += result.read;
+    return result;
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto UTF32ToUTF16AVX2(
+    const CharUTF32* src,
+    size_t src_length,
+    CharUTF16* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + 2 * kBlockSize <= src_length &&
+           result.written + kMaxBlockSize <= dest_length) {
+      const __m256i low  = LoadUnaligned<__m256i>(src + result.read);
+      const __m256i high = LoadUnaligned<__m256i>(src + result.read + 8);
+      const __m256i surrogate_bits =
+        _mm256_set1_epi32(static_cast<int32_t>(0xFFFFF800));
+      const __m256i surrogates = _mm256_or_si256(
+        _mm256_cmpeq_epi32(
+          _mm256_and_si256(low, surrogate_bits),
+          _mm256_set1_epi32(0xD800)),
+        _mm256_cmpeq_epi32(
+          _mm256_and_si256(high, surrogate_bits),
+          _mm256_set1_epi32(0xD800)));
+      if (_mm256_testz_si256(
+            _mm256_or_si256(low, high),
+            _mm256_set1_epi32(static_cast<int32_t>(0xFFFF0000))) &&
+          _mm256_testz_si256(surrogates, surrogates)) {
+        // packus works within 128-bit lanes, the permute restores the order.
+        StoreUnaligned(
+          dest + result.written,
+          _mm256_permute4x64_epi64(_mm256_packus_epi32(low, high), 0xD8));
+        result.read += 16;
+        result.written += 16;
+        continue;
+      }
+
+      if (!StepsSSE42(
+            src,
+            src_length,
+            result.read + 2 * kBlockSize,
+            dest,
+            dest_length,
+            result)) {
+        return result;
+      }
+    }
+    StepsSSE42(src, src_length, src_length, dest, dest_length, result);
+    return result;
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  auto UTF16LengthOfUTF32AVX512(const CharUTF32* src, size_t src_length)
+    -> TranscodeResult {
+    TranscodeResult result;
+    for (; result.read + 16 <= src_length; result.read += 16) {
+      const __m512i code_points = LoadUnaligned<__m512i>(src + result.read);
+      const __mmask16 supplementary =
+        _mm512_cmpge_epu32_mask(code_points, _mm512_set1_epi32(0x10000)) &
+        _mm512_cmple_epu32_mask(code_points, _mm512_set1_epi32(0x10FFFF));
+      result.written +=
+        static_cast<size_t>(std::popcount(static_cast<uint32_t>(supplementary)));
+    }
+    result.written += result.read;
+    return result;
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  auto UTF32ToUTF16AVX512(
+    const CharUTF32* src,
+    size_t src_length,
+    CharUTF16* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + 2 * kBlockSize <= src_length &&
+           result.written + kMaxBlockSize <= dest_length) {
+      const __m512i code_points = LoadUnaligned<__m512i>(src + result.read);
+      const __mmask16 outside_bmp = _mm512_test_epi32_mask(
+        code_points,
+        _mm512_set1_epi32(static_cast<int32_t>(0xFFFF0000)));
+      const __mmask16 surrogates = _mm512_cmpeq_epi32_mask(
+        _mm512_and_si512(
+          code_points,
+          _mm512_set1_epi32(static_cast<int32_t>(0xFFFFF800))),
+        _mm512_set1_epi32(0xD800));
+      if ((outside_bmp | surrogates) == 0) {
+        StoreUnaligned(
+          dest + result.written,
+          _mm512_maskz_cvtepi32_epi16(
+            static_cast<__mmask16>(0xFFFF),
+            code_points));
+        result.read += 16;
+        result.written += 16;
+        continue;
+      }
+
+      if (!StepsSSE42(
+            src,
+            src_length,
+            result.read + 2 * kBlockSize,
+            dest,
+            dest_length,
+            result)) {
+        return result;
+      }
+    }
+    StepsSSE42(src, src_length, src_length, dest, dest_length, result);
+    return result;
+  }
+#endif    // defined(LONGLP_ARCH_CPU_X86_FAMILY)
+
+#if defined(LONGLP_ARCH_CPU_ARM64)
+  auto UTF16LengthOfUTF32NEON(const CharUTF32* src, size_t src_length)
+    -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + 4 <= src_length) {
+      uint32x4_t pairs = vdupq_n_u32(0);
+      for (size_t block = 0;
+           block < kLengthFlushBlocks && result.read + 4 <= src_length;
+           ++block, result.read += 4) {
+        const uint32x4_t code_points =
+          vld1q_u32(reinterpret_cast<const uint32_t*>(src + result.read));
+        pairs = vsubq_u32(
+          pairs,
+          vandq_u32(
+            vcgeq_u32(code_points, vdupq_n_u32(0x10000)),
+            vcleq_u32(code_points, vdupq_n_u32(0x10FFFF))));
+      }
+      result.written += vaddvq_u32(pairs);
+    }
+    result.written += result.read;
+    return result;
+  }
+
+  // See EncodeHalfSSE42().
+  inline auto EncodeHalfNEON(
+    uint32x4_t code_points,
+    const CharUTF32* src,
+    CharUTF16* dest) -> TranscodeResult {
+    if (vminvq_u32(code_points) >= 0x10000 &&
+        vmaxvq_u32(code_points) <= 0x10FFFF) {
+      const uint32x4_t leads =
+        vaddq_u32(vshrq_n_u32(code_points, 10), vdupq_n_u32(0xD7C0));
+      const uint32x4_t trails = vorrq_u32(
+        vandq_u32(code_points, vdupq_n_u32(0x3FF)),
+        vdupq_n_u32(0xDC00));
+      vst1q_u16(
+        reinterpret_cast<uint16_t*>(dest),
+        vreinterpretq_u16_u32(vorrq_u32(leads, vshlq_n_u32(trails, 16))));
+      return {4, 8};
+    }
+    return EncodeBlock(src, 4, dest);
+  }
+
+  // See StepSSE42().
+  inline auto StepNEON(const CharUTF32* src, CharUTF16* dest)
+    -> TranscodeResult {
+    const auto* input     = reinterpret_cast<const uint32_t*>(src);
+    const uint32x4_t low  = vld1q_u32(input);
+    const uint32x4_t high = vld1q_u32(input + 4);
+
+    const uint32x4_t surrogate_bits = vdupq_n_u32(0xFFFFF800);
+    const uint32x4_t surrogates     = vorrq_u32(
+      vceqq_u32(vandq_u32(low, surrogate_bits), vdupq_n_u32(0xD800)),
+      vceqq_u32(vandq_u32(high, surrogate_bits), vdupq_n_u32(0xD800)));
+    if (vmaxvq_u32(vmaxq_u32(low, high)) < 0x10000 &&
+        vmaxvq_u32(surrogates) == 0) {
+      vst1q_u16(
+        reinterpret_cast<uint16_t*>(dest),
+        vcombine_u16(vmovn_u32(low), vmovn_u32(high)));
+      return {kBlockSize, kBlockSize};
+    }
+
+    const auto first = EncodeHalfNEON(low, src, dest);
+    if (first.read < 4) {
+      return first;
+    }
+    const auto second = EncodeHalfNEON(high, src + 4, dest + first.written);
+    return {first.read + second.read, first.written + second.written};
+  }
+
+  auto UTF32ToUTF16NEON(
+    const CharUTF32* src,
+    size_t src_length,
+    CharUTF16* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + kBlockSize <= src_length &&
+           result.written + kMaxBlockSize <= dest_length) {
+      const auto step = StepNEON(src + result.read, dest + result.written);
+      if (step.read == 0) {
+        break;
+      }
+      result.read += step.read;
+      result.written += step.written;
+    }
+    return result;
+  }
+#endif    // defined(LONGLP_ARCH_CPU_ARM64)
+
+  auto SelectKernels() -> Kernels {
+    [[maybe_unused]] const auto& cpu = CPU::GetInstanceNoAllocation();
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+    if (cpu.has_avx512bw()) {
+      return {&UTF16LengthOfUTF32AVX512, &UTF32ToUTF16AVX512};
+    }
+    if (cpu.has_avx2()) {
+      return {&UTF16LengthOfUTF32AVX2, &UTF32ToUTF16AVX2};
+    }
+    if (cpu.has_sse42()) {
+      return {&UTF16LengthOfUTF32SSE42, &UTF32ToUTF16SSE42};
+    }
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+    if (cpu.has_neon()) {
+      return {&UTF16LengthOfUTF32NEON, &UTF32ToUTF16NEON};
+    }
+#endif
+    return {&UTF16LengthOfUTF32Scalar, &UTF32ToUTF16Scalar};
+  }
+
+  auto GetKernels() -> const Kernels& {
+    static const Kernels kKernels = SelectKernels();
+    return kKernels;
+  }
+}    // namespace
+
+auto UTF16LengthOfUTF32(const CharUTF32* src, size_t src_length) -> size_t {
+  auto [read, length] = GetKernels().length(src, src_length);
+  for (; read < src_length; ++read) {
+    length += IsSupplementary(src[read]) ? 2U : 1U;
+  }
+  return length;
+}
+
+auto UTF32ToUTF16(
+  const CharUTF32* src,
+  size_t src_length,
+  CharUTF16* dest,
+  size_t dest_length) -> TranscodeResult {
+  return GetKernels().transcode(src, src_length, dest, dest_length);
+}
+
+// NOLINTEND(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}    // namespace longlp::base::internal::simd
@@ -0,0 +1,578 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <bit>
+#include <cstdint>
+
+#include "base/compiler_specific.h"
+#include "base/cpu.h"
+#include "base/predef.h"
+#include "strings/simd/byte_swap.h"
+#include "strings/simd/load_store.h"
+#include "strings/simd/utf8_encode.h"
+#include "strings/simd/utf_kernels.h"
+
+namespace longlp::base::internal::simd {
+// NOLINTBEGIN(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+namespace {
+  using LengthKernel = auto (*)(const CharUTF32*, size_t) -> TranscodeResult;
+  using Kernel       = auto (*)(const CharUTF32*, size_t, CharUTF8*, size_t)
+    -> TranscodeResult;
+
+  struct Kernels {
+    LengthKernel length;
+    Kernel transcode;
+  };
+
+  // Every step reads 8 code points and writes at most 32 bytes.
+  constexpr size_t kBlockSize    = 8;
+  constexpr size_t kMaxBlockSize = 32;
+
+  // The length kernels count in 32-bit lanes, at most 3 per code point. They
+  // fold the lanes into the total every |kLengthFlushBlocks| blocks.
+  constexpr size_t kLengthFlushBlocks = size_t{1} << 20U;
+
+  constexpr auto UTF8Length(uint32_t code_point) -> size_t {
+    if (code_point < 0x80) {
+      return 1;
+    }
+    if (code_point < 0x800) {
+      return 2;
+    }
+    if (code_point < 0x10000 || code_point > 0x10FFFF) {
+      // U+FFFD replaces code points above U+10FFFF, and takes 3 bytes like
+      // the surrogates it replaces.
+      return 3;
+    }
+    return 4;
+  }
+
+  constexpr auto IsScalarValue(uint32_t code_point) -> bool {
+    return code_point <= 0x10FFFF && (code_point & 0xFFFFF800) != 0xD800;
+  }
+
+  auto UTF8LengthOfUTF32Scalar(const CharUTF32* /*src*/, size_t /*src_length*/)
+    -> TranscodeResult {
+    return {};
+  }
+
+  auto UTF32ToUTF8Scalar(
+    const CharUTF32* /*src*/,
+    size_t /*src_length*/,
+    CharUTF8* /*dest*/,
+    size_t /*dest_length*/) -> TranscodeResult {
+    return {};
+  }
+
+  // Encodes |count| code points one at a time. Stops in front of a code point
+  // that is not a Unicode scalar value.
+  template <bool kSwapped>
+  inline auto EncodeBlock(const CharUTF32* src, size_t count, CharUTF8* dest)
+    -> TranscodeResult {
+    TranscodeResult result;
+    for (; result.read < count; ++result.read) {
+      const uint32_t code_point = LoadUnit<kSwapped>(src + result.read);
+      if (!IsScalarValue(code_point)) {
+        break;
+      }
+      result.written += EncodeUTF8(code_point, dest + result.written);
+    }
+    return result;
+  }
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+  // Lanes holding |code_points| >= |bound|, compared as unsigned.
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto AtLeastSSE42(__m128i code_points, uint32_t bound)
+    -> __m128i {
+    return _mm_cmpeq_epi32(
+      _mm_max_epu32(code_points, _mm_set1_epi32(static_cast<int32_t>(bound))),
+      code_points);
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto HorizontalSumSSE42(__m128i lanes) -> size_t {
+    lanes = _mm_add_epi32(lanes, _mm_srli_si128(lanes, 8));
+    lanes = _mm_add_epi32(lanes, _mm_srli_si128(lanes, 4));
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(lanes));
+  }
+
+  // Number of bytes beyond the first one, per lane, as negative counts.
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto ExtraBytesSSE42(__m128i code_points) -> __m128i {
+    const __m128i supplementary = _mm_and_si128(
+      AtLeastSSE42(code_points, 0x10000),
+      _mm_cmpeq_epi32(
+        _mm_min_epu32(code_points, _mm_set1_epi32(0x10FFFF)),
+        code_points));
+    return _mm_add_epi32(
+      _mm_add_epi32(
+        AtLeastSSE42(code_points, 0x80),
+        AtLeastSSE42(code_points, 0x800)),
+      supplementary);
+  }
+
+  template <bool kSwapped>
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto UTF8LengthOfUTF32SSE42(const CharUTF32* src, size_t src_length)
+    -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + 4 <= src_length) {
+      __m128i extra = _mm_setzero_si128();
+      for (size_t block = 0;
+           block < kLengthFlushBlocks && result.read + 4 <= src_length;
+           ++block, result.read += 4) {
+        extra = _mm_sub_epi32(
+          extra,
+          ExtraBytesSSE42(LoadSSE42<kSwapped>(src + result.read)));
+      }
+      result.written += HorizontalSumSSE42(extra);
+    }
+    result.written += result.read;
+    return result;
+  }
+
+  // Encodes the four code points of |code_points| (loaded from |src|) with a
+  // vector encoder when they are all BMP or all supplementary.
+  template <bool kSwapped>
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto EncodeHalfSSE42(
+    __m128i code_points,
+    const CharUTF32* src,
+    CharUTF8* dest) -> TranscodeResult {
+    const __m128i invalid = _mm_or_si128(
+      AtLeastSSE42(code_points, 0x110000),
+      _mm_cmpeq_epi32(
+        _mm_and_si128(
+          code_points,
+          _mm_set1_epi32(static_cast<int32_t>(0xFFFFF800))),
+        _mm_set1_epi32(0xD800)));
+    if (_mm_testz_si128(invalid, invalid)) {
+      if (_mm_testz_si128(
+            code_points,
+            _mm_set1_epi32(static_cast<int32_t>(0xFFFF0000)))) {
+        return {4, EncodeUpToThreeBytesSSE42(code_points, dest)};
+      }
+      if (_mm_movemask_epi8(AtLeastSSE42(code_points, 0x10000)) == 0xFFFF) {
+        StoreUnaligned(dest, EncodeFourBytesSSE42(code_points));
+        return {4, 16};
+      }
+    }
+    return EncodeBlock<kSwapped>(src, 4, dest);
+  }
+
+  // Encodes the 8 code points at |src|. Stops in front of the first one that
+  // is not a Unicode scalar value.
+  template <bool kSwapped>
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto StepSSE42(const CharUTF32* src, CharUTF8* dest)
+    -> TranscodeResult {
+    const __m128i low  = LoadSSE42<kSwapped>(src);
+    const __m128i high = LoadSSE42<kSwapped>(src + 4);
+    const __m128i max = _mm_max_epu32(low, high);
+
+    // ASCII block.
+    if (_mm_testz_si128(max, _mm_set1_epi32(static_cast<int32_t>(0xFFFFFF80)))) {
+      const __m128i words = _mm_packus_epi32(low, high);
+      StoreUnalignedLow64(dest, _mm_packus_epi16(words, words));
+      return {kBlockSize, kBlockSize};
+    }
+
+    // BMP block below the surrogates, the common case for non-Latin scripts.
+    if (_mm_movemask_epi8(AtLeastSSE42(max, 0xD800)) == 0) {
+      const size_t written = EncodeUpToThreeBytesSSE42(low, dest);
+      return {
+        kBlockSize,
+        written + EncodeUpToThreeBytesSSE42(high, dest + written)};
+    }
+
+    const auto first = EncodeHalfSSE42<kSwapped>(low, src, dest);
+    if (first.read < 4) {
+      return first;
+    }
+    const auto second =
+      EncodeHalfSSE42<kSwapped>(high, src + 4, dest + first.written);
+    return {first.read + second.read, first.written + second.written};
+  }
+
+  // Runs StepSSE42() until |result| reaches |stop|, the end of the input or
+  // the end of the output. Returns false when it stopped in front of an
+  // invalid code point.
+  template <bool kSwapped>
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto StepsSSE42(
+    const CharUTF32* src,
+    size_t src_length,
+    size_t stop,
+    CharUTF8* dest,
+    size_t dest_length,
+    TranscodeResult& result) -> bool {
+    while (result.read < stop && result.read + kBlockSize <= src_length &&
+           result.written + kMaxBlockSize <= dest_length) {
+      const auto step =
+        StepSSE42<kSwapped>(src + result.read, dest + result.written);
+      if (step.read == 0) {
+        return false;
+      }
+      result.read += step.read;
+      result.written += step.written;
+    }
+    return true;
+  }
+
+  template <bool kSwapped>
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto UTF32ToUTF8SSE42(
+    const CharUTF32* src,
+    size_t src_length,
+    CharUTF8* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    StepsSSE42<kSwapped>(
+      src,
+      src_length,
+      src_length,
+      dest,
+      dest_length,
+      result);
+    return result;
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  LONGLP_ALWAYS_INLINE auto AtLeastAVX2(__m256i code_points, uint32_t bound)
+    -> __m256i {
+    return _mm256_cmpeq_epi32(
+      _mm256_max_epu32(
+        code_points,
+        _mm256_set1_epi32(static_cast<int32_t>(bound))),
+      code_points);
+  }
+
+  template <bool kSwapped>
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto UTF8LengthOfUTF32AVX2(const CharUTF32* src, size_t src_length)
+    -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + 8 <= src_length) {
+      __m256i extra = _mm256_setzero_si256();
+      for (size_t block = 0;
+           block < kLengthFlushBlocks && result.read + 8 <= src_length;
+           ++block, result.read += 8) {
+        const __m256i code_points = LoadAVX2<kSwapped>(src + result.read);
+        const __m256i supplementary = _mm256_and_si256(
+          AtLeastAVX2(code_points, 0x10000),
+          _mm256_cmpeq_epi32(
+            _mm256_min_epu32(code_points, _mm256_set1_epi32(0x10FFFF)),
+            code_points));
+        extra = _mm256_sub_epi32(
+          extra,
+          _mm256_add_epi32(
+            _mm256_add_epi32(
+              AtLeastAVX2(code_points, 0x80),
+              AtLeastAVX2(code_points, 0x800)),
+            supplementary));
+      }
+      result.written += HorizontalSumSSE42(_mm_add_epi32(
+        _mm256_castsi256_si128(extra),
+        _mm256_extracti128_si256(extra, 1)));
+    }
+    result.written += result.read;
+    return result;
+  }
+
+  template <bool kSwapped>
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto UTF32ToUTF8AVX2(
+    const CharUTF32* src,
+    size_t src_length,
+    CharUTF8* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + 2 * kBlockSize <= src_length &&
+           result.written + kMaxBlockSize <= dest_length) {
+      const __m256i low  = LoadAVX2<kSwapped>(src + result.read);
+      const __m256i high = LoadAVX2<kSwapped>(src + result.read + 8);
+      if (_mm256_testz_si256(
+            _mm256_or_si256(low, high),
+            _mm256_set1_epi32(static_cast<int32_t>(0xFFFFFF80)))) {
+        // packus works within 128-bit lanes, the permute restores the order.
+        const __m256i words = _mm256_permute4x64_epi64(
+          _mm256_packus_epi32(low, high),
+          0xD8);
+        StoreUnaligned(
+          dest + result.written,
+          _mm_packus_epi16(
+            _mm256_castsi256_si128(words),
+            _mm256_extracti128_si256(words, 1)));
+        result.read += 16;
+        result.written += 16;
+        continue;
+      }
+
+      if (!StepsSSE42<kSwapped>(
+            src,
+            src_length,
+            result.read + 2 * kBlockSize,
+            dest,
+            dest_length,
+            result)) {
+        return result;
+      }
+    }
+    StepsSSE42<kSwapped>(
+      src,
+      src_length,
+      src_length,
+      dest,
+      dest_length,
+      result);
+    return result;
+  }
+
+  template <bool kSwapped>
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  auto UTF8LengthOfUTF32AVX512(const CharUTF32* src, size_t src_length)
+    -> TranscodeResult {
+    TranscodeResult result;
+    for (; result.read + 16 <= src_length; result.read += 16) {
+      const __m512i code_points = LoadAVX512<kSwapped>(src + result.read);
+      const __mmask16 supplementary =
+        _mm512_cmpge_epu32_mask(code_points, _mm512_set1_epi32(0x10000)) &
+        _mm512_cmple_epu32_mask(code_points, _mm512_set1_epi32(0x10FFFF));
+      result.written += static_cast<size_t>(
+        std::popcount(static_cast<uint32_t>(
+          _mm512_cmpge_epu32_mask(code_points, _mm512_set1_epi32(0x80)))) +
+        std::popcount(static_cast<uint32_t>(
+          _mm512_cmpge_epu32_mask(code_points, _mm512_set1_epi32(0x800)))) +
+        std::popcount(static_cast<uint32_t>(supplementary)));
+    }
+    result.written += result.read;
+    return result;
+  }
+
+  template <bool kSwapped>
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  auto UTF32ToUTF8AVX512(
+    const CharUTF32* src,
+    size_t src_length,
+    CharUTF8* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + 2 * kBlockSize <= src_length &&
+           result.written + kMaxBlockSize <= dest_length) {
+      const __m512i code_points = LoadAVX512<kSwapped>(src + result.read);
+      if (_mm512_test_epi32_mask(
+            code_points,
+            _mm512_set1_epi32(static_cast<int32_t>(0xFFFFFF80))) == 0) {
+        StoreUnaligned(
+          dest + result.written,
+          _mm512_maskz_cvtepi32_epi8(
+            static_cast<__mmask16>(0xFFFF),
+            code_points));
+        result.read += 16;
+        result.written += 16;
+        continue;
+      }
+
+      if (!StepsSSE42<kSwapped>(
+            src,
+            src_length,
+            result.read + 2 * kBlockSize,
+            dest,
+            dest_length,
+            result)) {
+        return result;
+      }
+    }
+    StepsSSE42<kSwapped>(
+      src,
+      src_length,
+      src_length,
+      dest,
+      dest_length,
+      result);
+    return result;
+  }
+#endif    // defined(LONGLP_ARCH_CPU_X86_FAMILY)
+
+#if defined(LONGLP_ARCH_CPU_ARM64)
+  template <bool kSwapped>
+  auto UTF8LengthOfUTF32NEON(const CharUTF32* src, size_t src_length)
+    -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + 4 <= src_length) {
+      uint32x4_t extra = vdupq_n_u32(0);
+      for (size_t block = 0;
+           block < kLengthFlushBlocks && result.read + 4 <= src_length;
+           ++block, result.read += 4) {
+        const uint32x4_t code_points = LoadNEON<kSwapped>(src + result.read);
+        const uint32x4_t supplementary = vandq_u32(
+          vcgeq_u32(code_points, vdupq_n_u32(0x10000)),
+          vcleq_u32(code_points, vdupq_n_u32(0x10FFFF)));
+        extra = vsubq_u32(
+          extra,
+          vaddq_u32(
+            vaddq_u32(
+              vcgeq_u32(code_points, vdupq_n_u32(0x80)),
+              vcgeq_u32(code_points, vdupq_n_u32(0x800))),
+            supplementary));
+      }
+      result.written += vaddvq_u32(extra);
+    }
+    result.written += result.read;
+    return result;
+  }
+
+  // See EncodeHalfSSE42().
+  template <bool kSwapped>
+  inline auto EncodeHalfNEON(
+    uint32x4_t code_points,
+    const CharUTF32* src,
+    CharUTF8* dest) -> TranscodeResult {
+    const uint32x4_t invalid = vorrq_u32(
+      vcgtq_u32(code_points, vdupq_n_u32(0x10FFFF)),
+      vceqq_u32(
+        vandq_u32(code_points, vdupq_n_u32(0xFFFFF800)),
+        vdupq_n_u32(0xD800)));
+    if (vmaxvq_u32(invalid) == 0) {
+      if (vmaxvq_u32(code_points) < 0x10000) {
+        return {4, EncodeUpToThreeBytesNEON(code_points, dest)};
+      }
+      if (vminvq_u32(code_points) >= 0x10000) {
+        vst1q_u8(
+          reinterpret_cast<uint8_t*>(dest),
+          vreinterpretq_u8_u32(EncodeFourBytesNEON(code_points)));
+        return {4, 16};
+      }
+    }
+    return EncodeBlock<kSwapped>(src, 4, dest);
+  }
+
+  // See StepSSE42().
+  template <bool kSwapped>
+  inline auto StepNEON(const CharUTF32* src, CharUTF8* dest)
+    -> TranscodeResult {
+    const uint32x4_t low  = LoadNEON<kSwapped>(src);
+    const uint32x4_t high = LoadNEON<kSwapped>(src + 4);
+    const uint32_t max    = vmaxvq_u32(vmaxq_u32(low, high));
+
+    if (max < 0x80) {
+      vst1_u8(
+        reinterpret_cast<uint8_t*>(dest),
+        vmovn_u16(vcombine_u16(vmovn_u32(low), vmovn_u32(high))));
+      return {kBlockSize, kBlockSize};
+    }
+
+    if (max < 0xD800) {
+      const size_t written = EncodeUpToThreeBytesNEON(low, dest);
+      return {
+        kBlockSize,
+        written + EncodeUpToThreeBytesNEON(high, dest + written)};
+    }
+
+    const auto first = EncodeHalfNEON<kSwapped>(low, src, dest);
+    if (first.read < 4) {
+      return first;
+    }
+    const auto second =
+      EncodeHalfNEON<kSwapped>(high, src + 4, dest + first.written);
+    return {first.read + second.read, first.written + second.written};
+  }
+
+  template <bool kSwapped>
+  auto UTF32ToUTF8NEON(
+    const CharUTF32* src,
+    size_t src_length,
+    CharUTF8* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + kBlockSize <= src_length &&
+           result.written + kMaxBlockSize <= dest_length) {
+      const auto step =
+        StepNEON<kSwapped>(src + result.read, dest + result.written);
+      if (step.read == 0) {
+        break;
+      }
+      result.read += step.read;
+      result.written += step.written;
+    }
+    return result;
+  }
+#endif    // defined(LONGLP_ARCH_CPU_ARM64)
+
+  template <bool kSwapped>
+  auto SelectKernels() -> Kernels {
+    [[maybe_unused]] const auto& cpu = CPU::GetInstanceNoAllocation();
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+    if (cpu.has_avx512bw()) {
+      return {
+        &UTF8LengthOfUTF32AVX512<kSwapped>,
+        &UTF32ToUTF8AVX512<kSwapped>};
+    }
+    if (cpu.has_avx2()) {
+      return {
+        &UTF8LengthOfUTF32AVX2<kSwapped>,
+        &UTF32ToUTF8AVX2<kSwapped>};
+    }
+    if (cpu.has_sse42()) {
+      return {
+        &UTF8LengthOfUTF32SSE42<kSwapped>,
+        &UTF32ToUTF8SSE42<kSwapped>};
+    }
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+    if (cpu.has_neon()) {
+      return {
+        &UTF8LengthOfUTF32NEON<kSwapped>,
+        &UTF32ToUTF8NEON<kSwapped>};
+    }
+#endif
+    return {&UTF8LengthOfUTF32Scalar, &UTF32ToUTF8Scalar};
+  }
+
+  template <bool kSwapped>
+  auto GetKernels() -> const Kernels& {
+    static const Kernels kKernels = SelectKernels<kSwapped>();
+    return kKernels;
+  }
+
+  template <bool kSwapped>
+  auto UTF8LengthOfUTF32Impl(const CharUTF32* src, size_t src_length)
+    -> size_t {
+    auto [read, length] = GetKernels<kSwapped>().length(src, src_length);
+    for (; read < src_length; ++read) {
+      length += UTF8Length(LoadUnit<kSwapped>(src + read));
+    }
+    return length;
+  }
+}    // namespace
+
+auto UTF8LengthOfUTF32(const CharUTF32* src, size_t src_length) -> size_t {
+  return UTF8LengthOfUTF32Impl<false>(src, src_length);
+}
+
+auto UTF8LengthOfSwappedUTF32(const CharUTF32* src, size_t src_length)
+  -> size_t {
+  return UTF8LengthOfUTF32Impl<true>(src, src_length);
+}
+
+auto UTF32ToUTF8(
+  const CharUTF32* src,
+  size_t src_length,
+  CharUTF8* dest,
+  size_t dest_length) -> TranscodeResult {
+  return GetKernels<false>().transcode(src, src_length, dest, dest_length);
+}
+
+auto SwappedUTF32ToUTF8(
+  const CharUTF32* src,
+  size_t src_length,
+  CharUTF8* dest,
+  size_t dest_length) -> TranscodeResult {
+  return GetKernels<true>().transcode(src, src_length, dest, dest_length);
+}
+
+// NOLINTEND(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}    // namespace longlp::base::internal::simd
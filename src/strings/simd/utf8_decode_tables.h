@@ -0,0 +1,114 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+// Shuffle tables used to decode UTF-8 with a byte shuffle (pshufb/tbl).
+//
+// The decoder looks at a 12-byte window and builds a mask with one bit per
+// byte that ends a code point (i.e. the next byte is not a continuation byte).
+// The mask selects a shuffle that gathers the bytes of each code point into
+// its own 16-bit lane (up to six 1-2 byte code points) or 32-bit lane (up to
+// four 1-3 byte code points). The last byte of a code point lands in the lowest
+// byte of its lane; missing bytes are zeroed with a 0x80 index.
+//
+// The tables only describe the layout. Whether the gathered bytes form a valid
+// sequence is checked on the lanes by the kernels.
+
+#ifndef LONGLP_SRC_STRINGS_SIMD_UTF8_DECODE_TABLES_H_
+#define LONGLP_SRC_STRINGS_SIMD_UTF8_DECODE_TABLES_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace longlp::base::internal::simd {
+// NOLINTBEGIN(*-magic-numbers)
+
+inline constexpr size_t kUTF8WindowSize = 12;
+
+enum class UTF8WindowKind : uint8_t {
+  // The window starts with a code point this table cannot handle (4 bytes or
+  // a malformed run of continuation bytes).
+  kUnsupported,
+  // Six code points of 1 or 2 bytes, one per 16-bit lane.
+  kSixUpToTwoBytes,
+  // Four code points of 1 to 3 bytes, one per 32-bit lane.
+  kFourUpToThreeBytes,
+};
+
+struct UTF8WindowShuffle {
+  UTF8WindowKind kind = UTF8WindowKind::kUnsupported;
+  // Number of bytes of the window covered by the decoded code points.
+  uint8_t consumed    = 0;
+  alignas(16) std::array<uint8_t, 16> shuffle{};
+};
+
+namespace internal_tables {
+  constexpr uint8_t kZeroLane = 0x80;
+
+  constexpr auto MakeUTF8WindowShuffle(uint32_t end_mask) -> UTF8WindowShuffle {
+    std::array<uint8_t, kUTF8WindowSize> ends{};
+    size_t num_ends = 0;
+    for (uint8_t i = 0; i < kUTF8WindowSize; ++i) {
+      if ((end_mask & (1U << i)) != 0) {
+        ends[num_ends++] = i;
+      }
+    }
+
+    auto code_point_length = [&ends](size_t index) -> size_t {
+      return index == 0 ? ends[0] + size_t{1}
+                        : size_t{ends[index]} - size_t{ends[index - 1]};
+    };
+
+    UTF8WindowShuffle entry;
+    entry.shuffle.fill(kZeroLane);
+
+    bool all_up_to_two = num_ends >= 6;
+    for (size_t i = 0; all_up_to_two && i < 6; ++i) {
+      all_up_to_two = code_point_length(i) <= 2;
+    }
+    if (all_up_to_two) {
+      entry.kind     = UTF8WindowKind::kSixUpToTwoBytes;
+      entry.consumed = static_cast<uint8_t>(ends[5] + 1);
+      for (size_t i = 0; i < 6; ++i) {
+        entry.shuffle[2 * i] = ends[i];
+        if (code_point_length(i) == 2) {
+          entry.shuffle[2 * i + 1] = static_cast<uint8_t>(ends[i] - 1);
+        }
+      }
+      return entry;
+    }
+
+    bool all_up_to_three = num_ends >= 4;
+    for (size_t i = 0; all_up_to_three && i < 4; ++i) {
+      all_up_to_three = code_point_length(i) <= 3;
+    }
+    if (all_up_to_three) {
+      entry.kind     = UTF8WindowKind::kFourUpToThreeBytes;
+      entry.consumed = static_cast<uint8_t>(ends[3] + 1);
+      for (size_t i = 0; i < 4; ++i) {
+        for (size_t byte = 0; byte < code_point_length(i); ++byte) {
+          entry.shuffle[4 * i + byte] = static_cast<uint8_t>(ends[i] - byte);
+        }
+      }
+    }
+    return entry;
+  }
+
+  constexpr auto MakeUTF8WindowTable() {
+    std::array<UTF8WindowShuffle, 1U << kUTF8WindowSize> table{};
+    for (uint32_t mask = 0; mask < table.size(); ++mask) {
+      table[mask] = MakeUTF8WindowShuffle(mask);
+    }
+    return table;
+  }
+}    // namespace internal_tables
+
+// Indexed by the end-of-code-point mask of a 12-byte window.
+inline constexpr auto kUTF8WindowTable =
+  internal_tables::MakeUTF8WindowTable();
+
+// NOLINTEND(*-magic-numbers)
+}    // namespace longlp::base::internal::simd
+
+#endif    // LONGLP_SRC_STRINGS_SIMD_UTF8_DECODE_TABLES_H_
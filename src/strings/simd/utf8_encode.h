@@ -0,0 +1,175 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+// UTF-8 block encoders shared by the UTF-16 and UTF-32 kernels. The input is
+// one code point per 32-bit lane, already known to be a Unicode scalar value.
+
+#ifndef LONGLP_SRC_STRINGS_SIMD_UTF8_ENCODE_H_
+#define LONGLP_SRC_STRINGS_SIMD_UTF8_ENCODE_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "base/compiler_specific.h"
+#include "base/predef.h"
+#include "base/strings/typedefs.h"
+#include "strings/simd/load_store.h"
+#include "strings/simd/utf8_encode_tables.h"
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+#  include <immintrin.h>
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+#  include <arm_neon.h>
+#endif
+
+namespace longlp::base::internal::simd {
+// NOLINTBEGIN(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+// Encodes one Unicode scalar value, returns the number of bytes written.
+LONGLP_ALWAYS_INLINE auto EncodeUTF8(uint32_t code_point, CharUTF8* dest)
+  -> size_t {
+  if (code_point < 0x80) {
+    dest[0] = static_cast<CharUTF8>(code_point);
+    return 1;
+  }
+  if (code_point < 0x800) {
+    dest[0] = static_cast<CharUTF8>(0xC0 | (code_point >> 6));
+    dest[1] = static_cast<CharUTF8>(0x80 | (code_point & 0x3F));
+    return 2;
+  }
+  if (code_point < 0x10000) {
+    dest[0] = static_cast<CharUTF8>(0xE0 | (code_point >> 12));
+    dest[1] = static_cast<CharUTF8>(0x80 | ((code_point >> 6) & 0x3F));
+    dest[2] = static_cast<CharUTF8>(0x80 | (code_point & 0x3F));
+    return 3;
+  }
+  dest[0] = static_cast<CharUTF8>(0xF0 | (code_point >> 18));
+  dest[1] = static_cast<CharUTF8>(0x80 | ((code_point >> 12) & 0x3F));
+  dest[2] = static_cast<CharUTF8>(0x80 | ((code_point >> 6) & 0x3F));
+  dest[3] = static_cast<CharUTF8>(0x80 | (code_point & 0x3F));
+  return 4;
+}
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+// Encodes four BMP code points, returns the number of bytes written. Writes
+// 16 bytes.
+LONGLP_TARGET_ATTRIBUTE("sse4.2")
+LONGLP_ALWAYS_INLINE auto EncodeUpToThreeBytesSSE42(
+  __m128i code_points,
+  CharUTF8* dest) -> size_t {
+  const __m128i low_six = _mm_or_si128(
+    _mm_and_si128(code_points, _mm_set1_epi32(0x3F)),
+    _mm_set1_epi32(0x80));
+  const __m128i middle_six = _mm_or_si128(
+    _mm_and_si128(_mm_srli_epi32(code_points, 6), _mm_set1_epi32(0x3F)),
+    _mm_set1_epi32(0x80));
+
+  const __m128i two_bytes = _mm_or_si128(
+    _mm_or_si128(_mm_srli_epi32(code_points, 6), _mm_set1_epi32(0xC0)),
+    _mm_slli_epi32(low_six, 8));
+  const __m128i three_bytes = _mm_or_si128(
+    _mm_or_si128(_mm_srli_epi32(code_points, 12), _mm_set1_epi32(0xE0)),
+    _mm_or_si128(_mm_slli_epi32(middle_six, 8), _mm_slli_epi32(low_six, 16)));
+
+  const __m128i at_least_two =
+    _mm_cmpgt_epi32(code_points, _mm_set1_epi32(0x7F));
+  const __m128i three = _mm_cmpgt_epi32(code_points, _mm_set1_epi32(0x7FF));
+  const __m128i lanes = _mm_blendv_epi8(
+    _mm_blendv_epi8(code_points, two_bytes, at_least_two),
+    three_bytes,
+    three);
+
+  const auto index =
+    static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(at_least_two))) |
+    (static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(three))) << 4U);
+  const auto& entry = kUTF8ThreeByteCompactTable[index];
+  StoreUnaligned(
+    dest,
+    _mm_shuffle_epi8(lanes, LoadUnaligned<__m128i>(entry.shuffle.data())));
+  return entry.length;
+}
+
+// Encodes four supplementary code points, 4 bytes each, in place.
+LONGLP_TARGET_ATTRIBUTE("sse4.2")
+LONGLP_ALWAYS_INLINE auto EncodeFourBytesSSE42(__m128i code_points)
+  -> __m128i {
+  const __m128i six_bits = _mm_set1_epi32(0x3F);
+  const __m128i first =
+    _mm_or_si128(_mm_srli_epi32(code_points, 18), _mm_set1_epi32(0xF0));
+  const __m128i second =
+    _mm_and_si128(_mm_srli_epi32(code_points, 4), _mm_slli_epi32(six_bits, 8));
+  const __m128i third = _mm_and_si128(
+    _mm_slli_epi32(code_points, 10),
+    _mm_slli_epi32(six_bits, 16));
+  const __m128i fourth = _mm_and_si128(
+    _mm_slli_epi32(code_points, 24),
+    _mm_slli_epi32(six_bits, 24));
+  return _mm_or_si128(
+    _mm_or_si128(first, second),
+    _mm_or_si128(
+      _mm_or_si128(third, fourth),
+      _mm_set1_epi32(static_cast<int32_t>(0x80808000))));
+}
+#endif    // defined(LONGLP_ARCH_CPU_X86_FAMILY)
+
+#if defined(LONGLP_ARCH_CPU_ARM64)
+// See EncodeUpToThreeBytesSSE42().
+LONGLP_ALWAYS_INLINE auto
+EncodeUpToThreeBytesNEON(uint32x4_t code_points, CharUTF8* dest) -> size_t {
+  const uint32x4_t low_six =
+    vorrq_u32(vandq_u32(code_points, vdupq_n_u32(0x3F)), vdupq_n_u32(0x80));
+  const uint32x4_t middle_six = vorrq_u32(
+    vandq_u32(vshrq_n_u32(code_points, 6), vdupq_n_u32(0x3F)),
+    vdupq_n_u32(0x80));
+
+  const uint32x4_t two_bytes = vorrq_u32(
+    vorrq_u32(vshrq_n_u32(code_points, 6), vdupq_n_u32(0xC0)),
+    vshlq_n_u32(low_six, 8));
+  const uint32x4_t three_bytes = vorrq_u32(
+    vorrq_u32(vshrq_n_u32(code_points, 12), vdupq_n_u32(0xE0)),
+    vorrq_u32(vshlq_n_u32(middle_six, 8), vshlq_n_u32(low_six, 16)));
+
+  const uint32x4_t at_least_two = vcgtq_u32(code_points, vdupq_n_u32(0x7F));
+  const uint32x4_t three        = vcgtq_u32(code_points, vdupq_n_u32(0x7FF));
+  const uint32x4_t lanes        = vbslq_u32(
+    three,
+    three_bytes,
+    vbslq_u32(at_least_two, two_bytes, code_points));
+
+  constexpr std::array<uint32_t, 4> kLaneBits = {1, 2, 4, 8};
+  const uint32x4_t lane_bits = vld1q_u32(kLaneBits.data());
+  const uint32_t index       = vaddvq_u32(vandq_u32(at_least_two, lane_bits)) |
+                         (vaddvq_u32(vandq_u32(three, lane_bits)) << 4U);
+  const auto& entry = kUTF8ThreeByteCompactTable[index];
+  vst1q_u8(
+    reinterpret_cast<uint8_t*>(dest),
+    vqtbl1q_u8(vreinterpretq_u8_u32(lanes), vld1q_u8(entry.shuffle.data())));
+  return entry.length;
+}
+
+// See EncodeFourBytesSSE42().
+LONGLP_ALWAYS_INLINE auto EncodeFourBytesNEON(uint32x4_t code_points)
+  -> uint32x4_t {
+  const uint32x4_t six_bits = vdupq_n_u32(0x3F);
+  const uint32x4_t first =
+    vorrq_u32(vshrq_n_u32(code_points, 18), vdupq_n_u32(0xF0));
+  const uint32x4_t second =
+    vandq_u32(vshrq_n_u32(code_points, 4), vshlq_n_u32(six_bits, 8));
+  const uint32x4_t third =
+    vandq_u32(vshlq_n_u32(code_points, 10), vshlq_n_u32(six_bits, 16));
+  const uint32x4_t fourth =
+    vandq_u32(vshlq_n_u32(code_points, 24), vshlq_n_u32(six_bits, 24));
+  return vorrq_u32(
+    vorrq_u32(first, second),
+    vorrq_u32(vorrq_u32(third, fourth), vdupq_n_u32(0x80808000)));
+}
+#endif    // defined(LONGLP_ARCH_CPU_ARM64)
+
+// NOLINTEND(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}    // namespace longlp::base::internal::simd
+
+#endif    // LONGLP_SRC_STRINGS_SIMD_UTF8_ENCODE_H_
@@ -0,0 +1,83 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+// Shuffle tables used to compact UTF-8 produced in vector lanes.
+//
+// The encoders write every code point into a fixed-size lane, with its first
+// UTF-8 byte in the lowest byte of the lane. A shuffle then drops the unused
+// bytes of each lane so that the sequences are contiguous.
+
+#ifndef LONGLP_SRC_STRINGS_SIMD_UTF8_ENCODE_TABLES_H_
+#define LONGLP_SRC_STRINGS_SIMD_UTF8_ENCODE_TABLES_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace longlp::base::internal::simd {
+// NOLINTBEGIN(*-magic-numbers)
+
+struct UTF8CompactShuffle {
+  // Number of UTF-8 bytes produced by the shuffle.
+  uint8_t length = 0;
+  alignas(16) std::array<uint8_t, 16> shuffle{};
+};
+
+namespace internal_tables {
+  constexpr uint8_t kUnusedByte = 0x80;
+
+  // Eight 16-bit lanes holding one or two bytes. Bit i of |ascii_mask| is set
+  // when lane i holds a single (ASCII) byte.
+  constexpr auto MakeTwoByteCompactShuffle(uint32_t ascii_mask)
+    -> UTF8CompactShuffle {
+    UTF8CompactShuffle entry;
+    entry.shuffle.fill(kUnusedByte);
+    for (uint8_t lane = 0; lane < 8; ++lane) {
+      entry.shuffle[entry.length++] = static_cast<uint8_t>(2 * lane);
+      if ((ascii_mask & (1U << lane)) == 0) {
+        entry.shuffle[entry.length++] = static_cast<uint8_t>(2 * lane + 1);
+      }
+    }
+    return entry;
+  }
+
+  // Four 32-bit lanes holding one to three bytes. Bit i of |index| is set when
+  // lane i has at least two bytes, bit i + 4 when it has three bytes.
+  constexpr auto MakeThreeByteCompactShuffle(uint32_t index)
+    -> UTF8CompactShuffle {
+    UTF8CompactShuffle entry;
+    entry.shuffle.fill(kUnusedByte);
+    for (uint8_t lane = 0; lane < 4; ++lane) {
+      const uint32_t length = 1U + ((index >> lane) & 1U) +
+                              ((index >> (lane + 4U)) & 1U);
+      for (uint8_t byte = 0; byte < length; ++byte) {
+        entry.shuffle[entry.length++] = static_cast<uint8_t>(4 * lane + byte);
+      }
+    }
+    return entry;
+  }
+
+  template <auto kMakeEntry>
+  constexpr auto MakeCompactTable() {
+    std::array<UTF8CompactShuffle, 256> table{};
+    for (uint32_t index = 0; index < table.size(); ++index) {
+      table[index] = kMakeEntry(index);
+    }
+    return table;
+  }
+}    // namespace internal_tables
+
+// Indexed by the mask of ASCII lanes among eight 16-bit lanes.
+inline constexpr auto kUTF8TwoByteCompactTable = internal_tables::
+  MakeCompactTable<&internal_tables::MakeTwoByteCompactShuffle>();
+
+// Indexed by (at least two bytes mask) | (three bytes mask << 4) of four 32-bit
+// lanes.
+inline constexpr auto kUTF8ThreeByteCompactTable = internal_tables::
+  MakeCompactTable<&internal_tables::MakeThreeByteCompactShuffle>();
+
+// NOLINTEND(*-magic-numbers)
+}    // namespace longlp::base::internal::simd
+
+#endif    // LONGLP_SRC_STRINGS_SIMD_UTF8_ENCODE_TABLES_H_
@@ -0,0 +1,227 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+#include "base/compiler_specific.h"
+#include "base/cpu.h"
+#include "base/icu/utf.h"
+#include "base/predef.h"
+#include "base/strings/utf_string_conversion_utils.h"
+#include "strings/simd/load_store.h"
+#include "strings/simd/utf_kernels.h"
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+#  include <immintrin.h>
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+#  include <arm_neon.h>
+#endif
+
+namespace longlp::base::internal::simd {
+// NOLINTBEGIN(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+namespace {
+  // In valid UTF-8 every code point starts with exactly one byte that is not
+  // a continuation byte (10______), and takes a surrogate pair in UTF-16 iff
+  // that byte is a 4-byte lead (11110___).
+  struct LeadCounts {
+    size_t leads           = 0;
+    size_t four_byte_leads = 0;
+  };
+
+  using Kernel = auto (*)(const CharUTF8*, size_t) -> LeadCounts;
+
+  // Invalid input is measured by the scalar decoder, one chunk at a time so
+  // that a stray byte does not slow down the rest of the input.
+  constexpr size_t kChunkSize = 4096;
+
+  constexpr auto IsContinuation(CharUTF8 byte) -> bool {
+    return (static_cast<uint8_t>(byte) & 0xC0) == 0x80;
+  }
+
+  // Also the tail of the vector kernels.
+  auto CountLeadsScalar(const CharUTF8* src, size_t src_length) -> LeadCounts {
+    LeadCounts counts;
+    for (size_t i = 0; i < src_length; ++i) {
+      counts.leads += IsContinuation(src[i]) ? 0U : 1U;
+      counts.four_byte_leads += static_cast<uint8_t>(src[i]) >= 0xF0 ? 1U : 0U;
+    }
+    return counts;
+  }
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto CountLeadsSSE42(const CharUTF8* src, size_t src_length) -> LeadCounts {
+    LeadCounts counts;
+    size_t i = 0;
+    for (; i + 16 <= src_length; i += 16) {
+      const __m128i input = LoadUnaligned<__m128i>(src + i);
+      // Continuation bytes are the signed values below -64.
+      const __m128i leads = _mm_cmpgt_epi8(input, _mm_set1_epi8(-65));
+      const __m128i four_byte_leads = _mm_cmpeq_epi8(
+        _mm_max_epu8(input, _mm_set1_epi8(static_cast<char>(0xF0))),
+        input);
+      counts.leads += static_cast<size_t>(
+        std::popcount(static_cast<uint32_t>(_mm_movemask_epi8(leads))));
+      counts.four_byte_leads += static_cast<size_t>(std::popcount(
+        static_cast<uint32_t>(_mm_movemask_epi8(four_byte_leads))));
+    }
+    const auto tail = CountLeadsScalar(src + i, src_length - i);
+    return {
+      counts.leads + tail.leads,
+      counts.four_byte_leads + tail.four_byte_leads};
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto CountLeadsAVX2(const CharUTF8* src, size_t src_length) -> LeadCounts {
+    LeadCounts counts;
+    size_t i = 0;
+    for (; i + 32 <= src_length; i += 32) {
+      const __m256i input = LoadUnaligned<__m256i>(src + i);
+      const __m256i leads = _mm256_cmpgt_epi8(input, _mm256_set1_epi8(-65));
+      const __m256i four_byte_leads = _mm256_cmpeq_epi8(
+        _mm256_max_epu8(input, _mm256_set1_epi8(static_cast<char>(0xF0))),
+        input);
+      counts.leads += static_cast<size_t>(
+        std::popcount(static_cast<uint32_t>(_mm256_movemask_epi8(leads))));
+      counts.four_byte_leads += static_cast<size_t>(std::popcount(
+        static_cast<uint32_t>(_mm256_movemask_epi8(four_byte_leads))));
+    }
+    const auto tail = CountLeadsScalar(src + i, src_length - i);
+    return {
+      counts.leads + tail.leads,
+      counts.four_byte_leads + tail.four_byte_leads};
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  auto CountLeadsAVX512(const CharUTF8* src, size_t src_length) -> LeadCounts {
+    LeadCounts counts;
+    size_t i = 0;
+    for (; i + 64 <= src_length; i += 64) {
+      const __m512i input = LoadUnaligned<__m512i>(src + i);
+      counts.leads += static_cast<size_t>(std::popcount(
+        _mm512_cmpgt_epi8_mask(input, _mm512_set1_epi8(-65))));
+      counts.four_byte_leads += static_cast<size_t>(
+        std::popcount(_mm512_cmpge_epu8_mask(
+          input,
+          _mm512_set1_epi8(static_cast<char>(0xF0)))));
+    }
+    const auto tail = CountLeadsScalar(src + i, src_length - i);
+    return {
+      counts.leads + tail.leads,
+      counts.four_byte_leads + tail.four_byte_leads};
+  }
+#endif    // defined(LONGLP_ARCH_CPU_X86_FAMILY)
+
+#if defined(LONGLP_ARCH_CPU_ARM64)
+  // The 8-bit lanes count up to 255 blocks before they are folded.
+  auto CountLeadsNEON(const CharUTF8* src, size_t src_length) -> LeadCounts {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(src);
+    LeadCounts counts;
+    size_t i = 0;
+    while (i + 16 <= src_length) {
+      uint8x16_t leads           = vdupq_n_u8(0);
+      uint8x16_t four_byte_leads = vdupq_n_u8(0);
+      for (size_t block = 0; block < 255 && i + 16 <= src_length;
+           ++block, i += 16) {
+        const uint8x16_t input = vld1q_u8(bytes + i);
+        leads                  = vsubq_u8(
+          leads,
+          vcgtq_s8(vreinterpretq_s8_u8(input), vdupq_n_s8(-65)));
+        four_byte_leads =
+          vsubq_u8(four_byte_leads, vcgeq_u8(input, vdupq_n_u8(0xF0)));
+      }
+      counts.leads += vaddlvq_u8(leads);
+      counts.four_byte_leads += vaddlvq_u8(four_byte_leads);
+    }
+    const auto tail = CountLeadsScalar(src + i, src_length - i);
+    return {
+      counts.leads + tail.leads,
+      counts.four_byte_leads + tail.four_byte_leads};
+  }
+#endif    // defined(LONGLP_ARCH_CPU_ARM64)
+
+  auto SelectKernel() -> Kernel {
+    [[maybe_unused]] const auto& cpu = CPU::GetInstanceNoAllocation();
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+    if (cpu.has_avx512bw()) {
+      return &CountLeadsAVX512;
+    }
+    if (cpu.has_avx2()) {
+      return &CountLeadsAVX2;
+    }
+    if (cpu.has_sse42()) {
+      return &CountLeadsSSE42;
+    }
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+    if (cpu.has_neon()) {
+      return &CountLeadsNEON;
+    }
+#endif
+    return &CountLeadsScalar;
+  }
+
+  // Number of code units the scalar decoder produces for invalid input, which
+  // is one U+FFFD for every maximal subpart of an ill-formed sequence.
+  auto LengthOfInvalidUTF8(
+    const CharUTF8* src,
+    size_t src_length,
+    bool count_surrogate_pairs) -> size_t {
+    const auto* bytes  = reinterpret_cast<const uint8_t*>(src);
+    const auto length  = static_cast<int32_t>(src_length);
+    size_t code_units  = 0;
+    for (int32_t i = 0; i < length;) {
+      icu::CodePoint code_point;
+      icu::internal::U8Next(bytes, i, length, *code_point);
+      code_units += count_surrogate_pairs && IsValidCodepoint(code_point) &&
+                        *code_point > 0xFFFF
+                      ? 2U
+                      : 1U;
+    }
+    return code_units;
+  }
+
+  // Decoding restarts at every byte that is not a continuation byte, valid or
+  // not, so the input can be measured in chunks ending in front of one.
+  auto LengthOfUTF8(
+    const CharUTF8* src,
+    size_t src_length,
+    bool count_surrogate_pairs) -> size_t {
+    static const Kernel kKernel = SelectKernel();
+
+    size_t code_units = 0;
+    for (size_t begin = 0; begin < src_length;) {
+      size_t end = std::min(begin + kChunkSize, src_length);
+      while (end < src_length && IsContinuation(src[end])) {
+        ++end;
+      }
+
+      if (ValidateUTF8(src + begin, end - begin).valid) {
+        const auto counts = kKernel(src + begin, end - begin);
+        code_units +=
+          counts.leads + (count_surrogate_pairs ? counts.four_byte_leads : 0);
+      }
+      else {
+        code_units +=
+          LengthOfInvalidUTF8(src + begin, end - begin, count_surrogate_pairs);
+      }
+      begin = end;
+    }
+    return code_units;
+  }
+}    // namespace
+
+auto UTF16LengthOfUTF8(const CharUTF8* src, size_t src_length) -> size_t {
+  return LengthOfUTF8(src, src_length, /*count_surrogate_pairs=*/true);
+}
+
+auto UTF32LengthOfUTF8(const CharUTF8* src, size_t src_length) -> size_t {
+  return LengthOfUTF8(src, src_length, /*count_surrogate_pairs=*/false);
+}
+
+// NOLINTEND(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}    // namespace longlp::base::internal::simd
@@ -0,0 +1,374 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#include "base/compiler_specific.h"
+#include "base/cpu.h"
+#include "base/predef.h"
+#include "strings/simd/load_store.h"
+#include "strings/simd/utf8_decode_tables.h"
+#include "strings/simd/utf_kernels.h"
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+#  include <immintrin.h>
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+#  include <arm_neon.h>
+#endif
+
+namespace longlp::base::internal::simd {
+// NOLINTBEGIN(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+namespace {
+  using Kernel = auto (*)(const CharUTF8*, size_t, CharUTF16*, size_t)
+    -> TranscodeResult;
+
+  // A step reads 16 bytes and stores up to 16 code units, of which only
+  // |written| are meaningful. The wide ASCII paths store 32 or 64.
+  constexpr size_t kStepSize = 16;
+
+  auto UTF8ToUTF16Scalar(
+    const CharUTF8* /*src*/,
+    size_t /*src_length*/,
+    CharUTF16* /*dest*/,
+    size_t /*dest_length*/) -> TranscodeResult {
+    return {};
+  }
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+  // Returns all-ones in the 32-bit lanes of |values| that are in
+  // [low, low + span].
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto InRangeSSE42(__m128i values, int32_t low, int32_t span)
+    -> __m128i {
+    const __m128i rebased = _mm_sub_epi32(values, _mm_set1_epi32(low));
+    return _mm_cmpeq_epi32(_mm_min_epu32(rebased, _mm_set1_epi32(span)), rebased);
+  }
+
+  // Handles the 16 bytes at |src|: widens the ASCII prefix, or decodes one
+  // 12-byte window of multi-byte code points. Returns an empty result when the
+  // scalar decoder has to take over.
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto StepSSE42(const CharUTF8* src, CharUTF16* dest)
+    -> TranscodeResult {
+    const __m128i input  = LoadUnaligned<__m128i>(src);
+    const auto non_ascii = static_cast<uint32_t>(_mm_movemask_epi8(input));
+
+    if ((non_ascii & 1U) == 0) {
+      const auto ascii =
+        non_ascii == 0 ? size_t{16} : static_cast<size_t>(std::countr_zero(non_ascii));
+      const __m128i zero = _mm_setzero_si128();
+      StoreUnaligned(dest, _mm_unpacklo_epi8(input, zero));
+      StoreUnaligned(dest + 8, _mm_unpackhi_epi8(input, zero));
+      return {ascii, ascii};
+    }
+
+    // Continuation bytes are [0x80, 0xBF], i.e. less than 0xC0 when signed.
+    const auto continuation = static_cast<uint32_t>(
+      _mm_movemask_epi8(_mm_cmplt_epi8(input, _mm_set1_epi8(-64))));
+    const auto end_mask = ~(continuation >> 1U) & 0xFFFU;
+    const auto& entry   = kUTF8WindowTable[end_mask];
+    const __m128i lanes =
+      _mm_shuffle_epi8(input, LoadUnaligned<__m128i>(entry.shuffle.data()));
+
+    // Within a lane, a valid sequence is one of (lead byte is the highest):
+    //   1 byte : [0x00007F, 0x00007F]
+    //   2 bytes: [0x00C280, 0x00DFBF]
+    //   3 bytes: [0xE0A080, 0xED9FBF] and [0xEE8080, 0xEFBFBF]
+    // The lower bounds reject overlong forms and the gap rejects surrogates.
+    // Every byte but the lead is a continuation byte by construction of the
+    // mask, so range checks are enough.
+    switch (entry.kind) {
+      case UTF8WindowKind::kSixUpToTwoBytes: {
+        const __m128i is_ascii = _mm_cmpeq_epi16(
+          _mm_min_epu16(lanes, _mm_set1_epi16(0x7F)),
+          lanes);
+        const __m128i two_bytes =
+          _mm_sub_epi16(lanes, _mm_set1_epi16(static_cast<int16_t>(0xC280)));
+        const __m128i is_two_bytes = _mm_cmpeq_epi16(
+          _mm_min_epu16(two_bytes, _mm_set1_epi16(0x1D3F)),
+          two_bytes);
+        if (_mm_movemask_epi8(_mm_or_si128(is_ascii, is_two_bytes)) != 0xFFFF) {
+          return {};
+        }
+
+        const __m128i composed = _mm_or_si128(
+          _mm_and_si128(lanes, _mm_set1_epi16(0x7F)),
+          _mm_srli_epi16(_mm_and_si128(lanes, _mm_set1_epi16(0x1F00)), 2));
+        StoreUnaligned(dest, composed);
+        return {entry.consumed, 6};
+      }
+
+      case UTF8WindowKind::kFourUpToThreeBytes: {
+        const __m128i valid = _mm_or_si128(
+          _mm_or_si128(
+            InRangeSSE42(lanes, 0, 0x7F),
+            InRangeSSE42(lanes, 0xC280, 0x1D3F)),
+          _mm_or_si128(
+            InRangeSSE42(lanes, 0xE0A080, 0x0CFF3F),
+            InRangeSSE42(lanes, 0xEE8080, 0x013F3F)));
+        if (_mm_movemask_epi8(valid) != 0xFFFF) {
+          return {};
+        }
+
+        const __m128i composed = _mm_or_si128(
+          _mm_or_si128(
+            _mm_and_si128(lanes, _mm_set1_epi32(0x7F)),
+            _mm_srli_epi32(_mm_and_si128(lanes, _mm_set1_epi32(0x3F00)), 2)),
+          _mm_srli_epi32(_mm_and_si128(lanes, _mm_set1_epi32(0x0F0000)), 4));
+        StoreUnalignedLow64(dest, _mm_packus_epi32(composed, composed));
+        return {entry.consumed, 4};
+      }
+
+      case UTF8WindowKind::kUnsupported:
+      default:
+        return {};
+    }
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto UTF8ToUTF16SSE42(
+    const CharUTF8* src,
+    size_t src_length,
+    CharUTF16* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + kStepSize <= src_length &&
+           result.written + kStepSize <= dest_length) {
+      const auto step = StepSSE42(src + result.read, dest + result.written);
+      if (step.read == 0) {
+        break;
+      }
+      result.read += step.read;
+      result.written += step.written;
+    }
+    return result;
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto UTF8ToUTF16AVX2(
+    const CharUTF8* src,
+    size_t src_length,
+    CharUTF16* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + kStepSize <= src_length &&
+           result.written + kStepSize <= dest_length) {
+      if (
+        result.read + 32 <= src_length && result.written + 32 <= dest_length) {
+        const __m256i input = LoadUnaligned<__m256i>(src + result.read);
+        const auto non_ascii =
+          static_cast<uint32_t>(_mm256_movemask_epi8(input));
+        if ((non_ascii & 1U) == 0) {
+          const auto ascii =
+            non_ascii == 0 ? size_t{32} : static_cast<size_t>(std::countr_zero(non_ascii));
+          auto* out = dest + result.written;
+          StoreUnaligned(
+            out,
+            _mm256_cvtepu8_epi16(_mm256_castsi256_si128(input)));
+          StoreUnaligned(
+            out + 16,
+            _mm256_cvtepu8_epi16(_mm256_extracti128_si256(input, 1)));
+          result.read += ascii;
+          result.written += ascii;
+          continue;
+        }
+      }
+
+      const auto step = StepSSE42(src + result.read, dest + result.written);
+      if (step.read == 0) {
+        break;
+      }
+      result.read += step.read;
+      result.written += step.written;
+    }
+    return result;
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx512f,avx512bw")
+  auto UTF8ToUTF16AVX512(
+    const CharUTF8* src,
+    size_t src_length,
+    CharUTF16* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + kStepSize <= src_length &&
+           result.written + kStepSize <= dest_length) {
+      if (
+        result.read + 64 <= src_length && result.written + 64 <= dest_length) {
+        const __m512i input = LoadUnaligned<__m512i>(src + result.read);
+        const uint64_t non_ascii = _mm512_movepi8_mask(input);
+        if ((non_ascii & 1U) == 0) {
+          const auto ascii =
+            non_ascii == 0 ? size_t{64} : static_cast<size_t>(std::countr_zero(non_ascii));
+          // Reloading the halves is cheaper than extracting them.
+          const auto* in = src + result.read;
+          auto* out      = dest + result.written;
+          StoreUnaligned(
+            out,
+            _mm512_cvtepu8_epi16(LoadUnaligned<__m256i>(in)));
+          StoreUnaligned(
+            out + 32,
+            _mm512_cvtepu8_epi16(LoadUnaligned<__m256i>(in + 32)));
+          result.read += ascii;
+          result.written += ascii;
+          continue;
+        }
+      }
+
+      const auto step = StepSSE42(src + result.read, dest + result.written);
+      if (step.read == 0) {
+        break;
+      }
+      result.read += step.read;
+      result.written += step.written;
+    }
+    return result;
+  }
+#endif    // defined(LONGLP_ARCH_CPU_X86_FAMILY)
+
+#if defined(LONGLP_ARCH_CPU_ARM64)
+  // Equivalent of _mm_movemask_epi8 for comparison results (0x00 or 0xFF).
+  inline auto MoveMaskNEON(uint8x16_t bytes) -> uint32_t {
+    constexpr std::array<uint8_t, 16> kBits = {
+      1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    const uint8x16_t bits = vandq_u8(bytes, vld1q_u8(kBits.data()));
+    return static_cast<uint32_t>(vaddv_u8(vget_low_u8(bits))) |
+           (static_cast<uint32_t>(vaddv_u8(vget_high_u8(bits))) << 8U);
+  }
+
+  // See InRangeSSE42().
+  inline auto InRangeNEON(uint32x4_t values, uint32_t low, uint32_t span)
+    -> uint32x4_t {
+    return vcleq_u32(vsubq_u32(values, vdupq_n_u32(low)), vdupq_n_u32(span));
+  }
+
+  // See StepSSE42().
+  inline auto StepNEON(const CharUTF8* src, CharUTF16* dest)
+    -> TranscodeResult {
+    const uint8x16_t input = vld1q_u8(reinterpret_cast<const uint8_t*>(src));
+    auto* out              = reinterpret_cast<uint16_t*>(dest);
+
+    if (vmaxvq_u8(input) < 0x80) {
+      vst1q_u16(out, vmovl_u8(vget_low_u8(input)));
+      vst1q_u16(out + 8, vmovl_high_u8(input));
+      return {16, 16};
+    }
+
+    const auto non_ascii = MoveMaskNEON(vcgeq_u8(input, vdupq_n_u8(0x80)));
+    if ((non_ascii & 1U) == 0) {
+      const auto ascii = static_cast<size_t>(std::countr_zero(non_ascii));
+      vst1q_u16(out, vmovl_u8(vget_low_u8(input)));
+      vst1q_u16(out + 8, vmovl_high_u8(input));
+      return {ascii, ascii};
+    }
+
+    const auto continuation = MoveMaskNEON(
+      vceqq_u8(vandq_u8(input, vdupq_n_u8(0xC0)), vdupq_n_u8(0x80)));
+    const auto end_mask = ~(continuation >> 1U) & 0xFFFU;
+    const auto& entry   = kUTF8WindowTable[end_mask];
+    const uint8x16_t lanes =
+      vqtbl1q_u8(input, vld1q_u8(entry.shuffle.data()));
+
+    switch (entry.kind) {
+      case UTF8WindowKind::kSixUpToTwoBytes: {
+        const uint16x8_t values     = vreinterpretq_u16_u8(lanes);
+        const uint16x8_t is_ascii   = vcleq_u16(values, vdupq_n_u16(0x7F));
+        const uint16x8_t is_two_bytes = vcleq_u16(
+          vsubq_u16(values, vdupq_n_u16(0xC280)),
+          vdupq_n_u16(0x1D3F));
+        if (vminvq_u16(vorrq_u16(is_ascii, is_two_bytes)) != 0xFFFF) {
+          return {};
+        }
+
+        vst1q_u16(
+          out,
+          vorrq_u16(
+            vandq_u16(values, vdupq_n_u16(0x7F)),
+            vshrq_n_u16(vandq_u16(values, vdupq_n_u16(0x1F00)), 2)));
+        return {entry.consumed, 6};
+      }
+
+      case UTF8WindowKind::kFourUpToThreeBytes: {
+        const uint32x4_t values = vreinterpretq_u32_u8(lanes);
+        const uint32x4_t valid  = vorrq_u32(
+          vorrq_u32(
+            InRangeNEON(values, 0, 0x7F),
+            InRangeNEON(values, 0xC280, 0x1D3F)),
+          vorrq_u32(
+            InRangeNEON(values, 0xE0A080, 0x0CFF3F),
+            InRangeNEON(values, 0xEE8080, 0x013F3F)));
+        if (vminvq_u32(valid) != 0xFFFFFFFF) {
+          return {};
+        }
+
+        const uint32x4_t composed = vorrq_u32(
+          vorrq_u32(
+            vandq_u32(values, vdupq_n_u32(0x7F)),
+            vshrq_n_u32(vandq_u32(values, vdupq_n_u32(0x3F00)), 2)),
+          vshrq_n_u32(vandq_u32(values, vdupq_n_u32(0x0F0000)), 4));
+        vst1_u16(out, vmovn_u32(composed));
+        return {entry.consumed, 4};
+      }
+
+      case UTF8WindowKind::kUnsupported:
+      default:
+        return {};
+    }
+  }
+
+  auto UTF8ToUTF16NEON(
+    const CharUTF8* src,
+    size_t src_length,
+    CharUTF16* dest,
+    size_t dest_length) -> TranscodeResult {
+    TranscodeResult result;
+    while (result.read + kStepSize <= src_length &&
+           result.written + kStepSize <= dest_length) {
+      const auto step = StepNEON(src + result.read, dest + result.written);
+      if (step.read == 0) {
+        break;
+      }
+      result.read += step.read;
+      result.written += step.written;
+    }
+    return result;
+  }
+#endif    // defined(LONGLP_ARCH_CPU_ARM64)
+
+  auto SelectKernel() -> Kernel {
+    [[maybe_unused]] const auto& cpu = CPU::GetInstanceNoAllocation();
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+    if (cpu.has_avx512bw()) {
+      return &UTF8ToUTF16AVX512;
+    }
+    if (cpu.has_avx2()) {
+      return &UTF8ToUTF16AVX2;
+    }
+    if (cpu.has_sse42()) {
+      return &UTF8ToUTF16SSE42;
+    }
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+    if (cpu.has_neon()) {
+      return &UTF8ToUTF16NEON;
+    }
+#endif
+    return &UTF8ToUTF16Scalar;
+  }
+}    // namespace
+
+auto UTF8ToUTF16(
+  const CharUTF8* src,
+  size_t src_length,
+  CharUTF16* dest,
+  size_t dest_length) -> TranscodeResult {
+  static const Kernel kKernel = SelectKernel();
+  return kKernel(src, src_length, dest, dest_length);
+}
+
+// NOLINTEND(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}    // namespace longlp::base::internal::simd
@@ -0,0 +1,230 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+// Vectorized building blocks of the UTF conversions. The kernels are selected
+// once per process from base::CPU (SSE4.2, AVX2, AVX-512BW or NEON) and fall
+// back to doing nothing when no vector unit is available, so every caller
+// must keep its scalar loop.
+//
+// A kernel only consumes input it can prove to be valid, and stops in front of
+// anything else (malformed sequences, code points it has no fast path for, or
+// a tail shorter than one vector). The caller then decodes one code point with
+// the scalar code, which owns the U+FFFD replacement, and calls the kernel
+// again.
+
+#ifndef LONGLP_SRC_STRINGS_SIMD_UTF_KERNELS_H_
+#define LONGLP_SRC_STRINGS_SIMD_UTF_KERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "base/strings/typedefs.h"
+
+namespace longlp::base::internal::simd {
+
+struct TranscodeResult {
+  // Number of source code units consumed.
+  size_t read    = 0;
+  // Number of destination code units produced.
+  size_t written = 0;
+};
+
+// Exact number of code units the conversion of |src| produces, counting one
+// U+FFFD for every code point that is not a Unicode scalar value, and for
+// every maximal subpart of an ill-formed UTF-8 sequence or lone surrogate.
+// Unlike the transcoding kernels these measure the whole input.
+auto UTF16LengthOfUTF8(const CharUTF8* src, size_t src_length) -> size_t;
+auto UTF32LengthOfUTF8(const CharUTF8* src, size_t src_length) -> size_t;
+auto UTF8LengthOfUTF16(const CharUTF16* src, size_t src_length) -> size_t;
+auto UTF32LengthOfUTF16(const CharUTF16* src, size_t src_length) -> size_t;
+auto UTF8LengthOfUTF32(const CharUTF32* src, size_t src_length) -> size_t;
+auto UTF16LengthOfUTF32(const CharUTF32* src, size_t src_length) -> size_t;
+// Latin-1 (ISO-8859-1) bytes are the code points U+0000..U+00FF.
+auto UTF8LengthOfLatin1(const CharLatin1* src, size_t src_length) -> size_t;
+
+// |dest| has room for |dest_length| code units, usually the exact size from
+// the functions above. The kernels stop when less than one block worth of
+// room is left, so they never write past |dest_length|.
+//
+// The UTF-16 to UTF-8 kernel only consumes surrogate pairs as a whole; a lone
+// surrogate stops it.
+auto UTF8ToUTF16(
+  const CharUTF8* src,
+  size_t src_length,
+  CharUTF16* dest,
+  size_t dest_length) -> TranscodeResult;
+auto UTF16ToUTF8(
+  const CharUTF16* src,
+  size_t src_length,
+  CharUTF8* dest,
+  size_t dest_length) -> TranscodeResult;
+auto UTF32ToUTF8(
+  const CharUTF32* src,
+  size_t src_length,
+  CharUTF8* dest,
+  size_t dest_length) -> TranscodeResult;
+auto UTF32ToUTF16(
+  const CharUTF32* src,
+  size_t src_length,
+  CharUTF16* dest,
+  size_t dest_length) -> TranscodeResult;
+
+// Same as above, for code units stored in the opposite of the host byte
+// order, e.g. UTF-16BE on a little-endian host. The swap is fused into the
+// loads of the kernels, so these are as fast as the host byte order.
+auto UTF8LengthOfSwappedUTF16(const CharUTF16* src, size_t src_length)
+  -> size_t;
+auto UTF8LengthOfSwappedUTF32(const CharUTF32* src, size_t src_length)
+  -> size_t;
+auto SwappedUTF16ToUTF8(
+  const CharUTF16* src,
+  size_t src_length,
+  CharUTF8* dest,
+  size_t dest_length) -> TranscodeResult;
+auto SwappedUTF32ToUTF8(
+  const CharUTF32* src,
+  size_t src_length,
+  CharUTF8* dest,
+  size_t dest_length) -> TranscodeResult;
+
+// Latin-1 takes one or two bytes per code point in UTF-8. The decoding kernel
+// only consumes ASCII and the two-byte sequences of U+0080..U+00FF.
+auto Latin1ToUTF8(
+  const CharLatin1* src,
+  size_t src_length,
+  CharUTF8* dest,
+  size_t dest_length) -> TranscodeResult;
+auto UTF8ToLatin1(
+  const CharUTF8* src,
+  size_t src_length,
+  CharLatin1* dest,
+  size_t dest_length) -> TranscodeResult;
+
+// Copies the ASCII prefix of |src| into |dest|, which must have room for
+// |src_length| code units. Stops in front of the first non-ASCII code unit.
+auto NarrowToASCII(const CharUTF16* src, size_t src_length, CharASCII* dest)
+  -> TranscodeResult;
+auto NarrowToASCII(const CharUTF32* src, size_t src_length, CharASCII* dest)
+  -> TranscodeResult;
+// Same for Latin-1, whose code units are those of UTF-16 below 0x100. Widening
+// has no prefix to stop at, only the tail shorter than one vector is left.
+auto Latin1ToUTF16(const CharLatin1* src, size_t src_length, CharUTF16* dest)
+  -> TranscodeResult;
+auto NarrowToLatin1(const CharUTF16* src, size_t src_length, CharLatin1* dest)
+  -> TranscodeResult;
+
+// The validators below answer for the whole input and carry their own scalar
+// fallback, so unlike the transcoding kernels they can be used directly.
+
+// Whether every code unit of |src| is below 0x80.
+auto IsASCII(const CharUTF8* src, size_t src_length) -> bool;
+auto IsASCII(const CharUTF16* src, size_t src_length) -> bool;
+auto IsASCII(const CharUTF32* src, size_t src_length) -> bool;
+
+// Number of leading bytes of |src| below 0x80.
+auto ASCIIPrefixLength(const CharUTF8* src, size_t src_length) -> size_t;
+
+// Writes |src| to |dest| with A-Z, resp. a-z, changed to the other case and
+// every other code unit, non-ASCII ones included, unchanged. |dest| has room
+// for |src_length| code units and may be |src| itself.
+void ToLowerASCII(const CharUTF8* src, size_t src_length, CharUTF8* dest);
+void ToLowerASCII(const CharUTF16* src, size_t src_length, CharUTF16* dest);
+void ToLowerASCII(const CharUTF32* src, size_t src_length, CharUTF32* dest);
+void ToUpperASCII(const CharUTF8* src, size_t src_length, CharUTF8* dest);
+void ToUpperASCII(const CharUTF16* src, size_t src_length, CharUTF16* dest);
+void ToUpperASCII(const CharUTF32* src, size_t src_length, CharUTF32* dest);
+
+// Length of the longest common prefix of |lhs| and |rhs|, both |length| code
+// units long, once A-Z are lowercased in both. Narrower code units are
+// zero-extended, so the mixed-width kernels take the narrower side first.
+auto CaseInsensitiveMismatchASCII(
+  const CharUTF8* lhs,
+  const CharUTF8* rhs,
+  size_t length) -> size_t;
+auto CaseInsensitiveMismatchASCII(
+  const CharUTF16* lhs,
+  const CharUTF16* rhs,
+  size_t length) -> size_t;
+auto CaseInsensitiveMismatchASCII(
+  const CharUTF32* lhs,
+  const CharUTF32* rhs,
+  size_t length) -> size_t;
+auto CaseInsensitiveMismatchASCII(
+  const CharUTF8* lhs,
+  const CharUTF16* rhs,
+  size_t length) -> size_t;
+auto CaseInsensitiveMismatchASCII(
+  const CharUTF8* lhs,
+  const CharUTF32* rhs,
+  size_t length) -> size_t;
+auto CaseInsensitiveMismatchASCII(
+  const CharUTF16* lhs,
+  const CharUTF32* rhs,
+  size_t length) -> size_t;
+
+// The code units below 0x100 of a base::CharSet, in the two layouts the
+// kernels look them up in. Both point to 32 bytes.
+struct ByteSet {
+  // Bit (unit & 7) of bitmap[unit >> 3] is set for the members.
+  const uint8_t* bitmap  = nullptr;
+  // Bit ((unit >> 4) & 7) of nibbles[(unit >> 7) * 16 + (unit & 15)] is set
+  // for the members, the layout of two pshufb lookups.
+  const uint8_t* nibbles = nullptr;
+};
+
+// Index of the first code unit of |src| below 0x100 whose membership in |set|
+// differs from |negate|, or with |stop_at_wide|, of the first code unit above
+// 0xFF, whichever comes first. |src_length| when there is none. These answer
+// for the whole input.
+auto FindInByteSet(
+  const CharUTF8* src,
+  size_t src_length,
+  const ByteSet& set,
+  bool negate) -> size_t;
+auto FindInByteSet(
+  const CharUTF16* src,
+  size_t src_length,
+  const ByteSet& set,
+  bool negate,
+  bool stop_at_wide) -> size_t;
+auto FindInByteSet(
+  const CharUTF32* src,
+  size_t src_length,
+  const ByteSet& set,
+  bool negate,
+  bool stop_at_wide) -> size_t;
+
+// Index of the first occurrence of |needle|, which is not empty, in
+// |haystack|, or |haystack_length| when there is none.
+auto FindSubstring(
+  const CharUTF8* haystack,
+  size_t haystack_length,
+  const CharUTF8* needle,
+  size_t needle_length) -> size_t;
+auto FindSubstring(
+  const CharUTF16* haystack,
+  size_t haystack_length,
+  const CharUTF16* needle,
+  size_t needle_length) -> size_t;
+auto FindSubstring(
+  const CharUTF32* haystack,
+  size_t haystack_length,
+  const CharUTF32* needle,
+  size_t needle_length) -> size_t;
+
+struct UTF8Validation {
+  // Whether |src| only holds shortest-form encodings of Unicode scalar values.
+  bool valid                    = false;
+  // Set when |src| may encode a noncharacter (U+FDD0..U+FDEF, U+xFFFE or
+  // U+xFFFF). False positives are possible, false negatives are not.
+  bool may_have_noncharacters   = false;
+};
+
+// Keiser and Lemire's lookup table validator, "Validating UTF-8 In Less Than
+// One Instruction Per Byte".
+auto ValidateUTF8(const CharUTF8* src, size_t src_length) -> UTF8Validation;
+
+}    // namespace longlp::base::internal::simd
+
+#endif    // LONGLP_SRC_STRINGS_SIMD_UTF_KERNELS_H_
@@ -0,0 +1,465 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#include "base/compiler_specific.h"
+#include "base/cpu.h"
+#include "base/icu/utf.h"
+#include "base/predef.h"
+#include "base/strings/utf_string_conversion_utils.h"
+#include "strings/simd/load_store.h"
+#include "strings/simd/utf_kernels.h"
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+#  include <immintrin.h>
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+#  include <arm_neon.h>
+#endif
+
+namespace longlp::base::internal::simd {
+// NOLINTBEGIN(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+namespace {
+  using Kernel = auto (*)(const CharUTF8*, size_t) -> UTF8Validation;
+
+  // Every error a two byte window can show is given one bit. Three lookups,
+  // on the high and low nibble of the first byte and the high nibble of the
+  // second one, each return the errors the nibble is compatible with; an
+  // error is present iff all three agree on it.
+  //
+  // The only errors spanning more than two bytes are missing or extra third
+  // and fourth bytes. A continuation byte must follow a 3-byte lead at
+  // distance 2 and a 4-byte lead at distance 2 and 3: that is exactly the
+  // kTwoContinuations case, which the check flips into an error when it is
+  // not expected.
+  constexpr uint8_t kTooShort          = 1 << 0;    // 11______ 0_______
+                                                    // 11______ 11______
+  constexpr uint8_t kTooLong           = 1 << 1;    // 0_______ 10______
+  constexpr uint8_t kOverlong3         = 1 << 2;    // 11100000 100_____
+  constexpr uint8_t kTooLarge          = 1 << 3;    // 11110100 1001____
+                                                    // 11110100 101_____
+                                                    // 111101__ 1001____
+                                                    // 111101__ 101_____
+                                                    // 11111___ 1001____
+                                                    // 11111___ 101_____
+  constexpr uint8_t kSurrogate         = 1 << 4;    // 11101101 101_____
+  constexpr uint8_t kOverlong2         = 1 << 5;    // 1100000_ 10______
+  constexpr uint8_t kTooLarge1000      = 1 << 6;    // 11110101 1000____
+                                                    // 1111011_ 1000____
+                                                    // 11111___ 1000____
+  constexpr uint8_t kOverlong4         = 1 << 6;    // 11110000 1000____
+  constexpr uint8_t kTwoContinuations  = 1 << 7;    // 10______ 10______
+  // Errors decided by the high nibble of the first byte alone.
+  constexpr uint8_t kCarry = kTooShort | kTooLong | kTwoContinuations;
+
+  alignas(16) constexpr std::array<uint8_t, 16> kFirstByteHighNibble = {{
+    // 0_______ (ASCII)
+    kTooLong, kTooLong, kTooLong, kTooLong,
+    kTooLong, kTooLong, kTooLong, kTooLong,
+    // 10______ (continuation)
+    kTwoContinuations, kTwoContinuations, kTwoContinuations, kTwoContinuations,
+    // 1100____
+    kTooShort | kOverlong2,
+    // 1101____
+    kTooShort,
+    // 1110____
+    kTooShort | kOverlong3 | kSurrogate,
+    // 1111____
+    kTooShort | kTooLarge | kTooLarge1000 | kOverlong4,
+  }};
+
+  alignas(16) constexpr std::array<uint8_t, 16> kFirstByteLowNibble = {{
+    // ____0000
+    kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+    // ____0001
+    kCarry | kOverlong2,
+    // ____001_
+    kCarry,
+    kCarry,
+    // ____0100
+    kCarry | kTooLarge,
+    // ____0101
+    kCarry | kTooLarge | kTooLarge1000,
+    // ____011_
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    // ____1___
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    // ____1101
+    kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+  }};
+
+  alignas(16) constexpr std::array<uint8_t, 16> kSecondByteHighNibble = {{
+    // 0_______ (ASCII)
+    kTooShort, kTooShort, kTooShort, kTooShort,
+    kTooShort, kTooShort, kTooShort, kTooShort,
+    // 1000____
+    kTooLong | kOverlong2 | kTwoContinuations | kOverlong3 | kTooLarge1000 |
+      kOverlong4,
+    // 1001____
+    kTooLong | kOverlong2 | kTwoContinuations | kOverlong3 | kTooLarge,
+    // 101_____
+    kTooLong | kOverlong2 | kTwoContinuations | kSurrogate | kTooLarge,
+    kTooLong | kOverlong2 | kTwoContinuations | kSurrogate | kTooLarge,
+    // 11______
+    kTooShort, kTooShort, kTooShort, kTooShort,
+  }};
+
+  // A block ending with a lead byte whose sequence does not fit in it leaves
+  // its last bytes above these bounds. The next block must then continue the
+  // sequence, which an ASCII block (or the end of the input) does not.
+  template <size_t kSize>
+  constexpr auto MakeIncompleteBounds() -> std::array<uint8_t, kSize> {
+    std::array<uint8_t, kSize> bounds{};
+    bounds.fill(0xFF);
+    bounds[kSize - 3] = 0xF0 - 1;
+    bounds[kSize - 2] = 0xE0 - 1;
+    bounds[kSize - 1] = 0xC0 - 1;
+    return bounds;
+  }
+
+  // Noncharacters are U+FDD0..U+FDEF (EF B7 90..EF B7 AF) and the code points
+  // ending in FFFE or FFFF, whose encodings end with BF BE or BF BF. The
+  // kernels flag any EF B7, BF BE or BF BF byte pair in valid input, which
+  // only costs a scalar pass for the rare code points sharing those bytes.
+  constexpr uint8_t kNoncharacterLead        = 0xEF;
+  constexpr uint8_t kNoncharacterArabicBlock = 0xB7;
+  constexpr uint8_t kNoncharacterPlaneEnd    = 0xBF;
+
+  auto ValidateUTF8Scalar(const CharUTF8* src, size_t src_length)
+    -> UTF8Validation {
+    const auto* bytes  = reinterpret_cast<const uint8_t*>(src);
+    const auto length  = static_cast<int32_t>(src_length);
+    bool has_nonchar   = false;
+    for (int32_t i = 0; i < length;) {
+      icu::CodePoint code_point;
+      icu::internal::U8Next(bytes, i, length, *code_point);
+      if (!IsValidCodepoint(code_point)) {
+        return {};
+      }
+      has_nonchar |= !IsValidCharacter(code_point);
+    }
+    return {.valid = true, .may_have_noncharacters = has_nonchar};
+  }
+
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+  struct StateSSE42 {
+    __m128i error;
+    __m128i noncharacters;
+    __m128i prev_input;
+    __m128i prev_incomplete;
+  };
+
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE auto Lookup16SSE42(
+    const std::array<uint8_t, 16>& table,
+    __m128i nibbles) -> __m128i {
+    return _mm_shuffle_epi8(LoadUnaligned<__m128i>(table.data()), nibbles);
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  LONGLP_ALWAYS_INLINE void CheckBlockSSE42(__m128i input, StateSSE42& state) {
+    static constexpr auto kIncompleteBounds = MakeIncompleteBounds<16>();
+
+    if (_mm_testz_si128(input, _mm_set1_epi8(static_cast<char>(0x80)))) {
+      state.error = _mm_or_si128(state.error, state.prev_incomplete);
+      state.prev_incomplete = _mm_setzero_si128();
+      state.prev_input      = input;
+      return;
+    }
+
+    const __m128i low_nibbles = _mm_set1_epi8(0x0F);
+    const __m128i prev1 = _mm_alignr_epi8(input, state.prev_input, 15);
+    const __m128i prev2 = _mm_alignr_epi8(input, state.prev_input, 14);
+    const __m128i prev3 = _mm_alignr_epi8(input, state.prev_input, 13);
+
+    const __m128i special_cases = _mm_and_si128(
+      _mm_and_si128(
+        Lookup16SSE42(
+          kFirstByteHighNibble,
+          _mm_and_si128(_mm_srli_epi16(prev1, 4), low_nibbles)),
+        Lookup16SSE42(kFirstByteLowNibble, _mm_and_si128(prev1, low_nibbles))),
+      Lookup16SSE42(
+        kSecondByteHighNibble,
+        _mm_and_si128(_mm_srli_epi16(input, 4), low_nibbles)));
+
+    // Only 111_____ (resp. 1111____) stay at or above 0x80.
+    const __m128i must_be_continuation = _mm_and_si128(
+      _mm_or_si128(
+        _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80))),
+        _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)))),
+      _mm_set1_epi8(static_cast<char>(0x80)));
+    state.error = _mm_or_si128(
+      state.error,
+      _mm_xor_si128(must_be_continuation, special_cases));
+
+    const __m128i arabic_block = _mm_and_si128(
+      _mm_cmpeq_epi8(
+        prev1,
+        _mm_set1_epi8(static_cast<char>(kNoncharacterLead))),
+      _mm_cmpeq_epi8(
+        input,
+        _mm_set1_epi8(static_cast<char>(kNoncharacterArabicBlock))));
+    const __m128i plane_end = _mm_and_si128(
+      _mm_cmpeq_epi8(
+        prev1,
+        _mm_set1_epi8(static_cast<char>(kNoncharacterPlaneEnd))),
+      _mm_cmpeq_epi8(
+        _mm_or_si128(input, _mm_set1_epi8(1)),
+        _mm_set1_epi8(static_cast<char>(kNoncharacterPlaneEnd))));
+    state.noncharacters = _mm_or_si128(
+      state.noncharacters,
+      _mm_or_si128(arabic_block, plane_end));
+
+    state.prev_incomplete =
+      _mm_subs_epu8(input, LoadUnaligned<__m128i>(kIncompleteBounds.data()));
+    state.prev_input = input;
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("sse4.2")
+  auto ValidateUTF8SSE42(const CharUTF8* src, size_t src_length)
+    -> UTF8Validation {
+    const __m128i zero = _mm_setzero_si128();
+    StateSSE42 state{zero, zero, zero, zero};
+    size_t i = 0;
+    for (; i + 16 <= src_length; i += 16) {
+      CheckBlockSSE42(LoadUnaligned<__m128i>(src + i), state);
+    }
+    // The zero padding reads as ASCII, which ends the input as the real end
+    // would.
+    if (i < src_length) {
+      alignas(16) std::array<uint8_t, 16> tail{};
+      std::memcpy(tail.data(), src + i, src_length - i);
+      CheckBlockSSE42(LoadUnaligned<__m128i>(tail.data()), state);
+    }
+    const __m128i error = _mm_or_si128(state.error, state.prev_incomplete);
+    return {
+      .valid                  = _mm_testz_si128(error, error) != 0,
+      .may_have_noncharacters = _mm_testz_si128(
+                                  state.noncharacters,
+                                  state.noncharacters) == 0};
+  }
+
+  struct StateAVX2 {
+    __m256i error;
+    __m256i noncharacters;
+    __m256i prev_input;
+    __m256i prev_incomplete;
+  };
+
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  LONGLP_ALWAYS_INLINE auto Lookup16AVX2(
+    const std::array<uint8_t, 16>& table,
+    __m256i nibbles) -> __m256i {
+    return _mm256_shuffle_epi8(
+      _mm256_broadcastsi128_si256(LoadUnaligned<__m128i>(table.data())),
+      nibbles);
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  LONGLP_ALWAYS_INLINE void CheckBlockAVX2(__m256i input, StateAVX2& state) {
+    static constexpr auto kIncompleteBounds = MakeIncompleteBounds<32>();
+
+    if (_mm256_testz_si256(input, _mm256_set1_epi8(static_cast<char>(0x80)))) {
+      state.error = _mm256_or_si256(state.error, state.prev_incomplete);
+      state.prev_incomplete = _mm256_setzero_si256();
+      state.prev_input      = input;
+      return;
+    }
+
+    // alignr works within 128-bit lanes: shift against the high lane of the
+    // previous block followed by the low lane of this one.
+    const __m256i low_nibbles = _mm256_set1_epi8(0x0F);
+    const __m256i shifted_in =
+      _mm256_permute2x128_si256(state.prev_input, input, 0x21);
+    const __m256i prev1 = _mm256_alignr_epi8(input, shifted_in, 15);
+    const __m256i prev2 = _mm256_alignr_epi8(input, shifted_in, 14);
+    const __m256i prev3 = _mm256_alignr_epi8(input, shifted_in, 13);
+
+    const __m256i special_cases = _mm256_and_si256(
+      _mm256_and_si256(
+        Lookup16AVX2(
+          kFirstByteHighNibble,
+          _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low_nibbles)),
+        Lookup16AVX2(
+          kFirstByteLowNibble,
+          _mm256_and_si256(prev1, low_nibbles))),
+      Lookup16AVX2(
+        kSecondByteHighNibble,
+        _mm256_and_si256(_mm256_srli_epi16(input, 4), low_nibbles)));
+
+    const __m256i must_be_continuation = _mm256_and_si256(
+      _mm256_or_si256(
+        _mm256_subs_epu8(
+          prev2,
+          _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80))),
+        _mm256_subs_epu8(
+          prev3,
+          _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)))),
+      _mm256_set1_epi8(static_cast<char>(0x80)));
+    state.error = _mm256_or_si256(
+      state.error,
+      _mm256_xor_si256(must_be_continuation, special_cases));
+
+    const __m256i arabic_block = _mm256_and_si256(
+      _mm256_cmpeq_epi8(
+        prev1,
+        _mm256_set1_epi8(static_cast<char>(kNoncharacterLead))),
+      _mm256_cmpeq_epi8(
+        input,
+        _mm256_set1_epi8(static_cast<char>(kNoncharacterArabicBlock))));
+    const __m256i plane_end = _mm256_and_si256(
+      _mm256_cmpeq_epi8(
+        prev1,
+        _mm256_set1_epi8(static_cast<char>(kNoncharacterPlaneEnd))),
+      _mm256_cmpeq_epi8(
+        _mm256_or_si256(input, _mm256_set1_epi8(1)),
+        _mm256_set1_epi8(static_cast<char>(kNoncharacterPlaneEnd))));
+    state.noncharacters = _mm256_or_si256(
+      state.noncharacters,
+      _mm256_or_si256(arabic_block, plane_end));
+
+    state.prev_incomplete =
+      _mm256_subs_epu8(input, LoadUnaligned<__m256i>(kIncompleteBounds.data()));
+    state.prev_input = input;
+  }
+
+  LONGLP_TARGET_ATTRIBUTE("avx2")
+  auto ValidateUTF8AVX2(const CharUTF8* src, size_t src_length)
+    -> UTF8Validation {
+    const __m256i zero = _mm256_setzero_si256();
+    StateAVX2 state{zero, zero, zero, zero};
+    size_t i = 0;
+    for (; i + 32 <= src_length; i += 32) {
+      CheckBlockAVX2(LoadUnaligned<__m256i>(src + i), state);
+    }
+    if (i < src_length) {
+      alignas(32) std::array<uint8_t, 32> tail{};
+      std::memcpy(tail.data(), src + i, src_length - i);
+      CheckBlockAVX2(LoadUnaligned<__m256i>(tail.data()), state);
+    }
+    const __m256i error = _mm256_or_si256(state.error, state.prev_incomplete);
+    return {
+      .valid                  = _mm256_testz_si256(error, error) != 0,
+      .may_have_noncharacters = _mm256_testz_si256(
+                                  state.noncharacters,
+                                  state.noncharacters) == 0};
+  }
+#endif    // defined(LONGLP_ARCH_CPU_X86_FAMILY)
+
+#if defined(LONGLP_ARCH_CPU_ARM64)
+  struct StateNEON {
+    uint8x16_t error;
+    uint8x16_t noncharacters;
+    uint8x16_t prev_input;
+    uint8x16_t prev_incomplete;
+  };
+
+  LONGLP_ALWAYS_INLINE void CheckBlockNEON(uint8x16_t input, StateNEON& state) {
+    static constexpr auto kIncompleteBounds = MakeIncompleteBounds<16>();
+
+    if (vmaxvq_u8(input) < 0x80) {
+      state.error           = vorrq_u8(state.error, state.prev_incomplete);
+      state.prev_incomplete = vdupq_n_u8(0);
+      state.prev_input      = input;
+      return;
+    }
+
+    const uint8x16_t prev1 = vextq_u8(state.prev_input, input, 15);
+    const uint8x16_t prev2 = vextq_u8(state.prev_input, input, 14);
+    const uint8x16_t prev3 = vextq_u8(state.prev_input, input, 13);
+
+    const uint8x16_t special_cases = vandq_u8(
+      vandq_u8(
+        vqtbl1q_u8(vld1q_u8(kFirstByteHighNibble.data()), vshrq_n_u8(prev1, 4)),
+        vqtbl1q_u8(
+          vld1q_u8(kFirstByteLowNibble.data()),
+          vandq_u8(prev1, vdupq_n_u8(0x0F)))),
+      vqtbl1q_u8(vld1q_u8(kSecondByteHighNibble.data()), vshrq_n_u8(input, 4)));
+
+    const uint8x16_t must_be_continuation = vandq_u8(
+      vorrq_u8(
+        vqsubq_u8(prev2, vdupq_n_u8(0xE0 - 0x80)),
+        vqsubq_u8(prev3, vdupq_n_u8(0xF0 - 0x80))),
+      vdupq_n_u8(0x80));
+    state.error = vorrq_u8(
+      state.error,
+      veorq_u8(must_be_continuation, special_cases));
+
+    const uint8x16_t arabic_block = vandq_u8(
+      vceqq_u8(prev1, vdupq_n_u8(kNoncharacterLead)),
+      vceqq_u8(input, vdupq_n_u8(kNoncharacterArabicBlock)));
+    const uint8x16_t plane_end = vandq_u8(
+      vceqq_u8(prev1, vdupq_n_u8(kNoncharacterPlaneEnd)),
+      vceqq_u8(
+        vorrq_u8(input, vdupq_n_u8(1)),
+        vdupq_n_u8(kNoncharacterPlaneEnd)));
+    state.noncharacters = vorrq_u8(
+      state.noncharacters,
+      vorrq_u8(arabic_block, plane_end));
+
+    state.prev_incomplete =
+      vqsubq_u8(input, vld1q_u8(kIncompleteBounds.data()));
+    state.prev_input = input;
+  }
+
+  auto ValidateUTF8NEON(const CharUTF8* src, size_t src_length)
+    -> UTF8Validation {
+    const uint8x16_t zero = vdupq_n_u8(0);
+    StateNEON state{zero, zero, zero, zero};
+    const auto* bytes = reinterpret_cast<const uint8_t*>(src);
+    size_t i          = 0;
+    for (; i + 16 <= src_length; i += 16) {
+      CheckBlockNEON(vld1q_u8(bytes + i), state);
+    }
+    if (i < src_length) {
+      std::array<uint8_t, 16> tail{};
+      std::memcpy(tail.data(), bytes + i, src_length - i);
+      CheckBlockNEON(vld1q_u8(tail.data()), state);
+    }
+    return {
+      .valid =
+        vmaxvq_u8(vorrq_u8(state.error, state.prev_incomplete)) == 0,
+      .may_have_noncharacters = vmaxvq_u8(state.noncharacters) != 0};
+  }
+#endif    // defined(LONGLP_ARCH_CPU_ARM64)
+
+  // The AVX2 kernel already runs at memory speed on ASCII and the lookups do
+  // not get cheaper with AVX-512, so AVX-512 machines use it as well.
+  auto SelectKernel() -> Kernel {
+    [[maybe_unused]] const auto& cpu = CPU::GetInstanceNoAllocation();
+#if defined(LONGLP_ARCH_CPU_X86_FAMILY)
+    if (cpu.has_avx2()) {
+      return &ValidateUTF8AVX2;
+    }
+    if (cpu.has_sse42()) {
+      return &ValidateUTF8SSE42;
+    }
+#elif defined(LONGLP_ARCH_CPU_ARM64)
+    if (cpu.has_neon()) {
+      return &ValidateUTF8NEON;
+    }
+#endif
+    return &ValidateUTF8Scalar;
+  }
+}    // namespace
+
+auto ValidateUTF8(const CharUTF8* src, size_t src_length) -> UTF8Validation {
+  static const Kernel kKernel = SelectKernel();
+  return kKernel(src, src_length);
+}
+
+// NOLINTEND(*-magic-numbers, *-reinterpret-cast,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}    // namespace longlp::base::internal::simd
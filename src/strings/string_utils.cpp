@@ -4,19 +4,91 @@
 
 #include "base/strings/string_utils.h"
 
+#include <algorithm>
 #include <bit>
+#include <concepts>
 #include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
 #include "base/icu/utf.h"
+#include "base/no_destructor.h"
 #include "base/strings/utf_string_conversion_utils.h"
+#include "strings/simd/utf_kernels.h"
 
 namespace longlp::base {
+namespace {
+  // The sets of the whitespace trimmers, built on first use.
+  template <CharTraits Char, const std::basic_string_view<Char>& kChars>
+  auto CharSetOf() -> const CharSet<Char>& {
+    static const NoDestructor<CharSet<Char>> kSet(kChars);
+    return *kSet;
+  }
+
+  // Runs the case conversion kernel of |Char|, ASCII strings going through
+  // the UTF-8 one. |dest| may be |src|.
+  template <bool kToUpper, CharTraits Char>
+  void ChangeCaseASCII(const Char* src, size_t length, Char* dest) {
+    if constexpr (std::same_as<Char, CharASCII>) {
+      ChangeCaseASCII<kToUpper>(
+        std::bit_cast<const CharUTF8*>(src),
+        length,
+        std::bit_cast<CharUTF8*>(dest));
+    }
+    else if constexpr (kToUpper) {
+      internal::simd::ToUpperASCII(src, length, dest);
+    }
+    else {
+      internal::simd::ToLowerASCII(src, length, dest);
+    }
+  }
+
+  template <bool kToUpper, CharTraits Char>
+  auto ChangeCaseASCII(std::basic_string_view<Char> str)
+    -> std::basic_string<Char> {
+    std::basic_string<Char> result(str.size(), Char{});
+    ChangeCaseASCII<kToUpper>(str.data(), str.size(), result.data());
+    return result;
+  }
+
+  template <bool kToUpper, CharTraits Char>
+  auto ChangeCaseASCII(
+    std::basic_string_view<Char> str,
+    std::span<Char> output) -> bool {
+    if (output.size() < str.size()) {
+      return false;
+    }
+    ChangeCaseASCII<kToUpper>(str.data(), str.size(), output.data());
+    return true;
+  }
+}    // namespace
+
 #define LONGLP_DEFINE_TO_LOWER_AND_TO_UPPER_ASCII(CharType)       \
   auto ToLowerASCII(StringView##CharType str)->String##CharType { \
-    return internal::ToLowerASCII<Char##CharType>(str);           \
+    return ChangeCaseASCII<false>(str);                           \
   }                                                               \
   auto ToUpperASCII(StringView##CharType str)->String##CharType { \
-    return internal::ToUpperASCII<Char##CharType>(str);           \
+    return ChangeCaseASCII<true>(str);                            \
+  }                                                               \
+  auto ToLowerASCII(                                              \
+    StringView##CharType str,                                     \
+    std::span<Char##CharType> output)                             \
+    ->bool {                                                      \
+    return ChangeCaseASCII<false>(str, output);                   \
+  }                                                               \
+  auto ToUpperASCII(                                              \
+    StringView##CharType str,                                     \
+    std::span<Char##CharType> output)                             \
+    ->bool {                                                      \
+    return ChangeCaseASCII<true>(str, output);                    \
+  }                                                               \
+  void ToLowerASCIIInPlace(String##CharType& str) {               \
+    ChangeCaseASCII<false>(str.data(), str.size(), str.data());   \
+  }                                                               \
+  void ToUpperASCIIInPlace(String##CharType& str) {               \
+    ChangeCaseASCII<true>(str.data(), str.size(), str.data());    \
   }
 
 LONGLP_DEFINE_TO_LOWER_AND_TO_UPPER_ASCII(ASCII)
@@ -26,12 +98,172 @@ LONGLP_DEFINE_TO_LOWER_AND_TO_UPPER_ASCII(UTF32)
 
 #undef LONGLP_DEFINE_TO_LOWER_AND_TO_UPPER_ASCII
 
+namespace {
+  // The kernels take the char8_t view of ASCII strings.
+  template <CharTraits Char>
+  using KernelUnit =
+    std::conditional_t<std::same_as<Char, CharASCII>, CharUTF8, Char>;
+
+  template <CharTraits Char>
+  auto KernelUnits(std::basic_string_view<Char> str)
+    -> const KernelUnit<Char>* {
+    return std::bit_cast<const KernelUnit<Char>*>(str.data());
+  }
+
+  // Index of the first code unit that differs ignoring case, or the common
+  // length of |lhs| and |rhs|.
+  template <CharTraits CharA, CharTraits CharB>
+  auto CaseInsensitiveMismatchASCII(
+    std::basic_string_view<CharA> lhs,
+    std::basic_string_view<CharB> rhs) -> size_t {
+    if constexpr (sizeof(CharA) > sizeof(CharB)) {
+      return CaseInsensitiveMismatchASCII(rhs, lhs);
+    }
+    else {
+      return internal::simd::CaseInsensitiveMismatchASCII(
+        KernelUnits(lhs),
+        KernelUnits(rhs),
+        std::min(lhs.size(), rhs.size()));
+    }
+  }
+
+  template <CharTraits Char>
+  auto VectorizedCompare(
+    std::basic_string_view<Char> lhs,
+    std::basic_string_view<Char> rhs) -> int32_t {
+    // The scalar comparison settles the first difference, or the lengths.
+    const size_t equal_length = CaseInsensitiveMismatchASCII(lhs, rhs);
+    return internal::CompareCaseInsensitiveASCII<Char>(
+      lhs.substr(equal_length),
+      rhs.substr(equal_length));
+  }
+
+  template <CharTraits CharA, CharTraits CharB>
+  auto VectorizedEquals(
+    std::basic_string_view<CharA> lhs,
+    std::basic_string_view<CharB> rhs) -> bool {
+    if constexpr (
+      std::same_as<CharB, CharASCII> && !std::same_as<CharA, CharASCII>) {
+      return VectorizedEquals(rhs, lhs);
+    }
+    else {
+      if (lhs.size() != rhs.size()) {
+        return false;
+      }
+      // A negative char is compared to the other type after integral
+      // promotion, unlike the zero-extended code units of the kernels. Such
+      // strings keep the scalar comparison.
+      if constexpr (
+        std::is_signed_v<CharASCII> && std::same_as<CharA, CharASCII> &&
+        !std::same_as<CharB, CharASCII>) {
+        if (!IsStringASCII(lhs)) {
+          return internal::EqualsCaseInsensitiveASCII(lhs, rhs);
+        }
+      }
+      return CaseInsensitiveMismatchASCII(lhs, rhs) == lhs.size();
+    }
+  }
+
+  template <CharTraits Char>
+  auto FindSubstring(
+    std::basic_string_view<Char> str,
+    std::basic_string_view<Char> find_this,
+    size_t pos) -> size_t {
+    if (pos > str.size() || find_this.size() > str.size() - pos) {
+      return std::basic_string_view<Char>::npos;
+    }
+    if (find_this.empty()) {
+      return pos;
+    }
+    const size_t found = internal::simd::FindSubstring(
+      KernelUnits(str) + pos,
+      str.size() - pos,
+      KernelUnits(find_this),
+      find_this.size());
+    return found == str.size() - pos ? std::basic_string_view<Char>::npos
+                                     : pos + found;
+  }
+}    // namespace
+
+namespace internal {
+#define LONGLP_DEFINE_VECTORIZED_FIND(CharType) \
+  auto VectorizedFind(                          \
+    StringView##CharType str,                   \
+    StringView##CharType find_this,             \
+    size_t pos)                                 \
+    ->size_t {                                  \
+    return FindSubstring(str, find_this, pos);  \
+  }
+
+  LONGLP_DEFINE_VECTORIZED_FIND(ASCII)
+  LONGLP_DEFINE_VECTORIZED_FIND(UTF8)
+  LONGLP_DEFINE_VECTORIZED_FIND(UTF16)
+  LONGLP_DEFINE_VECTORIZED_FIND(UTF32)
+
+#undef LONGLP_DEFINE_VECTORIZED_FIND
+
+#define LONGLP_DEFINE_VECTORIZED_COMPARE_CASE_INSENSITIVE_ASCII(CharType) \
+  auto VectorizedCompareCaseInsensitiveASCII(                             \
+    StringView##CharType lhs,                                             \
+    StringView##CharType rhs)                                             \
+    ->int32_t {                                                           \
+    return VectorizedCompare(lhs, rhs);                                   \
+  }
+
+  LONGLP_DEFINE_VECTORIZED_COMPARE_CASE_INSENSITIVE_ASCII(ASCII)
+  LONGLP_DEFINE_VECTORIZED_COMPARE_CASE_INSENSITIVE_ASCII(UTF8)
+  LONGLP_DEFINE_VECTORIZED_COMPARE_CASE_INSENSITIVE_ASCII(UTF16)
+  LONGLP_DEFINE_VECTORIZED_COMPARE_CASE_INSENSITIVE_ASCII(UTF32)
+
+#undef LONGLP_DEFINE_VECTORIZED_COMPARE_CASE_INSENSITIVE_ASCII
+
+#define LONGLP_DEFINE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(CharA, CharB) \
+  auto VectorizedEqualsCaseInsensitiveASCII(                                 \
+    StringView##CharA lhs,                                                   \
+    StringView##CharB rhs)                                                   \
+    ->bool {                                                                 \
+    return VectorizedEquals(lhs, rhs);                                       \
+  }
+
+  LONGLP_DEFINE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF8, UTF8)
+  LONGLP_DEFINE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF8, UTF16)
+  LONGLP_DEFINE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF8, UTF32)
+  LONGLP_DEFINE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF8, ASCII)
+
+  LONGLP_DEFINE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF16, UTF8)
+  LONGLP_DEFINE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF16, UTF16)
+  LONGLP_DEFINE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF16, UTF32)
+  LONGLP_DEFINE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF16, ASCII)
+
+  LONGLP_DEFINE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF32, UTF8)
+  LONGLP_DEFINE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF32, UTF16)
+  LONGLP_DEFINE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF32, UTF32)
+  LONGLP_DEFINE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(UTF32, ASCII)
+
+  LONGLP_DEFINE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(ASCII, UTF8)
+  LONGLP_DEFINE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(ASCII, UTF16)
+  LONGLP_DEFINE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(ASCII, UTF32)
+  LONGLP_DEFINE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII(ASCII, ASCII)
+
+#undef LONGLP_DEFINE_VECTORIZED_EQUALS_CASE_INSENSITIVE_ASCII
+}    // namespace internal
+
 #define LONGLP_DEFINE_REMOVE_CHARS(CharType)                                \
   auto RemoveChars(                                                         \
     StringView##CharType input,                                             \
     StringView##CharType remove_chars,                                      \
     String##CharType& output)                                               \
     ->bool {                                                                \
+    return RemoveChars(                                                     \
+      input,                                                                \
+      CharSet<Char##CharType>(remove_chars),                                \
+      output);                                                              \
+  }                                                                         \
+  auto RemoveChars(                                                         \
+    StringView##CharType input,                                             \
+    const CharSet<Char##CharType>& remove_chars,                            \
+    String##CharType& output)                                               \
+    ->bool {                                                                \
     return internal::ReplaceChars<                                          \
       Char##CharType>(input, remove_chars, StringView##CharType(), output); \
   }
@@ -49,6 +281,18 @@ LONGLP_DEFINE_REMOVE_CHARS(UTF32)
     StringView##CharType replace_with,                             \
     String##CharType& output)                                      \
     ->bool {                                                       \
+    return ReplaceChars(                                           \
+      input,                                                       \
+      CharSet<Char##CharType>(replace_chars),                      \
+      replace_with,                                                \
+      output);                                                     \
+  }                                                                \
+  auto ReplaceChars(                                               \
+    StringView##CharType input,                                    \
+    const CharSet<Char##CharType>& replace_chars,                  \
+    StringView##CharType replace_with,                             \
+    String##CharType& output)                                      \
+    ->bool {                                                       \
     return internal::ReplaceChars<                                 \
       Char##CharType>(input, replace_chars, replace_with, output); \
   }
@@ -59,25 +303,73 @@ LONGLP_DEFINE_REPLACE_CHARS(UTF32)
 
 #undef LONGLP_DEFINE_REPLACE_CHARS
 
-#define LONGLP_DEFINE_TRIM_STRING(CharType)          \
-  auto TrimString(                                   \
-    StringView##CharType input,                      \
-    StringView##CharType trim_chars,                 \
-    String##CharType& output)                        \
-    ->bool {                                         \
-    return internal::TrimString<Char##CharType>(     \
-             input,                                  \
-             trim_chars,                             \
-             TrimPositions::kTrimAll,                \
-             output) != TrimPositions::kTrimNone;    \
-  }                                                  \
-  auto TrimString(                                   \
-    StringView##CharType input,                      \
-    StringView##CharType trim_chars,                 \
-    TrimPositions positions)                         \
-    ->StringView##CharType {                         \
-    return internal::TrimStringView<                 \
-      Char##CharType>(input, trim_chars, positions); \
+#define LONGLP_DEFINE_REPLACE_SUBSTRINGS_AFTER_OFFSET(CharType) \
+  auto ReplaceFirstSubstringAfterOffset(                        \
+    String##CharType& str,                                      \
+    size_t start_offset,                                        \
+    StringView##CharType find_this,                             \
+    StringView##CharType replace_with)                          \
+    ->bool {                                                    \
+    return internal::DoReplaceMatchesAfterOffset(               \
+      str,                                                      \
+      start_offset,                                             \
+      internal::SubstringMatcher<Char##CharType>{find_this},    \
+      replace_with,                                             \
+      internal::ReplaceType::kReplaceFirst);                    \
+  }                                                             \
+  auto ReplaceSubstringsAfterOffset(                            \
+    String##CharType& str,                                      \
+    size_t start_offset,                                        \
+    StringView##CharType find_this,                             \
+    StringView##CharType replace_with)                          \
+    ->bool {                                                    \
+    return internal::DoReplaceMatchesAfterOffset(               \
+      str,                                                      \
+      start_offset,                                             \
+      internal::SubstringMatcher<Char##CharType>{find_this},    \
+      replace_with,                                             \
+      internal::ReplaceType::kReplaceAll);                      \
+  }
+LONGLP_DEFINE_REPLACE_SUBSTRINGS_AFTER_OFFSET(ASCII)
+LONGLP_DEFINE_REPLACE_SUBSTRINGS_AFTER_OFFSET(UTF8)
+LONGLP_DEFINE_REPLACE_SUBSTRINGS_AFTER_OFFSET(UTF16)
+LONGLP_DEFINE_REPLACE_SUBSTRINGS_AFTER_OFFSET(UTF32)
+
+#undef LONGLP_DEFINE_REPLACE_SUBSTRINGS_AFTER_OFFSET
+
+#define LONGLP_DEFINE_TRIM_STRING(CharType)                                   \
+  auto TrimString(                                                            \
+    StringView##CharType input,                                               \
+    StringView##CharType trim_chars,                                          \
+    String##CharType& output)                                                 \
+    ->bool {                                                                  \
+    return TrimString(input, CharSet<Char##CharType>(trim_chars), output);    \
+  }                                                                           \
+  auto TrimString(                                                            \
+    StringView##CharType input,                                               \
+    StringView##CharType trim_chars,                                          \
+    TrimPositions positions)                                                  \
+    ->StringView##CharType {                                                  \
+    return TrimString(input, CharSet<Char##CharType>(trim_chars), positions); \
+  }                                                                           \
+  auto TrimString(                                                            \
+    StringView##CharType input,                                               \
+    const CharSet<Char##CharType>& trim_chars,                                \
+    String##CharType& output)                                                 \
+    ->bool {                                                                  \
+    return internal::TrimString<Char##CharType>(                              \
+             input,                                                           \
+             trim_chars,                                                      \
+             TrimPositions::kTrimAll,                                         \
+             output) != TrimPositions::kTrimNone;                             \
+  }                                                                           \
+  auto TrimString(                                                            \
+    StringView##CharType input,                                               \
+    const CharSet<Char##CharType>& trim_chars,                                \
+    TrimPositions positions)                                                  \
+    ->StringView##CharType {                                                  \
+    return internal::TrimStringView<                                          \
+      Char##CharType>(input, trim_chars, positions);                          \
   }
 
 LONGLP_DEFINE_TRIM_STRING(ASCII)
@@ -93,13 +385,18 @@ LONGLP_DEFINE_TRIM_STRING(UTF32)
     TrimPositions positions,                                               \
     String##CharType& output)                                              \
     ->TrimPositions {                                                      \
-    return internal::TrimString<                                           \
-      Char##CharType>(input, kWhitespace##CharType, positions, output);    \
+    return internal::TrimString<Char##CharType>(                           \
+      input,                                                               \
+      CharSetOf<Char##CharType, kWhitespace##CharType>(),                  \
+      positions,                                                           \
+      output);                                                             \
   }                                                                        \
   auto TrimWhitespace(StringView##CharType input, TrimPositions positions) \
     ->StringView##CharType {                                               \
-    return internal::TrimStringView<                                       \
-      Char##CharType>(input, kWhitespace##CharType, positions);            \
+    return internal::TrimStringView<Char##CharType>(                       \
+      input,                                                               \
+      CharSetOf<Char##CharType, kWhitespace##CharType>(),                  \
+      positions);                                                          \
   }
 LONGLP_DEFINE_TRIM_WHITESPACE(UTF8)
 LONGLP_DEFINE_TRIM_WHITESPACE(UTF16)
@@ -107,20 +404,25 @@ LONGLP_DEFINE_TRIM_WHITESPACE(UTF32)
 
 #undef LONGLP_DEFINE_TRIM_WHITESPACE
 
-#define LONGLP_DEFINE_TRIM_WHITESPACE_ASCII(CharType)                          \
-  auto TrimWhitespaceASCII(                                                    \
-    StringView##CharType input,                                                \
-    TrimPositions positions,                                                   \
-    String##CharType& output)                                                  \
-    ->TrimPositions {                                                          \
-    return internal::TrimString<                                               \
-      Char##CharType>(input, kWhitespaceASCIIAs##CharType, positions, output); \
-  }                                                                            \
-  auto                                                                         \
-  TrimWhitespaceASCII(StringView##CharType input, TrimPositions positions)     \
-    ->StringView##CharType {                                                   \
-    return internal::TrimStringView<                                           \
-      Char##CharType>(input, kWhitespaceASCIIAs##CharType, positions);         \
+#define LONGLP_DEFINE_TRIM_WHITESPACE_ASCII(CharType)                      \
+  auto TrimWhitespaceASCII(                                                \
+    StringView##CharType input,                                            \
+    TrimPositions positions,                                               \
+    String##CharType& output)                                              \
+    ->TrimPositions {                                                      \
+    return internal::TrimString<Char##CharType>(                           \
+      input,                                                               \
+      CharSetOf<Char##CharType, kWhitespaceASCIIAs##CharType>(),           \
+      positions,                                                           \
+      output);                                                             \
+  }                                                                        \
+  auto                                                                     \
+  TrimWhitespaceASCII(StringView##CharType input, TrimPositions positions) \
+    ->StringView##CharType {                                               \
+    return internal::TrimStringView<Char##CharType>(                       \
+      input,                                                               \
+      CharSetOf<Char##CharType, kWhitespaceASCIIAs##CharType>(),           \
+      positions);                                                          \
   }
 LONGLP_DEFINE_TRIM_WHITESPACE_ASCII(UTF8)
 LONGLP_DEFINE_TRIM_WHITESPACE_ASCII(UTF16)
@@ -130,14 +432,19 @@ auto TrimWhitespaceASCII(
   StringViewASCII input,
   TrimPositions positions,
   StringASCII& output) -> TrimPositions {
-  return internal ::TrimString<
-    CharASCII>(input, kWhitespaceASCII, positions, output);
+  return internal ::TrimString<CharASCII>(
+    input,
+    CharSetOf<CharASCII, kWhitespaceASCII>(),
+    positions,
+    output);
 }
 
 auto TrimWhitespaceASCII(StringViewASCII input, TrimPositions positions)
   -> StringViewASCII {
-  return internal ::TrimStringView<
-    CharASCII>(input, kWhitespaceASCII, positions);
+  return internal ::TrimStringView<CharASCII>(
+    input,
+    CharSetOf<CharASCII, kWhitespaceASCII>(),
+    positions);
 }
 
 #undef LONGLP_DEFINE_TRIM_WHITESPACE_ASCII
@@ -187,4 +494,44 @@ void TruncateUTF8ToByteSize(
     output.clear();
   }
 }
+
+auto IsStringASCII(const StringViewASCII str) -> bool {
+  return internal::simd::IsASCII(
+    std::bit_cast<const CharUTF8*>(str.data()),
+    str.length());
+}
+
+#define LONGLP_DEFINE_IS_STRING_ASCII(CharType)               \
+  auto IsStringASCII(const StringView##CharType str)->bool {  \
+    return internal::simd::IsASCII(str.data(), str.length()); \
+  }
+LONGLP_DEFINE_IS_STRING_ASCII(UTF8)
+LONGLP_DEFINE_IS_STRING_ASCII(UTF16)
+LONGLP_DEFINE_IS_STRING_ASCII(UTF32)
+
+#undef LONGLP_DEFINE_IS_STRING_ASCII
+
+auto IsStringUTF8(const StringViewUTF8 str) -> bool {
+  const auto validation = internal::simd::ValidateUTF8(str.data(), str.size());
+  if (!validation.valid || !validation.may_have_noncharacters) {
+    return validation.valid;
+  }
+
+  // The vector validator only flags byte pairs that may belong to a
+  // noncharacter; decode the input to find out.
+  const auto* src     = std::bit_cast<const uint8_t*>(str.data());
+  const auto src_len  = static_cast<int32_t>(str.length());
+  for (int32_t char_index = 0; char_index < src_len;) {
+    icu::CodePoint code_point(0);
+    icu::internal::U8Next(src, char_index, src_len, *code_point);
+    if (!IsValidCharacter(code_point)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto IsStringUTF8AllowingNoncharacters(const StringViewUTF8 str) -> bool {
+  return internal::simd::ValidateUTF8(str.data(), str.size()).valid;
+}
 }    // namespace longlp::base
@@ -0,0 +1,82 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include "base/strings/utf8_position_index.h"
+
+#include <bit>
+#include <cstdint>
+
+#include "base/assert.h"
+#include "base/strings/utf_string_conversion_utils.h"
+#include "strings/simd/utf_kernels.h"
+
+namespace longlp::base {
+// NOLINTBEGIN(*-magic-numbers,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+namespace {
+  constexpr icu::CodePoint kErrorCodePoint(0xFFFD);
+}    // namespace
+
+UTF8PositionIndex::UTF8PositionIndex(StringViewUTF8 text, size_t stride)
+  : text_(text),
+    stride_(stride) {
+  LONGLP_EXPECTS(stride > 0);
+  const auto* data  = std::bit_cast<const uint8_t*>(text_.data());
+  const auto length = static_cast<int32_t>(text_.size());
+  for (int32_t i = 0; i < length;) {
+    // ASCII runs hold one code point per byte, so their samples need no
+    // decoding.
+    const size_t ascii = internal::simd::ASCIIPrefixLength(
+      text_.data() + i,
+      text_.size() - static_cast<size_t>(i));
+    for (size_t next = samples_.size() * stride_; next < size_ + ascii;
+         next += stride_) {
+      samples_.push_back(static_cast<size_t>(i) + next - size_);
+    }
+    size_ += ascii;
+    i += static_cast<int32_t>(ascii);
+    if (i >= length) {
+      break;
+    }
+
+    if (size_ == samples_.size() * stride_) {
+      samples_.push_back(static_cast<size_t>(i));
+    }
+    UChar32 code_point = 0;
+    icu::internal::U8Next(data, i, length, code_point);
+    ++size_;
+  }
+}
+
+auto UTF8PositionIndex::OffsetOf(size_t code_point_index) const -> size_t {
+  if (code_point_index >= size_) {
+    return code_point_index == size_ ? text_.size() : StringViewUTF8::npos;
+  }
+
+  const auto* data  = std::bit_cast<const uint8_t*>(text_.data());
+  const auto length = static_cast<int32_t>(text_.size());
+  auto offset =
+    static_cast<int32_t>(samples_[code_point_index / stride_]);
+  for (size_t skip = code_point_index % stride_; skip > 0; --skip) {
+    UChar32 code_point = 0;
+    icu::internal::U8Next(data, offset, length, code_point);
+  }
+  return static_cast<size_t>(offset);
+}
+
+auto UTF8PositionIndex::CodePointAt(size_t code_point_index) const
+  -> icu::CodePoint {
+  auto offset = static_cast<int32_t>(OffsetOf(code_point_index));
+  icu::CodePoint code_point;
+  icu::internal::U8Next(
+    std::bit_cast<const uint8_t*>(text_.data()),
+    offset,
+    static_cast<int32_t>(text_.size()),
+    *code_point);
+  return IsValidCodepoint(code_point) ? code_point : kErrorCodePoint;
+}
+
+// NOLINTEND(*-magic-numbers,
+// cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}    // namespace longlp::base
@@ -0,0 +1,169 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include "base/strings/utf_stream_converter.h"
+
+#include <algorithm>
+#include <bit>
+#include <span>
+
+#include "base/icu/utf.h"
+#include "base/strings/utf_string_conversion.h"
+#include "base/strings/utf_string_conversion_utils.h"
+
+namespace longlp::base {
+// NOLINTBEGIN(*-magic-numbers)
+namespace {
+  // The maximum number of code units in the destination encoding for one code
+  // unit in the source encoding, U+FFFD replacements included.
+  template <CharTraits SrcChar, CharTraits DestChar>
+  consteval auto MaxGrowth() -> size_t {
+    if constexpr (
+      std::same_as<SrcChar, CharUTF16> && std::same_as<DestChar, CharUTF8>) {
+      return 3;
+    }
+    if constexpr (
+      std::same_as<SrcChar, CharUTF32> && std::same_as<DestChar, CharUTF8>) {
+      return 4;
+    }
+    if constexpr (
+      std::same_as<SrcChar, CharUTF32> && std::same_as<DestChar, CharUTF16>) {
+      return 2;
+    }
+    return 1;
+  }
+
+  // Length of the trailing code units of |src| that may still become a valid
+  // code point with more input. Decoding never consumes a code unit that can
+  // start a code point as part of another one, so these always start one.
+  auto IncompleteTailLength(const StringViewUTF8 src) -> size_t {
+    const size_t limit = std::min<size_t>(src.size(), 3);
+    for (size_t length = 1; length <= limit; ++length) {
+      const auto lead = static_cast<uint8_t>(src[src.size() - length]);
+      if ((lead & 0xC0) == 0x80) {
+        continue;
+      }
+      if (lead < 0xC0) {
+        return 0;
+      }
+      // U8Next() stops in front of the first byte that cannot continue the
+      // sequence, so it only consumes everything when the input ended first.
+      const auto end      = static_cast<int32_t>(src.size());
+      auto offset         = end - static_cast<int32_t>(length);
+      UChar32 code_point  = 0;
+      icu::internal::U8Next(
+        std::bit_cast<const uint8_t*>(src.data()),
+        offset,
+        end,
+        code_point);
+      return offset == end && code_point < 0 ? length : 0;
+    }
+    return 0;
+  }
+
+  auto IncompleteTailLength(const StringViewUTF16 src) -> size_t {
+    return !src.empty() && icu::internal::U16IsLead(src.back()) ? 1 : 0;
+  }
+
+  // Appends the conversion of |src| to |output|. The output grows to the
+  // worst case first so that the conversion skips its size pre-pass; its
+  // capacity is kept for the next chunk.
+  template <CharTraits SrcChar, CharTraits DestChar>
+  auto AppendConversion(
+    const std::basic_string_view<SrcChar> src,
+    std::basic_string<DestChar>& output) -> bool {
+    const size_t offset = output.size();
+    output.resize(offset + MaxGrowth<SrcChar, DestChar>() * src.size());
+    const auto dest = std::span<DestChar>(output).subspan(offset);
+
+    UTFConversionResult result;
+    if constexpr (std::same_as<SrcChar, CharUTF8>) {
+      if constexpr (std::same_as<DestChar, CharUTF16>) {
+        result = UTF8ToUTF16(src, dest);
+      }
+      else {
+        result = UTF8ToUTF32(src, dest);
+      }
+    }
+    else if constexpr (std::same_as<SrcChar, CharUTF16>) {
+      if constexpr (std::same_as<DestChar, CharUTF8>) {
+        result = UTF16ToUTF8(src, dest);
+      }
+      else {
+        result = UTF16ToUTF32(src, dest);
+      }
+    }
+    else {
+      if constexpr (std::same_as<DestChar, CharUTF8>) {
+        result = UTF32ToUTF8(src, dest);
+      }
+      else {
+        result = UTF32ToUTF16(src, dest);
+      }
+    }
+
+    output.resize(offset + result.size);
+    return result.success;
+  }
+}    // namespace
+
+template <CharTraits SrcChar, CharTraits DestChar>
+auto UTFStreamConverter<SrcChar, DestChar>::Convert(
+  std::basic_string_view<SrcChar> chunk,
+  std::basic_string<DestChar>& output) -> bool {
+  bool success = true;
+
+  if constexpr (kMaxPending > 0) {
+    if (pending_size_ > 0) {
+      // Completes the pending code point with the first units of |chunk|.
+      std::array<SrcChar, 2 * kMaxPending> joined{};
+      const size_t taken = std::min(chunk.size(), kMaxPending);
+      std::copy_n(pending_.begin(), pending_size_, joined.begin());
+      std::copy_n(chunk.begin(), taken, joined.begin() + pending_size_);
+      const std::basic_string_view<SrcChar> head(
+        joined.data(),
+        pending_size_ + taken);
+
+      if (IncompleteTailLength(head) == head.size()) {
+        std::copy(head.begin(), head.end(), pending_.begin());
+        pending_size_ = head.size();
+        return true;
+      }
+
+      // The first code point spans at least the pending units, which were a
+      // prefix of it.
+      const size_t length = FirstCodePointLength(head);
+      success             = AppendConversion(head.substr(0, length), output);
+      chunk.remove_prefix(length - pending_size_);
+      pending_size_ = 0;
+    }
+
+    pending_size_ = IncompleteTailLength(chunk);
+    std::copy(chunk.end() - pending_size_, chunk.end(), pending_.begin());
+    chunk.remove_suffix(pending_size_);
+  }
+
+  return AppendConversion(chunk, output) && success;
+}
+
+template <CharTraits SrcChar, CharTraits DestChar>
+auto UTFStreamConverter<SrcChar, DestChar>::Finish(
+  std::basic_string<DestChar>& output) -> bool {
+  if (pending_size_ == 0) {
+    return true;
+  }
+  const std::basic_string_view<SrcChar> pending(pending_.data(), pending_size_);
+  pending_size_ = 0;
+  return AppendConversion(pending, output);
+}
+
+template class UTFStreamConverter<CharUTF8, CharUTF16>;
+template class UTFStreamConverter<CharUTF8, CharUTF32>;
+template class UTFStreamConverter<CharUTF16, CharUTF8>;
+template class UTFStreamConverter<CharUTF16, CharUTF32>;
+template class UTFStreamConverter<CharUTF32, CharUTF8>;
+template class UTFStreamConverter<CharUTF32, CharUTF16>;
+
+// NOLINTEND(*-magic-numbers)
+}    // namespace longlp::base
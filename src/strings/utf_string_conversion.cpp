@@ -4,13 +4,22 @@
 
 #include "base/strings/utf_string_conversion.h"
 
+#include <algorithm>
+#include <array>
 #include <bit>
 #include <climits>
 #include <concepts>
-#include <type_traits>
+#include <cstring>
+#include <numeric>
+#include <span>
+#include <thread>
+#include <vector>
 
 #include "base/icu/utf.h"
+#include "base/strings/string_utils.h"
 #include "base/strings/utf_string_conversion_utils.h"
+#include "strings/simd/byte_swap.h"
+#include "strings/simd/utf_kernels.h"
 
 namespace longlp::base {
 // NOLINTBEGIN(*-magic-numbers)
@@ -60,7 +69,7 @@ namespace {
 
     // UTF-16 to UTF-8
     if constexpr (
-      std::same_as<SrcChar, CharUTF32> && std::same_as<DestChar, CharUTF8>) {
+      std::same_as<SrcChar, CharUTF16> && std::same_as<DestChar, CharUTF8>) {
       return 3;
     }
 
@@ -92,7 +101,7 @@ namespace {
     size_t& size,
     base::icu::CodePoint code_point) {
     icu::internal::
-      U8AppendUnsafe(std::bit_cast<uint8_t*>(out), size, code_point);
+      U8AppendUnsafe(std::bit_cast<uint8_t*>(out), size, *code_point);
   }
 
   template <CharTraits Char>
@@ -101,7 +110,7 @@ namespace {
     Char* out,
     size_t& size,
     base::icu::CodePoint code_point) {
-    icu::internal::U16AppendUnsafe(out, size, code_point);
+    icu::internal::U16AppendUnsafe(out, size, *code_point);
   }
 
   template <CharTraits Char>
@@ -110,146 +119,909 @@ namespace {
     Char* out,
     size_t& size,
     base::icu::CodePoint code_point) {
-    out[size] = static_cast<Char>(code_point);
+    out[size] = static_cast<Char>(*code_point);
     ++size;
   }
 
+  // ConvertedLength -----------------------------------------------------------
+  // Exact number of code units the conversion of |src| produces, U+FFFD
+  // replacements included, so that the destination is allocated once.
+  // |kSwapped| sources hold code units in the opposite of the host byte order;
+  // only their conversion to UTF-8 is supported.
+
+  template <CharTraits DestChar, bool kSwapped = false>
+  auto ConvertedLength(const StringViewUTF8 src) -> size_t {
+    static_assert(!kSwapped);
+    if constexpr (std::same_as<DestChar, CharUTF16>) {
+      return internal::simd::UTF16LengthOfUTF8(src.data(), src.size());
+    }
+    else {
+      static_assert(std::same_as<DestChar, CharUTF32>);
+      return internal::simd::UTF32LengthOfUTF8(src.data(), src.size());
+    }
+  }
+
+  template <CharTraits DestChar, bool kSwapped = false>
+  auto ConvertedLength(const StringViewUTF16 src) -> size_t {
+    if constexpr (kSwapped) {
+      static_assert(std::same_as<DestChar, CharUTF8>);
+      return internal::simd::UTF8LengthOfSwappedUTF16(src.data(), src.size());
+    }
+    else if constexpr (std::same_as<DestChar, CharUTF8>) {
+      return internal::simd::UTF8LengthOfUTF16(src.data(), src.size());
+    }
+    else {
+      static_assert(std::same_as<DestChar, CharUTF32>);
+      return internal::simd::UTF32LengthOfUTF16(src.data(), src.size());
+    }
+  }
+
+  template <CharTraits DestChar, bool kSwapped = false>
+  auto ConvertedLength(const StringViewUTF32 src) -> size_t {
+    if constexpr (kSwapped) {
+      static_assert(std::same_as<DestChar, CharUTF8>);
+      return internal::simd::UTF8LengthOfSwappedUTF32(src.data(), src.size());
+    }
+    else if constexpr (std::same_as<DestChar, CharUTF8>) {
+      return internal::simd::UTF8LengthOfUTF32(src.data(), src.size());
+    }
+    else {
+      static_assert(std::same_as<DestChar, CharUTF16>);
+      return internal::simd::UTF16LengthOfUTF32(src.data(), src.size());
+    }
+  }
+
+  // UTF-32 kernels ------------------------------------------------------------
+
+  template <bool kSwapped>
+  auto TranscodeUTF32(const StringViewUTF32 src, std::span<CharUTF8> dest)
+    -> internal::simd::TranscodeResult {
+    if constexpr (kSwapped) {
+      return internal::simd::SwappedUTF32ToUTF8(
+        src.data(),
+        src.size(),
+        dest.data(),
+        dest.size());
+    }
+    else {
+      return internal::simd::UTF32ToUTF8(
+        src.data(),
+        src.size(),
+        dest.data(),
+        dest.size());
+    }
+  }
+
+  template <bool kSwapped>
+  auto TranscodeUTF32(const StringViewUTF32 src, std::span<CharUTF16> dest)
+    -> internal::simd::TranscodeResult {
+    static_assert(!kSwapped);
+    return internal::simd::UTF32ToUTF16(
+      src.data(),
+      src.size(),
+      dest.data(),
+      dest.size());
+  }
+
+  // Notes that the code unit at |src_offset| starts a sequence replaced by
+  // U+FFFD. Only the scalar loops below reach this, after the kernels gave up,
+  // so valid input never pays for the bookkeeping.
+  void RecordReplacement(UTFConversionResult& result, size_t src_offset) {
+    if (!result.first_invalid_offset) {
+      result.first_invalid_offset = src_offset;
+    }
+    ++result.replaced_count;
+  }
+
   // DoUTFConversion
   // ------------------------------------------------------------ Main driver of
   // UTFConversion specialized for different Src encodings. dest has to have
-  // enough room for the converted text.
+  // room for the converted text, usually exactly ConvertedLength().
 
-  template <CharTraits DestChar>
-  auto DoUTFConversion(
-    const StringViewUTF8 src,
-    std::basic_string<DestChar>& dest,
-    const size_t dest_offset) -> bool {
-    bool success = true;
-    dest.reserve(dest_offset + src.size());
+  template <CharTraits DestChar, bool kSwapped = false>
+  auto DoUTFConversion(const StringViewUTF8 src, std::span<DestChar> dest)
+    -> UTFConversionResult {
+    static_assert(!kSwapped);
+    UTFConversionResult result;
+    size_t dest_len = 0;
 
-    auto start_offset = dest_offset;
+    // ICU requires 32 bit numbers.
+    const auto* data  = std::bit_cast<const uint8_t*>(src.data());
+    const auto length = static_cast<int32_t>(src.size());
 
-    for (size_t i = 0; i < src.size();) {
+    for (int32_t i = 0; i < length;) {
+      if constexpr (std::same_as<DestChar, CharUTF16>) {
+        // The vector kernel takes the longest prefix it can prove valid, the
+        // scalar decoder below only sees what the kernel gave up on.
+        const auto [read, written] = internal::simd::UTF8ToUTF16(
+          src.data() + i,
+          src.size() - static_cast<size_t>(i),
+          dest.data() + dest_len,
+          dest.size() - dest_len);
+        i += static_cast<int32_t>(read);
+        dest_len += written;
+        if (i >= length) {
+          break;
+        }
+      }
+      else {
+        // There is no UTF-32 kernel, but ASCII runs widen without decoding.
+        if (data[i] < 0x80) {
+          const size_t ascii = internal::simd::ASCIIPrefixLength(
+            src.data() + i,
+            src.size() - static_cast<size_t>(i));
+          std::copy_n(data + i, ascii, dest.data() + dest_len);
+          i += static_cast<int32_t>(ascii);
+          dest_len += ascii;
+          continue;
+        }
+      }
+
+      const int32_t start = i;
       base::icu::CodePoint code_point;
-      icu::internal::U8Next(
-        std::bit_cast<const uint8_t*>(src.data()),
-        i,
-        static_cast<int32_t>(src.size()),
-        *code_point);
-
-      if (!IsValidCodepoint(code_point)) {
-        success    = false;
+      icu::internal::U8Next(data, i, length, *code_point);
+
+      if (!IsValidCodepoint(code_point)) [[unlikely]] {
+        RecordReplacement(result, static_cast<size_t>(start));
         code_point = kErrorCodePoint;
       }
 
-      UnicodeAppendUnsafe(dest, start_offset, code_point);
+      UnicodeAppendUnsafe(dest.data(), dest_len, code_point);
     }
 
-    return success;
+    result.size    = dest_len;
+    result.success = result.replaced_count == 0;
+    return result;
   }
 
-  template <CharTraits DestChar>
-  auto DoUTFConversion(
-    const StringViewUTF16 src,
-    std::basic_string<DestChar>& dest,
-    const size_t dest_offset) -> bool {
-    bool success = true;
-    dest.reserve(dest_offset + src.size());
+  template <CharTraits DestChar, bool kSwapped = false>
+  auto DoUTFConversion(const StringViewUTF16 src, std::span<DestChar> dest)
+    -> UTFConversionResult {
+    static_assert(!kSwapped || std::same_as<DestChar, CharUTF8>);
+    UTFConversionResult result;
+    size_t dest_len = 0;
 
-    auto convert_single_char = [&success](char16_t input) -> icu::CodePoint {
+    // Code unit |index| of |src| in the host byte order.
+    auto unit = [src](size_t index) -> char16_t {
+      return internal::simd::LoadUnit<kSwapped>(src.data() + index);
+    };
+
+    auto convert_single_char = [&result](char16_t input, size_t src_offset)
+      -> icu::CodePoint {
       icu::CodePoint code_point(input);
-      if (!icu::internal::U16IsSingle(input) || !IsValidCodepoint(code_point)) {
-        success    = false;
+      if (!icu::internal::U16IsSingle(input) || !IsValidCodepoint(code_point))
+        [[unlikely]] {
+        RecordReplacement(result, src_offset);
         code_point = kErrorCodePoint;
       }
       return code_point;
     };
 
-    size_t i          = 0U;
-    auto start_offset = dest_offset;
+    size_t i = 0U;
 
     // Always have another symbol in order to avoid checking boundaries in the
     // middle of the surrogate pair.
     while (i + 1 < src.size()) {
+      if constexpr (std::same_as<DestChar, CharUTF8>) {
+        // Same contract as the UTF-8 decoder above: the kernel stops in front
+        // of lone surrogates and the short tail.
+        const auto [read, written] =
+          (kSwapped ? internal::simd::SwappedUTF16ToUTF8
+                    : internal::simd::UTF16ToUTF8)(
+            src.data() + i,
+            src.size() - i,
+            dest.data() + dest_len,
+            dest.size() - dest_len);
+        i += read;
+        dest_len += written;
+        if (i + 1 >= src.size()) {
+          break;
+        }
+      }
+
       base::icu::CodePoint code_point;
 
-      if (icu::internal::U16IsLead(src[i]) &&
-          icu::internal::U16IsTrail(src[i + 1])) {
-        *code_point = icu::internal::U16GetSupplementary(src[i], src[i + 1]);
-        if (!IsValidCodepoint(code_point)) {
+      if (icu::internal::U16IsLead(unit(i)) &&
+          icu::internal::U16IsTrail(unit(i + 1))) {
+        *code_point = icu::internal::U16GetSupplementary(unit(i), unit(i + 1));
+        if (!IsValidCodepoint(code_point)) [[unlikely]] {
+          RecordReplacement(result, i);
           code_point = kErrorCodePoint;
-          success    = false;
         }
         i += 2;
       }
       else {
-        code_point = convert_single_char(src[i]);
+        code_point = convert_single_char(unit(i), i);
         ++i;
       }
 
-      UnicodeAppendUnsafe(dest, start_offset, code_point);
+      UnicodeAppendUnsafe(dest.data(), dest_len, code_point);
     }
 
     if (i < src.size()) {
-      UnicodeAppendUnsafe(dest, start_offset, convert_single_char(src[i]));
+      UnicodeAppendUnsafe(
+        dest.data(),
+        dest_len,
+        convert_single_char(unit(i), i));
     }
 
-    return success;
+    result.size    = dest_len;
+    result.success = result.replaced_count == 0;
+    return result;
   }
 
-  template <CharTraits DestChar>
-  auto DoUTFConversion(
-    const StringViewUTF32 src,
-    std::basic_string<DestChar>& dest,
-    const size_t dest_offset) -> bool {
-    bool success = true;
-    dest.reserve(dest_offset + src.size());
+  template <CharTraits DestChar, bool kSwapped = false>
+  auto DoUTFConversion(const StringViewUTF32 src, std::span<DestChar> dest)
+    -> UTFConversionResult {
+    UTFConversionResult result;
+    size_t dest_len = 0;
+
+    for (size_t i = 0; i < src.size(); ++i) {
+      if constexpr (
+        std::same_as<DestChar, CharUTF8> || std::same_as<DestChar, CharUTF16>) {
+        // |dest| is sized exactly, the kernel leaves the last few code points
+        // to the loop below.
+        const auto [read, written] =
+          TranscodeUTF32<kSwapped>(src.substr(i), dest.subspan(dest_len));
+        i += read;
+        dest_len += written;
+        if (i >= src.size()) {
+          break;
+        }
+      }
 
-    auto start_offset = dest_offset;
-    for (CharUTF32 character : src) {
-      icu::CodePoint code_point(static_cast<UChar32>(character));
+      icu::CodePoint code_point(static_cast<UChar32>(
+        internal::simd::LoadUnit<kSwapped>(src.data() + i)));
 
-      if (!IsValidCodepoint(code_point)) {
-        success    = false;
+      if (!IsValidCodepoint(code_point)) [[unlikely]] {
+        RecordReplacement(result, i);
         code_point = kErrorCodePoint;
       }
 
-      UnicodeAppendUnsafe(dest, start_offset, code_point);
+      UnicodeAppendUnsafe(dest.data(), dest_len, code_point);
     }
 
-    return success;
+    result.size    = dest_len;
+    result.success = result.replaced_count == 0;
+    return result;
   }
 
   // UTFConversion
   // -------------------------------------------------------------- Function
-  // template for generating all UTF conversions.
+  // template for generating all UTF conversions. With |kSwapped|, |src_str|
+  // holds code units in the opposite of the host byte order.
+
+  template <CharTraits SrcChar, CharTraits DestChar, bool kSwapped = false>
+  auto UTFConversion(
+    const std::basic_string_view<SrcChar> src_str,
+    std::basic_string<DestChar>& dest_str) -> UTFConversionResult {
+    if constexpr (!std::same_as<SrcChar, CharUTF32> && !kSwapped) {
+      if (IsStringASCII(src_str)) {
+        dest_str.assign(src_str.begin(), src_str.end());
+        return {.size = dest_str.size(), .success = true};
+      }
+    }
+
+    // The size pre-pass runs at about the speed of a validation, and lets the
+    // destination be allocated once at its final size.
+    dest_str.resize(ConvertedLength<DestChar, kSwapped>(src_str));
+
+    return DoUTFConversion<DestChar, kSwapped>(
+      src_str,
+      std::span<DestChar>(dest_str));
+  }
+
+  // Copies ASCII code units into |dest|, or reports the size it needs.
+  template <CharTraits SrcChar, CharTraits DestChar>
+  auto CopyASCII(
+    const std::basic_string_view<SrcChar> src,
+    std::span<DestChar> dest) -> UTFConversionResult {
+    if (src.size() > dest.size()) {
+      return {.size = src.size()};
+    }
+    std::copy(src.begin(), src.end(), dest.begin());
+    return {.size = src.size(), .success = true};
+  }
+
+  template <CharTraits SrcChar, CharTraits DestChar, bool kSwapped = false>
+  auto UTFConversion(
+    const std::basic_string_view<SrcChar> src_str,
+    std::span<DestChar> dest) -> UTFConversionResult {
+    if constexpr (!std::same_as<SrcChar, CharUTF32> && !kSwapped) {
+      if (IsStringASCII(src_str)) {
+        return CopyASCII(src_str, dest);
+      }
+    }
+
+    // A buffer sized for the worst case needs no size pre-pass.
+    if (dest.size() < src_str.size() * SizeCoefficient<SrcChar, DestChar>()) {
+      const size_t length = ConvertedLength<DestChar, kSwapped>(src_str);
+      if (length > dest.size()) {
+        return {.size = length};
+      }
+    }
+
+    return DoUTFConversion<DestChar, kSwapped>(src_str, dest);
+  }
+
+  // Converts |src_str|, whose code units are stored in |byte_order|, to UTF-8.
+  template <CharTraits SrcChar, typename Dest>
+  auto UTFConversion(
+    const std::basic_string_view<SrcChar> src_str,
+    std::endian byte_order,
+    Dest& dest) -> UTFConversionResult {
+    if (byte_order == std::endian::native) {
+      return UTFConversion<SrcChar, CharUTF8>(src_str, dest);
+    }
+    return UTFConversion<SrcChar, CharUTF8, /*kSwapped=*/true>(src_str, dest);
+  }
+
+  // BatchUTFConversion
+  // -------------------------------------------------------------- Converts
+  // every string of |src_batch| back to back into |dest_str|. The output is
+  // sized for the worst case of the whole batch once, so the strings skip the
+  // size pre-pass, and only shrinks at the end, keeping its capacity.
+
+  template <CharTraits SrcChar, CharTraits DestChar>
+  auto BatchUTFConversion(
+    std::span<const std::basic_string_view<SrcChar>> src_batch,
+    std::basic_string<DestChar>& dest_str,
+    std::vector<size_t>& offsets) -> bool {
+    size_t src_length = 0;
+    for (const auto& src : src_batch) {
+      src_length += src.size();
+    }
+    dest_str.resize(src_length * SizeCoefficient<SrcChar, DestChar>());
+    offsets.resize(src_batch.size() + 1);
+    offsets[0] = 0;
+
+    bool success    = true;
+    size_t dest_len = 0;
+    for (size_t i = 0; i < src_batch.size(); ++i) {
+      const auto result = UTFConversion(
+        src_batch[i],
+        std::span<DestChar>(dest_str).subspan(dest_len));
+      success = success && result.success;
+      dest_len += result.size;
+      offsets[i + 1] = dest_len;
+    }
+    dest_str.resize(dest_len);
+    return success;
+  }
+
+  // ParallelUTFConversion
+  // ----------------------------------------------------------- Splits |src|
+  // in front of code points, where decoding restarts whatever precedes it, so
+  // that the pieces convert independently into their slice of |dest_str|.
+
+  // Below this many source code units per thread, starting the threads costs
+  // more than they save.
+  constexpr size_t kMinParallelPieceSize = size_t{1} << 18U;
+
+  auto CodePointBoundary(const StringViewUTF8 src, size_t pos) -> size_t {
+    while (
+      pos < src.size() && (static_cast<uint8_t>(src[pos]) & 0xC0) == 0x80) {
+      ++pos;
+    }
+    return pos;
+  }
+
+  auto CodePointBoundary(const StringViewUTF16 src, size_t pos) -> size_t {
+    if (
+      pos > 0 && pos < src.size() && icu::internal::U16IsLead(src[pos - 1]) &&
+      icu::internal::U16IsTrail(src[pos])) {
+      ++pos;
+    }
+    return pos;
+  }
+
+  auto CodePointBoundary(const StringViewUTF32 /*src*/, size_t pos) -> size_t {
+    return pos;
+  }
+
+  // Runs |task(i)| for every i below |count|, the last one on the calling
+  // thread, and returns once all of them are done.
+  template <typename Task>
+  void RunInParallel(size_t count, const Task& task) {
+    std::vector<std::jthread> threads;
+    threads.reserve(count - 1);
+    for (size_t i = 0; i + 1 < count; ++i) {
+      threads.emplace_back(task, i);
+    }
+    task(count - 1);
+  }
+
+  template <CharTraits SrcChar, CharTraits DestChar>
+  auto ParallelUTFConversion(
+    const std::basic_string_view<SrcChar> src_str,
+    std::basic_string<DestChar>& dest_str,
+    size_t max_threads) -> bool {
+    if (max_threads == 0) {
+      max_threads =
+        std::max(size_t{1}, size_t{std::thread::hardware_concurrency()});
+    }
+    const size_t piece_count =
+      std::min(max_threads, src_str.size() / kMinParallelPieceSize);
+    if (piece_count <= 1) {
+      return UTFConversion(src_str, dest_str).success;
+    }
+
+    std::vector<size_t> bounds(piece_count + 1, src_str.size());
+    bounds[0] = 0;
+    for (size_t i = 1; i < piece_count; ++i) {
+      bounds[i] =
+        CodePointBoundary(src_str, i * (src_str.size() / piece_count));
+    }
+    const auto piece = [&](size_t i) {
+      return src_str.substr(bounds[i], bounds[i + 1] - bounds[i]);
+    };
+
+    // offsets[i + 1] first holds the size of piece i, then the end of its
+    // output.
+    std::vector<size_t> offsets(piece_count + 1);
+    RunInParallel(piece_count, [&](size_t i) {
+      offsets[i + 1] = ConvertedLength<DestChar>(piece(i));
+    });
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    dest_str.resize(offsets.back());
+
+    // Not std::vector<bool>, whose elements share words.
+    std::vector<uint8_t> success(piece_count);
+    RunInParallel(piece_count, [&](size_t i) {
+      success[i] = static_cast<uint8_t>(
+        DoUTFConversion(
+          piece(i),
+          std::span<DestChar>(dest_str).subspan(
+            offsets[i],
+            offsets[i + 1] - offsets[i]))
+          .success);
+    });
+    return std::ranges::all_of(success, [](uint8_t ok) { return ok != 0; });
+  }
+
+  // UTFConversionAdjustingOffsets
+  // --------------------------------------------------- Converts |src_str|
+  // piece by piece, cutting it at the offsets to adjust. Each piece but the
+  // code point containing an offset converts in bulk.
+
+  // Start of the code point of |src| containing |pos|, not before |begin|,
+  // which has to be a code point boundary.
+  auto CodePointStart(const StringViewUTF8 src, size_t begin, size_t pos)
+    -> size_t {
+    while (pos > begin && pos < src.size() &&
+           (static_cast<uint8_t>(src[pos]) & 0xC0) == 0x80) {
+      --pos;
+    }
+    return pos;
+  }
+
+  auto CodePointStart(const StringViewUTF16 src, size_t begin, size_t pos)
+    -> size_t {
+    if (
+      pos > begin && pos < src.size() &&
+      icu::internal::U16IsLead(src[pos - 1]) &&
+      icu::internal::U16IsTrail(src[pos])) {
+      --pos;
+    }
+    return pos;
+  }
+
+  template <CharTraits SrcChar, CharTraits DestChar>
+  auto UTFConversionAdjustingOffsets(
+    const std::basic_string_view<SrcChar> src_str,
+    std::basic_string<DestChar>& dest_str,
+    std::vector<size_t>& offsets) -> bool {
+    constexpr size_t kNpos = std::basic_string<DestChar>::npos;
 
-  template <typename InputString, typename DestString>
-  bool UTFConversion(const InputString& src_str, DestString* dest_str) {
     if (IsStringASCII(src_str)) {
-      dest_str->assign(src_str.begin(), src_str.end());
+      dest_str.assign(src_str.begin(), src_str.end());
+      size_t last = 0;
+      for (auto& offset : offsets) {
+        if (offset < last || offset > src_str.size()) {
+          offset = kNpos;
+          continue;
+        }
+        last = offset;
+      }
       return true;
     }
 
-    dest_str->resize(
-      src_str.length() *
-      size_coefficient_v<
-        typename InputString::value_type,
-        typename DestString::value_type>);
+    dest_str.resize(ConvertedLength<DestChar>(src_str));
+    const auto dest = std::span<DestChar>(dest_str);
 
-    // Empty string is ASCII => it OK to call operator[].
-    auto* dest = &(*dest_str)[0];
-
-    // ICU requires 32 bit numbers.
-    size_t src_len  = src_str.length();
+    bool success    = true;
+    size_t src_pos  = 0;
     size_t dest_len = 0;
+    const auto convert_until = [&](size_t end) {
+      const auto result = DoUTFConversion(
+        src_str.substr(src_pos, end - src_pos),
+        dest.subspan(dest_len));
+      success = success && result.success;
+      dest_len += result.size;
+      src_pos = end;
+    };
+
+    for (auto& offset : offsets) {
+      // Also the offsets out of order, which would need a second pass.
+      if (offset < src_pos || offset > src_str.size()) {
+        offset = kNpos;
+        continue;
+      }
+      convert_until(CodePointStart(src_str, src_pos, offset));
+      while (src_pos < offset) {
+        convert_until(
+          src_pos + FirstCodePointLength(src_str.substr(src_pos)));
+      }
+      offset = src_pos == offset ? dest_len : kNpos;
+    }
+    convert_until(src_str.size());
+    return success;
+  }
+
+  // CodePointEncoding / CodePointDecoding
+  // -------------------------------------------- Conversions between code
+  // point arrays and text. icu::CodePoint is not a code unit type, so the
+  // code points go through a stack buffer of UTF-32, one chunk at a time.
+
+  constexpr size_t kCodePointChunkSize = 1024;
+
+  // Accounts for the conversion of a piece of the source, which starts at
+  // |src_offset|, in the result of the whole conversion.
+  void AppendResult(
+    UTFConversionResult& total,
+    const UTFConversionResult& piece,
+    size_t src_offset) {
+    if (piece.first_invalid_offset && !total.first_invalid_offset) {
+      total.first_invalid_offset = src_offset + *piece.first_invalid_offset;
+    }
+    total.size += piece.size;
+    total.replaced_count += piece.replaced_count;
+  }
+
+  // Runs |convert(utf32, offset)| on every chunk of |code_points|.
+  template <typename Convert>
+  void ForEachUTF32Chunk(
+    std::span<const icu::CodePoint> code_points,
+    const Convert& convert) {
+    std::array<CharUTF32, kCodePointChunkSize> buffer{};
+    for (size_t offset = 0; offset < code_points.size();
+         offset += buffer.size()) {
+      const auto chunk = code_points.subspan(
+        offset,
+        std::min(buffer.size(), code_points.size() - offset));
+      std::ranges::transform(
+        chunk,
+        buffer.begin(),
+        [](icu::CodePoint code_point) {
+          return static_cast<CharUTF32>(code_point.value());
+        });
+      convert(StringViewUTF32(buffer.data(), chunk.size()), offset);
+    }
+  }
+
+  template <CharTraits DestChar>
+  auto EncodedLength(std::span<const icu::CodePoint> code_points) -> size_t {
+    size_t length = 0;
+    ForEachUTF32Chunk(
+      code_points,
+      [&length](StringViewUTF32 utf32, size_t /*offset*/) {
+        length += ConvertedLength<DestChar>(utf32);
+      });
+    return length;
+  }
+
+  template <CharTraits DestChar>
+  auto DoCodePointEncoding(
+    std::span<const icu::CodePoint> code_points,
+    std::span<DestChar> dest) -> UTFConversionResult {
+    UTFConversionResult result;
+    ForEachUTF32Chunk(
+      code_points,
+      [&result, dest](StringViewUTF32 utf32, size_t offset) {
+        AppendResult(
+          result,
+          DoUTFConversion(utf32, dest.subspan(result.size)),
+          offset);
+      });
+    result.success = result.replaced_count == 0;
+    return result;
+  }
+
+  template <CharTraits DestChar>
+  auto CodePointEncoding(
+    std::span<const icu::CodePoint> code_points,
+    std::basic_string<DestChar>& dest_str) -> bool {
+    dest_str.resize(EncodedLength<DestChar>(code_points));
+    return DoCodePointEncoding(code_points, std::span<DestChar>(dest_str))
+      .success;
+  }
+
+  template <CharTraits DestChar>
+  auto CodePointEncoding(
+    std::span<const icu::CodePoint> code_points,
+    std::span<DestChar> dest) -> UTFConversionResult {
+    // A buffer sized for the worst case needs no size pre-pass.
+    if (
+      dest.size() <
+      code_points.size() * SizeCoefficient<CharUTF32, DestChar>()) {
+      const size_t length = EncodedLength<DestChar>(code_points);
+      if (length > dest.size()) {
+        return {.size = length};
+      }
+    }
+    return DoCodePointEncoding(code_points, dest);
+  }
+
+  auto CodePointDecoding(
+    const StringViewUTF32 src,
+    std::span<icu::CodePoint> dest) -> UTFConversionResult {
+    if (src.size() > dest.size()) {
+      return {.size = src.size()};
+    }
+    UTFConversionResult result{.size = src.size()};
+    for (size_t i = 0; i < src.size(); ++i) {
+      icu::CodePoint code_point(static_cast<UChar32>(src[i]));
+      if (!IsValidCodepoint(code_point)) [[unlikely]] {
+        RecordReplacement(result, i);
+        code_point = kErrorCodePoint;
+      }
+      dest[i] = code_point;
+    }
+    result.success = result.replaced_count == 0;
+    return result;
+  }
+
+  // Decodes at most one chunk of code units at a time, cut in front of a code
+  // point so that it decodes to at most one chunk of code points.
+  template <CharTraits SrcChar>
+  auto CodePointDecoding(
+    const std::basic_string_view<SrcChar> src,
+    std::span<icu::CodePoint> dest) -> UTFConversionResult {
+    // Every code unit decodes to at most one code point.
+    if (src.size() > dest.size()) {
+      const size_t length = ConvertedLength<CharUTF32>(src);
+      if (length > dest.size()) {
+        return {.size = length};
+      }
+    }
+
+    UTFConversionResult result;
+    std::array<CharUTF32, kCodePointChunkSize> buffer{};
+    for (size_t begin = 0; begin < src.size();) {
+      size_t end = CodePointStart(
+        src,
+        begin,
+        std::min(begin + buffer.size(), src.size()));
+      if (end == begin) {
+        end = begin + FirstCodePointLength(src.substr(begin));
+      }
+
+      const auto piece = DoUTFConversion(
+        src.substr(begin, end - begin),
+        std::span<CharUTF32>(buffer));
+      std::ranges::transform(
+        std::span(buffer).first(piece.size),
+        dest.begin() + static_cast<std::ptrdiff_t>(result.size),
+        [](CharUTF32 unit) {
+          return icu::CodePoint(static_cast<UChar32>(unit));
+        });
+      AppendResult(result, piece, begin);
+      begin = end;
+    }
+    result.success = result.replaced_count == 0;
+    return result;
+  }
+
+  // NarrowToASCII
+  // ----------------------------------------------------------------- Truncates
+  // every code unit to 7 bits. Returns false if any of them was not ASCII.
+
+  template <CharTraits SrcChar>
+  auto NarrowToASCII(
+    const std::basic_string_view<SrcChar> src,
+    std::span<CharASCII> dest) -> UTFConversionResult {
+    if (src.size() > dest.size()) {
+      return {.size = src.size()};
+    }
+
+    UTFConversionResult result{.size = src.size()};
+    for (size_t i = 0; i < src.size(); ++i) {
+      i += internal::simd::NarrowToASCII(
+             src.data() + i,
+             src.size() - i,
+             dest.data() + i)
+             .read;
+      if (i >= src.size()) {
+        break;
+      }
+
+      if (src[i] >= 0x80) {
+        RecordReplacement(result, i);
+      }
+      dest[i] = static_cast<CharASCII>(src[i] & 0x7F);
+    }
+    result.success = result.replaced_count == 0;
+    return result;
+  }
+
+  template <CharTraits SrcChar>
+  auto NarrowToASCII(
+    const std::basic_string_view<SrcChar> src,
+    StringASCII& ascii_output) -> UTFConversionResult {
+    ascii_output.resize(src.size());
+    return NarrowToASCII(src, std::span<CharASCII>(ascii_output));
+  }
+
+  // Latin-1
+  // ---------------------------------------------------------------------- Each
+  // byte is the code point of the same value. Code points above U+00FF, and
+  // the sequences the UTF conversions replace by U+FFFD, become '?'. dest has
+  // to have room for the converted text, which the functions below size
+  // exactly.
+
+  constexpr CharLatin1 kLatin1Substitute = '?';
+
+  auto Latin1ToUTF8Length(const StringViewLatin1 src) -> size_t {
+    return internal::simd::UTF8LengthOfLatin1(src.data(), src.size());
+  }
+
+  // Every code point takes one byte, so this is the number of code points.
+  auto Latin1Length(const StringViewUTF8 src) -> size_t {
+    return internal::simd::UTF32LengthOfUTF8(src.data(), src.size());
+  }
+
+  auto Latin1Length(const StringViewUTF16 src) -> size_t {
+    return internal::simd::UTF32LengthOfUTF16(src.data(), src.size());
+  }
+
+  auto DoLatin1Conversion(
+    const StringViewLatin1 src,
+    std::span<CharUTF8> dest) -> UTFConversionResult {
+    size_t read    = 0;
+    size_t written = 0;
+    while (read < src.size()) {
+      const auto step = internal::simd::Latin1ToUTF8(
+        src.data() + read,
+        src.size() - read,
+        dest.data() + written,
+        dest.size() - written);
+      read += step.read;
+      written += step.written;
+      if (read >= src.size()) {
+        break;
+      }
+
+      const auto byte = static_cast<uint8_t>(src[read++]);
+      if (byte < 0x80) {
+        dest[written++] = byte;
+      }
+      else {
+        dest[written++] = static_cast<CharUTF8>(0xC0 | (byte >> 6));
+        dest[written++] = static_cast<CharUTF8>(0x80 | (byte & 0x3F));
+      }
+    }
+    return {.size = written, .success = true};
+  }
 
-    bool res        = DoUTFConversion(src_str.data(), src_len, dest, &dest_len);
+  auto DoLatin1Conversion(
+    const StringViewLatin1 src,
+    std::span<CharUTF16> dest) -> UTFConversionResult {
+    size_t i =
+      internal::simd::Latin1ToUTF16(src.data(), src.size(), dest.data()).read;
+    for (; i < src.size(); ++i) {
+      dest[i] = static_cast<uint8_t>(src[i]);
+    }
+    return {.size = src.size(), .success = true};
+  }
 
-    dest_str->resize(dest_len);
-    dest_str->shrink_to_fit();
+  auto DoLatin1Conversion(
+    const StringViewUTF8 src,
+    std::span<CharLatin1> dest) -> UTFConversionResult {
+    UTFConversionResult result;
+    const auto* data  = std::bit_cast<const uint8_t*>(src.data());
+    const auto length = static_cast<int32_t>(src.size());
+    size_t written    = 0;
+    for (int32_t i = 0; i < length;) {
+      const auto step = internal::simd::UTF8ToLatin1(
+        src.data() + i,
+        src.size() - static_cast<size_t>(i),
+        dest.data() + written,
+        dest.size() - written);
+      i += static_cast<int32_t>(step.read);
+      written += step.written;
+      if (i >= length) {
+        break;
+      }
 
-    return res;
+      const int32_t start = i;
+      UChar32 code_point  = 0;
+      icu::internal::U8Next(data, i, length, code_point);
+      if (code_point < 0 || code_point > 0xFF) [[unlikely]] {
+        RecordReplacement(result, static_cast<size_t>(start));
+        code_point = kLatin1Substitute;
+      }
+      dest[written++] = static_cast<CharLatin1>(code_point);
+    }
+    result.size    = written;
+    result.success = result.replaced_count == 0;
+    return result;
+  }
+
+  auto DoLatin1Conversion(
+    const StringViewUTF16 src,
+    std::span<CharLatin1> dest) -> UTFConversionResult {
+    UTFConversionResult result;
+    size_t read    = 0;
+    size_t written = 0;
+    while (read < src.size()) {
+      const auto step = internal::simd::NarrowToLatin1(
+        src.data() + read,
+        src.size() - read,
+        dest.data() + written);
+      read += step.read;
+      written += step.written;
+      if (read >= src.size()) {
+        break;
+      }
+
+      const CharUTF16 unit = src[read];
+      if (unit <= 0xFF) {
+        dest[written++] = static_cast<CharLatin1>(unit);
+        ++read;
+        continue;
+      }
+      // A surrogate pair is one code point, replaced once.
+      RecordReplacement(result, read);
+      dest[written++] = kLatin1Substitute;
+      read += FirstCodePointLength(src.substr(read));
+    }
+    result.size    = written;
+    result.success = result.replaced_count == 0;
+    return result;
+  }
+
+  template <CharTraits SrcChar, CharTraits DestChar>
+  auto Latin1Conversion(
+    const std::basic_string_view<SrcChar> src_str,
+    std::basic_string<DestChar>& dest_str) -> UTFConversionResult {
+    if constexpr (std::same_as<DestChar, CharUTF16>) {
+      dest_str.resize(src_str.size());
+    }
+    else if constexpr (std::same_as<DestChar, CharUTF8>) {
+      dest_str.resize(Latin1ToUTF8Length(src_str));
+    }
+    else {
+      if (IsStringASCII(src_str)) {
+        dest_str.assign(src_str.begin(), src_str.end());
+        return {.size = dest_str.size(), .success = true};
+      }
+      dest_str.resize(Latin1Length(src_str));
+    }
+    return DoLatin1Conversion(src_str, std::span<DestChar>(dest_str));
+  }
+
+  template <CharTraits SrcChar, CharTraits DestChar>
+  auto Latin1Conversion(
+    const std::basic_string_view<SrcChar> src_str,
+    std::span<DestChar> dest) -> UTFConversionResult {
+    // Latin-1 to UTF-8 takes up to two bytes per byte, the others at most one
+    // code unit per code unit. A buffer sized for the worst case needs no size
+    // pre-pass.
+    constexpr size_t kSizeCoefficient =
+      std::same_as<DestChar, CharUTF8> ? 2 : 1;
+    if (dest.size() < src_str.size() * kSizeCoefficient) {
+      size_t length = src_str.size();
+      if constexpr (std::same_as<DestChar, CharUTF8>) {
+        length = Latin1ToUTF8Length(src_str);
+      }
+      else if constexpr (std::same_as<DestChar, CharLatin1>) {
+        length = Latin1Length(src_str);
+      }
+      if (length > dest.size()) {
+        return {.size = length};
+      }
+    }
+    return DoLatin1Conversion(src_str, dest);
   }
 
   // NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
@@ -274,12 +1046,370 @@ auto ASCIIToUTF8(StringViewASCII ascii, StringUTF8& utf8_output) -> bool {
   return true;
 }
 
+// Latin-1 To Others
+auto Latin1ToUTF8(StringViewLatin1 latin1, StringUTF8& utf8_output) -> bool {
+  return Latin1Conversion(latin1, utf8_output).success;
+}
+
+auto Latin1ToUTF16(StringViewLatin1 latin1, StringUTF16& utf16_output)
+  -> bool {
+  return Latin1Conversion(latin1, utf16_output).success;
+}
+
+// Others To Latin-1
+auto UTF8ToLatin1(StringViewUTF8 utf8, StringLatin1& latin1_output) -> bool {
+  return Latin1Conversion(utf8, latin1_output).success;
+}
+
+auto UTF16ToLatin1(StringViewUTF16 utf16, StringLatin1& latin1_output)
+  -> bool {
+  return Latin1Conversion(utf16, latin1_output).success;
+}
+
+// UTF8 To Others
+auto UTF8ToUTF16(StringViewUTF8 utf8, StringUTF16& utf16_output) -> bool {
+  return UTFConversion(utf8, utf16_output).success;
+}
+
+auto UTF8ToUTF32(StringViewUTF8 utf8, StringUTF32& utf32_output) -> bool {
+  return UTFConversion(utf8, utf32_output).success;
+}
+
+auto UTF8ToASCII(StringViewUTF8 utf8, StringASCII& ascii_output) -> bool {
+  const size_t length =
+    internal::simd::ASCIIPrefixLength(utf8.data(), utf8.size());
+  ascii_output.assign(std::bit_cast<const CharASCII*>(utf8.data()), length);
+  return length == utf8.size();
+}
+
+auto UTF8ToASCIILossy(
+  StringViewUTF8 utf8,
+  StringASCII& ascii_output,
+  CharASCII substitute) -> bool {
+  // Every code point takes one byte, at most as many as it had.
+  ascii_output.resize(utf8.size());
+
+  const auto* data  = std::bit_cast<const uint8_t*>(utf8.data());
+  const auto length = static_cast<int32_t>(utf8.size());
+  bool success      = true;
+  size_t dest_len   = 0;
+  for (int32_t i = 0; i < length;) {
+    const size_t ascii = internal::simd::ASCIIPrefixLength(
+      utf8.data() + i,
+      utf8.size() - static_cast<size_t>(i));
+    std::memcpy(ascii_output.data() + dest_len, data + i, ascii);
+    i += static_cast<int32_t>(ascii);
+    dest_len += ascii;
+    if (i >= length) {
+      break;
+    }
+
+    // Skips one code point, or one ill-formed sequence.
+    UChar32 code_point = 0;
+    icu::internal::U8Next(data, i, length, code_point);
+    ascii_output[dest_len++] = substitute;
+    success                  = false;
+  }
+
+  ascii_output.resize(dest_len);
+  return success;
+}
+
+// UTF16 To Others
+auto UTF16ToUTF8(StringViewUTF16 utf16, StringUTF8& utf8_output) -> bool {
+  return UTFConversion(utf16, utf8_output).success;
+}
+
+auto UTF16ToUTF32(StringViewUTF16 utf16, StringUTF32& utf32_output) -> bool {
+  return UTFConversion(utf16, utf32_output).success;
+}
+
+auto UTF16ToASCII(StringViewUTF16 utf16, StringASCII& ascii_output) -> bool {
+  return NarrowToASCII(utf16, ascii_output).success;
+}
+
+// In a given byte order
+auto UTF16ToUTF8(
+  StringViewUTF16 utf16,
+  std::endian byte_order,
+  StringUTF8& utf8_output) -> bool {
+  return UTFConversion(utf16, byte_order, utf8_output).success;
+}
+
+auto UTF32ToUTF8(
+  StringViewUTF32 utf32,
+  std::endian byte_order,
+  StringUTF8& utf8_output) -> bool {
+  return UTFConversion(utf32, byte_order, utf8_output).success;
+}
+
 // UTF32 To Others
-auto UTF32ToUTF8(StringViewUTF32 utf32, StringUTF8& utf8_output) -> bool {}
+auto UTF32ToUTF8(StringViewUTF32 utf32, StringUTF8& utf8_output) -> bool {
+  return UTFConversion(utf32, utf8_output).success;
+}
+
+auto UTF32ToUTF16(StringViewUTF32 utf32, StringUTF16& utf16_output) -> bool {
+  return UTFConversion(utf32, utf16_output).success;
+}
+
+auto UTF32ToASCII(StringViewUTF32 utf32, StringASCII& ascii_output) -> bool {
+  return NarrowToASCII(utf32, ascii_output).success;
+}
+
+// With a report of the invalid input
+auto UTF8ToUTF16(
+  StringViewUTF8 utf8,
+  StringUTF16& utf16_output,
+  UTFConversionResult& result) -> bool {
+  result = UTFConversion(utf8, utf16_output);
+  return result.success;
+}
+
+auto UTF8ToUTF32(
+  StringViewUTF8 utf8,
+  StringUTF32& utf32_output,
+  UTFConversionResult& result) -> bool {
+  result = UTFConversion(utf8, utf32_output);
+  return result.success;
+}
+
+auto UTF16ToUTF8(
+  StringViewUTF16 utf16,
+  StringUTF8& utf8_output,
+  UTFConversionResult& result) -> bool {
+  result = UTFConversion(utf16, utf8_output);
+  return result.success;
+}
+
+auto UTF16ToUTF32(
+  StringViewUTF16 utf16,
+  StringUTF32& utf32_output,
+  UTFConversionResult& result) -> bool {
+  result = UTFConversion(utf16, utf32_output);
+  return result.success;
+}
+
+auto UTF32ToUTF8(
+  StringViewUTF32 utf32,
+  StringUTF8& utf8_output,
+  UTFConversionResult& result) -> bool {
+  result = UTFConversion(utf32, utf8_output);
+  return result.success;
+}
+
+auto UTF32ToUTF16(
+  StringViewUTF32 utf32,
+  StringUTF16& utf16_output,
+  UTFConversionResult& result) -> bool {
+  result = UTFConversion(utf32, utf16_output);
+  return result.success;
+}
+
+// Batches
+auto UTF8ToUTF16Batch(
+  std::span<const StringViewUTF8> utf8_batch,
+  StringUTF16& utf16_output,
+  std::vector<size_t>& offsets) -> bool {
+  return BatchUTFConversion(utf8_batch, utf16_output, offsets);
+}
+
+auto UTF16ToUTF8Batch(
+  std::span<const StringViewUTF16> utf16_batch,
+  StringUTF8& utf8_output,
+  std::vector<size_t>& offsets) -> bool {
+  return BatchUTFConversion(utf16_batch, utf8_output, offsets);
+}
 
-auto UTF32ToUTF16(StringViewUTF32 utf32, StringUTF16& utf16_output) -> bool {}
+// Adjusting offsets
+auto UTF8ToUTF16AndAdjustOffsets(
+  StringViewUTF8 utf8,
+  StringUTF16& utf16_output,
+  std::vector<size_t>& offsets) -> bool {
+  return UTFConversionAdjustingOffsets(utf8, utf16_output, offsets);
+}
+
+auto UTF16ToUTF8AndAdjustOffsets(
+  StringViewUTF16 utf16,
+  StringUTF8& utf8_output,
+  std::vector<size_t>& offsets) -> bool {
+  return UTFConversionAdjustingOffsets(utf16, utf8_output, offsets);
+}
+
+// On several threads
+auto UTF8ToUTF16Parallel(
+  StringViewUTF8 utf8,
+  StringUTF16& utf16_output,
+  size_t max_threads) -> bool {
+  return ParallelUTFConversion(utf8, utf16_output, max_threads);
+}
+
+auto UTF8ToUTF32Parallel(
+  StringViewUTF8 utf8,
+  StringUTF32& utf32_output,
+  size_t max_threads) -> bool {
+  return ParallelUTFConversion(utf8, utf32_output, max_threads);
+}
+
+auto UTF16ToUTF8Parallel(
+  StringViewUTF16 utf16,
+  StringUTF8& utf8_output,
+  size_t max_threads) -> bool {
+  return ParallelUTFConversion(utf16, utf8_output, max_threads);
+}
+
+auto UTF16ToUTF32Parallel(
+  StringViewUTF16 utf16,
+  StringUTF32& utf32_output,
+  size_t max_threads) -> bool {
+  return ParallelUTFConversion(utf16, utf32_output, max_threads);
+}
+
+auto UTF32ToUTF8Parallel(
+  StringViewUTF32 utf32,
+  StringUTF8& utf8_output,
+  size_t max_threads) -> bool {
+  return ParallelUTFConversion(utf32, utf8_output, max_threads);
+}
+
+auto UTF32ToUTF16Parallel(
+  StringViewUTF32 utf32,
+  StringUTF16& utf16_output,
+  size_t max_threads) -> bool {
+  return ParallelUTFConversion(utf32, utf16_output, max_threads);
+}
+
+// Code point arrays
+auto EncodeCodePoints(
+  std::span<const icu::CodePoint> code_points,
+  StringUTF8& utf8_output) -> bool {
+  return CodePointEncoding(code_points, utf8_output);
+}
+
+auto EncodeCodePoints(
+  std::span<const icu::CodePoint> code_points,
+  StringUTF16& utf16_output) -> bool {
+  return CodePointEncoding(code_points, utf16_output);
+}
+
+auto EncodeCodePoints(
+  std::span<const icu::CodePoint> code_points,
+  std::span<CharUTF8> utf8_output) -> UTFConversionResult {
+  return CodePointEncoding(code_points, utf8_output);
+}
 
-auto UTF32ToASCII(StringViewUTF32 utf32, StringASCII& ascii_output) -> bool {}
+auto EncodeCodePoints(
+  std::span<const icu::CodePoint> code_points,
+  std::span<CharUTF16> utf16_output) -> UTFConversionResult {
+  return CodePointEncoding(code_points, utf16_output);
+}
+
+auto DecodeCodePoints(
+  StringViewUTF8 utf8,
+  std::span<icu::CodePoint> code_points) -> UTFConversionResult {
+  return CodePointDecoding(utf8, code_points);
+}
+
+auto DecodeCodePoints(
+  StringViewUTF16 utf16,
+  std::span<icu::CodePoint> code_points) -> UTFConversionResult {
+  return CodePointDecoding(utf16, code_points);
+}
+
+auto DecodeCodePoints(
+  StringViewUTF32 utf32,
+  std::span<icu::CodePoint> code_points) -> UTFConversionResult {
+  return CodePointDecoding(utf32, code_points);
+}
+
+// Into caller-provided buffers
+auto ASCIIToUTF16(StringViewASCII ascii, std::span<CharUTF16> utf16_output)
+  -> UTFConversionResult {
+  return CopyASCII(ascii, utf16_output);
+}
+
+auto ASCIIToUTF32(StringViewASCII ascii, std::span<CharUTF32> utf32_output)
+  -> UTFConversionResult {
+  return CopyASCII(ascii, utf32_output);
+}
+
+auto ASCIIToUTF8(StringViewASCII ascii, std::span<CharUTF8> utf8_output)
+  -> UTFConversionResult {
+  return CopyASCII(ascii, utf8_output);
+}
+
+auto Latin1ToUTF8(StringViewLatin1 latin1, std::span<CharUTF8> utf8_output)
+  -> UTFConversionResult {
+  return Latin1Conversion(latin1, utf8_output);
+}
+
+auto Latin1ToUTF16(StringViewLatin1 latin1, std::span<CharUTF16> utf16_output)
+  -> UTFConversionResult {
+  return Latin1Conversion(latin1, utf16_output);
+}
+
+auto UTF8ToLatin1(StringViewUTF8 utf8, std::span<CharLatin1> latin1_output)
+  -> UTFConversionResult {
+  return Latin1Conversion(utf8, latin1_output);
+}
+
+auto UTF16ToLatin1(StringViewUTF16 utf16, std::span<CharLatin1> latin1_output)
+  -> UTFConversionResult {
+  return Latin1Conversion(utf16, latin1_output);
+}
+
+auto UTF8ToUTF16(StringViewUTF8 utf8, std::span<CharUTF16> utf16_output)
+  -> UTFConversionResult {
+  return UTFConversion(utf8, utf16_output);
+}
+
+auto UTF8ToUTF32(StringViewUTF8 utf8, std::span<CharUTF32> utf32_output)
+  -> UTFConversionResult {
+  return UTFConversion(utf8, utf32_output);
+}
+
+auto UTF16ToUTF8(StringViewUTF16 utf16, std::span<CharUTF8> utf8_output)
+  -> UTFConversionResult {
+  return UTFConversion(utf16, utf8_output);
+}
+
+auto UTF16ToUTF32(StringViewUTF16 utf16, std::span<CharUTF32> utf32_output)
+  -> UTFConversionResult {
+  return UTFConversion(utf16, utf32_output);
+}
+
+auto UTF16ToASCII(StringViewUTF16 utf16, std::span<CharASCII> ascii_output)
+  -> UTFConversionResult {
+  return NarrowToASCII(utf16, ascii_output);
+}
+
+auto UTF32ToUTF8(StringViewUTF32 utf32, std::span<CharUTF8> utf8_output)
+  -> UTFConversionResult {
+  return UTFConversion(utf32, utf8_output);
+}
+
+auto UTF32ToUTF16(StringViewUTF32 utf32, std::span<CharUTF16> utf16_output)
+  -> UTFConversionResult {
+  return UTFConversion(utf32, utf16_output);
+}
+
+auto UTF32ToASCII(StringViewUTF32 utf32, std::span<CharASCII> ascii_output)
+  -> UTFConversionResult {
+  return NarrowToASCII(utf32, ascii_output);
+}
+
+auto UTF16ToUTF8(
+  StringViewUTF16 utf16,
+  std::endian byte_order,
+  std::span<CharUTF8> utf8_output) -> UTFConversionResult {
+  return UTFConversion(utf16, byte_order, utf8_output);
+}
+
+auto UTF32ToUTF8(
+  StringViewUTF32 utf32,
+  std::endian byte_order,
+  std::span<CharUTF8> utf8_output) -> UTFConversionResult {
+  return UTFConversion(utf32, byte_order, utf8_output);
+}
 
 // NOLINTEND(*-magic-numbers)
 }    // namespace longlp::base
@@ -3,7 +3,11 @@
 // found in the LICENSE file.
 
 #include "base/strings/utf_string_conversion_utils.h"
+
 #include <bit>
+#include <concepts>
+
+#include "strings/simd/utf_kernels.h"
 
 namespace longlp::base {
 
@@ -69,6 +73,38 @@ auto ReadUnicodeCharacter(
   return IsValidCodepoint(code_point_out);
 }
 
+// CountCodePoints -------------------------------------------------------------
+
+auto CountCodePoints(const StringViewUTF8 utf8_src) -> size_t {
+  return internal::simd::UTF32LengthOfUTF8(utf8_src.data(), utf8_src.size());
+}
+
+auto CountCodePoints(const StringViewUTF16 utf16_src) -> size_t {
+  return internal::simd::UTF32LengthOfUTF16(
+    utf16_src.data(),
+    utf16_src.size());
+}
+
+// FirstCodePointLength --------------------------------------------------------
+
+auto FirstCodePointLength(const StringViewUTF8 utf8_src) -> size_t {
+  int32_t offset     = 0;
+  UChar32 code_point = 0;
+  icu::internal::U8Next(
+    std::bit_cast<const uint8_t*>(utf8_src.data()),
+    offset,
+    static_cast<int32_t>(utf8_src.size()),
+    code_point);
+  return static_cast<size_t>(offset);
+}
+
+auto FirstCodePointLength(const StringViewUTF16 utf16_src) -> size_t {
+  return utf16_src.size() >= 2 && icu::internal::U16IsLead(utf16_src[0]) &&
+             icu::internal::U16IsTrail(utf16_src[1])
+           ? 2
+           : 1;
+}
+
 // WriteUnicodeCharacter -------------------------------------------------------
 
 auto AppendUnicodeCharacter(
@@ -119,17 +155,15 @@ void PrepareForUTF8Output(
   const std::basic_string_view<CharT> src,
   StringUTF8& utf8_output) {
   utf8_output.clear();
-  if (src.empty()) {
-    return;
+  if constexpr (std::same_as<CharT, CharUTF16>) {
+    utf8_output.reserve(
+      internal::simd::UTF8LengthOfUTF16(src.data(), src.size()));
   }
-  if (src[0] < 0x80) {
-    // Assume that the entire input will be ASCII.
-    utf8_output.reserve(src.length());
-    return;
+  else {
+    static_assert(std::same_as<CharT, CharUTF32>);
+    utf8_output.reserve(
+      internal::simd::UTF8LengthOfUTF32(src.data(), src.size()));
   }
-
-  // Assume that the entire input is non-ASCII and will have 3 bytes per char.
-  utf8_output.reserve(src.length() * 3);
 }
 
 // Instantiate versions we know callers will need.
@@ -141,18 +175,15 @@ void PrepareForUTF16Or32Output(
   StringViewUTF8 utf8_src,
   std::basic_string<CharT>& output) {
   output.clear();
-  if (utf8_src.empty()) {
-    return;
+  if constexpr (std::same_as<CharT, CharUTF16>) {
+    output.reserve(
+      internal::simd::UTF16LengthOfUTF8(utf8_src.data(), utf8_src.size()));
   }
-  if (static_cast<CharUTF8>(utf8_src[0]) < 0x80) {
-    // Assume the input is all ASCII, which means 1:1 correspondence.
-    output.reserve(utf8_src.length());
-    return;
+  else {
+    static_assert(std::same_as<CharT, CharUTF32>);
+    output.reserve(
+      internal::simd::UTF32LengthOfUTF8(utf8_src.data(), utf8_src.size()));
   }
-
-  // Otherwise assume that the UTF-8 sequences will have 2 bytes for each
-  // character.
-  output.reserve(utf8_src.length() / 2);
 }
 
 // Instantiate versions we know callers will need.
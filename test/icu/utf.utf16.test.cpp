@@ -17,6 +17,8 @@
 
 #include <fmt/printf.h>
 #include <gtest/gtest.h>
+// The macros of ICU, as reference.
+#include <unicode/utf.h>
 
 namespace longlp::base::icu {
 // NOLINTBEGIN(cppcoreguidelines-avoid-do-while, cppcoreguidelines-macro-usage)
@@ -17,6 +17,8 @@
 
 #include <fmt/printf.h>
 #include <gtest/gtest.h>
+// The macros of ICU, as reference.
+#include <unicode/utf.h>
 
 namespace longlp::base::icu {
 // NOLINTBEGIN(cppcoreguidelines-avoid-do-while, cppcoreguidelines-macro-usage)
@@ -297,5 +299,32 @@ TEST(UTF8Test, TestSurrogates) {
   // for now
 }
 
+// Unlike the macros of ICU, the functions can run at compile time.
+TEST(UTF8Test, Constexpr) {
+  static constexpr std::array<uint8_t, 7> kInput = {
+    0x61,
+    0xe2, 0x82, 0xac,  // 20AC
+    0xc0, 0x80,        // non-shortest form
+    0x62
+  };
+  constexpr auto kDecoded = [] {
+    std::array<UChar32, 4> decoded{};
+    int32_t offset = 0;
+    for (auto& codepoint : decoded) {
+      U8Next(kInput.data(), offset, std::ssize(kInput), codepoint);
+    }
+    return decoded;
+  }();
+  static_assert(kDecoded == std::array<UChar32, 4>{0x61, 0x20ac, -1, -1});
+
+  constexpr auto kEncoded = [] {
+    std::array<uint8_t, 4> encoded{};
+    size_t offset = 0;
+    U8AppendUnsafe(encoded.data(), offset, 0x10ffff);
+    return encoded;
+  }();
+  static_assert(kEncoded == std::array<uint8_t, 4>{0xf4, 0x8f, 0xbf, 0xbf});
+}
+
 // NOLINTEND(cppcoreguidelines-avoid-do-while, cppcoreguidelines-macro-usage)
 }    // namespace longlp::base::icu
@@ -0,0 +1,171 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <base/strings/char_set.h>
+
+#include <array>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include <base/strings/string_utils.h>
+#include <base/strings/typedefs.h>
+#include <gtest/gtest.h>
+
+#include "test_utils/gtest_fix_u8string_comparison.h"
+
+namespace longlp::base {
+// NOLINTBEGIN(*-magic-numbers)
+namespace {
+  // Code units around the boundaries the matcher cares about: ASCII, the rest
+  // of the bitmap, and wide code units whose low byte collides with ASCII.
+  template <CharTraits Char>
+  auto RandomUnit(std::mt19937& engine) -> Char {
+    constexpr std::array<uint32_t, 8> kUnits = {
+      {'a', ' ', 0x7F, 0x80, 0xFF, 0x100, 0x161, 0xFF20}};
+    std::uniform_int_distribution<size_t> pick(0, kUnits.size());
+    std::uniform_int_distribution<uint32_t> any('a', 'z');
+    const size_t index = pick(engine);
+    uint32_t unit      = index == kUnits.size() ? any(engine) : kUnits[index];
+    if constexpr (sizeof(Char) == 4) {
+      // Above the Unicode range, which saturating narrowing must not wrap.
+      if (unit == 0xFF20) {
+        unit = 0x80000061;
+      }
+    }
+    return static_cast<Char>(unit);
+  }
+
+  template <CharTraits Char>
+  auto RandomString(std::mt19937& engine, size_t length)
+    -> std::basic_string<Char> {
+    std::basic_string<Char> str;
+    for (size_t i = 0; i < length; ++i) {
+      str.push_back(RandomUnit<Char>(engine));
+    }
+    return str;
+  }
+
+  // The searches match std::basic_string_view, from every position, for
+  // sets with and without wide code units, over lengths that cover the
+  // vector blocks and their tails.
+  template <CharTraits Char>
+  void ExpectMatchesStringView() {
+    std::mt19937 engine(20231016);
+    for (const size_t set_size : {0U, 1U, 3U, 8U}) {
+      for (int round = 0; round < 4; ++round) {
+        const std::basic_string<Char> chars =
+          RandomString<Char>(engine, set_size);
+        const CharSet<Char> set(chars);
+        for (size_t length = 0; length <= 200; length += 7) {
+          const std::basic_string<Char> str =
+            RandomString<Char>(engine, length);
+          const std::basic_string_view<Char> view(str);
+          for (size_t pos = 0; pos <= length + 1; pos += 5) {
+            EXPECT_EQ(
+              view.find_first_of(chars, pos),
+              set.FindFirstOf(str, pos));
+            EXPECT_EQ(
+              view.find_first_not_of(chars, pos),
+              set.FindFirstNotOf(str, pos));
+          }
+          EXPECT_EQ(view.find_last_not_of(chars), set.FindLastNotOf(str));
+
+          // A match only at the very end, past all the vector blocks.
+          std::basic_string<Char> tail(
+            length,
+            static_cast<Char>(sizeof(Char) == 1 ? 0x01 : 0x100));
+          if (!chars.empty()) {
+            tail.push_back(chars.back());
+            EXPECT_EQ(
+              std::basic_string_view<Char>(tail).find_first_of(chars),
+              set.FindFirstOf(tail));
+          }
+        }
+      }
+    }
+  }
+
+  // The CharSet overloads give the same results as the string ones.
+  template <CharTraits Char>
+  void ExpectOverloadsMatch() {
+    std::mt19937 engine(20231017);
+    const std::basic_string<Char> chars = RandomString<Char>(engine, 3);
+    const CharSet<Char> set(chars);
+    const std::basic_string<Char> replace_with = RandomString<Char>(engine, 2);
+    for (size_t length = 0; length <= 100; length += 9) {
+      const std::basic_string<Char> str = RandomString<Char>(engine, length);
+      std::basic_string<Char> expected;
+      std::basic_string<Char> actual;
+
+      EXPECT_EQ(
+        ReplaceChars(str, chars, replace_with, expected),
+        ReplaceChars(str, set, replace_with, actual));
+      ExpectSameString<Char>(expected, actual);
+      EXPECT_EQ(
+        RemoveChars(str, chars, expected),
+        RemoveChars(str, set, actual));
+      ExpectSameString<Char>(expected, actual);
+      EXPECT_EQ(TrimString(str, chars, expected), TrimString(str, set, actual));
+      ExpectSameString<Char>(expected, actual);
+      for (const auto positions :
+           {TrimPositions::kTrimLeading,
+            TrimPositions::kTrimTrailing,
+            TrimPositions::kTrimAll}) {
+        ExpectSameString<Char>(
+          TrimString(str, chars, positions),
+          TrimString(str, set, positions));
+      }
+    }
+  }
+}    // namespace
+
+TEST(CharSetTest, Contains) {
+  const CharSet<CharUTF16> set(u"a\u00FF\u0101\u0100\u0103\uFFFF\u0100");
+  EXPECT_TRUE(set.Contains(u'a'));
+  EXPECT_TRUE(set.Contains(0xFF));
+  EXPECT_TRUE(set.Contains(0x100));
+  EXPECT_TRUE(set.Contains(0x101));
+  EXPECT_FALSE(set.Contains(0x102));
+  EXPECT_TRUE(set.Contains(0x103));
+  EXPECT_TRUE(set.Contains(0xFFFF));
+  EXPECT_FALSE(set.Contains(u'b'));
+  EXPECT_FALSE(set.Contains(0x261));
+  EXPECT_FALSE(set.Contains(0));
+
+  const CharSet<CharASCII> empty;
+  EXPECT_FALSE(empty.Contains('\0'));
+  EXPECT_EQ(CharSet<CharASCII>::npos, empty.FindFirstOf("abc"));
+  EXPECT_EQ(0U, empty.FindFirstNotOf("abc"));
+  EXPECT_EQ(2U, empty.FindLastNotOf("abc"));
+
+  // Signed chars are looked up by their byte value.
+  const CharSet<CharASCII> high_bytes(StringViewASCII("\xE9\x80"));
+  EXPECT_TRUE(high_bytes.Contains('\xE9'));
+  EXPECT_EQ(3U, high_bytes.FindFirstOf("caf\xE9"));
+}
+
+TEST(CharSetTest, FindMatchesStringView) {
+  ExpectMatchesStringView<CharASCII>();
+  ExpectMatchesStringView<CharUTF8>();
+  ExpectMatchesStringView<CharUTF16>();
+  ExpectMatchesStringView<CharUTF32>();
+}
+
+TEST(CharSetTest, StringUtilsOverloads) {
+  ExpectOverloadsMatch<CharASCII>();
+  ExpectOverloadsMatch<CharUTF8>();
+  ExpectOverloadsMatch<CharUTF16>();
+  ExpectOverloadsMatch<CharUTF32>();
+
+  static const CharSet<CharUTF8> kSeparators(LONGLP_LITERAL_UTF8(",; "));
+  StringUTF8 output;
+  EXPECT_TRUE(TrimString(LONGLP_LITERAL_UTF8(" ;a,b; "), kSeparators, output));
+  ExpectEQ(LONGLP_LITERAL_UTF8("a,b"), output);
+  EXPECT_TRUE(RemoveChars(output, kSeparators, output));
+  ExpectEQ(LONGLP_LITERAL_UTF8("ab"), output);
+}
+
+// NOLINTEND(*-magic-numbers)
+}    // namespace longlp::base
@@ -0,0 +1,119 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <base/strings/code_points.h>
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <ranges>
+#include <vector>
+
+#include <base/icu/utf.h>
+#include <base/strings/typedefs.h>
+#include <base/strings/utf_string_conversion.h>
+#include <gtest/gtest.h>
+
+namespace longlp::base {
+namespace {
+  static_assert(std::ranges::forward_range<CodePointView<CharUTF8>>);
+  static_assert(std::ranges::view<CodePointView<CharUTF16>>);
+  static_assert(std::ranges::borrowed_range<CodePointView<CharUTF32>>);
+
+  template <typename Range>
+  auto Collect(Range&& range) -> std::vector<UChar32> {
+    std::vector<UChar32> code_points;
+    for (icu::CodePoint code_point : range) {
+      code_points.push_back(code_point.value());
+    }
+    return code_points;
+  }
+}    // namespace
+
+TEST(CodePointsTest, DecodesEveryEncoding) {
+  const std::vector<UChar32> expected = {'a', 0xE9, 0x4F60, 0x1F600, 'z'};
+
+  EXPECT_EQ(
+    expected,
+    Collect(CodePoints(LONGLP_LITERAL_UTF8(
+      "a\xC3\xA9\xE4\xBD\xA0\xF0\x9F\x98\x80z"))));
+  EXPECT_EQ(
+    expected,
+    Collect(CodePoints(LONGLP_LITERAL_UTF16("a\x00E9\x4F60\xD83D\xDE00z"))));
+  EXPECT_EQ(
+    expected,
+    Collect(CodePoints(LONGLP_LITERAL_UTF32("a\x00E9\x4F60\x1F600z"))));
+
+  EXPECT_TRUE(CodePoints(StringViewUTF8{}).empty());
+  EXPECT_TRUE(Collect(CodePoints(StringViewUTF16{})).empty());
+}
+
+TEST(CodePointsTest, ReplacesIllFormedSequences) {
+  // The truncated \xE4\xBD and the stray \xFF read as one U+FFFD each.
+  EXPECT_EQ(
+    (std::vector<UChar32>{'a', 0xFFFD, 'b', 0xFFFD}),
+    Collect(CodePoints(LONGLP_LITERAL_UTF8("a\xE4\xBD" "b\xFF"))));
+
+  // Lone surrogates, one of them at the end.
+  EXPECT_EQ(
+    (std::vector<UChar32>{0xFFFD, 'a', 0xFFFD}),
+    Collect(CodePoints(LONGLP_LITERAL_UTF16("\xDC00" "a\xD800"))));
+
+  constexpr std::array<CharUTF32, 3> kUTF32 = {U'a', 0xD800, 0x110000};
+  EXPECT_EQ(
+    (std::vector<UChar32>{'a', 0xFFFD, 0xFFFD}),
+    Collect(CodePoints(StringViewUTF32(kUTF32.data(), kUTF32.size()))));
+}
+
+TEST(CodePointsTest, ComposesWithRangeAlgorithms) {
+  constexpr StringViewUTF8 kText =
+    LONGLP_LITERAL_UTF8("long ascii prefix, then \xC3\xA9t\xC3\xA9");
+  const auto view = CodePoints(kText);
+
+  const auto it = std::ranges::find(view, icu::CodePoint(0xE9));
+  ASSERT_NE(view.end(), it);
+  EXPECT_EQ(kText.find(LONGLP_LITERAL_UTF8("\xC3\xA9")), it.offset());
+
+  EXPECT_EQ(
+    2,
+    std::ranges::count_if(view, [](icu::CodePoint code_point) {
+      return code_point.value() > 0x7F;
+    }));
+  EXPECT_EQ(27, std::ranges::distance(view));
+}
+
+TEST(CodePointsTest, MatchesConversionToUTF32) {
+  std::mt19937 engine(20230912);    // NOLINT(*-magic-numbers)
+  constexpr std::array<StringViewUTF8, 6> kFragments = {
+    LONGLP_LITERAL_UTF8("a run of ascii text longer than a word"),
+    LONGLP_LITERAL_UTF8("b"),
+    LONGLP_LITERAL_UTF8("\xC3\xA9"),
+    LONGLP_LITERAL_UTF8("\xE4\xBD\xA0"),
+    LONGLP_LITERAL_UTF8("\xF0\x9F\x98\x80"),
+    LONGLP_LITERAL_UTF8("\xED\xA0\x80\xFF")};
+  std::uniform_int_distribution<size_t> pick(0, kFragments.size() - 1);
+  StringUTF8 utf8;
+  for (size_t i = 0; i < 2000; ++i) {    // NOLINT(*-magic-numbers)
+    utf8 += kFragments[pick(engine)];
+  }
+
+  StringUTF32 utf32;
+  UTF8ToUTF32(utf8, utf32);
+  StringUTF16 utf16;
+  UTF8ToUTF16(utf8, utf16);
+
+  const auto to_code_point = [](CharUTF32 unit) {
+    return icu::CodePoint(static_cast<UChar32>(unit));
+  };
+  EXPECT_TRUE(std::ranges::equal(
+    CodePoints(utf8),
+    utf32 | std::views::transform(to_code_point)));
+  EXPECT_TRUE(std::ranges::equal(
+    CodePoints(utf16),
+    utf32 | std::views::transform(to_code_point)));
+  EXPECT_TRUE(std::ranges::equal(
+    CodePoints(utf32),
+    utf32 | std::views::transform(to_code_point)));
+}
+}    // namespace longlp::base
@@ -0,0 +1,233 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <base/strings/encoding_detection.h>
+
+#include <array>
+#include <bit>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include <base/icu/utf.h>
+#include <base/strings/string_utils.constants.h>
+#include <base/strings/typedefs.h>
+#include <base/strings/utf_string_conversion.h>
+#include <base/strings/utf_string_conversion_utils.h>
+#include <gtest/gtest.h>
+
+#include "test_utils/gtest_fix_u8string_comparison.h"
+
+namespace longlp::base {
+namespace {
+  // The bytes of |units| in the byte order |endian|.
+  template <CharTraits Char>
+  auto ToBytes(std::basic_string_view<Char> units, std::endian endian)
+    -> std::string {
+    std::string bytes;
+    for (const Char unit : units) {
+      for (size_t k = 0; k < sizeof(Char); ++k) {
+        const size_t shift =
+          8 * (endian == std::endian::big ? sizeof(Char) - 1 - k : k);
+        bytes.push_back(static_cast<char>((unit >> shift) & 0xFFU));
+      }
+    }
+    return bytes;
+  }
+
+  auto ToBytes(StringViewUTF8 utf8) -> std::string {
+    return {std::bit_cast<const char*>(utf8.data()), utf8.size()};
+  }
+
+  constexpr StringViewUTF8 kText =
+    LONGLP_LITERAL_UTF8("Grüße, 世界 \U0001F600!");
+}    // namespace
+
+TEST(EncodingDetectionTest, ByteOrderMark) {
+  struct TestCase {
+    std::string_view bytes;
+    TextEncoding encoding;
+    size_t bom_length;
+  };
+
+  constexpr std::array<TestCase, 6> kCases = {{
+    {"\xEF\xBB\xBF" "abc", TextEncoding::kUTF8, 3},
+    {std::string_view("\xFF\xFE\0\0a\0\0\0", 8), TextEncoding::kUTF32LE, 4},
+    {std::string_view("\0\0\xFE\xFF\0\0\0a", 8), TextEncoding::kUTF32BE, 4},
+    {std::string_view("\xFF\xFE" "a\0", 4), TextEncoding::kUTF16LE, 2},
+    {std::string_view("\xFE\xFF\0a", 4), TextEncoding::kUTF16BE, 2},
+    // The mark decides, even for input that is invalid in its encoding.
+    {"\xFE\xFF\xD8", TextEncoding::kUTF16BE, 2},
+  }};
+  ExpectEQ(LONGLP_LITERAL_UTF8("\xEF\xBB\xBF"), kUTF8ByteOrderMark);
+  for (const auto& test_case : kCases) {
+    const auto detection = DetectEncoding(test_case.bytes);
+    EXPECT_EQ(test_case.encoding, detection.encoding);
+    EXPECT_EQ(test_case.bom_length, detection.bom_length);
+  }
+}
+
+TEST(EncodingDetectionTest, WithoutByteOrderMark) {
+  EXPECT_EQ(TextEncoding::kASCII, DetectEncoding("").encoding);
+  EXPECT_EQ(TextEncoding::kASCII, DetectEncoding("plain text").encoding);
+  EXPECT_EQ(
+    TextEncoding::kASCII,
+    DetectEncoding(std::string_view("\0\0\0\0", 4)).encoding);
+  EXPECT_EQ(TextEncoding::kUTF8, DetectEncoding(ToBytes(kText)).encoding);
+  EXPECT_EQ(TextEncoding::kLatin1, DetectEncoding("caf\xE9").encoding);
+  EXPECT_EQ(0U, DetectEncoding(ToBytes(kText)).bom_length);
+
+  StringUTF16 utf16;
+  StringUTF32 utf32;
+  ASSERT_TRUE(UTF8ToUTF16(kText, utf16));
+  ASSERT_TRUE(UTF8ToUTF32(kText, utf32));
+  EXPECT_EQ(
+    TextEncoding::kUTF16LE,
+    DetectEncoding(ToBytes<CharUTF16>(utf16, std::endian::little)).encoding);
+  EXPECT_EQ(
+    TextEncoding::kUTF16BE,
+    DetectEncoding(ToBytes<CharUTF16>(utf16, std::endian::big)).encoding);
+  EXPECT_EQ(
+    TextEncoding::kUTF32LE,
+    DetectEncoding(ToBytes<CharUTF32>(utf32, std::endian::little)).encoding);
+  EXPECT_EQ(
+    TextEncoding::kUTF32BE,
+    DetectEncoding(ToBytes<CharUTF32>(utf32, std::endian::big)).encoding);
+
+  // Mostly CJK, with the spaces giving UTF-16 away.
+  utf16 = u"世界你好 世界 你好";
+  EXPECT_EQ(
+    TextEncoding::kUTF16LE,
+    DetectEncoding(ToBytes<CharUTF16>(utf16, std::endian::little)).encoding);
+
+  // Looks like UTF-16, but a lone surrogate gives it away.
+  utf16 = u"abcdefgh";
+  utf16.push_back(0xD800);
+  EXPECT_EQ(
+    TextEncoding::kLatin1,
+    DetectEncoding(ToBytes<CharUTF16>(utf16, std::endian::little)).encoding);
+}
+
+TEST(EncodingDetectionTest, ConvertToUTF8) {
+  StringUTF16 utf16;
+  StringUTF32 utf32;
+  ASSERT_TRUE(UTF8ToUTF16(kText, utf16));
+  ASSERT_TRUE(UTF8ToUTF32(kText, utf32));
+
+  const std::array<std::string, 5> inputs = {
+    ToBytes(kText),
+    ToBytes<CharUTF16>(utf16, std::endian::little),
+    ToBytes<CharUTF16>(utf16, std::endian::big),
+    ToBytes<CharUTF32>(utf32, std::endian::little),
+    ToBytes<CharUTF32>(utf32, std::endian::big)};
+  const std::array<std::string_view, 5> marks = {
+    "\xEF\xBB\xBF",
+    "\xFF\xFE",
+    "\xFE\xFF",
+    std::string_view("\xFF\xFE\0\0", 4),
+    std::string_view("\0\0\xFE\xFF", 4)};
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    StringUTF8 output;
+    EXPECT_TRUE(ConvertToUTF8(inputs[i], output));
+    ExpectEQ(kText, output);
+    EXPECT_TRUE(ConvertToUTF8(std::string(marks[i]) + inputs[i], output));
+    ExpectEQ(kText, output);
+  }
+
+  StringUTF8 output;
+  EXPECT_TRUE(ConvertToUTF8("caf\xE9", output));
+  ExpectEQ(LONGLP_LITERAL_UTF8("café"), output);
+  EXPECT_TRUE(ConvertToUTF8("", output));
+  EXPECT_TRUE(output.empty());
+}
+
+TEST(EncodingDetectionTest, ConvertToUTF8WithEncoding) {
+  StringUTF8 output;
+  EXPECT_TRUE(ConvertToUTF8("caf\xE9", TextEncoding::kLatin1, output));
+  ExpectEQ(LONGLP_LITERAL_UTF8("café"), output);
+
+  // Only one byte order mark is dropped, and only the one of the encoding.
+  EXPECT_TRUE(ConvertToUTF8(
+    "\xEF\xBB\xBF\xEF\xBB\xBF" "a",
+    TextEncoding::kUTF8,
+    output));
+  ExpectEQ(LONGLP_LITERAL_UTF8("\uFEFF" "a"), output);
+  EXPECT_TRUE(ConvertToUTF8("\xEF\xBB\xBF", TextEncoding::kLatin1, output));
+  ExpectEQ(LONGLP_LITERAL_UTF8("ï»¿"), output);
+
+  // Wide input is converted in place when aligned, copied otherwise.
+  StringUTF32 utf32;
+  ASSERT_TRUE(UTF8ToUTF32(kText, utf32));
+  const std::string misaligned =
+    "." + ToBytes<CharUTF32>(utf32, std::endian::big);
+  EXPECT_TRUE(ConvertToUTF8(
+    std::string_view(misaligned).substr(1),
+    TextEncoding::kUTF32BE,
+    output));
+  ExpectEQ(kText, output);
+
+  // Invalid input is replaced by U+FFFD.
+  EXPECT_FALSE(ConvertToUTF8("a\xE4\xBD" "b", TextEncoding::kUTF8, output));
+  ExpectEQ(LONGLP_LITERAL_UTF8("a�" "b"), output);
+  EXPECT_FALSE(ConvertToUTF8("caf\xE9", TextEncoding::kASCII, output));
+  ExpectEQ(LONGLP_LITERAL_UTF8("caf�"), output);
+  EXPECT_FALSE(ConvertToUTF8(
+    std::string_view("a\0\0\xD8" "b", 5),
+    TextEncoding::kUTF16LE,
+    output));
+  ExpectEQ(LONGLP_LITERAL_UTF8("a��"), output);
+  EXPECT_FALSE(ConvertToUTF8(
+    std::string_view("\0\0\0a\0\x11\0\0", 8),
+    TextEncoding::kUTF32BE,
+    output));
+  ExpectEQ(LONGLP_LITERAL_UTF8("a�"), output);
+}
+
+TEST(EncodingDetectionTest, RoundTripsRandomText) {
+  std::mt19937 engine(20230916);    // NOLINT(*-magic-numbers)
+  // Mostly ASCII, as most text, then Latin-1, the BMP and beyond.
+  std::discrete_distribution<int> plane({8, 2, 2, 1});
+  std::uniform_int_distribution<UChar32> ascii(0x20, 0x7E);
+  std::uniform_int_distribution<UChar32> latin1(0xA0, 0xFF);
+  std::uniform_int_distribution<UChar32> bmp(0x4E00, 0x9FFF);
+  std::uniform_int_distribution<UChar32> supplementary(0x1F300, 0x1F64F);
+  for (const size_t length : {1, 7, 100, 5000, 20000}) {
+    StringUTF32 utf32;
+    for (size_t i = 0; i < length; ++i) {
+      switch (plane(engine)) {
+        case 0:
+          utf32.push_back(static_cast<CharUTF32>(ascii(engine)));
+          break;
+        case 1:
+          utf32.push_back(static_cast<CharUTF32>(latin1(engine)));
+          break;
+        case 2:
+          utf32.push_back(static_cast<CharUTF32>(bmp(engine)));
+          break;
+        default:
+          utf32.push_back(static_cast<CharUTF32>(supplementary(engine)));
+          break;
+      }
+    }
+    StringUTF8 utf8;
+    StringUTF16 utf16;
+    ASSERT_TRUE(UTF32ToUTF8(utf32, utf8));
+    ASSERT_TRUE(UTF32ToUTF16(utf32, utf16));
+
+    for (const auto endian : {std::endian::little, std::endian::big}) {
+      for (const auto& bytes :
+           {ToBytes<CharUTF16>(utf16, endian),
+            ToBytes<CharUTF32>(utf32, endian)}) {
+        StringUTF8 output;
+        EXPECT_TRUE(ConvertToUTF8(bytes, output));
+        ExpectEQ(utf8, output);
+      }
+    }
+    StringUTF8 output;
+    EXPECT_TRUE(ConvertToUTF8(ToBytes(utf8), output));
+    ExpectEQ(utf8, output);
+  }
+}
+
+}    // namespace longlp::base
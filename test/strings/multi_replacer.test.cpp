@@ -0,0 +1,200 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <base/strings/multi_replacer.h>
+
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <base/strings/typedefs.h>
+#include <gtest/gtest.h>
+
+#include "test_utils/gtest_fix_u8string_comparison.h"
+
+namespace longlp::base {
+// NOLINTBEGIN(*-magic-numbers)
+namespace {
+  template <CharTraits Char>
+  struct Table {
+    std::vector<std::basic_string<Char>> storage{};
+    std::vector<typename MultiReplacer<Char>::Replacement> replacements{};
+  };
+
+  template <CharTraits Char>
+  auto Compile(
+    const std::vector<std::pair<StringViewASCII, StringViewASCII>>& table)
+    -> Table<Char> {
+    Table<Char> result;
+    result.storage.reserve(table.size() * 2);
+    for (const auto& [find_this, replace_with] : table) {
+      result.storage.push_back(Widen<Char>(find_this));
+      result.storage.push_back(Widen<Char>(replace_with));
+    }
+    for (size_t i = 0; i < result.storage.size(); i += 2) {
+      result.replacements.push_back(
+        {.find_this    = result.storage[i],
+         .replace_with = result.storage[i + 1]});
+    }
+    return result;
+  }
+
+  // At each position, replaces the longest pattern found there, if any.
+  template <CharTraits Char>
+  auto ReplaceNaive(
+    std::basic_string_view<Char> str,
+    size_t start_offset,
+    const std::vector<typename MultiReplacer<Char>::Replacement>& replacements)
+    -> std::basic_string<Char> {
+    std::basic_string<Char> result(str.substr(0, start_offset));
+    for (size_t pos = start_offset; pos < str.size();) {
+      const typename MultiReplacer<Char>::Replacement* best = nullptr;
+      for (const auto& replacement : replacements) {
+        if (
+          !replacement.find_this.empty() &&
+          str.substr(pos).starts_with(replacement.find_this) &&
+          (best == nullptr ||
+           replacement.find_this.size() > best->find_this.size())) {
+          best = &replacement;
+        }
+      }
+      if (best == nullptr) {
+        result.push_back(str[pos++]);
+        continue;
+      }
+      result.append(best->replace_with);
+      pos += best->find_this.size();
+    }
+    return result;
+  }
+
+  template <CharTraits Char>
+  void ExpectReplaces(
+    const std::vector<std::pair<StringViewASCII, StringViewASCII>>& table,
+    StringViewASCII input,
+    size_t start_offset,
+    StringViewASCII expected) {
+    const Table<Char> compiled = Compile<Char>(table);
+    const MultiReplacer<Char> replacer(compiled.replacements);
+    std::basic_string<Char> str = Widen<Char>(input);
+    EXPECT_EQ(input != expected, replacer.Replace(str, start_offset));
+    ExpectSameString<Char>(Widen<Char>(expected), str);
+  }
+
+  template <CharTraits Char>
+  void ExpectReplacesAll() {
+    const std::vector<std::pair<StringViewASCII, StringViewASCII>> kEscapes = {
+      {"&", "&amp;"},
+      {"<", "&lt;"},
+      {">", "&gt;"},
+      {"\"", "&quot;"},
+    };
+    ExpectReplaces<Char>(kEscapes, "", 0, "");
+    ExpectReplaces<Char>(kEscapes, "plain", 0, "plain");
+    ExpectReplaces<Char>(kEscapes, "<a>", 0, "&lt;a&gt;");
+    ExpectReplaces<Char>(kEscapes, "\"&\"", 0, "&quot;&amp;&quot;");
+    ExpectReplaces<Char>(kEscapes, "<a>", 1, "<a&gt;");
+    ExpectReplaces<Char>(kEscapes, "<a>", 3, "<a>");
+    ExpectReplaces<Char>(kEscapes, "<a>", 9999, "<a>");
+
+    // Leftmost, then longest.
+    const std::vector<std::pair<StringViewASCII, StringViewASCII>> kOverlaps = {
+      {"b", "1"},
+      {"abcd", "2"},
+      {"bc", "3"},
+      {"ab", "4"},
+      {"abc", "5"},
+    };
+    ExpectReplaces<Char>(kOverlaps, "abcd", 0, "2");
+    ExpectReplaces<Char>(kOverlaps, "abce", 0, "5e");
+    ExpectReplaces<Char>(kOverlaps, "abx", 0, "4x");
+    ExpectReplaces<Char>(kOverlaps, "xbcd", 0, "x3d");
+    ExpectReplaces<Char>(kOverlaps, "xbx", 0, "x1x");
+    ExpectReplaces<Char>(kOverlaps, "aabcabd", 0, "a54d");
+
+    // Shrinking and growing, the first replacement wins for a duplicated
+    // pattern, and empty patterns are ignored.
+    const std::vector<std::pair<StringViewASCII, StringViewASCII>> kMixed = {
+      {"", "never"},
+      {"x", "long replacement"},
+      {"yyyy", ""},
+      {"x", "unused"},
+    };
+    ExpectReplaces<Char>(kMixed, "yyyyx", 0, "long replacement");
+    ExpectReplaces<Char>(kMixed, "xyyyy", 0, "long replacement");
+    ExpectReplaces<Char>(kMixed, "yyyyyyyyx", 0, "long replacement");
+    ExpectReplaces<Char>(kMixed, "yyyyyyyyzz", 0, "zz");
+
+    // No patterns at all.
+    ExpectReplaces<Char>({}, "text", 0, "text");
+  }
+
+  template <CharTraits Char>
+  void ExpectMatchesNaive() {
+    std::mt19937 engine(20231019);
+    std::uniform_int_distribution<size_t> pattern_length(0, 6);
+    std::uniform_int_distribution<size_t> replace_length(0, 8);
+    for (const size_t num_patterns : {1U, 2U, 5U, 20U}) {
+      for (int round = 0; round < 10; ++round) {
+        std::vector<std::basic_string<Char>> storage;
+        for (size_t i = 0; i < num_patterns; ++i) {
+          storage.push_back(
+            RandomSmallAlphabetString<Char>(engine, pattern_length(engine)));
+          storage.push_back(
+            RandomSmallAlphabetString<Char>(engine, replace_length(engine)));
+        }
+        std::vector<typename MultiReplacer<Char>::Replacement> replacements;
+        for (size_t i = 0; i < storage.size(); i += 2) {
+          replacements.push_back(
+            {.find_this = storage[i], .replace_with = storage[i + 1]});
+        }
+        const MultiReplacer<Char> replacer(replacements);
+
+        for (const size_t length : {0U, 1U, 7U, 64U, 300U}) {
+          const std::basic_string<Char> str =
+            RandomSmallAlphabetString<Char>(engine, length);
+          for (const size_t start_offset : {size_t{0}, size_t{3}}) {
+            std::basic_string<Char> actual = str;
+            replacer.Replace(actual, start_offset);
+            ExpectSameString<Char>(
+              ReplaceNaive<Char>(str, start_offset, replacements),
+              actual);
+
+            // The same, rewritten in place with enough capacity.
+            std::basic_string<Char> in_place = str;
+            in_place.reserve(length * 10);
+            replacer.Replace(in_place, start_offset);
+            ExpectSameString<Char>(actual, in_place);
+          }
+        }
+      }
+    }
+  }
+}    // namespace
+
+TEST(MultiReplacerTest, Replace) {
+  ExpectReplacesAll<CharASCII>();
+  ExpectReplacesAll<CharUTF8>();
+  ExpectReplacesAll<CharUTF16>();
+  ExpectReplacesAll<CharUTF32>();
+
+  static const MultiReplacer<CharUTF16> kReplacer({
+    {u"š", u"s"},
+    {u"šš", u"\U0001F600"},
+  });
+  StringUTF16 str = u"ašššb";
+  EXPECT_TRUE(kReplacer.Replace(str));
+  EXPECT_EQ(u"a\U0001F600sb", str);
+}
+
+TEST(MultiReplacerTest, ReplaceMatchesNaive) {
+  ExpectMatchesNaive<CharASCII>();
+  ExpectMatchesNaive<CharUTF8>();
+  ExpectMatchesNaive<CharUTF16>();
+  ExpectMatchesNaive<CharUTF32>();
+}
+
+// NOLINTEND(*-magic-numbers)
+}    // namespace longlp::base
@@ -5,13 +5,61 @@
 #include <base/strings/string_utils.h>
 
 #include <array>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include <base/strings/typedefs.h>
 #include <gtest/gtest.h>
 
+#include "test_utils/ascii_case.h"
 #include "test_utils/gtest_fix_u8string_comparison.h"
 
 namespace longlp::base {
+namespace {
+  // Checks the vectorized comparison against the scalar one on random strings
+  // of every length up to a few vectors, differing at every position.
+  template <CharTraits Char>
+  void ExpectCompareMatchesScalar() {
+    // NOLINTBEGIN(*-magic-numbers)
+    std::mt19937 engine(20230919);
+    const std::vector<uint32_t> alphabet = ASCIICaseAlphabet<Char>();
+    // NOLINTEND(*-magic-numbers)
+    std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+    std::bernoulli_distribution flip_case;
+
+    for (size_t length = 0; length <= 150; ++length) {
+      std::basic_string<Char> lhs;
+      std::basic_string<Char> rhs;
+      for (size_t i = 0; i < length; ++i) {
+        lhs.push_back(static_cast<Char>(alphabet[pick(engine)]));
+        rhs.push_back(
+          flip_case(engine) ? ToUpperASCII(lhs.back())
+                            : ToLowerASCII(lhs.back()));
+      }
+      const auto expect_same = [](
+                                 std::basic_string_view<Char> str_a,
+                                 std::basic_string_view<Char> str_b) {
+        EXPECT_EQ(
+          internal::CompareCaseInsensitiveASCII(str_a, str_b),
+          CompareCaseInsensitiveASCII(str_a, str_b));
+      };
+      EXPECT_EQ(0, CompareCaseInsensitiveASCII(lhs, rhs));
+      if (length > 0) {
+        expect_same(lhs, std::basic_string_view<Char>(rhs).substr(1));
+        expect_same(std::basic_string_view<Char>(lhs).substr(1), rhs);
+      }
+      for (size_t i = 0; i < length; ++i) {
+        std::basic_string<Char> changed = rhs;
+        changed[i] = static_cast<Char>(alphabet[pick(engine)]);
+        expect_same(lhs, changed);
+        expect_same(changed, lhs);
+      }
+    }
+  }
+}    // namespace
 
 TEST(StringUtilTest, CompareCaseInsensitiveASCII) {
 #define EXPECT_EQ_COMPARE_CASE_INSENSITIVE_ASCII(          \
@@ -79,4 +127,11 @@ TEST(StringUtilTest, CompareCaseInsensitiveASCII) {
 
 #undef EXPECT_EQ_COMPARE_CASE_INSENSITIVE_ASCII
 }
+
+TEST(StringUtilTest, CompareCaseInsensitiveASCIIMatchesScalar) {
+  ExpectCompareMatchesScalar<CharASCII>();
+  ExpectCompareMatchesScalar<CharUTF8>();
+  ExpectCompareMatchesScalar<CharUTF16>();
+  ExpectCompareMatchesScalar<CharUTF32>();
+}
 }    // namespace longlp::base
@@ -5,13 +5,69 @@
 #include <base/strings/string_utils.h>
 
 #include <array>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include <base/strings/typedefs.h>
 #include <gtest/gtest.h>
 
+#include "test_utils/ascii_case.h"
 #include "test_utils/gtest_fix_u8string_comparison.h"
 
 namespace longlp::base {
+namespace {
+  // Checks the vectorized equality against the scalar one on random strings
+  // of every length up to a few vectors, differing at every position. The
+  // code units are those both types can hold, non-ASCII ones included.
+  template <CharTraits CharA, CharTraits CharB>
+  void ExpectEqualsMatchesScalar() {
+    // NOLINTBEGIN(*-magic-numbers)
+    std::mt19937 engine(20230919);
+    const std::vector<uint32_t> alphabet = ASCIICaseAlphabet<CharA, CharB>();
+    // NOLINTEND(*-magic-numbers)
+    std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+    std::bernoulli_distribution flip_case;
+
+    for (size_t length = 0; length <= 150; ++length) {
+      std::basic_string<CharA> lhs;
+      std::basic_string<CharB> rhs;
+      for (size_t i = 0; i < length; ++i) {
+        const uint32_t unit = alphabet[pick(engine)];
+        lhs.push_back(static_cast<CharA>(unit));
+        rhs.push_back(
+          flip_case(engine) ? ToUpperASCII(static_cast<CharB>(unit))
+                            : static_cast<CharB>(unit));
+      }
+      const auto expect_same = [](
+                                 std::basic_string_view<CharA> str_a,
+                                 std::basic_string_view<CharB> str_b) {
+        EXPECT_EQ(
+          internal::EqualsCaseInsensitiveASCII(str_a, str_b),
+          EqualsCaseInsensitiveASCII(str_a, str_b));
+      };
+      expect_same(lhs, rhs);
+      if (length > 0) {
+        expect_same(lhs, std::basic_string_view<CharB>(rhs).substr(1));
+      }
+      for (size_t i = 0; i < length; ++i) {
+        std::basic_string<CharB> changed = rhs;
+        changed[i] = static_cast<CharB>(alphabet[pick(engine)]);
+        expect_same(lhs, changed);
+      }
+    }
+  }
+
+  template <CharTraits CharA>
+  void ExpectEqualsMatchesScalarForAll() {
+    ExpectEqualsMatchesScalar<CharA, CharASCII>();
+    ExpectEqualsMatchesScalar<CharA, CharUTF8>();
+    ExpectEqualsMatchesScalar<CharA, CharUTF16>();
+    ExpectEqualsMatchesScalar<CharA, CharUTF32>();
+  }
+}    // namespace
 
 TEST(StringUtilTest, EqualsCaseInsensitiveASCII) {
 #define EXPECT_EQUAL_CASE_INSENSITIVE_ASCII(         \
@@ -145,4 +201,11 @@ TEST(StringUtilTest, EqualsCaseInsensitiveASCII) {
   EXPECT_FALSE(EqualsCaseInsensitiveASCII("aaa \xc3\xa4", U"AAA \xc3\xa4"));
   EXPECT_FALSE(EqualsCaseInsensitiveASCII("aaa \xc3\x84", "AAA \xc3\xa4"));
 }
+
+TEST(StringUtilTest, EqualsCaseInsensitiveASCIIMatchesScalar) {
+  ExpectEqualsMatchesScalarForAll<CharASCII>();
+  ExpectEqualsMatchesScalarForAll<CharUTF8>();
+  ExpectEqualsMatchesScalarForAll<CharUTF16>();
+  ExpectEqualsMatchesScalarForAll<CharUTF32>();
+}
 }    // namespace longlp::base
@@ -0,0 +1,50 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <base/strings/string_utils.h>
+
+#include <base/strings/typedefs.h>
+#include <gtest/gtest.h>
+
+namespace longlp::base {
+namespace {
+  // Checks every length up to a few vectors and every position of a single
+  // non-ASCII code unit, so both the vector loops and the tails are covered.
+  template <typename String>
+  void CheckNonASCIIAtEveryPosition(
+    typename String::value_type non_ascii) {
+    for (size_t length = 0; length < 300; ++length) {
+      String str(length, 'A');
+      EXPECT_TRUE(IsStringASCII(str)) << length;
+      for (size_t i = 0; i < length; ++i) {
+        str[i] = non_ascii;
+        EXPECT_FALSE(IsStringASCII(str)) << length << " " << i;
+        str[i] = 'A';
+      }
+    }
+  }
+}    // namespace
+
+TEST(StringUtilTest, IsStringASCII) {
+  EXPECT_TRUE(IsStringASCII(StringViewASCII()));
+  EXPECT_TRUE(IsStringASCII(LONGLP_LITERAL_ASCII("\x7f")));
+  EXPECT_TRUE(IsStringASCII(LONGLP_LITERAL_UTF8("plain ascii")));
+  EXPECT_TRUE(IsStringASCII(LONGLP_LITERAL_UTF16("plain ascii")));
+  EXPECT_TRUE(IsStringASCII(LONGLP_LITERAL_UTF32("plain ascii")));
+
+  EXPECT_FALSE(IsStringASCII(LONGLP_LITERAL_ASCII("\x80")));
+  EXPECT_FALSE(IsStringASCII(LONGLP_LITERAL_UTF8("café")));
+  EXPECT_FALSE(IsStringASCII(LONGLP_LITERAL_UTF16("café")));
+  EXPECT_FALSE(IsStringASCII(LONGLP_LITERAL_UTF32("café")));
+
+  CheckNonASCIIAtEveryPosition<StringASCII>(static_cast<CharASCII>(0x80));
+  CheckNonASCIIAtEveryPosition<StringUTF8>(static_cast<CharUTF8>(0xFF));
+  // Code units whose low byte is ASCII must not pass as ASCII.
+  CheckNonASCIIAtEveryPosition<StringUTF16>(static_cast<CharUTF16>(0x0100));
+  CheckNonASCIIAtEveryPosition<StringUTF16>(static_cast<CharUTF16>(0x8000));
+  CheckNonASCIIAtEveryPosition<StringUTF32>(static_cast<CharUTF32>(0x0100));
+  CheckNonASCIIAtEveryPosition<StringUTF32>(static_cast<CharUTF32>(0x10000));
+  CheckNonASCIIAtEveryPosition<StringUTF32>(static_cast<CharUTF32>(0x80000000));
+}
+}    // namespace longlp::base
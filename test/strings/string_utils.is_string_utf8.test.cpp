@@ -0,0 +1,212 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <base/strings/string_utils.h>
+
+#include <array>
+#include <bit>
+#include <random>
+
+#include <base/icu/utf.h>
+#include <base/strings/typedefs.h>
+#include <base/strings/utf_string_conversion_utils.h>
+#include <gtest/gtest.h>
+
+namespace longlp::base {
+namespace {
+  // The scalar loop the vectorized validator replaces.
+  auto ReferenceIsStringUTF8(StringViewUTF8 str, bool allow_noncharacters)
+    -> bool {
+    const auto length = static_cast<int32_t>(str.size());
+    for (int32_t i = 0; i < length;) {
+      icu::CodePoint code_point;
+      icu::internal::U8Next(
+        std::bit_cast<const uint8_t*>(str.data()),
+        i,
+        length,
+        *code_point);
+      if (allow_noncharacters ? !IsValidCodepoint(code_point)
+                              : !IsValidCharacter(code_point)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Valid text of every UTF-8 length, noncharacters, code points sharing their
+  // last bytes, and malformed sequences.
+  auto RandomUTF8(std::mt19937& engine, size_t fragments) -> StringUTF8 {
+    static constexpr std::array<StringViewUTF8, 18> kFragments = {
+      LONGLP_LITERAL_UTF8("Hello, world. "),
+      LONGLP_LITERAL_UTF8("a"),
+      LONGLP_LITERAL_UTF8("é"),
+      LONGLP_LITERAL_UTF8("пя"),
+      LONGLP_LITERAL_UTF8("你好"),
+      LONGLP_LITERAL_UTF8("\U0001F600"),
+      LONGLP_LITERAL_UTF8("\xE4\xBF\xBF"),        // U+4FFF.
+      LONGLP_LITERAL_UTF8("\xEF\xB7\x8F"),        // U+FDCF.
+      LONGLP_LITERAL_UTF8("\xEF\xB7\x90"),        // Noncharacter U+FDD0.
+      LONGLP_LITERAL_UTF8("\xEF\xBF\xBE"),        // Noncharacter U+FFFE.
+      LONGLP_LITERAL_UTF8("\xF4\x8F\xBF\xBF"),    // Noncharacter U+10FFFF.
+      LONGLP_LITERAL_UTF8("\xC0\x80"),            // Overlong NUL.
+      LONGLP_LITERAL_UTF8("\xF0\x8F\xBF\xBF"),    // Overlong U+FFFF.
+      LONGLP_LITERAL_UTF8("\xED\xA0\x80"),        // Surrogate U+D800.
+      LONGLP_LITERAL_UTF8("\xF4\x90\x80\x80"),    // Above U+10FFFF.
+      LONGLP_LITERAL_UTF8("\x80"),                // Lone continuation byte.
+      LONGLP_LITERAL_UTF8("\xF0\x9F\x98"),        // Truncated sequence.
+      LONGLP_LITERAL_UTF8("\xFF"),
+    };
+    // Mostly valid text, so that errors land at every offset of a block.
+    std::uniform_int_distribution<size_t> pick(0, kFragments.size() - 1);
+    std::uniform_int_distribution<size_t> valid(0, 10);
+    std::uniform_int_distribution<size_t> pick_valid(0, 7);
+    StringUTF8 result;
+    for (size_t i = 0; i < fragments; ++i) {
+      const size_t index =
+        valid(engine) == 0 ? pick(engine) : pick_valid(engine);
+      result += kFragments[index];
+    }
+    return result;
+  }
+}    // namespace
+
+TEST(StringUtilTest, IsStringUTF8) {
+  EXPECT_TRUE(IsStringUTF8(LONGLP_LITERAL_UTF8("")));
+  EXPECT_TRUE(IsStringUTF8(LONGLP_LITERAL_UTF8("abc")));
+  EXPECT_TRUE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xc2\x81")));
+  EXPECT_TRUE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xe1\x80\xbf")));
+  EXPECT_TRUE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xf1\x80\xa0\xbf")));
+  EXPECT_TRUE(IsStringUTF8(
+    LONGLP_LITERAL_UTF8("a\xc2\x81\xe1\x80\xbf\xf1\x80\xa0\xbf")));
+  // UTF-8 BOM
+  EXPECT_TRUE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xef\xbb\xbf" "abc")));
+
+  // surrogate code points
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xed\xa0\x80\xed\xbf\xbf")));
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xed\xa0\x8f")));
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xed\xbf\xbf")));
+
+  // overlong sequences
+  // U+0000
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xc0\x80")));
+  // "AB"
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xc1\x80\xc1\x81")));
+  // U+0000
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xe0\x80\x80")));
+  // U+0080
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xe0\x82\x80")));
+  // U+07FF
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xe0\x9f\xbf")));
+  // U+000D
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xf0\x80\x80\x8D")));
+  // U+0091
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xf0\x80\x82\x91")));
+  // U+0800
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xf0\x80\xa0\x80")));
+  // U+FEFF (BOM)
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xf0\x8f\xbb\xbf")));
+  // U+003F
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xf8\x80\x80\x80\xbf")));
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xfc\x80\x80\x80\xa0\xa5")));
+
+  // Beyond U+10FFFF (the upper limit of Unicode codespace)
+  // U+110000
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xf4\x90\x80\x80")));
+  // 5 bytes
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xf8\xa0\xbf\x80\xbf")));
+  // 6 bytes
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xfc\x9c\xbf\x80\xbf\x80")));
+
+  // BOMs in UTF-16(BE|LE) and UTF-32(BE|LE)
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xfe\xff")));
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xff\xfe")));
+  EXPECT_FALSE(IsStringUTF8(
+    StringViewUTF8(LONGLP_LITERAL_UTF8("\x00\x00\xfe\xff"), 4)));
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xff\xfe\x00\x00")));
+
+  // Non-characters : U+xxFFF[EF] where xx is 0x00 through 0x10 and <FDD0,FDEF>
+  // U+FFFE
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xef\xbf\xbe")));
+  // U+1FFFE
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xf0\x9f\xbf\xbe")));
+  // U+FFFFF
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xf3\xbf\xbf\xbf")));
+  // U+FDD0
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xef\xb7\x90")));
+  // U+FDEF
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xef\xb7\xaf")));
+  // Strings in legacy encodings. We can certainly make up strings
+  // in a legacy encoding that are valid in UTF-8, but in real data,
+  // most of them are invalid as UTF-8.
+  // cafe with U+00E9 in ISO-8859-1
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("caf\xe9")));
+  // U+AC00, U+AC001 in EUC-KR
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xb0\xa1\xb0\xa2")));
+  // U+4F60 U+597D in Big5
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xa7\x41\xa6\x6e")));
+  // "abc" with U+201[CD] in windows-125[0-8]
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\x93" "abc\x94")));
+  // U+0639 U+064E U+0644 U+064E in ISO-8859-6
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xd9\xee\xe4\xee")));
+  // U+03B3 U+03B5 U+03B9 U+03AC in ISO-8859-7
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("\xe3\xe5\xe9\xdC")));
+
+  // Check that we support Embedded Nulls. The first uses the canonical UTF-8
+  // representation, and the second uses a 2-byte sequence. The second version
+  // is invalid UTF-8 since UTF-8 states that the shortest encoding for a
+  // given codepoint must be used.
+  static constexpr StringViewUTF8 kEmbeddedNull(
+    LONGLP_LITERAL_UTF8("embedded\0null"),
+    13);
+  EXPECT_TRUE(IsStringUTF8(kEmbeddedNull));
+  EXPECT_FALSE(IsStringUTF8(LONGLP_LITERAL_UTF8("embedded\xc0\x80U+0000")));
+}
+
+TEST(StringUtilTest, IsStringUTF8AllowingNoncharacters) {
+  // Unicode noncharacters are allowed.
+  // U+FFFE
+  EXPECT_TRUE(IsStringUTF8AllowingNoncharacters(
+    LONGLP_LITERAL_UTF8("\xef\xbf\xbe")));
+  // U+1FFFE
+  EXPECT_TRUE(IsStringUTF8AllowingNoncharacters(
+    LONGLP_LITERAL_UTF8("\xf0\x9f\xbf\xbe")));
+  // U+10FFFF
+  EXPECT_TRUE(IsStringUTF8AllowingNoncharacters(
+    LONGLP_LITERAL_UTF8("\xf4\x8f\xbf\xbf")));
+  // U+FDD0
+  EXPECT_TRUE(IsStringUTF8AllowingNoncharacters(
+    LONGLP_LITERAL_UTF8("\xef\xb7\x90")));
+
+  // Everything else is still rejected.
+  EXPECT_FALSE(IsStringUTF8AllowingNoncharacters(
+    LONGLP_LITERAL_UTF8("\xed\xa0\x80")));
+  EXPECT_FALSE(IsStringUTF8AllowingNoncharacters(
+    LONGLP_LITERAL_UTF8("\xc0\x80")));
+  EXPECT_FALSE(IsStringUTF8AllowingNoncharacters(
+    LONGLP_LITERAL_UTF8("\xf4\x90\x80\x80")));
+  EXPECT_FALSE(IsStringUTF8AllowingNoncharacters(
+    LONGLP_LITERAL_UTF8("\xe4\xbd")));
+  EXPECT_FALSE(IsStringUTF8AllowingNoncharacters(
+    LONGLP_LITERAL_UTF8("caf\xe9")));
+}
+
+TEST(StringUtilTest, IsStringUTF8MatchesScalarDecoder) {
+  std::mt19937 engine(20230904);    // NOLINT(*-magic-numbers)
+  for (size_t fragments = 0; fragments < 400; ++fragments) {
+    const auto input = RandomUTF8(engine, fragments);
+    // Every prefix, so that errors and truncations cross block boundaries.
+    for (size_t length = input.size() >= 64 ? input.size() - 64 : 0;
+         length <= input.size();
+         ++length) {
+      const StringViewUTF8 prefix(input.data(), length);
+      ASSERT_EQ(IsStringUTF8(prefix), ReferenceIsStringUTF8(prefix, false))
+        << fragments << " " << length;
+      ASSERT_EQ(
+        IsStringUTF8AllowingNoncharacters(prefix),
+        ReferenceIsStringUTF8(prefix, true))
+        << fragments << " " << length;
+    }
+  }
+}
+}    // namespace longlp::base
@@ -0,0 +1,175 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <base/strings/string_utils.h>
+
+#include <array>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include <base/strings/typedefs.h>
+#include <gtest/gtest.h>
+
+#include "test_utils/gtest_fix_u8string_comparison.h"
+
+namespace longlp::base {
+// NOLINTBEGIN(*-magic-numbers)
+namespace {
+  struct ReplaceCase {
+    StringViewASCII str;
+    size_t start_offset;
+    StringViewASCII find_this;
+    StringViewASCII replace_with;
+    StringViewASCII expected;
+  };
+
+  template <CharTraits Char, bool kReplaceAll>
+  void ExpectReplaces(const ReplaceCase& test_case) {
+    std::basic_string<Char> str = Widen<Char>(test_case.str);
+    const std::basic_string<Char> find_this = Widen<Char>(test_case.find_this);
+    const std::basic_string<Char> replace_with =
+      Widen<Char>(test_case.replace_with);
+    const bool replaced =
+      kReplaceAll ? ReplaceSubstringsAfterOffset(
+                      str,
+                      test_case.start_offset,
+                      find_this,
+                      replace_with)
+                  : ReplaceFirstSubstringAfterOffset(
+                      str,
+                      test_case.start_offset,
+                      find_this,
+                      replace_with);
+    ExpectSameString<Char>(Widen<Char>(test_case.expected), str);
+    EXPECT_EQ(test_case.str != test_case.expected, replaced);
+  }
+
+  template <bool kReplaceAll, size_t kSize>
+  void ExpectReplacesForAll(const std::array<ReplaceCase, kSize>& cases) {
+    for (const auto& test_case : cases) {
+      SCOPED_TRACE(test_case.str);
+      ExpectReplaces<CharASCII, kReplaceAll>(test_case);
+      ExpectReplaces<CharUTF8, kReplaceAll>(test_case);
+      ExpectReplaces<CharUTF16, kReplaceAll>(test_case);
+      ExpectReplaces<CharUTF32, kReplaceAll>(test_case);
+    }
+  }
+
+  // Replaces every instance with a plain left-to-right find() loop.
+  template <CharTraits Char>
+  auto ReplaceAllNaive(
+    std::basic_string_view<Char> str,
+    std::basic_string_view<Char> find_this,
+    std::basic_string_view<Char> replace_with) -> std::basic_string<Char> {
+    std::basic_string<Char> result;
+    size_t pos = 0;
+    for (size_t match = str.find(find_this); match != str.npos;
+         match        = str.find(find_this, pos)) {
+      result.append(str.substr(pos, match - pos));
+      result.append(replace_with);
+      pos = match + find_this.size();
+    }
+    result.append(str.substr(pos));
+    return result;
+  }
+
+  template <CharTraits Char>
+  void ExpectMatchesNaive() {
+    std::mt19937 engine(20231018);
+    for (const size_t needle_length : {1U, 2U, 3U, 5U, 17U, 40U}) {
+      for (const size_t length :
+           {0U, 1U, 15U, 16U, 33U, 64U, 100U, 257U, 1000U}) {
+        const std::basic_string<Char> str =
+          RandomSmallAlphabetString<Char>(engine, length);
+        // A needle taken from the string, to be sure it matches at least once.
+        std::basic_string<Char> find_this =
+          RandomSmallAlphabetString<Char>(engine, needle_length);
+        if (length >= needle_length) {
+          find_this = str.substr(length - needle_length);
+        }
+        for (const size_t replace_length :
+             {size_t{0}, size_t{1}, needle_length, size_t{50}}) {
+          const std::basic_string<Char> replace_with =
+            RandomSmallAlphabetString<Char>(engine, replace_length);
+          std::basic_string<Char> actual = str;
+          ReplaceSubstringsAfterOffset(actual, 0, find_this, replace_with);
+          ExpectSameString<Char>(
+            ReplaceAllNaive<Char>(str, find_this, replace_with),
+            actual);
+        }
+      }
+    }
+  }
+}    // namespace
+
+TEST(StringUtilTest, ReplaceSubstringsAfterOffset) {
+  constexpr std::array<ReplaceCase, 22> kCases = {{
+    {"aaa", 0, "", "b", "aaa"},
+    {"aaa", 1, "", "b", "aaa"},
+    {"aaa", 0, "a", "b", "bbb"},
+    {"aaa", 0, "aa", "b", "ba"},
+    {"aaa", 0, "aa", "bbb", "bbba"},
+    {"aaaaa", 0, "aa", "b", "bba"},
+    {"ababaaababa", 0, "aba", "", "baaba"},
+    {"ababaaababa", 0, "aba", "_", "_baa_ba"},
+    {"ababaaababa", 0, "aba", "__", "__baa__ba"},
+    {"ababaaababa", 0, "aba", "___", "___baa___ba"},
+    {"ababaaababa", 0, "aba", "____", "____baa____ba"},
+    {"ababaaababa", 0, "aba", "_____", "_____baa_____ba"},
+    {"abb", 0, "ab", "a", "ab"},
+    {"Removing some substrings inging", 0, "ing", "", "Remov some substrs "},
+    {"Not found", 0, "x", "0", "Not found"},
+    {"Not found again", 5, "x", "1", "Not found again"},
+    {" Making it much longer ",
+     0,
+     " ",
+     "Four score and seven years ago",
+     "Four score and seven years agoMakingFour score and seven years agoit"
+     "Four score and seven years agomuchFour score and seven years agolonger"
+     "Four score and seven years ago"},
+    {"Invalid offset", 9999, "t", "foobar", "Invalid offset"},
+    {"Replace me only me once", 9, "me ", "", "Replace me only once"},
+    {"abababab", 2, "ab", "c", "abccc"},
+    {"abababab", 1, "ab", "c", "abccc"},
+    {"abababab", 1, "aba", "c", "abcbab"},
+  }};
+  ExpectReplacesForAll</*kReplaceAll=*/true>(kCases);
+}
+
+TEST(StringUtilTest, ReplaceFirstSubstringAfterOffset) {
+  constexpr std::array<ReplaceCase, 12> kCases = {{
+    {"aaa", 0, "a", "b", "baa"},
+    {"aaa", 0, "", "b", "aaa"},
+    {"abb", 0, "ab", "a", "ab"},
+    {"Removing some substrings inging",
+     0,
+     "ing",
+     "",
+     "Remov some substrings inging"},
+    {"Not found", 0, "x", "0", "Not found"},
+    {"Not found again", 5, "x", "1", "Not found again"},
+    {" Making it much longer ",
+     0,
+     " ",
+     "Four score and seven years ago",
+     "Four score and seven years agoMaking it much longer "},
+    {"Invalid offset", 9999, "t", "foobar", "Invalid offset"},
+    {"Replace me only me once", 4, "me ", "", "Replace only me once"},
+    {"abababab", 2, "ab", "c", "abcabab"},
+    {"abababab", 1, "ab", "c", "abcabab"},
+    {"abababab", 8, "ab", "c", "abababab"},
+  }};
+  ExpectReplacesForAll</*kReplaceAll=*/false>(kCases);
+}
+
+TEST(StringUtilTest, ReplaceSubstringsAfterOffsetMatchesNaive) {
+  ExpectMatchesNaive<CharASCII>();
+  ExpectMatchesNaive<CharUTF8>();
+  ExpectMatchesNaive<CharUTF16>();
+  ExpectMatchesNaive<CharUTF32>();
+}
+
+// NOLINTEND(*-magic-numbers)
+}    // namespace longlp::base
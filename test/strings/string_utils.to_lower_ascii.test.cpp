@@ -4,11 +4,12 @@
 
 #include <base/strings/string_utils.h>
 
-#include <array>
+#include <string>
 
 #include <base/strings/typedefs.h>
 #include <gtest/gtest.h>
 
+#include "test_utils/ascii_case.h"
 #include "test_utils/gtest_fix_u8string_comparison.h"
 
 namespace longlp::base {
@@ -57,4 +58,11 @@ TEST(StringUtilTest, ToLowerASCII) {
     LONGLP_LITERAL_UTF32('\x00c4'),
     ToLowerASCII(LONGLP_LITERAL_UTF8('\x00c4')));
 }
+
+TEST(StringUtilTest, ToLowerASCIIOverloadsMatchPerCharacter) {
+  ExpectASCIICaseConversionMatchesPerCharacter<false, CharASCII>();
+  ExpectASCIICaseConversionMatchesPerCharacter<false, CharUTF8>();
+  ExpectASCIICaseConversionMatchesPerCharacter<false, CharUTF16>();
+  ExpectASCIICaseConversionMatchesPerCharacter<false, CharUTF32>();
+}
 }    // namespace longlp::base
@@ -4,15 +4,15 @@
 
 #include <base/strings/string_utils.h>
 
-#include <array>
+#include <string>
 
 #include <base/strings/typedefs.h>
 #include <gtest/gtest.h>
 
+#include "test_utils/ascii_case.h"
 #include "test_utils/gtest_fix_u8string_comparison.h"
 
 namespace longlp::base {
-
 TEST(StringUtilTest, ToUpperASCII) {
   EXPECT_EQ(LONGLP_LITERAL_ASCII('C'), ToUpperASCII(LONGLP_LITERAL_ASCII('C')));
   EXPECT_EQ(LONGLP_LITERAL_ASCII('C'), ToUpperASCII(LONGLP_LITERAL_ASCII('c')));
@@ -58,4 +58,11 @@ TEST(StringUtilTest, ToUpperASCII) {
     LONGLP_LITERAL_UTF32('\x00c4'),
     ToUpperASCII(LONGLP_LITERAL_UTF32('\x00c4')));
 }
+
+TEST(StringUtilTest, ToUpperASCIIOverloadsMatchPerCharacter) {
+  ExpectASCIICaseConversionMatchesPerCharacter<true, CharASCII>();
+  ExpectASCIICaseConversionMatchesPerCharacter<true, CharUTF8>();
+  ExpectASCIICaseConversionMatchesPerCharacter<true, CharUTF16>();
+  ExpectASCIICaseConversionMatchesPerCharacter<true, CharUTF32>();
+}
 }    // namespace longlp::base
@@ -0,0 +1,75 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <base/strings/utf8_position_index.h>
+
+#include <array>
+#include <bit>
+#include <random>
+#include <vector>
+
+#include <base/icu/utf.h>
+#include <base/strings/typedefs.h>
+#include <base/strings/utf_string_conversion_utils.h>
+#include <gtest/gtest.h>
+
+namespace longlp::base {
+namespace {
+  // ASCII runs, multi-byte code points and ill-formed sequences.
+  auto RandomText(std::mt19937& engine, size_t fragments) -> StringUTF8 {
+    constexpr std::array<StringViewUTF8, 7> kFragments = {
+      LONGLP_LITERAL_UTF8("plain ascii text"),
+      LONGLP_LITERAL_UTF8("a"),
+      LONGLP_LITERAL_UTF8("\xC3\xA9"),
+      LONGLP_LITERAL_UTF8("\xE4\xBD\xA0\xE5\xA5\xBD"),
+      LONGLP_LITERAL_UTF8("\xF0\x9F\x98\x80"),
+      LONGLP_LITERAL_UTF8("\xE4\xBD"),
+      LONGLP_LITERAL_UTF8("\x80\xFF")};
+    std::uniform_int_distribution<size_t> pick(0, kFragments.size() - 1);
+    StringUTF8 text;
+    for (size_t i = 0; i < fragments; ++i) {
+      text += kFragments[pick(engine)];
+    }
+    return text;
+  }
+}    // namespace
+
+TEST(UTF8PositionIndexTest, Empty) {
+  const UTF8PositionIndex index(StringViewUTF8{});
+  EXPECT_EQ(0U, index.size());
+  EXPECT_EQ(0U, index.OffsetOf(0));
+  EXPECT_EQ(StringViewUTF8::npos, index.OffsetOf(1));
+}
+
+TEST(UTF8PositionIndexTest, MatchesSequentialDecoding) {
+  std::mt19937 engine(20230911);    // NOLINT(*-magic-numbers)
+  const auto text = RandomText(engine, 500);
+
+  std::vector<size_t> offsets;
+  std::vector<icu::CodePoint> code_points;
+  for (int32_t i = 0; i < static_cast<int32_t>(text.size());) {
+    offsets.push_back(static_cast<size_t>(i));
+    icu::CodePoint code_point;
+    icu::internal::U8Next(
+      std::bit_cast<const uint8_t*>(text.data()),
+      i,
+      static_cast<int32_t>(text.size()),
+      *code_point);
+    code_points.push_back(
+      IsValidCodepoint(code_point) ? code_point : icu::CodePoint(0xFFFD));
+  }
+  ASSERT_EQ(offsets.size(), CountCodePoints(text));
+
+  for (size_t stride : {1U, 3U, 64U, 100000U}) {
+    const UTF8PositionIndex index(text, stride);
+    ASSERT_EQ(offsets.size(), index.size());
+    for (size_t i = 0; i < offsets.size(); ++i) {
+      EXPECT_EQ(offsets[i], index.OffsetOf(i));
+      EXPECT_EQ(code_points[i], index.CodePointAt(i));
+    }
+    EXPECT_EQ(text.size(), index.OffsetOf(offsets.size()));
+    EXPECT_EQ(StringViewUTF8::npos, index.OffsetOf(offsets.size() + 1));
+  }
+}
+}    // namespace longlp::base
@@ -0,0 +1,70 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <base/strings/utf_literals.h>
+
+#include <base/strings/typedefs.h>
+#include <base/strings/utf_string_conversion.h>
+#include <gtest/gtest.h>
+
+#include "test_utils/gtest_fix_u8string_comparison.h"
+
+namespace longlp::base {
+namespace {
+  // Everything below is checked by the compiler.
+  static_assert(
+    LONGLP_UTF16_FROM_UTF8("caf\xC3\xA9") == LONGLP_LITERAL_UTF16("caf\x00E9"));
+  static_assert(
+    LONGLP_UTF32_FROM_UTF8("\xF0\x9F\x98\x80!") ==
+    LONGLP_LITERAL_UTF32("\x1F600!"));
+  static_assert(
+    LONGLP_UTF8_FROM_UTF16("\xD83D\xDE00") ==
+    LONGLP_LITERAL_UTF8("\xF0\x9F\x98\x80"));
+  static_assert(
+    LONGLP_UTF32_FROM_UTF16("a\xD83D\xDE00") ==
+    LONGLP_LITERAL_UTF32("a\x1F600"));
+  static_assert(
+    LONGLP_UTF8_FROM_UTF32("\x20AC") == LONGLP_LITERAL_UTF8("\xE2\x82\xAC"));
+  static_assert(
+    LONGLP_UTF16_FROM_UTF32("\x10FFFF") ==
+    LONGLP_LITERAL_UTF16("\xDBFF\xDFFF"));
+
+  static_assert(LONGLP_UTF16_FROM_UTF8("").empty());
+  // Embedded NULs are kept, and the result is NUL-terminated.
+  static_assert(LONGLP_UTF16_FROM_UTF8("a\0b").size() == 3);
+  static_assert(LONGLP_UTF16_FROM_UTF8("ab").data()[2] == u'\0');
+
+  // The same literal shares its storage.
+  static_assert(
+    LONGLP_UTF16_FROM_UTF8("shared").data() ==
+    LONGLP_UTF16_FROM_UTF8("shared").data());
+
+  // Ill-formed input, e.g. LONGLP_UTF16_FROM_UTF8("\xC3"), the overlong
+  // "\xC0\x80" or the lone surrogate LONGLP_UTF8_FROM_UTF16("\xD800"), does
+  // not compile.
+}    // namespace
+
+TEST(UTFLiteralsTest, MatchesRuntimeConversion) {
+  constexpr StringViewUTF8 kUTF8 = LONGLP_LITERAL_UTF8(
+    "ASCII, \xC3\xA9, \xE4\xBD\xA0\xE5\xA5\xBD, \xF0\x9F\x98\x80");
+
+  StringUTF16 utf16;
+  ASSERT_TRUE(UTF8ToUTF16(kUTF8, utf16));
+  EXPECT_EQ(
+    utf16,
+    LONGLP_UTF16_FROM_UTF8(
+      "ASCII, \xC3\xA9, \xE4\xBD\xA0\xE5\xA5\xBD, \xF0\x9F\x98\x80"));
+
+  StringUTF32 utf32;
+  ASSERT_TRUE(UTF8ToUTF32(kUTF8, utf32));
+  EXPECT_EQ(
+    utf32,
+    LONGLP_UTF32_FROM_UTF8(
+      "ASCII, \xC3\xA9, \xE4\xBD\xA0\xE5\xA5\xBD, \xF0\x9F\x98\x80"));
+
+  ExpectEQ(
+    kUTF8,
+    LONGLP_UTF8_FROM_UTF32("ASCII, \x00E9, \x4F60\x597D, \x1F600"));
+}
+}    // namespace longlp::base
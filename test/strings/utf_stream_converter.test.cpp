@@ -0,0 +1,144 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <base/strings/utf_stream_converter.h>
+
+#include <array>
+#include <random>
+#include <vector>
+
+#include <base/strings/typedefs.h>
+#include <base/strings/utf_string_conversion.h>
+#include <gtest/gtest.h>
+
+#include "test_utils/gtest_fix_u8string_comparison.h"
+
+namespace longlp::base {
+namespace {
+  // Feeds |input| split at |splits| and returns the concatenated output.
+  template <typename SrcChar, typename DestChar>
+  auto ConvertInChunks(
+    std::basic_string_view<SrcChar> input,
+    const std::vector<size_t>& splits,
+    bool& success) -> std::basic_string<DestChar> {
+    UTFStreamConverter<SrcChar, DestChar> converter;
+    std::basic_string<DestChar> output;
+    success      = true;
+    size_t begin = 0;
+    for (size_t end : splits) {
+      success = converter.Convert(input.substr(begin, end - begin), output) &&
+                success;
+      begin = end;
+    }
+    success = converter.Convert(input.substr(begin), output) && success;
+    success = converter.Finish(output) && success;
+    EXPECT_FALSE(converter.has_pending());
+    return output;
+  }
+}    // namespace
+
+TEST(UTFStreamConverterTest, HoldsSplitCodePoint) {
+  UTFStreamConverter<CharUTF8, CharUTF16> converter;
+  StringUTF16 output;
+
+  EXPECT_TRUE(converter.Convert(LONGLP_LITERAL_UTF8("a\xF0"), output));
+  EXPECT_TRUE(converter.has_pending());
+  EXPECT_TRUE(converter.Convert(LONGLP_LITERAL_UTF8("\x9F"), output));
+  EXPECT_TRUE(converter.Convert(LONGLP_LITERAL_UTF8(""), output));
+  EXPECT_TRUE(converter.Convert(LONGLP_LITERAL_UTF8("\x98"), output));
+  EXPECT_EQ(LONGLP_LITERAL_UTF16("a"), output);
+  EXPECT_TRUE(converter.Convert(LONGLP_LITERAL_UTF8("\x80z"), output));
+  EXPECT_FALSE(converter.has_pending());
+  EXPECT_EQ(LONGLP_LITERAL_UTF16("a\xd83d\xde00z"), output);
+  EXPECT_TRUE(converter.Finish(output));
+
+  // A sequence that cannot be completed is replaced as soon as that is known.
+  output.clear();
+  EXPECT_TRUE(converter.Convert(LONGLP_LITERAL_UTF8("\xE4\xBD"), output));
+  EXPECT_FALSE(converter.Convert(LONGLP_LITERAL_UTF8("z"), output));
+  EXPECT_EQ(LONGLP_LITERAL_UTF16("\xfffdz"), output);
+
+  // The end of the stream replaces what is pending.
+  output.clear();
+  EXPECT_TRUE(converter.Convert(LONGLP_LITERAL_UTF8("\xE4\xBD"), output));
+  EXPECT_FALSE(converter.Finish(output));
+  EXPECT_EQ(LONGLP_LITERAL_UTF16("\xfffd"), output);
+  EXPECT_FALSE(converter.has_pending());
+}
+
+TEST(UTFStreamConverterTest, HoldsSplitSurrogatePair) {
+  UTFStreamConverter<CharUTF16, CharUTF8> converter;
+  StringUTF8 output;
+
+  EXPECT_TRUE(converter.Convert(LONGLP_LITERAL_UTF16("a\xd83d"), output));
+  EXPECT_TRUE(converter.has_pending());
+  EXPECT_TRUE(converter.Convert(LONGLP_LITERAL_UTF16("\xde00"), output));
+  ExpectEQ(LONGLP_LITERAL_UTF8("a\xF0\x9F\x98\x80"), output);
+
+  EXPECT_TRUE(converter.Convert(LONGLP_LITERAL_UTF16("\xd83d"), output));
+  EXPECT_FALSE(converter.Convert(LONGLP_LITERAL_UTF16("\xd83d"), output));
+  EXPECT_FALSE(converter.Finish(output));
+  ExpectEQ(
+    LONGLP_LITERAL_UTF8("a\xF0\x9F\x98\x80\xEF\xBF\xBD\xEF\xBF\xBD"),
+    output);
+}
+
+TEST(UTFStreamConverterTest, MatchesWholeConversion) {
+  static constexpr std::array<StringViewUTF8, 12> kFragments = {
+    LONGLP_LITERAL_UTF8("a"),
+    LONGLP_LITERAL_UTF8("Hello, world. "),
+    LONGLP_LITERAL_UTF8("é"),
+    LONGLP_LITERAL_UTF8("你好"),
+    LONGLP_LITERAL_UTF8("\U0001F600"),
+    LONGLP_LITERAL_UTF8("\xC0\x80"),
+    LONGLP_LITERAL_UTF8("\xE0\x9F\xBF"),
+    LONGLP_LITERAL_UTF8("\xF4\x90\x80\x80"),
+    LONGLP_LITERAL_UTF8("\x80"),
+    LONGLP_LITERAL_UTF8("\xE4\xBD"),
+    LONGLP_LITERAL_UTF8("\xF0\x9F\x98"),
+    LONGLP_LITERAL_UTF8("\xFF"),
+  };
+  std::mt19937 engine(20230907);    // NOLINT(*-magic-numbers)
+  std::uniform_int_distribution<size_t> pick(0, kFragments.size() - 1);
+
+  for (size_t round = 0; round < 500; ++round) {
+    StringUTF8 utf8;
+    for (size_t i = 0; i < round % 40; ++i) {
+      utf8 += kFragments[pick(engine)];
+    }
+    StringUTF16 utf16;
+    const bool utf8_valid = UTF8ToUTF16(utf8, utf16);
+    StringUTF32 utf32;
+    UTF8ToUTF32(utf8, utf32);
+    StringUTF8 utf8_from_utf16;
+    const bool utf16_valid = UTF16ToUTF8(utf16, utf8_from_utf16);
+
+    // Chunks of 0 to 4 code units cut every code point in every way.
+    std::uniform_int_distribution<size_t> step(0, 4);
+    std::vector<size_t> splits;
+    for (size_t end = step(engine); end < utf8.size(); end += step(engine)) {
+      splits.push_back(end);
+    }
+
+    bool success = false;
+    EXPECT_EQ(
+      utf16,
+      (ConvertInChunks<CharUTF8, CharUTF16>(utf8, splits, success)));
+    EXPECT_EQ(utf8_valid, success);
+    EXPECT_EQ(
+      utf32,
+      (ConvertInChunks<CharUTF8, CharUTF32>(utf8, splits, success)));
+    EXPECT_EQ(utf8_valid, success);
+
+    std::erase_if(splits, [&](size_t end) { return end > utf16.size(); });
+    ExpectEQ(
+      utf8_from_utf16,
+      ConvertInChunks<CharUTF16, CharUTF8>(utf16, splits, success));
+    EXPECT_EQ(utf16_valid, success);
+    EXPECT_EQ(
+      utf32,
+      (ConvertInChunks<CharUTF16, CharUTF32>(utf16, splits, success)));
+  }
+}
+}    // namespace longlp::base
@@ -0,0 +1,1088 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#include <base/strings/utf_string_conversion.h>
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <base/icu/utf.h>
+#include <base/strings/typedefs.h>
+#include <base/strings/utf_string_conversion_utils.h>
+#include <gtest/gtest.h>
+
+#include "test_utils/gtest_fix_u8string_comparison.h"
+
+namespace longlp::base {
+namespace {
+  // Straightforward decoder, used as the reference for the vectorized paths.
+  auto ReferenceUTF8ToUTF16(StringViewUTF8 src, StringUTF16& output) -> bool {
+    bool success = true;
+    output.clear();
+    const auto length = static_cast<int32_t>(src.size());
+    for (int32_t i = 0; i < length;) {
+      icu::CodePoint code_point;
+      icu::internal::U8Next(
+        std::bit_cast<const uint8_t*>(src.data()),
+        i,
+        length,
+        *code_point);
+      if (!IsValidCodepoint(code_point)) {
+        success    = false;
+        code_point = icu::CodePoint(0xFFFD);
+      }
+      AppendUnicodeCharacter(code_point, output);
+    }
+    return success;
+  }
+
+  // Builds random text out of fragments of every UTF-8 length, plus malformed
+  // sequences, so that the kernels see every kind of window.
+  auto RandomUTF8(std::mt19937& engine, size_t fragments) -> StringUTF8 {
+    static constexpr std::array<StringViewUTF8, 14> kFragments = {
+      LONGLP_LITERAL_UTF8("a"),
+      LONGLP_LITERAL_UTF8("Hello, world. "),
+      LONGLP_LITERAL_UTF8("é"),
+      LONGLP_LITERAL_UTF8("да"),
+      LONGLP_LITERAL_UTF8("你好"),
+      LONGLP_LITERAL_UTF8("\xEF\xBF\xBF"),
+      LONGLP_LITERAL_UTF8("\U0001F600"),
+      LONGLP_LITERAL_UTF8("\xC0\x80"),            // Overlong NUL.
+      LONGLP_LITERAL_UTF8("\xE0\x9F\xBF"),        // Overlong U+07FF.
+      LONGLP_LITERAL_UTF8("\xED\xA0\x80"),        // Surrogate U+D800.
+      LONGLP_LITERAL_UTF8("\xF4\x90\x80\x80"),    // Above U+10FFFF.
+      LONGLP_LITERAL_UTF8("\x80"),                // Lone continuation byte.
+      LONGLP_LITERAL_UTF8("\xE4\xBD"),            // Truncated sequence.
+      LONGLP_LITERAL_UTF8("\xFF"),
+    };
+    std::uniform_int_distribution<size_t> pick(0, kFragments.size() - 1);
+    StringUTF8 result;
+    for (size_t i = 0; i < fragments; ++i) {
+      result += kFragments[pick(engine)];
+    }
+    return result;
+  }
+
+  // Straightforward encoder, used as the reference for the vectorized paths.
+  auto ReferenceUTF16ToUTF8(StringViewUTF16 src, StringUTF8& output) -> bool {
+    bool success = true;
+    output.clear();
+    for (size_t i = 0; i < src.size(); ++i) {
+      icu::CodePoint code_point(src[i]);
+      if (icu::internal::U16IsLead(src[i]) && i + 1 < src.size() &&
+          icu::internal::U16IsTrail(src[i + 1])) {
+        *code_point = icu::internal::U16GetSupplementary(src[i], src[i + 1]);
+        ++i;
+      }
+      if (!IsValidCodepoint(code_point)) {
+        success    = false;
+        code_point = icu::CodePoint(0xFFFD);
+      }
+      AppendUnicodeCharacter(code_point, output);
+    }
+    return success;
+  }
+
+  auto RandomUTF16(std::mt19937& engine, size_t fragments) -> StringUTF16 {
+    static constexpr std::array<StringViewUTF16, 10> kFragments = {
+      LONGLP_LITERAL_UTF16("a"),
+      LONGLP_LITERAL_UTF16("Hello, world. "),
+      LONGLP_LITERAL_UTF16("\x00e9"),
+      LONGLP_LITERAL_UTF16("\x0434\x0430"),
+      LONGLP_LITERAL_UTF16("\x4f60\x597d"),
+      LONGLP_LITERAL_UTF16("\xffff"),
+      LONGLP_LITERAL_UTF16("\xd83d\xde00"),
+      LONGLP_LITERAL_UTF16("\xd83d\xde00\xd83d\xde01\xd83d\xde02\xd83d\xde03"),
+      LONGLP_LITERAL_UTF16("\xd800"),    // Lone lead surrogate.
+      LONGLP_LITERAL_UTF16("\xdc00"),    // Lone trail surrogate.
+    };
+    std::uniform_int_distribution<size_t> pick(0, kFragments.size() - 1);
+    StringUTF16 result;
+    for (size_t i = 0; i < fragments; ++i) {
+      result += kFragments[pick(engine)];
+    }
+    return result;
+  }
+
+  // Random code points of every UTF-8 length, in runs so that whole vector
+  // blocks share a length, with a few values that are not scalar values.
+  auto RandomUTF32(std::mt19937& engine, size_t runs) -> StringUTF32 {
+    static constexpr std::array<std::pair<CharUTF32, CharUTF32>, 7> kRanges = {
+      {
+       {0x0, 0x7F},
+       {0x80, 0x7FF},
+       {0x800, 0xD7FF},
+       {0xE000, 0xFFFF},
+       {0x10000, 0x10FFFF},
+       {0xD800, 0xDFFF},          // Surrogates.
+        {0x110000, 0xFFFFFFFF},    // Above U+10FFFF.
+      }
+    };
+    std::uniform_int_distribution<size_t> pick_range(0, kRanges.size() - 1);
+    std::uniform_int_distribution<size_t> pick_length(1, 20);
+    StringUTF32 result;
+    for (size_t run = 0; run < runs; ++run) {
+      // Invalid code points are rare in real text.
+      size_t range = pick_range(engine);
+      if (range >= 5 && pick_range(engine) != 0) {
+        range = 0;
+      }
+      std::uniform_int_distribution<CharUTF32> pick(
+        kRanges[range].first,
+        kRanges[range].second);
+      for (size_t length = pick_length(engine); length > 0; --length) {
+        result.push_back(pick(engine));
+      }
+    }
+    return result;
+  }
+
+  template <typename String>
+  auto ReferenceFromUTF32(StringViewUTF32 src, String& output) -> bool {
+    bool success = true;
+    output.clear();
+    for (CharUTF32 character : src) {
+      icu::CodePoint code_point(static_cast<UChar32>(character));
+      if (!IsValidCodepoint(code_point)) {
+        success    = false;
+        code_point = icu::CodePoint(0xFFFD);
+      }
+      AppendUnicodeCharacter(code_point, output);
+    }
+    return success;
+  }
+}    // namespace
+
+TEST(UTFStringConversionTest, ConvertUTF8ToUTF16) {
+  struct TestData {
+    StringViewUTF8 utf8;
+    StringViewUTF16 utf16;
+    bool success;
+  };
+
+  const std::array<TestData, 9> kCases = {
+    {
+     // Regular UTF-8 input.
+      {LONGLP_LITERAL_UTF8("\xe4\xbd\xa0\xe5\xa5\xbd"),
+       LONGLP_LITERAL_UTF16("\x4f60\x597d"),
+       true},
+     // Non-character is passed through.
+      {LONGLP_LITERAL_UTF8("\xef\xbf\xbfHello"),
+       LONGLP_LITERAL_UTF16("\xffffHello"),
+       true},
+     // Truncated UTF-8 sequence.
+      {LONGLP_LITERAL_UTF8("\xe4\xa0\xe5\xa5\xbd"),
+       LONGLP_LITERAL_UTF16("\xfffd\x597d"),
+       false},
+     // Truncated off the end.
+      {LONGLP_LITERAL_UTF8("\xe5\xa5\xbd\xe4\xa0"),
+       LONGLP_LITERAL_UTF16("\x597d\xfffd"),
+       false},
+     // Non-shortest-form UTF-8.
+      {LONGLP_LITERAL_UTF8("\xf0\x84\xbd\xa0\xe5\xa5\xbd"),
+       LONGLP_LITERAL_UTF16("\xfffd\xfffd\xfffd\xfffd\x597d"),
+       false},
+     // This UTF-8 character decodes to a UTF-16 surrogate, which is illegal.
+      {LONGLP_LITERAL_UTF8("\xed\xb0\x80"),
+       LONGLP_LITERAL_UTF16("\xfffd\xfffd\xfffd"),
+       false},
+     // Non-BMP characters. The second is a non-character regarded as valid.
+      {LONGLP_LITERAL_UTF8("A\xF0\x90\x8C\x80z"),
+       LONGLP_LITERAL_UTF16("A\xd800\xdf00z"),
+       true},
+      {LONGLP_LITERAL_UTF8("A\xF4\x8F\xBF\xBEz"),
+       LONGLP_LITERAL_UTF16("A\xdbff\xdffez"),
+       true},
+     // Long enough to go through the vector kernels.
+      {LONGLP_LITERAL_UTF8("The quick brown fox \xc3\xa9\xc3\xa8 \xe4\xbd\xa0"
+                          "\xe5\xa5\xbd jumps over the lazy dog \xed\xa0\x80"),
+       LONGLP_LITERAL_UTF16("The quick brown fox \x00e9\x00e8 \x4f60\x597d jumps "
+                           "over the lazy dog \xfffd\xfffd\xfffd"),
+       false},
+     }
+  };
+
+  for (const auto& test_case : kCases) {
+    StringUTF16 converted;
+    EXPECT_EQ(test_case.success, UTF8ToUTF16(test_case.utf8, converted));
+    EXPECT_EQ(test_case.utf16, converted);
+  }
+}
+
+TEST(UTFStringConversionTest, ConvertUTF8ToUTF16MatchesScalarDecoder) {
+  std::mt19937 engine(20230901);    // NOLINT(*-magic-numbers)
+  for (size_t fragments = 0; fragments < 200; ++fragments) {
+    const auto input = RandomUTF8(engine, fragments);
+
+    StringUTF16 expected;
+    const bool expected_success = ReferenceUTF8ToUTF16(input, expected);
+
+    StringUTF16 converted;
+    EXPECT_EQ(expected_success, UTF8ToUTF16(input, converted));
+    EXPECT_EQ(expected, converted);
+  }
+}
+
+// The output is sized by a pre-pass which measures long inputs in chunks.
+TEST(UTFStringConversionTest, ConvertLongUTF8MatchesScalarDecoder) {
+  std::mt19937 engine(20230905);    // NOLINT(*-magic-numbers)
+  for (size_t round = 0; round < 20; ++round) {
+    const auto input = RandomUTF8(engine, 2000);
+
+    StringUTF16 expected;
+    const bool expected_success = ReferenceUTF8ToUTF16(input, expected);
+
+    StringUTF16 converted;
+    EXPECT_EQ(expected_success, UTF8ToUTF16(input, converted));
+    EXPECT_EQ(expected, converted);
+
+    StringUTF32 converted32;
+    EXPECT_EQ(expected_success, UTF8ToUTF32(input, converted32));
+    StringUTF32 from_utf16;
+    EXPECT_TRUE(UTF16ToUTF32(expected, from_utf16));
+    EXPECT_EQ(from_utf16, converted32);
+  }
+}
+
+TEST(UTFStringConversionTest, ConvertUTF16ToUTF8) {
+  struct TestData {
+    StringViewUTF16 utf16;
+    StringViewUTF8 utf8;
+    bool success;
+  };
+
+  const std::array<TestData, 7> kCases = {
+    {
+     // Regular UTF-16 input.
+      {LONGLP_LITERAL_UTF16("\x4f60\x597d"),
+       LONGLP_LITERAL_UTF8("\xe4\xbd\xa0\xe5\xa5\xbd"),
+       true},
+     // Test a non-BMP character.
+      {LONGLP_LITERAL_UTF16("\xd800\xdf00"),
+       LONGLP_LITERAL_UTF8("\xF0\x90\x8C\x80"),
+       true},
+     // Non-characters are passed through.
+      {LONGLP_LITERAL_UTF16("\xffffHello"),
+       LONGLP_LITERAL_UTF8("\xEF\xBF\xBFHello"),
+       true},
+      {LONGLP_LITERAL_UTF16("\xdbff\xdffeHello"),
+       LONGLP_LITERAL_UTF8("\xF4\x8F\xBF\xBEHello"),
+       true},
+     // The first character is a truncated UTF-16 character.
+      {LONGLP_LITERAL_UTF16("\xd800\x597d"),
+       LONGLP_LITERAL_UTF8("\xef\xbf\xbd\xe5\xa5\xbd"),
+       false},
+     // Truncated at the end.
+      {LONGLP_LITERAL_UTF16("\x597d\xd800"),
+       LONGLP_LITERAL_UTF8("\xe5\xa5\xbd\xef\xbf\xbd"),
+       false},
+     // Long enough to go through the vector kernels.
+      {LONGLP_LITERAL_UTF16("The quick brown fox \x00e9\x00e8 \x4f60\x597d "
+                            "\xd83d\xde00\xd83d\xde01\xd83d\xde02\xd83d\xde03"
+                            " jumps over \xdc00 the lazy dog"),
+       LONGLP_LITERAL_UTF8("The quick brown fox \xc3\xa9\xc3\xa8 \xe4\xbd\xa0"
+                           "\xe5\xa5\xbd \xf0\x9f\x98\x80\xf0\x9f\x98\x81"
+                           "\xf0\x9f\x98\x82\xf0\x9f\x98\x83 jumps over "
+                           "\xef\xbf\xbd the lazy dog"),
+       false},
+     }
+  };
+
+  for (const auto& test_case : kCases) {
+    StringUTF8 converted;
+    EXPECT_EQ(test_case.success, UTF16ToUTF8(test_case.utf16, converted));
+    ExpectEQ(test_case.utf8, converted);
+  }
+}
+
+TEST(UTFStringConversionTest, ConvertUTF16ToUTF8MatchesScalarEncoder) {
+  std::mt19937 engine(20230902);    // NOLINT(*-magic-numbers)
+  for (size_t fragments = 0; fragments < 200; ++fragments) {
+    const auto input = RandomUTF16(engine, fragments);
+
+    StringUTF8 expected;
+    const bool expected_success = ReferenceUTF16ToUTF8(input, expected);
+
+    StringUTF8 converted;
+    EXPECT_EQ(expected_success, UTF16ToUTF8(input, converted));
+    ExpectEQ(expected, converted);
+  }
+}
+
+TEST(UTFStringConversionTest, ConvertUTF32ToUTF8) {
+  struct TestData {
+    StringViewUTF32 utf32;
+    StringViewUTF8 utf8;
+    bool success;
+  };
+
+  const std::array<TestData, 8> kCases = {
+    {
+     // Regular 16-bit input.
+      {LONGLP_LITERAL_UTF32("\x4f60\x597d"),
+       LONGLP_LITERAL_UTF8("\xe4\xbd\xa0\xe5\xa5\xbd"),
+       true},
+     // Test a non-BMP character.
+      {LONGLP_LITERAL_UTF32("A\x10300z"),
+       LONGLP_LITERAL_UTF8("A\xF0\x90\x8C\x80z"),
+       true},
+     // Non-characters are passed through.
+      {LONGLP_LITERAL_UTF32("\xffffHello"),
+       LONGLP_LITERAL_UTF8("\xEF\xBF\xBFHello"),
+       true},
+      {LONGLP_LITERAL_UTF32("\x10fffeHello"),
+       LONGLP_LITERAL_UTF8("\xF4\x8F\xBF\xBEHello"),
+       true},
+     // Invalid Unicode code points.
+      {LONGLP_LITERAL_UTF32("\xfffffffHello"),
+       LONGLP_LITERAL_UTF8("\xEF\xBF\xBDHello"),
+       false},
+      {LONGLP_LITERAL_UTF32("\x110000Hello"),
+       LONGLP_LITERAL_UTF8("\xEF\xBF\xBDHello"),
+       false},
+     // The first character is a truncated UTF-16 character.
+      {LONGLP_LITERAL_UTF32("\xd800\x597d"),
+       LONGLP_LITERAL_UTF8("\xef\xbf\xbd\xe5\xa5\xbd"),
+       false},
+     // Long enough to go through the vector kernels.
+      {LONGLP_LITERAL_UTF32("The quick brown fox \x00e9\x00e8 \x4f60\x597d "
+                            "\x1f600\x1f601\x1f602\x1f603 jumps over "
+                            "\xdc00 the lazy dog"),
+       LONGLP_LITERAL_UTF8("The quick brown fox \xc3\xa9\xc3\xa8 \xe4\xbd\xa0"
+                           "\xe5\xa5\xbd \xf0\x9f\x98\x80\xf0\x9f\x98\x81"
+                           "\xf0\x9f\x98\x82\xf0\x9f\x98\x83 jumps over "
+                           "\xef\xbf\xbd the lazy dog"),
+       false},
+     }
+  };
+
+  for (const auto& test_case : kCases) {
+    StringUTF8 converted;
+    EXPECT_EQ(test_case.success, UTF32ToUTF8(test_case.utf32, converted));
+    ExpectEQ(test_case.utf8, converted);
+  }
+}
+
+TEST(UTFStringConversionTest, ConvertUTF32ToUTF16) {
+  constexpr StringViewUTF32 kMixed =
+    LONGLP_LITERAL_UTF32("A\x10300z\xd800\x4f60\x1f600\x1f601\x1f602"
+                         "\x1f603\x110000 and some ASCII text");
+
+  StringUTF16 converted;
+  EXPECT_FALSE(UTF32ToUTF16(kMixed, converted));
+  EXPECT_EQ(
+    LONGLP_LITERAL_UTF16("A\xd800\xdf00z\xfffd\x4f60\xd83d\xde00\xd83d"
+                         "\xde01\xd83d\xde02\xd83d\xde03\xfffd and some "
+                         "ASCII text"),
+    converted);
+}
+
+TEST(UTFStringConversionTest, ConvertUTF32MatchesScalarEncoder) {
+  std::mt19937 engine(20230903);    // NOLINT(*-magic-numbers)
+  for (size_t runs = 0; runs < 100; ++runs) {
+    const auto input = RandomUTF32(engine, runs);
+
+    StringUTF8 expected_utf8;
+    const bool expected_success = ReferenceFromUTF32(input, expected_utf8);
+    StringUTF8 utf8;
+    EXPECT_EQ(expected_success, UTF32ToUTF8(input, utf8));
+    ExpectEQ(expected_utf8, utf8);
+
+    StringUTF16 expected_utf16;
+    ReferenceFromUTF32(input, expected_utf16);
+    StringUTF16 utf16;
+    EXPECT_EQ(expected_success, UTF32ToUTF16(input, utf16));
+    EXPECT_EQ(expected_utf16, utf16);
+  }
+}
+
+TEST(UTFStringConversionTest, ConvertInByteOrder) {
+  constexpr auto kSwapped = std::endian::native == std::endian::little
+                            ? std::endian::big
+                            : std::endian::little;
+  std::mt19937 engine(20230917);    // NOLINT(*-magic-numbers)
+  // Long enough for every kernel width, with lone surrogates, invalid code
+  // points and a short tail.
+  for (size_t length : {0U, 1U, 100U, 3000U}) {
+    const auto utf16 = RandomUTF16(engine, length);
+    const auto utf32 = RandomUTF32(engine, length / 10);
+
+    StringUTF16 swapped16(utf16);
+    for (auto& unit : swapped16) {
+      unit = static_cast<CharUTF16>((unit >> 8U) | (unit << 8U));
+    }
+    StringUTF32 swapped32(utf32);
+    for (auto& unit : swapped32) {
+      unit = ((unit >> 24U) & 0xFFU) | ((unit >> 8U) & 0xFF00U) |
+             ((unit << 8U) & 0xFF0000U) | (unit << 24U);
+    }
+
+    StringUTF8 expected;
+    StringUTF8 converted;
+    EXPECT_EQ(
+      UTF16ToUTF8(utf16, expected),
+      UTF16ToUTF8(swapped16, kSwapped, converted));
+    ExpectEQ(expected, converted);
+    EXPECT_EQ(
+      UTF16ToUTF8(utf16, expected),
+      UTF16ToUTF8(utf16, std::endian::native, converted));
+    ExpectEQ(expected, converted);
+
+    EXPECT_EQ(
+      UTF32ToUTF8(utf32, expected),
+      UTF32ToUTF8(swapped32, kSwapped, converted));
+    ExpectEQ(expected, converted);
+
+    // Into a span, too small first.
+    std::vector<CharUTF8> buffer(expected.size() / 2);
+    UTFConversionResult result =
+      UTF32ToUTF8(swapped32, kSwapped, std::span(buffer));
+    ASSERT_EQ(expected.size(), result.size);
+    if (buffer.size() < expected.size()) {
+      buffer.resize(result.size);
+      result = UTF32ToUTF8(swapped32, kSwapped, std::span(buffer));
+    }
+    ExpectEQ(expected, StringViewUTF8(buffer.data(), result.size));
+
+    UTF16ToUTF8(utf16, expected);
+    buffer.resize(expected.size());
+    result = UTF16ToUTF8(swapped16, kSwapped, std::span(buffer));
+    ASSERT_EQ(expected.size(), result.size);
+    ExpectEQ(expected, StringViewUTF8(buffer.data(), result.size));
+  }
+
+  // UTF-16BE as it comes from the network.
+  constexpr std::array<uint8_t, 8> kBigEndian = {
+    0x00, 'h', 0x00, 0xE9, 0xD8, 0x3D, 0xDE, 0x00};
+  StringUTF16 big_endian(kBigEndian.size() / 2, CharUTF16{});
+  std::memcpy(big_endian.data(), kBigEndian.data(), kBigEndian.size());
+  StringUTF8 utf8;
+  EXPECT_TRUE(UTF16ToUTF8(big_endian, std::endian::big, utf8));
+  ExpectEQ(LONGLP_LITERAL_UTF8("h\u00E9\U0001F600"), utf8);
+}
+
+TEST(UTFStringConversionTest, ConvertToASCII) {
+  constexpr StringViewUTF16 kASCII16 =
+    LONGLP_LITERAL_UTF16("The quick brown fox jumps over the lazy dog");
+  constexpr StringViewUTF32 kASCII32 =
+    LONGLP_LITERAL_UTF32("The quick brown fox jumps over the lazy dog");
+
+  StringASCII converted;
+  EXPECT_TRUE(UTF16ToASCII(kASCII16, converted));
+  EXPECT_EQ("The quick brown fox jumps over the lazy dog", converted);
+  EXPECT_TRUE(UTF32ToASCII(kASCII32, converted));
+  EXPECT_EQ("The quick brown fox jumps over the lazy dog", converted);
+
+  // Code units that are not ASCII are truncated to 7 bits.
+  constexpr StringViewUTF16 kNonASCII16 =
+    LONGLP_LITERAL_UTF16("The quick brown fox jumps over \x00e9 lazy dog");
+  constexpr StringViewUTF32 kNonASCII32 =
+    LONGLP_LITERAL_UTF32("The quick brown fox jumps over \x4f60 lazy dog");
+  EXPECT_FALSE(UTF16ToASCII(kNonASCII16, converted));
+  EXPECT_EQ("The quick brown fox jumps over i lazy dog", converted);
+  EXPECT_FALSE(UTF32ToASCII(kNonASCII32, converted));
+  EXPECT_EQ("The quick brown fox jumps over ` lazy dog", converted);
+}
+
+TEST(UTFStringConversionTest, ConvertUTF8ToASCII) {
+  StringASCII converted;
+  EXPECT_TRUE(UTF8ToASCII(StringViewUTF8(), converted));
+  EXPECT_EQ("", converted);
+
+  const StringUTF8 ascii(1000, 'a');
+  EXPECT_TRUE(UTF8ToASCII(ascii, converted));
+  EXPECT_EQ(StringASCII(1000, 'a'), converted);
+  EXPECT_TRUE(UTF8ToASCIILossy(ascii, converted));
+  EXPECT_EQ(StringASCII(1000, 'a'), converted);
+
+  // Strict mode stops at the first non-ASCII byte, wherever it is.
+  for (size_t i = 0; i < 200; ++i) {
+    StringUTF8 input(200, 'a');
+    input.replace(i, 1, LONGLP_LITERAL_UTF8("é"));
+    EXPECT_FALSE(UTF8ToASCII(input, converted));
+    EXPECT_EQ(StringASCII(i, 'a'), converted);
+
+    EXPECT_FALSE(UTF8ToASCIILossy(input, converted, '*'));
+    StringASCII expected(200, 'a');
+    expected[i] = '*';
+    EXPECT_EQ(expected, converted);
+  }
+
+  // One substitute per code point, or per sequence replaced by U+FFFD.
+  constexpr StringViewUTF8 kMixed =
+    LONGLP_LITERAL_UTF8("caf\xC3\xA9 \xF0\x9F\x98\x80\xE4\xBD!\xFF\x80");
+  EXPECT_FALSE(UTF8ToASCIILossy(kMixed, converted));
+  EXPECT_EQ("caf? ?\?!??", converted);
+}
+
+TEST(UTFStringConversionTest, ConvertUTF8ToUTF32) {
+  constexpr StringViewUTF8 kNonBMP = LONGLP_LITERAL_UTF8("A\xF0\x90\x8C\x80z");
+  constexpr StringViewUTF8 kSurrogate = LONGLP_LITERAL_UTF8("\xed\xb0\x80");
+
+  StringUTF32 converted;
+  EXPECT_TRUE(UTF8ToUTF32(kNonBMP, converted));
+  EXPECT_EQ(LONGLP_LITERAL_UTF32("A\x10300z"), converted);
+
+  EXPECT_FALSE(UTF8ToUTF32(kSurrogate, converted));
+  EXPECT_EQ(LONGLP_LITERAL_UTF32("\xfffd\xfffd\xfffd"), converted);
+}
+
+TEST(UTFStringConversionTest, ConvertLatin1) {
+  constexpr StringViewLatin1 kLatin1 = "caf\xE9 \xA9\xFF\x7F";
+  constexpr StringViewUTF8 kUTF8 =
+    LONGLP_LITERAL_UTF8("caf\xC3\xA9 \xC2\xA9\xC3\xBF\x7F");
+  constexpr StringViewUTF16 kUTF16 =
+    LONGLP_LITERAL_UTF16("caf\x00e9 \x00a9\x00ff\x007f");
+
+  StringUTF8 utf8;
+  EXPECT_TRUE(Latin1ToUTF8(kLatin1, utf8));
+  ExpectEQ(kUTF8, utf8);
+  StringUTF16 utf16;
+  EXPECT_TRUE(Latin1ToUTF16(kLatin1, utf16));
+  EXPECT_EQ(kUTF16, utf16);
+
+  StringLatin1 latin1;
+  EXPECT_TRUE(UTF8ToLatin1(kUTF8, latin1));
+  EXPECT_EQ(kLatin1, latin1);
+  EXPECT_TRUE(UTF16ToLatin1(kUTF16, latin1));
+  EXPECT_EQ(kLatin1, latin1);
+
+  // One '?' per code point above U+00FF, or per sequence replaced by U+FFFD.
+  constexpr StringViewUTF8 kMixed8 =
+    LONGLP_LITERAL_UTF8("\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80\xC3!\xFF");
+  EXPECT_FALSE(UTF8ToLatin1(kMixed8, latin1));
+  EXPECT_EQ("\xE9???" "!?", latin1);
+  constexpr StringViewUTF16 kMixed16 =
+    LONGLP_LITERAL_UTF16("\x00e9\x20ac\xd83d\xde00\xd800!");
+  EXPECT_FALSE(UTF16ToLatin1(kMixed16, latin1));
+  EXPECT_EQ("\xE9???" "!", latin1);
+
+  UTFConversionResult result;
+  std::array<CharLatin1, 8> buffer{};
+  result = UTF16ToLatin1(kMixed16, std::span(buffer));
+  EXPECT_EQ(5U, result.size);
+  EXPECT_EQ(1U, result.first_invalid_offset);
+  EXPECT_EQ(3U, result.replaced_count);
+
+  // Too small: nothing is written, the needed size is returned.
+  std::array<CharUTF8, 10> small{};
+  result = Latin1ToUTF8(kLatin1, std::span(small));
+  EXPECT_EQ(kUTF8.size(), result.size);
+  EXPECT_FALSE(result.success);
+  EXPECT_EQ(CharUTF8{}, small[0]);
+}
+
+TEST(UTFStringConversionTest, ConvertLatin1MatchesReference) {
+  std::mt19937 engine(20230915);    // NOLINT(*-magic-numbers)
+  std::uniform_int_distribution<int> pick_byte(0, 0xFF);
+  std::bernoulli_distribution pick_non_ascii(0.2);
+  for (size_t length = 0; length < 300; ++length) {
+    // Mostly ASCII, as Latin-1 text is.
+    StringLatin1 latin1;
+    for (size_t i = 0; i < length; ++i) {
+      latin1.push_back(static_cast<CharLatin1>(
+        pick_non_ascii(engine) ? pick_byte(engine) : pick_byte(engine) & 0x7F));
+    }
+
+    StringUTF8 utf8;
+    EXPECT_TRUE(Latin1ToUTF8(latin1, utf8));
+    StringUTF8 expected8;
+    StringUTF16 expected16;
+    for (CharLatin1 byte : latin1) {
+      const icu::CodePoint code_point(static_cast<uint8_t>(byte));
+      AppendUnicodeCharacter(code_point, expected8);
+      AppendUnicodeCharacter(code_point, expected16);
+    }
+    ExpectEQ(expected8, utf8);
+    StringUTF16 utf16;
+    EXPECT_TRUE(Latin1ToUTF16(latin1, utf16));
+    EXPECT_EQ(expected16, utf16);
+
+    StringLatin1 round_trip;
+    EXPECT_TRUE(UTF8ToLatin1(utf8, round_trip));
+    EXPECT_EQ(latin1, round_trip);
+    EXPECT_TRUE(UTF16ToLatin1(utf16, round_trip));
+    EXPECT_EQ(latin1, round_trip);
+
+    // Code points past U+00FF, and invalid input, anywhere in the text.
+    const auto to_latin1 = [](StringViewUTF32 utf32, StringLatin1& output) {
+      output.clear();
+      bool success = true;
+      for (CharUTF32 code_point : utf32) {
+        success = success && code_point <= 0xFF;
+        output.push_back(
+          code_point <= 0xFF ? static_cast<CharLatin1>(code_point) : '?');
+      }
+      return success;
+    };
+    const size_t position = utf8.empty() ? 0 : engine() % utf8.size();
+    const StringUTF8 mixed8 =
+      StringUTF8(utf8.substr(0, position)) + RandomUTF8(engine, 2) +
+      StringUTF8(utf8.substr(position));
+    StringUTF32 utf32;
+    UTF8ToUTF32(mixed8, utf32);
+    StringLatin1 expected;
+    EXPECT_EQ(to_latin1(utf32, expected), UTF8ToLatin1(mixed8, round_trip));
+    EXPECT_EQ(expected, round_trip);
+
+    const StringUTF16 mixed16 = RandomUTF16(engine, 1) + utf16 +
+                                RandomUTF16(engine, 1);
+    UTF16ToUTF32(mixed16, utf32);
+    EXPECT_EQ(to_latin1(utf32, expected), UTF16ToLatin1(mixed16, round_trip));
+    EXPECT_EQ(expected, round_trip);
+  }
+}
+
+TEST(UTFStringConversionTest, ConvertIntoSpan) {
+  constexpr StringViewUTF8 kUTF8 =
+    LONGLP_LITERAL_UTF8("A\xF0\x90\x8C\x80z\xFF");
+  constexpr StringViewUTF16 kUTF16 =
+    LONGLP_LITERAL_UTF16("A\xd800\xdf00z\xfffd");
+
+  // Too small: nothing is written, the needed size is returned.
+  std::array<CharUTF16, 4> small{};
+  auto result = UTF8ToUTF16(kUTF8, std::span(small));
+  EXPECT_EQ(kUTF16.size(), result.size);
+  EXPECT_FALSE(result.success);
+  EXPECT_EQ(CharUTF16{}, small[0]);
+
+  std::array<CharUTF16, 5> exact{};
+  result = UTF8ToUTF16(kUTF8, std::span(exact));
+  EXPECT_EQ(kUTF16.size(), result.size);
+  EXPECT_FALSE(result.success);    // The input ends with an invalid byte.
+  EXPECT_EQ(kUTF16, StringViewUTF16(exact.data(), result.size));
+
+  std::array<CharUTF8, 64> utf8{};
+  result = UTF16ToUTF8(kUTF16, std::span(utf8));
+  EXPECT_EQ(9U, result.size);
+  EXPECT_TRUE(result.success);
+  ExpectEQ(
+    LONGLP_LITERAL_UTF8("A\xF0\x90\x8C\x80z\xEF\xBF\xBD"),
+    StringViewUTF8(utf8.data(), result.size));
+
+  std::array<CharUTF32, 2> utf32{};
+  result = UTF16ToUTF32(kUTF16, std::span(utf32));
+  EXPECT_EQ(4U, result.size);
+  EXPECT_FALSE(result.success);
+
+  std::array<CharASCII, 4> ascii{};
+  result = UTF32ToASCII(LONGLP_LITERAL_UTF32("abc"), std::span(ascii));
+  EXPECT_EQ(3U, result.size);
+  EXPECT_TRUE(result.success);
+  EXPECT_EQ("abc", StringViewASCII(ascii.data(), result.size));
+  result = UTF32ToASCII(LONGLP_LITERAL_UTF32("abcde"), std::span(ascii));
+  EXPECT_EQ(5U, result.size);
+  EXPECT_FALSE(result.success);
+
+  result = ASCIIToUTF16("abcde", std::span(small));
+  EXPECT_EQ(5U, result.size);
+  EXPECT_FALSE(result.success);
+  result = ASCIIToUTF16("abcd", std::span(small));
+  EXPECT_EQ(4U, result.size);
+  EXPECT_TRUE(result.success);
+  EXPECT_EQ(LONGLP_LITERAL_UTF16("abcd"), StringViewUTF16(small.data(), 4));
+}
+
+TEST(UTFStringConversionTest, ConvertIntoSpanMatchesString) {
+  std::mt19937 engine(20230906);    // NOLINT(*-magic-numbers)
+  for (size_t fragments = 0; fragments < 100; ++fragments) {
+    const auto input = RandomUTF8(engine, fragments);
+    StringUTF16 expected;
+    const bool expected_success = UTF8ToUTF16(input, expected);
+
+    // Worst case, exact and one too small.
+    for (size_t size : {input.size(), expected.size(), expected.size() - 1}) {
+      if (size > input.size()) {
+        continue;
+      }
+      StringUTF16 buffer(size, CharUTF16{});
+      const auto result = UTF8ToUTF16(input, std::span(buffer));
+      if (size < expected.size()) {
+        EXPECT_EQ(expected.size(), result.size);
+        EXPECT_EQ(StringUTF16(size, CharUTF16{}), buffer);
+        continue;
+      }
+      EXPECT_EQ(expected_success, result.success);
+      EXPECT_EQ(expected, buffer.substr(0, result.size));
+    }
+
+    const auto utf16 = RandomUTF16(engine, fragments);
+    StringUTF8 expected8;
+    const bool expected8_success = UTF16ToUTF8(utf16, expected8);
+    StringUTF8 buffer(expected8.size(), CharUTF8{});
+    const auto result = UTF16ToUTF8(utf16, std::span(buffer));
+    EXPECT_EQ(expected8_success, result.success);
+    ExpectEQ(expected8, buffer.substr(0, result.size));
+  }
+}
+
+TEST(UTFStringConversionTest, ReportInvalidInput) {
+  // Valid input, long enough to go through the vector kernels.
+  StringUTF8 valid;
+  for (size_t i = 0; i < 500; ++i) {    // NOLINT(*-magic-numbers)
+    valid += LONGLP_LITERAL_UTF8("\xC3\xA9");
+  }
+  StringUTF16 utf16;
+  UTFConversionResult result;
+  EXPECT_TRUE(UTF8ToUTF16(valid, utf16, result));
+  EXPECT_TRUE(result.success);
+  EXPECT_EQ(utf16.size(), result.size);
+  EXPECT_FALSE(result.first_invalid_offset.has_value());
+  EXPECT_EQ(0U, result.replaced_count);
+
+  // The truncated sequence \xE4\xBD is replaced by one U+FFFD, the lone
+  // continuation byte by another one.
+  StringUTF8 invalid = valid;
+  invalid += LONGLP_LITERAL_UTF8("ab\xE4\xBDz\x80");
+  EXPECT_FALSE(UTF8ToUTF16(invalid, utf16, result));
+  EXPECT_FALSE(result.success);
+  EXPECT_EQ(utf16.size(), result.size);
+  EXPECT_EQ(valid.size() + 2, result.first_invalid_offset);
+  EXPECT_EQ(2U, result.replaced_count);
+
+  StringUTF32 utf32;
+  EXPECT_FALSE(UTF8ToUTF32(invalid, utf32, result));
+  EXPECT_EQ(valid.size() + 2, result.first_invalid_offset);
+  EXPECT_EQ(2U, result.replaced_count);
+
+  // A lone trail surrogate, a lone lead surrogate at the end.
+  constexpr StringViewUTF16 kUTF16 =
+    LONGLP_LITERAL_UTF16("ab\xdc00\x0063\xd800");
+  StringUTF8 utf8;
+  EXPECT_FALSE(UTF16ToUTF8(kUTF16, utf8, result));
+  EXPECT_EQ(2U, result.first_invalid_offset);
+  EXPECT_EQ(2U, result.replaced_count);
+  EXPECT_EQ(utf8.size(), result.size);
+
+  constexpr std::array<CharUTF32, 4> kUTF32 = {
+    U'a',
+    0x110000,
+    0xD800,
+    U'b'};
+  EXPECT_FALSE(UTF32ToUTF16(
+    StringViewUTF32(kUTF32.data(), kUTF32.size()),
+    utf16,
+    result));
+  EXPECT_EQ(1U, result.first_invalid_offset);
+  EXPECT_EQ(2U, result.replaced_count);
+
+  // The span overloads report the same.
+  std::array<CharUTF16, 2048> buffer{};
+  result = UTF8ToUTF16(invalid, std::span(buffer));
+  EXPECT_EQ(valid.size() + 2, result.first_invalid_offset);
+  EXPECT_EQ(2U, result.replaced_count);
+
+  std::array<CharASCII, 8> ascii{};
+  result = UTF16ToASCII(kUTF16, std::span(ascii));
+  EXPECT_EQ(2U, result.first_invalid_offset);
+  EXPECT_EQ(2U, result.replaced_count);
+}
+
+TEST(UTFStringConversionTest, AdjustOffsets) {
+  constexpr size_t kNpos = StringUTF16::npos;
+
+  // a, U+00E9, b, U+10300, a lone continuation byte, c.
+  constexpr StringViewUTF8 kUTF8 =
+    LONGLP_LITERAL_UTF8("a\xC3\xA9" "b\xF0\x90\x8C\x80\x80" "c");
+  StringUTF16 utf16;
+  std::vector<size_t> offsets = {0, 1, 2, 3, 4, 5, 8, 9, 10, 11};
+  EXPECT_FALSE(UTF8ToUTF16AndAdjustOffsets(kUTF8, utf16, offsets));
+  EXPECT_EQ(LONGLP_LITERAL_UTF16("a\x00E9" "b\xD800\xDF00\xFFFD" "c"), utf16);
+  EXPECT_EQ(
+    (std::vector<size_t>{0, 1, kNpos, 2, 3, kNpos, 5, 6, 7, kNpos}),
+    offsets);
+
+  // Repeated offsets map to the same place, offsets out of order do not map.
+  offsets = {3, 3, 1};
+  UTF8ToUTF16AndAdjustOffsets(kUTF8, utf16, offsets);
+  EXPECT_EQ((std::vector<size_t>{2, 2, kNpos}), offsets);
+
+  offsets = {0, 2, 3};
+  EXPECT_TRUE(UTF8ToUTF16AndAdjustOffsets(
+    LONGLP_LITERAL_UTF8("ab"),
+    utf16,
+    offsets));
+  EXPECT_EQ((std::vector<size_t>{0, 2, kNpos}), offsets);
+
+  // Also on ASCII input, which takes a shortcut.
+  offsets = {3, 3, 1};
+  EXPECT_TRUE(UTF8ToUTF16AndAdjustOffsets(
+    LONGLP_LITERAL_UTF8("abcdef"),
+    utf16,
+    offsets));
+  EXPECT_EQ((std::vector<size_t>{3, 3, kNpos}), offsets);
+
+  // a, U+10300, a lone trail surrogate, b.
+  constexpr StringViewUTF16 kUTF16 =
+    LONGLP_LITERAL_UTF16("a\xD800\xDF00\xDC00" "b");
+  StringUTF8 utf8;
+  offsets = {0, 1, 2, 3, 4, 5, 6};
+  EXPECT_FALSE(UTF16ToUTF8AndAdjustOffsets(kUTF16, utf8, offsets));
+  ExpectEQ(LONGLP_LITERAL_UTF8("a\xF0\x90\x8C\x80\xEF\xBF\xBD" "b"), utf8);
+  EXPECT_EQ((std::vector<size_t>{0, 1, kNpos, 5, 8, 9, kNpos}), offsets);
+
+  offsets = {3, 3, 1};
+  EXPECT_TRUE(UTF16ToUTF8AndAdjustOffsets(
+    LONGLP_LITERAL_UTF16("abcdef"),
+    utf8,
+    offsets));
+  EXPECT_EQ((std::vector<size_t>{3, 3, kNpos}), offsets);
+}
+
+TEST(UTFStringConversionTest, AdjustOffsetsMatchesPrefixConversion) {
+  std::mt19937 engine(20230910);    // NOLINT(*-magic-numbers)
+  const auto utf8  = RandomUTF8(engine, 300);
+  const auto utf16 = RandomUTF16(engine, 300);
+
+  // Every offset of the input, mapped by converting the prefix in front of
+  // it when it starts a code point.
+  std::vector<size_t> expected_utf16_offsets(
+    utf8.size() + 2,
+    StringUTF16::npos);
+  for (size_t i = 0;;) {
+    StringUTF16 prefix;
+    UTF8ToUTF16(utf8.substr(0, i), prefix);
+    expected_utf16_offsets[i] = prefix.size();
+    if (i == utf8.size()) {
+      break;
+    }
+    auto next = static_cast<int32_t>(i);
+    UChar32 code_point = 0;
+    icu::internal::U8Next(
+      std::bit_cast<const uint8_t*>(utf8.data()),
+      next,
+      static_cast<int32_t>(utf8.size()),
+      code_point);
+    i = static_cast<size_t>(next);
+  }
+  std::vector<size_t> offsets8(utf8.size() + 2);
+  std::iota(offsets8.begin(), offsets8.end(), 0);
+  StringUTF16 converted16;
+  StringUTF16 expected16;
+  EXPECT_EQ(
+    UTF8ToUTF16(utf8, expected16),
+    UTF8ToUTF16AndAdjustOffsets(utf8, converted16, offsets8));
+  EXPECT_EQ(expected16, converted16);
+  EXPECT_EQ(expected_utf16_offsets, offsets8);
+
+  std::vector<size_t> expected_utf8_offsets(
+    utf16.size() + 2,
+    StringUTF8::npos);
+  for (size_t i = 0;;) {
+    StringUTF8 prefix;
+    UTF16ToUTF8(utf16.substr(0, i), prefix);
+    expected_utf8_offsets[i] = prefix.size();
+    if (i == utf16.size()) {
+      break;
+    }
+    i += i + 1 < utf16.size() && icu::internal::U16IsLead(utf16[i]) &&
+             icu::internal::U16IsTrail(utf16[i + 1])
+           ? 2
+           : 1;
+  }
+  std::vector<size_t> offsets16(utf16.size() + 2);
+  std::iota(offsets16.begin(), offsets16.end(), 0);
+  StringUTF8 converted8;
+  StringUTF8 expected8;
+  EXPECT_EQ(
+    UTF16ToUTF8(utf16, expected8),
+    UTF16ToUTF8AndAdjustOffsets(utf16, converted8, offsets16));
+  ExpectEQ(expected8, converted8);
+  EXPECT_EQ(expected_utf8_offsets, offsets16);
+}
+
+TEST(UTFStringConversionTest, EncodeCodePoints) {
+  std::mt19937 engine(20230913);    // NOLINT(*-magic-numbers)
+  // More than one chunk, with some code points that are not scalar values.
+  std::uniform_int_distribution<UChar32> any(-1, 0x110000);
+  std::uniform_int_distribution<UChar32> ascii(0, 0x7F);
+  std::vector<icu::CodePoint> code_points;
+  StringUTF32 utf32;
+  for (size_t i = 0; i < 5000; ++i) {    // NOLINT(*-magic-numbers)
+    const UChar32 value = i % 3 == 0 ? any(engine) : ascii(engine);
+    code_points.emplace_back(value);
+    utf32.push_back(static_cast<CharUTF32>(value));
+  }
+
+  StringUTF8 expected8;
+  StringUTF8 utf8;
+  EXPECT_EQ(UTF32ToUTF8(utf32, expected8), EncodeCodePoints(code_points, utf8));
+  ExpectEQ(expected8, utf8);
+
+  StringUTF16 expected16;
+  StringUTF16 utf16;
+  EXPECT_EQ(
+    UTF32ToUTF16(utf32, expected16),
+    EncodeCodePoints(code_points, utf16));
+  EXPECT_EQ(expected16, utf16);
+
+  UTFConversionResult expected_result;
+  UTF32ToUTF8(utf32, expected8, expected_result);
+  std::vector<CharUTF8> buffer(expected8.size());
+  const auto result = EncodeCodePoints(code_points, std::span(buffer));
+  EXPECT_EQ(expected8.size(), result.size);
+  EXPECT_EQ(expected_result.first_invalid_offset, result.first_invalid_offset);
+  EXPECT_EQ(expected_result.replaced_count, result.replaced_count);
+  ExpectEQ(expected8, StringViewUTF8(buffer.data(), buffer.size()));
+
+  // Too small: nothing is written, the needed size is returned.
+  std::array<CharUTF16, 2> small{};
+  const std::array<icu::CodePoint, 2> kEmoji = {
+    icu::CodePoint(0x1F600),
+    icu::CodePoint('a')};
+  EXPECT_EQ(3U, EncodeCodePoints(kEmoji, std::span(small)).size);
+  EXPECT_EQ(CharUTF16{}, small[0]);
+}
+
+TEST(UTFStringConversionTest, DecodeCodePoints) {
+  std::mt19937 engine(20230914);    // NOLINT(*-magic-numbers)
+  const auto utf8  = RandomUTF8(engine, 3000);
+  const auto utf16 = RandomUTF16(engine, 3000);
+
+  const auto expect_decodes_as = [](const auto& src, auto convert) {
+    StringUTF32 utf32;
+    UTFConversionResult expected;
+    convert(src, utf32, expected);
+
+    std::vector<icu::CodePoint> code_points(src.size());
+    const auto result = DecodeCodePoints(src, std::span(code_points));
+    EXPECT_EQ(expected.size, result.size);
+    EXPECT_EQ(expected.success, result.success);
+    EXPECT_EQ(expected.first_invalid_offset, result.first_invalid_offset);
+    EXPECT_EQ(expected.replaced_count, result.replaced_count);
+    ASSERT_EQ(utf32.size(), result.size);
+    for (size_t i = 0; i < utf32.size(); ++i) {
+      EXPECT_EQ(static_cast<UChar32>(utf32[i]), code_points[i].value());
+    }
+  };
+  expect_decodes_as(
+    StringViewUTF8(utf8),
+    [](StringViewUTF8 src, StringUTF32& dest, UTFConversionResult& result) {
+      UTF8ToUTF32(src, dest, result);
+    });
+  expect_decodes_as(
+    StringViewUTF16(utf16),
+    [](StringViewUTF16 src, StringUTF32& dest, UTFConversionResult& result) {
+      UTF16ToUTF32(src, dest, result);
+    });
+
+  constexpr std::array<CharUTF32, 3> kUTF32 = {U'a', 0xD800, U'b'};
+  std::array<icu::CodePoint, 3> code_points{};
+  const auto result = DecodeCodePoints(
+    StringViewUTF32(kUTF32.data(), kUTF32.size()),
+    std::span(code_points));
+  EXPECT_EQ(3U, result.size);
+  EXPECT_EQ(1U, result.first_invalid_offset);
+  EXPECT_EQ(icu::CodePoint(0xFFFD), code_points[1]);
+
+  // Too small for the decoded text.
+  std::array<icu::CodePoint, 1> small{};
+  EXPECT_EQ(
+    2U,
+    DecodeCodePoints(LONGLP_LITERAL_UTF8("\xC3\xA9" "a"), std::span(small))
+      .size);
+}
+
+TEST(UTFStringConversionTest, ParallelMatchesSerial) {
+  std::mt19937 engine(20230908);    // NOLINT(*-magic-numbers)
+  // Large enough for several threads, with pieces cut at random places.
+  const auto utf8  = RandomUTF8(engine, 400000);
+  const auto utf16 = RandomUTF16(engine, 400000);
+  ASSERT_GT(utf8.size(), size_t{1} << 20U);
+  ASSERT_GT(utf16.size(), size_t{1} << 20U);
+
+  for (size_t max_threads : {0U, 1U, 3U}) {
+    StringUTF16 serial16;
+    StringUTF16 parallel16;
+    EXPECT_EQ(
+      UTF8ToUTF16(utf8, serial16),
+      UTF8ToUTF16Parallel(utf8, parallel16, max_threads));
+    EXPECT_EQ(serial16, parallel16);
+
+    StringUTF32 serial32;
+    StringUTF32 parallel32;
+    EXPECT_EQ(
+      UTF8ToUTF32(utf8, serial32),
+      UTF8ToUTF32Parallel(utf8, parallel32, max_threads));
+    EXPECT_EQ(serial32, parallel32);
+
+    StringUTF8 serial8;
+    StringUTF8 parallel8;
+    EXPECT_EQ(
+      UTF16ToUTF8(utf16, serial8),
+      UTF16ToUTF8Parallel(utf16, parallel8, max_threads));
+    ExpectEQ(serial8, parallel8);
+
+    EXPECT_EQ(
+      UTF16ToUTF32(utf16, serial32),
+      UTF16ToUTF32Parallel(utf16, parallel32, max_threads));
+    EXPECT_EQ(serial32, parallel32);
+
+    EXPECT_EQ(
+      UTF32ToUTF8(serial32, serial8),
+      UTF32ToUTF8Parallel(serial32, parallel8, max_threads));
+    ExpectEQ(serial8, parallel8);
+
+    EXPECT_EQ(
+      UTF32ToUTF16(serial32, serial16),
+      UTF32ToUTF16Parallel(serial32, parallel16, max_threads));
+    EXPECT_EQ(serial16, parallel16);
+  }
+}
+
+TEST(UTFStringConversionTest, ConvertBatch) {
+  std::mt19937 engine(20230909);    // NOLINT(*-magic-numbers)
+  std::vector<StringUTF8> strings(1000);
+  for (size_t i = 0; i < strings.size(); ++i) {
+    strings[i] = RandomUTF8(engine, i % 7);
+  }
+  // A sequence cut at the end of a string is not completed by the next one.
+  strings[1] = LONGLP_LITERAL_UTF8("\xE4\xBD");
+  strings[2] = LONGLP_LITERAL_UTF8("\xA0");
+  const std::vector<StringViewUTF8> batch(strings.begin(), strings.end());
+
+  StringUTF16 utf16 = LONGLP_LITERAL_UTF16("overwritten");
+  std::vector<size_t> offsets;
+  bool expected_success = true;
+  ASSERT_FALSE(UTF8ToUTF16Batch(batch, utf16, offsets));
+  ASSERT_EQ(batch.size() + 1, offsets.size());
+  EXPECT_EQ(0U, offsets.front());
+  EXPECT_EQ(utf16.size(), offsets.back());
+
+  std::vector<StringViewUTF16> utf16_batch;
+  for (size_t i = 0; i < batch.size(); ++i) {
+    StringUTF16 expected;
+    expected_success = UTF8ToUTF16(batch[i], expected) && expected_success;
+    const StringViewUTF16 converted =
+      StringViewUTF16(utf16).substr(offsets[i], offsets[i + 1] - offsets[i]);
+    EXPECT_EQ(expected, converted) << i;
+    utf16_batch.push_back(converted);
+  }
+  EXPECT_FALSE(expected_success);
+
+  StringUTF8 utf8;
+  std::vector<size_t> utf8_offsets;
+  EXPECT_TRUE(UTF16ToUTF8Batch(utf16_batch, utf8, utf8_offsets));
+  ASSERT_EQ(batch.size() + 1, utf8_offsets.size());
+  for (size_t i = 0; i < utf16_batch.size(); ++i) {
+    StringUTF8 expected;
+    UTF16ToUTF8(utf16_batch[i], expected);
+    ExpectEQ(
+      expected,
+      StringViewUTF8(utf8).substr(
+        utf8_offsets[i],
+        utf8_offsets[i + 1] - utf8_offsets[i]));
+  }
+
+  EXPECT_TRUE(UTF8ToUTF16Batch({}, utf16, offsets));
+  EXPECT_TRUE(utf16.empty());
+  EXPECT_EQ(std::vector<size_t>{0}, offsets);
+}
+}    // namespace longlp::base
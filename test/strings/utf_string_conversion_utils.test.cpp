@@ -4,8 +4,77 @@
 
 #include <base/strings/utf_string_conversion_utils.h>
 
+#include <base/strings/typedefs.h>
+#include <base/strings/utf_string_conversion.h>
 #include <gtest/gtest.h>
 
 namespace longlp::base {
-// TODO(longlp, test): Write test
+TEST(UTFStringConversionUtilsTest, PrepareForUTF8OutputReservesExactSize) {
+  // A non-ASCII first character used to reserve 3 bytes per code unit.
+  StringUTF16 utf16(1000, u'a');
+  utf16[0] = u'\x00e9';
+  StringUTF8 utf8;
+  ASSERT_TRUE(UTF16ToUTF8(utf16, utf8));
+
+  StringUTF8 output;
+  PrepareForUTF8Output(StringViewUTF16(utf16), output);
+  EXPECT_TRUE(output.empty());
+  EXPECT_GE(output.capacity(), utf8.size());
+  EXPECT_LT(output.capacity(), 2 * utf16.size());
+
+  // Lone surrogates are counted as the 3 bytes of U+FFFD.
+  const StringUTF16 invalid = {0xD800, u'a', 0xDC00, 0xD83D, 0xDE00};
+  StringUTF8 invalid_output;
+  PrepareForUTF8Output(StringViewUTF16(invalid), invalid_output);
+  EXPECT_GE(invalid_output.capacity(), 3U + 1U + 3U + 4U);
+
+  StringUTF32 utf32(1000, U'a');
+  utf32[0] = U'\x1F600';
+  StringUTF8 output32;
+  PrepareForUTF8Output(StringViewUTF32(utf32), output32);
+  EXPECT_GE(output32.capacity(), utf32.size() + 3);
+  EXPECT_LT(output32.capacity(), 2 * utf32.size());
+}
+
+TEST(UTFStringConversionUtilsTest, PrepareForUTF16Or32OutputReservesExactSize) {
+  StringUTF8 utf8(1000, 'a');
+  utf8.replace(0, 1, LONGLP_LITERAL_UTF8("\U0001F600"));
+  // Malformed sequences are counted as one U+FFFD each.
+  utf8 += LONGLP_LITERAL_UTF8("\xE4\xBD\xFF\x80");
+
+  StringUTF16 utf16;
+  PrepareForUTF16Or32Output(StringViewUTF8(utf8), utf16);
+  EXPECT_TRUE(utf16.empty());
+  EXPECT_GE(utf16.capacity(), 999U + 2U + 3U);
+  EXPECT_LT(utf16.capacity(), utf8.size() + 16);
+
+  StringUTF32 utf32;
+  PrepareForUTF16Or32Output(StringViewUTF8(utf8), utf32);
+  EXPECT_GE(utf32.capacity(), 999U + 1U + 3U);
+  EXPECT_LT(utf32.capacity(), utf8.size() + 16);
+}
+
+TEST(UTFStringConversionUtilsTest, CountCodePoints) {
+  EXPECT_EQ(0U, CountCodePoints(StringViewUTF8{}));
+  EXPECT_EQ(0U, CountCodePoints(StringViewUTF16{}));
+
+  // a, U+00E9, U+4F60, U+1F600, then the truncated \xE4\xBD and the stray
+  // \xFF count as one U+FFFD each.
+  EXPECT_EQ(
+    6U,
+    CountCodePoints(LONGLP_LITERAL_UTF8(
+      "a\xC3\xA9\xE4\xBD\xA0\xF0\x9F\x98\x80\xE4\xBD\xFF")));
+
+  // Long enough for the vector kernels, with pairs straddling their blocks.
+  StringUTF16 utf16;
+  for (size_t i = 0; i < 333; ++i) {    // NOLINT(*-magic-numbers)
+    utf16 += LONGLP_LITERAL_UTF16("ab\xD83D\xDE00");
+  }
+  utf16 += LONGLP_LITERAL_UTF16("\xDE00\xD83D");
+  EXPECT_EQ(3U * 333U + 2U, CountCodePoints(utf16));
+
+  StringUTF32 utf32;
+  ASSERT_TRUE(UTF16ToUTF32(utf16.substr(0, 4U * 333U), utf32));
+  EXPECT_EQ(utf32.size(), CountCodePoints(utf16.substr(0, 4U * 333U)));
+}
 }    // namespace longlp::base
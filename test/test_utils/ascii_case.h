@@ -0,0 +1,97 @@
+// Copyright 2023 Phi-Long Le. All rights reserved.
+// Use of this source code is governed by a MIT license that can be
+// found in the LICENSE file.
+
+#ifndef LONGLP_TEST_TEST_UTILS_ASCII_CASE_H_
+#define LONGLP_TEST_TEST_UTILS_ASCII_CASE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <base/strings/string_utils.h>
+#include <base/strings/typedefs.h>
+#include <gtest/gtest.h>
+
+#include "test_utils/gtest_fix_u8string_comparison.h"
+
+namespace longlp::base {
+// NOLINTBEGIN(*-magic-numbers)
+
+// Code units for the random tests of the ASCII case functions, among those
+// both |CharA| and |CharB| can hold: the letters, their neighbours, and
+// non-ASCII code units that only look like letters in their low byte.
+template <CharTraits CharA, CharTraits CharB = CharA>
+auto ASCIICaseAlphabet() -> std::vector<uint32_t> {
+  std::vector<uint32_t> alphabet = {
+    '@', 'A', 'M', 'Q', 'Z', '[', '`', 'a', 'm', 'q', 'z', '{', 0xC1, 0xE1};
+  if constexpr (sizeof(CharA) > 1 && sizeof(CharB) > 1) {
+    alphabet.push_back(0x141);
+    alphabet.push_back(0xFF41);
+    alphabet.push_back(0xFF61);
+  }
+  if constexpr (sizeof(CharA) > 2 && sizeof(CharB) > 2) {
+    alphabet.push_back(0x10041);
+  }
+  return alphabet;
+}
+
+// Checks every overload of ToUpperASCII() if |kToUpper|, or of ToLowerASCII()
+// otherwise, against the per-character conversion on random strings of every
+// length up to a few vectors.
+template <bool kToUpper, CharTraits Char>
+void ExpectASCIICaseConversionMatchesPerCharacter() {
+  const auto convert = [](const auto&... args) {
+    if constexpr (kToUpper) {
+      return ToUpperASCII(args...);
+    }
+    else {
+      return ToLowerASCII(args...);
+    }
+  };
+
+  std::mt19937 engine(20230918);
+  const std::vector<uint32_t> alphabet = ASCIICaseAlphabet<Char>();
+  std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+
+  for (size_t length = 0; length <= 200; ++length) {
+    std::basic_string<Char> str;
+    std::basic_string<Char> expected;
+    for (size_t i = 0; i < length; ++i) {
+      str.push_back(static_cast<Char>(alphabet[pick(engine)]));
+      expected.push_back(convert(str.back()));
+    }
+    const std::basic_string_view<Char> view = str;
+
+    ExpectSameString<Char>(expected, convert(view));
+
+    std::basic_string<Char> output(length + 1, Char{'.'});
+    ASSERT_TRUE(convert(view, std::span<Char>(output)));
+    ExpectSameString<Char>(expected, output.substr(0, length));
+    EXPECT_EQ(Char{'.'}, output.back());
+    if (length > 0) {
+      // Too short an output is left untouched.
+      const std::basic_string<Char> untouched(length - 1, Char{'.'});
+      output = untouched;
+      EXPECT_FALSE(convert(view, std::span<Char>(output)));
+      ExpectSameString<Char>(untouched, output);
+    }
+
+    if constexpr (kToUpper) {
+      ToUpperASCIIInPlace(str);
+    }
+    else {
+      ToLowerASCIIInPlace(str);
+    }
+    ExpectSameString<Char>(expected, str);
+  }
+}
+
+// NOLINTEND(*-magic-numbers)
+}    // namespace longlp::base
+
+#endif    // LONGLP_TEST_TEST_UTILS_ASCII_CASE_H_
@@ -5,7 +5,15 @@
 #ifndef LONGLP_TEST_TEST_UTILS_GTEST_FIX_U8STRING_COMPARISON_H_
 #define LONGLP_TEST_TEST_UTILS_GTEST_FIX_U8STRING_COMPARISON_H_
 
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+
 #include <base/strings/typedefs.h>
+#include <gtest/gtest.h>
 
 namespace longlp::base {
 // A fix for Gtest 1.13 cannot print u8string
@@ -13,6 +21,47 @@ namespace longlp::base {
 // TODO(longlp, gtest): Remove this when we have newer version
 void ExpectEQ(StringViewUTF8 str_a, StringViewUTF8 str_b);
 auto ToStringASCII(StringViewUTF8 str) -> StringASCII;
+
+// EXPECT_EQ for the strings of any code unit type, going through ExpectEQ for
+// UTF-8.
+template <CharTraits Char>
+void ExpectSameString(
+  std::basic_string_view<Char> expected,
+  std::basic_string_view<Char> actual) {
+  if constexpr (std::same_as<Char, CharUTF8>) {
+    ExpectEQ(expected, actual);
+  }
+  else {
+    EXPECT_EQ(expected, actual);
+  }
+}
+
+// Copies an ASCII string into a string of any code unit type, so that typed
+// tests can share their cases.
+template <CharTraits Char>
+auto Widen(StringViewASCII ascii) -> std::basic_string<Char> {
+  return {ascii.begin(), ascii.end()};
+}
+
+// Random text over "abcd", so that patterns and needles match and overlap
+// often. Wider code units use U+0161 for 'd', whose low byte collides with the
+// narrow ones.
+template <CharTraits Char>
+auto RandomSmallAlphabetString(std::mt19937& engine, size_t length)
+  -> std::basic_string<Char> {
+  std::uniform_int_distribution<uint32_t> pick(0, 3);
+  std::basic_string<Char> str;
+  for (size_t i = 0; i < length; ++i) {
+    uint32_t unit = 'a' + pick(engine);
+    if constexpr (sizeof(Char) > 1) {
+      if (unit == 'd') {
+        unit = 0x161;
+      }
+    }
+    str.push_back(static_cast<Char>(unit));
+  }
+  return str;
+}
 }    // namespace longlp::base
 
 #endif    // LONGLP_TEST_TEST_UTILS_GTEST_FIX_U8STRING_COMPARISON_H_